@@ -4,6 +4,7 @@
 
 #include <bench/bench.h>
 
+#include <crypto/keccak.h>
 #include <crypto/sha256.h>
 #include <key.h>
 #include <random.h>
@@ -65,6 +66,7 @@ int main(int argc, char** argv)
     const fs::path bench_datadir{SetDataDir()};
 
     SHA256AutoDetect();
+    KeccakAutoDetect();
     RandomInit();
     ECC_Start();
     SetupEnvironment();
@@ -10,6 +10,7 @@
 #include <random.h>
 #include <uint256.h>
 #include <utiltime.h>
+#include <crypto/keccak.h>
 #include <crypto/ripemd160.h>
 #include <crypto/sha1.h>
 #include <crypto/sha256.h>
@@ -68,6 +69,38 @@ static void SHA512(benchmark::State& state)
         CSHA512().Write(in.data(), in.size()).Finalize(hash);
 }
 
+static void KECCAK256(benchmark::State& state)
+{
+    uint8_t hash[CKeccak256::OUTPUT_SIZE];
+    std::vector<uint8_t> in(BUFFER_SIZE,0);
+    while (state.KeepRunning())
+        CKeccak256().Write(in.data(), in.size()).Finalize(hash);
+}
+
+static void KECCAK256_32b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(32,0);
+    while (state.KeepRunning()) {
+        CKeccak256()
+            .Write(in.data(), in.size())
+            .Finalize(in.data());
+    }
+}
+
+static void KECCAK256Batch_32b_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> in(32 * 1024, 0);
+    std::vector<uint8_t> out(32 * 1024);
+    std::vector<const unsigned char*> inputs(1024);
+    std::vector<size_t> lengths(1024, 32);
+    for (size_t i = 0; i < inputs.size(); i++) {
+        inputs[i] = in.data() + 32 * i;
+    }
+    while (state.KeepRunning()) {
+        Keccak256Batch(out.data(), inputs.data(), lengths.data(), inputs.size());
+    }
+}
+
 static void SipHash_32b(benchmark::State& state)
 {
     uint256 x;
@@ -99,9 +132,12 @@ BENCHMARK(RIPEMD160, 440);
 BENCHMARK(SHA1, 570);
 BENCHMARK(SHA256, 340);
 BENCHMARK(SHA512, 330);
+BENCHMARK(KECCAK256, 340);
 
 BENCHMARK(SHA256_32b, 4700 * 1000);
 BENCHMARK(SipHash_32b, 40 * 1000 * 1000);
 BENCHMARK(SHA256D64_1024, 7400);
+BENCHMARK(KECCAK256_32b, 4700 * 1000);
+BENCHMARK(KECCAK256Batch_32b_1024, 7400);
 BENCHMARK(FastRandom_32bit, 110 * 1000 * 1000);
 BENCHMARK(FastRandom_1bit, 440 * 1000 * 1000);
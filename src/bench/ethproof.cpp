@@ -0,0 +1,129 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <random.h>
+#include <ethereum/ethproof.h>
+#include <ethereum/RLP.h>
+#include <ethereum/SHA3.h>
+#include <ethereum/TrieCommon.h>
+
+using namespace dev;
+
+/**
+ * Proofs of nCount values that share a path of nDepth - 2 branch nodes and
+ * then fork at the last branch into their own leaves, so every proof has
+ * nDepth nodes. Unused branch slots hold random hashes, as in a full trie.
+ */
+struct BenchProofs
+{
+    std::vector<bytes> vKeys;
+    std::vector<bytes> vValues;
+    std::vector<bytes> vBranches;
+    std::vector<bytes> vLeaves;
+    std::vector<CEthProof> vProofs;
+    h256 root;
+
+    BenchProofs(unsigned int nDepth, unsigned int nCount)
+    {
+        assert(nDepth >= 2 && nDepth <= 64 && nCount >= 1 && nCount <= 16);
+        FastRandomContext rng(true);
+        const unsigned int nFork = nDepth - 2;
+        const std::vector<unsigned char> base = rng.randbytes(32);
+        for (unsigned int i = 0; i < nCount; i++) {
+            bytes key(base.begin(), base.end());
+            key[nFork / 2] = (nFork % 2) ? ((key[nFork / 2] & 0xf0) | i) : ((key[nFork / 2] & 0x0f) | (i << 4));
+            const std::vector<unsigned char> value = rng.randbytes(120);
+            vKeys.push_back(key);
+            vValues.push_back(bytes(value.begin(), value.end()));
+            RLPStream leaf(2);
+            leaf << hexPrefixEncode(NibbleSlice(&vKeys.back()).mid(nDepth - 1), true) << vValues.back();
+            vLeaves.push_back(leaf.out());
+        }
+        // Build the branches bottom up; the first child slot on the path of key i is its nibble.
+        vBranches.resize(nDepth - 1);
+        for (int d = nFork; d >= 0; d--) {
+            const NibbleSlice path(&vKeys[0]);
+            RLPStream branch(17);
+            for (unsigned int n = 0; n < 16; n++) {
+                if ((unsigned int)d == nFork && n < nCount)
+                    branch << sha3(vLeaves[n]);
+                else if ((unsigned int)d != nFork && n == path[d])
+                    branch << sha3(vBranches[d + 1]);
+                else
+                    branch << h256(rng.rand256().begin(), h256::ConstructFromPointer);
+            }
+            branch << "";
+            vBranches[d] = branch.out();
+        }
+        root = sha3(vBranches[0]);
+        for (unsigned int i = 0; i < nCount; i++) {
+            CEthProof proof;
+            proof.key = &vKeys[i];
+            proof.value = &vValues[i];
+            for (const auto& branch : vBranches)
+                proof.nodes.push_back(&branch);
+            proof.nodes.push_back(&vLeaves[i]);
+            vProofs.push_back(proof);
+        }
+    }
+};
+
+static void VerifyEthProof(benchmark::State& state, unsigned int nDepth)
+{
+    const BenchProofs proofs(nDepth, 1);
+    CEthProofVerifier verifier(0);
+    while (state.KeepRunning()) {
+        bool fValid = verifier.Verify(proofs.root, proofs.vProofs[0]);
+        assert(fValid);
+    }
+}
+
+static void EthProofVerify_Depth4(benchmark::State& state) { VerifyEthProof(state, 4); }
+static void EthProofVerify_Depth6(benchmark::State& state) { VerifyEthProof(state, 6); }
+static void EthProofVerify_Depth8(benchmark::State& state) { VerifyEthProof(state, 8); }
+static void EthProofVerify_Depth10(benchmark::State& state) { VerifyEthProof(state, 10); }
+
+static void EthProofVerify_Cached(benchmark::State& state)
+{
+    const BenchProofs proofs(8, 1);
+    CEthProofVerifier verifier;
+    while (state.KeepRunning()) {
+        bool fValid = verifier.Verify(proofs.root, proofs.vProofs[0]);
+        assert(fValid);
+    }
+}
+
+// Sixteen proofs of depth 8 that share all but their leaves, one at a time and as a batch
+static void EthProofVerify_16x8(benchmark::State& state)
+{
+    const BenchProofs proofs(8, 16);
+    CEthProofVerifier verifier(0);
+    while (state.KeepRunning()) {
+        for (const auto& proof : proofs.vProofs) {
+            bool fValid = verifier.Verify(proofs.root, proof);
+            assert(fValid);
+        }
+    }
+}
+
+static void EthProofVerifyBatch_16x8(benchmark::State& state)
+{
+    const BenchProofs proofs(8, 16);
+    CEthProofVerifier verifier(0);
+    std::vector<bool> vResults;
+    while (state.KeepRunning()) {
+        bool fValid = verifier.VerifyBatch(proofs.root, proofs.vProofs, vResults);
+        assert(fValid);
+    }
+}
+
+BENCHMARK(EthProofVerify_Depth4, 80 * 1000);
+BENCHMARK(EthProofVerify_Depth6, 55 * 1000);
+BENCHMARK(EthProofVerify_Depth8, 40 * 1000);
+BENCHMARK(EthProofVerify_Depth10, 32 * 1000);
+BENCHMARK(EthProofVerify_Cached, 1000 * 1000);
+BENCHMARK(EthProofVerify_16x8, 2500);
+BENCHMARK(EthProofVerifyBatch_16x8, 12 * 1000);
@@ -0,0 +1,157 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <random.h>
+#include <ethereum/BlockHeader.h>
+#include <ethereum/RLP.h>
+#include <ethereum/SHA3.h>
+#include <ethereum/TrieHash.h>
+
+#include <algorithm>
+
+using namespace dev;
+using namespace dev::eth;
+
+static h256 RandomHash(FastRandomContext& rng)
+{
+    return h256(rng.rand256().begin(), h256::ConstructFromPointer);
+}
+
+static BlockHeader RandomHeader()
+{
+    FastRandomContext rng(true);
+    BlockHeader header;
+    header.setParentHash(RandomHash(rng));
+    header.setRoots(RandomHash(rng), RandomHash(rng), RandomHash(rng), RandomHash(rng));
+    header.setAuthor(Address(RandomHash(rng)));
+    const std::vector<unsigned char> bloom = rng.randbytes(LogBloom::size);
+    header.setLogBloom(LogBloom(bloom.data(), LogBloom::ConstructFromPointer));
+    header.setDifficulty(u256("3000000000000000"));
+    header.setNumber(6000000);
+    header.setGasLimit(8000000);
+    header.setGasUsed(7999000);
+    header.setTimestamp(1530000000);
+    const std::vector<unsigned char> extraData = rng.randbytes(20);
+    header.setExtraData(bytes(extraData.begin(), extraData.end()));
+    header.setSeal(0, RandomHash(rng));
+    header.setSeal(1, h64(rng.rand64()));
+    return header;
+}
+
+// The same header through a list whose header is inserted when it completes, as before...
+static void RlpEncodeHeader_Unsized(benchmark::State& state)
+{
+    const BlockHeader header = RandomHeader();
+    const bytes seal0 = rlp(header.seal<h256>(0));
+    const bytes seal1 = rlp(header.seal<h64>(1));
+    while (state.KeepRunning()) {
+        RLPStream s;
+        s.appendList(BlockHeader::BasicFields + 2);
+        s << header.parentHash() << header.sha3Uncles() << header.author() << header.stateRoot() << header.transactionsRoot() << header.receiptsRoot() << header.logBloom()
+            << header.difficulty() << header.number() << header.gasLimit() << header.gasUsed() << header.timestamp() << header.extraData();
+        s.appendRaw(seal0).appendRaw(seal1);
+        assert(s.out().size() > 500);
+    }
+}
+
+// ...and sized up front, as BlockHeader::streamRLP now does
+static void RlpEncodeHeader(benchmark::State& state)
+{
+    const BlockHeader header = RandomHeader();
+    while (state.KeepRunning()) {
+        RLPStream s;
+        header.streamRLP(s);
+        assert(s.out().size() > 500);
+    }
+}
+
+// A trie branch node of 16 hashes, unsized and sized
+static void RlpEncodeBranch_Unsized(benchmark::State& state)
+{
+    FastRandomContext rng(true);
+    std::vector<h256> vHashes;
+    for (int i = 0; i < 16; i++)
+        vHashes.push_back(RandomHash(rng));
+    while (state.KeepRunning()) {
+        RLPStream s(17);
+        for (const auto& hash : vHashes)
+            s << hash;
+        s << "";
+        assert(s.out().size() == 532);
+    }
+}
+
+static void RlpEncodeBranch(benchmark::State& state)
+{
+    FastRandomContext rng(true);
+    std::vector<h256> vHashes;
+    for (int i = 0; i < 16; i++)
+        vHashes.push_back(RandomHash(rng));
+    while (state.KeepRunning()) {
+        RLPStream s(17, 16 * rlpSize(h256()) + 1);
+        for (const auto& hash : vHashes)
+            s << hash;
+        s << "";
+        assert(s.out().size() == 532);
+    }
+}
+
+static std::vector<bytes> RandomTransactions(size_t nCount)
+{
+    FastRandomContext rng(true);
+    std::vector<bytes> vTxs;
+    for (size_t i = 0; i < nCount; i++) {
+        const std::vector<unsigned char> tx = rng.randbytes(110 + rng.randrange(100));
+        vTxs.push_back(bytes(tx.begin(), tx.end()));
+    }
+    return vTxs;
+}
+
+// Transactions root of a block: through nested maps as before, flat, and flat on four threads
+static void TrieRootMap(benchmark::State& state, size_t nCount)
+{
+    const std::vector<bytes> vTxs = RandomTransactions(nCount);
+    while (state.KeepRunning()) {
+        BytesMap m;
+        for (size_t i = 0; i < vTxs.size(); i++)
+            m[rlp(i)] = vTxs[i];
+        h256 root = hash256(m);
+        assert(root);
+    }
+}
+
+static void TrieRootFlat(benchmark::State& state, size_t nCount, size_t nThreads)
+{
+    const std::vector<bytes> vTxs = RandomTransactions(nCount);
+    std::vector<bytesConstRef> vRefs;
+    for (const auto& tx : vTxs)
+        vRefs.push_back(&tx);
+    tp::ThreadPoolOptions options;
+    options.setThreadCount(std::max<size_t>(nThreads, 1));
+    tp::ThreadPool pool(options);
+    while (state.KeepRunning()) {
+        h256 root = orderedTrieRoot(vRefs, nThreads ? &pool : nullptr);
+        assert(root);
+    }
+}
+
+static void OrderedTrieRoot_200_Map(benchmark::State& state) { TrieRootMap(state, 200); }
+static void OrderedTrieRoot_200(benchmark::State& state) { TrieRootFlat(state, 200, 0); }
+static void OrderedTrieRoot_200_4Threads(benchmark::State& state) { TrieRootFlat(state, 200, 4); }
+static void OrderedTrieRoot_1000_Map(benchmark::State& state) { TrieRootMap(state, 1000); }
+static void OrderedTrieRoot_1000(benchmark::State& state) { TrieRootFlat(state, 1000, 0); }
+static void OrderedTrieRoot_1000_4Threads(benchmark::State& state) { TrieRootFlat(state, 1000, 4); }
+
+BENCHMARK(RlpEncodeHeader_Unsized, 500 * 1000);
+BENCHMARK(RlpEncodeHeader, 500 * 1000);
+BENCHMARK(RlpEncodeBranch_Unsized, 1000 * 1000);
+BENCHMARK(RlpEncodeBranch, 1000 * 1000);
+BENCHMARK(OrderedTrieRoot_200_Map, 500);
+BENCHMARK(OrderedTrieRoot_200, 500);
+BENCHMARK(OrderedTrieRoot_200_4Threads, 500);
+BENCHMARK(OrderedTrieRoot_1000_Map, 100);
+BENCHMARK(OrderedTrieRoot_1000, 100);
+BENCHMARK(OrderedTrieRoot_1000_4Threads, 100);
@@ -0,0 +1,106 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <arith_uint256.h>
+#include <clientversion.h>
+#include <governance-object.h>
+#include <streams.h>
+#include <uint256.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+static const int BENCH_GOVERNANCE_MASTERNODES = 5000;
+static const int BENCH_GOVERNANCE_PROPOSALS = 100;
+
+// Every masternode votes on the funding of a proposal and a quarter of them on its validity
+static CGovernanceObject::vote_m_t MakeProposalVotes(int nProposal)
+{
+    CGovernanceObject::vote_m_t mapVotes;
+    for (int i = 0; i < BENCH_GOVERNANCE_MASTERNODES; i++) {
+        vote_rec_t& rec = mapVotes[COutPoint(ArithToUint256(arith_uint256(i + 1)), 0)];
+        vote_outcome_enum_t eOutcome = vote_outcome_enum_t(VOTE_OUTCOME_YES + (i + nProposal) % 3);
+        rec.mapInstances[VOTE_SIGNAL_FUNDING] = vote_instance_t(eOutcome, 0, 0);
+        if (i % 4 == 0) {
+            rec.mapInstances[VOTE_SIGNAL_VALID] = vote_instance_t(VOTE_OUTCOME_YES, 0, 0);
+        }
+    }
+    return mapVotes;
+}
+
+// Build a proposal the way it is read back from governance.dat
+static std::unique_ptr<CGovernanceObject> MakeVotedProposal(int nProposal)
+{
+    const CGovernanceObject::vote_m_t mapVotes = MakeProposalVotes(nProposal);
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << uint256() << 1 << int64_t(nProposal) << uint256() << std::vector<unsigned char>() << GOVERNANCE_OBJECT_PROPOSAL;
+    ss << COutPoint() << std::vector<unsigned char>() << int64_t(0) << false << mapVotes << CGovernanceObjectVoteFile();
+
+    std::unique_ptr<CGovernanceObject> pObj(new CGovernanceObject());
+    ss >> *pObj;
+    return pObj;
+}
+
+// Tally queries made for every object by UpdateSentinelVariables, trigger
+// evaluation and "gobject list"
+static void GovernanceVoteTally(benchmark::State& state)
+{
+    std::vector<std::unique_ptr<CGovernanceObject> > vecObjects;
+    for (int i = 0; i < BENCH_GOVERNANCE_PROPOSALS; i++) {
+        vecObjects.push_back(MakeVotedProposal(i));
+    }
+
+    int64_t nSum = 0;
+    while (state.KeepRunning()) {
+        for (const auto& pObj : vecObjects) {
+            nSum += pObj->GetAbsoluteYesCount(VOTE_SIGNAL_FUNDING);
+            nSum += pObj->GetAbsoluteYesCount(VOTE_SIGNAL_DELETE);
+            nSum += pObj->GetAbsoluteYesCount(VOTE_SIGNAL_ENDORSED);
+            nSum += pObj->GetAbsoluteNoCount(VOTE_SIGNAL_VALID);
+            nSum += pObj->GetAbstainCount(VOTE_SIGNAL_FUNDING);
+        }
+    }
+    assert(nSum != 0);
+}
+
+// The same queries answered by going through every masternode's votes, as
+// CountMatchingVotes did before the tallies were kept
+static int RecountMatchingVotes(const CGovernanceObject::vote_m_t& mapVotes, vote_signal_enum_t eVoteSignal, vote_outcome_enum_t eVoteOutcome)
+{
+    int nCount = 0;
+    for (const auto& votepair : mapVotes) {
+        const vote_rec_t& recVote = votepair.second;
+        vote_instance_m_cit it = recVote.mapInstances.find(eVoteSignal);
+        if (it != recVote.mapInstances.end() && it->second.eOutcome == eVoteOutcome) {
+            ++nCount;
+        }
+    }
+    return nCount;
+}
+
+static void GovernanceVoteRecount(benchmark::State& state)
+{
+    std::vector<CGovernanceObject::vote_m_t> vecVotes;
+    for (int i = 0; i < BENCH_GOVERNANCE_PROPOSALS; i++) {
+        vecVotes.push_back(MakeProposalVotes(i));
+    }
+
+    int64_t nSum = 0;
+    while (state.KeepRunning()) {
+        for (const auto& mapVotes : vecVotes) {
+            nSum += RecountMatchingVotes(mapVotes, VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_YES) - RecountMatchingVotes(mapVotes, VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_NO);
+            nSum += RecountMatchingVotes(mapVotes, VOTE_SIGNAL_DELETE, VOTE_OUTCOME_YES) - RecountMatchingVotes(mapVotes, VOTE_SIGNAL_DELETE, VOTE_OUTCOME_NO);
+            nSum += RecountMatchingVotes(mapVotes, VOTE_SIGNAL_ENDORSED, VOTE_OUTCOME_YES) - RecountMatchingVotes(mapVotes, VOTE_SIGNAL_ENDORSED, VOTE_OUTCOME_NO);
+            nSum += RecountMatchingVotes(mapVotes, VOTE_SIGNAL_VALID, VOTE_OUTCOME_NO) - RecountMatchingVotes(mapVotes, VOTE_SIGNAL_VALID, VOTE_OUTCOME_YES);
+            nSum += RecountMatchingVotes(mapVotes, VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_ABSTAIN);
+        }
+    }
+    assert(nSum != 0);
+}
+
+BENCHMARK(GovernanceVoteTally, 40 * 1000);
+BENCHMARK(GovernanceVoteRecount, 5);
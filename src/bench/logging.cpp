@@ -0,0 +1,56 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <fs.h>
+#include <logging.h>
+
+/** A logger writing timestamped lines to a file of its own, removed afterwards */
+class BenchLogger
+{
+public:
+    BCLog::Logger logger;
+    const fs::path path;
+
+    BenchLogger() : path(fs::temp_directory_path() / fs::unique_path())
+    {
+        logger.m_print_to_console = false;
+        logger.m_print_to_file = true;
+        logger.m_file_path = path;
+        assert(logger.OpenDebugLog());
+    }
+
+    ~BenchLogger()
+    {
+        logger.StopAsync();
+        fs::remove(path);
+    }
+};
+
+static void Log(benchmark::State& state, BCLog::Logger& logger)
+{
+    int nHeight = 0;
+    while (state.KeepRunning()) {
+        logger.LogPrintStr(strprintf("UpdateTip: new best=%064x height=%d\n", nHeight, nHeight));
+        nHeight++;
+    }
+}
+
+// Write each line to the file on the logging thread, under the file lock
+static void LoggingSync(benchmark::State& state)
+{
+    BenchLogger bench;
+    Log(state, bench.logger);
+}
+
+// Hand lines to the background writer, as with -logasync
+static void LoggingAsync(benchmark::State& state)
+{
+    BenchLogger bench;
+    bench.logger.StartAsync(1 << 16);
+    Log(state, bench.logger);
+}
+
+BENCHMARK(LoggingSync, 100 * 1000);
+BENCHMARK(LoggingAsync, 1000 * 1000);
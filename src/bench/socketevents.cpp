@@ -0,0 +1,134 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <random.h>
+#include <socketevents.h>
+#include <util.h>
+
+#ifdef USE_EPOLL
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Peers a node might hold, of which only a few have something to say at a time
+static const int SOCKET_PAIRS = 1000;
+static const int ACTIVE_PAIRS = 10;
+
+/**
+ * Local socket pairs standing in for peers. The ends the node reads from are
+ * kept below FD_SETSIZE so that select() can wait for all of them; the ends
+ * the peers write to are moved above it. Fewer pairs are made if the file
+ * descriptor limit cannot be raised far enough.
+ */
+class SocketPairs
+{
+public:
+    std::vector<SOCKET> vRead;
+    std::vector<SOCKET> vWrite;
+
+    SocketPairs()
+    {
+        if (RaiseFileDescriptorLimit(FD_SETSIZE + SOCKET_PAIRS + 16) < FD_SETSIZE + SOCKET_PAIRS + 16)
+            return;
+        for (int i = 0; i < SOCKET_PAIRS; i++) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+                break;
+            const int hWrite = fcntl(fds[1], F_DUPFD, FD_SETSIZE);
+            close(fds[1]);
+            if (hWrite == -1 || fds[0] >= FD_SETSIZE) {
+                close(fds[0]);
+                if (hWrite != -1)
+                    close(hWrite);
+                break;
+            }
+            fcntl(fds[0], F_SETFL, O_NONBLOCK);
+            vRead.push_back(fds[0]);
+            vWrite.push_back(hWrite);
+        }
+    }
+
+    ~SocketPairs()
+    {
+        for (SOCKET hSocket : vRead)
+            close(hSocket);
+        for (SOCKET hSocket : vWrite)
+            close(hSocket);
+    }
+
+    /** Have a few random peers send a message. Returns the number of bytes sent. */
+    int Send(FastRandomContext& rand)
+    {
+        char buf[64] = {};
+        for (int i = 0; i < ACTIVE_PAIRS; i++)
+            assert(send(vWrite[rand.randrange(vWrite.size())], buf, sizeof(buf), 0) == sizeof(buf));
+        return ACTIVE_PAIRS * sizeof(buf);
+    }
+};
+
+/** Read from hSocket until it would block, as an edge-triggered socket requires */
+static int Drain(SOCKET hSocket)
+{
+    char buf[4096];
+    int nTotal = 0;
+    int nBytes;
+    while ((nBytes = recv(hSocket, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+        nTotal += nBytes;
+    return nTotal;
+}
+
+// Rebuild the fd_sets, wait, then look at every socket, as ThreadSocketHandler does with -socketevents=select
+static void SocketEventsSelect(benchmark::State& state)
+{
+    SocketPairs pairs;
+    assert(!pairs.vRead.empty());
+    FastRandomContext rand(true);
+    while (state.KeepRunning()) {
+        int nSent = pairs.Send(rand);
+        while (nSent > 0) {
+            fd_set fdsetRecv;
+            fd_set fdsetError;
+            FD_ZERO(&fdsetRecv);
+            FD_ZERO(&fdsetError);
+            SOCKET hSocketMax = 0;
+            for (SOCKET hSocket : pairs.vRead) {
+                FD_SET(hSocket, &fdsetRecv);
+                FD_SET(hSocket, &fdsetError);
+                hSocketMax = std::max(hSocketMax, hSocket);
+            }
+            struct timeval timeout = {0, 50000};
+            assert(select(hSocketMax + 1, &fdsetRecv, nullptr, &fdsetError, &timeout) > 0);
+            for (SOCKET hSocket : pairs.vRead) {
+                if (FD_ISSET(hSocket, &fdsetRecv) || FD_ISSET(hSocket, &fdsetError))
+                    nSent -= Drain(hSocket);
+            }
+        }
+    }
+}
+
+// Register once and only hear about the sockets that got data, as ThreadSocketHandler does with -socketevents=epoll
+static void SocketEventsEpoll(benchmark::State& state)
+{
+    SocketPairs pairs;
+    assert(!pairs.vRead.empty());
+    CSocketEvents socketEvents;
+    assert(socketEvents.IsValid());
+    for (size_t i = 0; i < pairs.vRead.size(); i++)
+        assert(socketEvents.Add(pairs.vRead[i], i));
+    FastRandomContext rand(true);
+    std::vector<SocketEvent> events;
+    while (state.KeepRunning()) {
+        int nSent = pairs.Send(rand);
+        while (nSent > 0) {
+            assert(socketEvents.Wait(50, events));
+            for (const SocketEvent& event : events)
+                nSent -= Drain(pairs.vRead[event.nData]);
+        }
+    }
+}
+
+BENCHMARK(SocketEventsSelect, 10 * 1000);
+BENCHMARK(SocketEventsEpoll, 50 * 1000);
+#endif // USE_EPOLL
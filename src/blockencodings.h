@@ -197,16 +197,28 @@ public:
 class PartiallyDownloadedBlock {
 protected:
     std::vector<CTransactionRef> txn_available;
-    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
+    // SYSCOIN asset_extra_count is the part of extra_count found among the extra asset transactions
+    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0, asset_extra_count = 0;
     CTxMemPool* pool;
 public:
     CBlockHeader header;
     explicit PartiallyDownloadedBlock(CTxMemPool* poolIn) : pool(poolIn) {}
 
     // extra_txn is a list of extra transactions to look at, in <witness hash, reference> form
-    ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn);
+    ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn) {
+        return InitData(cmpctblock, extra_txn, {});
+    }
+    // SYSCOIN extra_asset_txn is a second such list, kept apart so that bursts of asset transactions don't crowd out the others
+    ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn,
+                        const std::vector<std::pair<uint256, CTransactionRef>>& extra_asset_txn);
     bool IsTxAvailable(size_t index) const;
     ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing);
+
+    // Where the transactions found by InitData came from
+    size_t GetPrefilledCount() const { return prefilled_count; }
+    size_t GetMempoolCount() const { return mempool_count - extra_count; }
+    size_t GetExtraCount() const { return extra_count - asset_extra_count; }
+    size_t GetAssetExtraCount() const { return asset_extra_count; }
 };
 
 #endif // SYSCOIN_BLOCKENCODINGS_H
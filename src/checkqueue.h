@@ -5,6 +5,7 @@
 #ifndef SYSCOIN_CHECKQUEUE_H
 #define SYSCOIN_CHECKQUEUE_H
 
+#include <executor.h>
 #include <sync.h>
 
 #include <algorithm>
@@ -25,6 +26,10 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Instead of worker threads of its own, the queue can be given an executor,
+  * on which it then runs helpers while there is work queued. A helper stops
+  * once the queue is empty instead of waiting for more.
   */
 template <typename T>
 class CCheckQueue
@@ -62,8 +67,17 @@ private:
     //! The maximum number of elements to be processed in one batch
     unsigned int nBatchSize;
 
+    // SYSCOIN
+    //! The executor to run helpers on, if any
+    CExecutor* pexecutor;
+    TaskClass executorClass;
+    //! The maximum number of helpers at a time
+    int nMaxHelpers;
+    //! The number of helpers submitted that have not returned yet
+    int nHelpers;
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster = false)
+    bool Loop(bool fMaster = false, bool fHelper = false)
     {
         boost::condition_variable& cond = fMaster ? condMaster : condWorker;
         std::vector<T> vChecks;
@@ -95,6 +109,13 @@ private:
                         // return the current status
                         return fRet;
                     }
+                    // SYSCOIN
+                    if (fHelper) {
+                        nTotal--;
+                        if (--nHelpers == 0)
+                            condMaster.notify_all();
+                        return true;
+                    }
                     nIdle++;
                     cond.wait(lock); // wait
                     nIdle--;
@@ -128,7 +149,18 @@ public:
     boost::mutex ControlMutex;
 
     //! Create a new check queue
-    explicit CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), nBatchSize(nBatchSizeIn) {}
+    explicit CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), nBatchSize(nBatchSizeIn),
+        pexecutor(nullptr), executorClass(TaskClass::BLOCK), nMaxHelpers(0), nHelpers(0) {}
+
+    // SYSCOIN
+    //! Run up to nMaxHelpersIn helpers on an executor when work is added, or stop doing so if it is nullptr
+    void SetExecutor(CExecutor* pexecutorIn, TaskClass executorClassIn, int nMaxHelpersIn)
+    {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        pexecutor = pexecutorIn;
+        executorClass = executorClassIn;
+        nMaxHelpers = nMaxHelpersIn;
+    }
 
     //! Worker thread
     void Thread()
@@ -155,10 +187,22 @@ public:
             condWorker.notify_one();
         else if (vChecks.size() > 1)
             condWorker.notify_all();
+        // SYSCOIN
+        // The master works on the queue as well, so a full executor only makes it take longer
+        while (pexecutor != nullptr && nHelpers < nMaxHelpers && (size_t)nHelpers < queue.size()) {
+            if (!pexecutor->TrySubmit(executorClass, [this] { Loop(false, true); }))
+                break;
+            nHelpers++;
+        }
     }
 
     ~CCheckQueue()
     {
+        // SYSCOIN
+        // Helpers still queued on the executor refer to this queue
+        boost::unique_lock<boost::mutex> lock(mutex);
+        while (nHelpers > 0)
+            condMaster.wait(lock);
     }
 
 };
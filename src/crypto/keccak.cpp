@@ -0,0 +1,330 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <crypto/keccak.h>
+#include <crypto/common.h>
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
+#if defined(USE_ASM)
+#include <cpuid.h>
+#endif
+#endif
+
+namespace keccak_avx2
+{
+void Permute_4way(uint64_t st[4][25]);
+}
+
+// Internal implementation code.
+namespace
+{
+/// Internal Keccak-f[1600] implementation.
+namespace keccak
+{
+const uint64_t RNDC[24] = {
+    0x0000000000000001ull, 0x0000000000008082ull, 0x800000000000808aull, 0x8000000080008000ull,
+    0x000000000000808bull, 0x0000000080000001ull, 0x8000000080008081ull, 0x8000000000008009ull,
+    0x000000000000008aull, 0x0000000000000088ull, 0x0000000080008009ull, 0x000000008000000aull,
+    0x000000008000808bull, 0x800000000000008bull, 0x8000000000008089ull, 0x8000000000008003ull,
+    0x8000000000008002ull, 0x8000000000000080ull, 0x000000000000800aull, 0x800000008000000aull,
+    0x8000000080008081ull, 0x8000000000008080ull, 0x0000000080000001ull, 0x8000000080008008ull
+};
+
+uint64_t inline Rotl(uint64_t x, int n) { return (x << n) | (x >> (64 - n)); }
+
+/** Keccak-f[1600], the steps of each of the 24 rounds written out lane by lane. */
+void Permute(uint64_t* st)
+{
+    uint64_t bc0, bc1, bc2, bc3, bc4, t;
+    for (int round = 0; round < 24; ++round) {
+        // Theta
+        bc0 = st[0] ^ st[5] ^ st[10] ^ st[15] ^ st[20];
+        bc1 = st[1] ^ st[6] ^ st[11] ^ st[16] ^ st[21];
+        bc2 = st[2] ^ st[7] ^ st[12] ^ st[17] ^ st[22];
+        bc3 = st[3] ^ st[8] ^ st[13] ^ st[18] ^ st[23];
+        bc4 = st[4] ^ st[9] ^ st[14] ^ st[19] ^ st[24];
+        t = bc4 ^ Rotl(bc1, 1); st[0] ^= t; st[5] ^= t; st[10] ^= t; st[15] ^= t; st[20] ^= t;
+        t = bc0 ^ Rotl(bc2, 1); st[1] ^= t; st[6] ^= t; st[11] ^= t; st[16] ^= t; st[21] ^= t;
+        t = bc1 ^ Rotl(bc3, 1); st[2] ^= t; st[7] ^= t; st[12] ^= t; st[17] ^= t; st[22] ^= t;
+        t = bc2 ^ Rotl(bc4, 1); st[3] ^= t; st[8] ^= t; st[13] ^= t; st[18] ^= t; st[23] ^= t;
+        t = bc3 ^ Rotl(bc0, 1); st[4] ^= t; st[9] ^= t; st[14] ^= t; st[19] ^= t; st[24] ^= t;
+
+        // Rho and pi
+        t = st[1];
+        bc0 = st[10]; st[10] = Rotl(t, 1); t = bc0;
+        bc0 = st[7]; st[7] = Rotl(t, 3); t = bc0;
+        bc0 = st[11]; st[11] = Rotl(t, 6); t = bc0;
+        bc0 = st[17]; st[17] = Rotl(t, 10); t = bc0;
+        bc0 = st[18]; st[18] = Rotl(t, 15); t = bc0;
+        bc0 = st[3]; st[3] = Rotl(t, 21); t = bc0;
+        bc0 = st[5]; st[5] = Rotl(t, 28); t = bc0;
+        bc0 = st[16]; st[16] = Rotl(t, 36); t = bc0;
+        bc0 = st[8]; st[8] = Rotl(t, 45); t = bc0;
+        bc0 = st[21]; st[21] = Rotl(t, 55); t = bc0;
+        bc0 = st[24]; st[24] = Rotl(t, 2); t = bc0;
+        bc0 = st[4]; st[4] = Rotl(t, 14); t = bc0;
+        bc0 = st[15]; st[15] = Rotl(t, 27); t = bc0;
+        bc0 = st[23]; st[23] = Rotl(t, 41); t = bc0;
+        bc0 = st[19]; st[19] = Rotl(t, 56); t = bc0;
+        bc0 = st[13]; st[13] = Rotl(t, 8); t = bc0;
+        bc0 = st[12]; st[12] = Rotl(t, 25); t = bc0;
+        bc0 = st[2]; st[2] = Rotl(t, 43); t = bc0;
+        bc0 = st[20]; st[20] = Rotl(t, 62); t = bc0;
+        bc0 = st[14]; st[14] = Rotl(t, 18); t = bc0;
+        bc0 = st[22]; st[22] = Rotl(t, 39); t = bc0;
+        bc0 = st[9]; st[9] = Rotl(t, 61); t = bc0;
+        bc0 = st[6]; st[6] = Rotl(t, 20); t = bc0;
+        st[1] = Rotl(t, 44);
+
+        // Chi and iota
+        bc0 = st[0]; bc1 = st[1]; bc2 = st[2]; bc3 = st[3]; bc4 = st[4];
+        st[0] = bc0 ^ (~bc1 & bc2) ^ RNDC[round];
+        st[1] = bc1 ^ (~bc2 & bc3);
+        st[2] = bc2 ^ (~bc3 & bc4);
+        st[3] = bc3 ^ (~bc4 & bc0);
+        st[4] = bc4 ^ (~bc0 & bc1);
+        bc0 = st[5]; bc1 = st[6]; bc2 = st[7]; bc3 = st[8]; bc4 = st[9];
+        st[5] = bc0 ^ (~bc1 & bc2);
+        st[6] = bc1 ^ (~bc2 & bc3);
+        st[7] = bc2 ^ (~bc3 & bc4);
+        st[8] = bc3 ^ (~bc4 & bc0);
+        st[9] = bc4 ^ (~bc0 & bc1);
+        bc0 = st[10]; bc1 = st[11]; bc2 = st[12]; bc3 = st[13]; bc4 = st[14];
+        st[10] = bc0 ^ (~bc1 & bc2);
+        st[11] = bc1 ^ (~bc2 & bc3);
+        st[12] = bc2 ^ (~bc3 & bc4);
+        st[13] = bc3 ^ (~bc4 & bc0);
+        st[14] = bc4 ^ (~bc0 & bc1);
+        bc0 = st[15]; bc1 = st[16]; bc2 = st[17]; bc3 = st[18]; bc4 = st[19];
+        st[15] = bc0 ^ (~bc1 & bc2);
+        st[16] = bc1 ^ (~bc2 & bc3);
+        st[17] = bc2 ^ (~bc3 & bc4);
+        st[18] = bc3 ^ (~bc4 & bc0);
+        st[19] = bc4 ^ (~bc0 & bc1);
+        bc0 = st[20]; bc1 = st[21]; bc2 = st[22]; bc3 = st[23]; bc4 = st[24];
+        st[20] = bc0 ^ (~bc1 & bc2);
+        st[21] = bc1 ^ (~bc2 & bc3);
+        st[22] = bc2 ^ (~bc3 & bc4);
+        st[23] = bc3 ^ (~bc4 & bc0);
+        st[24] = bc4 ^ (~bc0 & bc1);
+    }
+}
+
+/** Xor one rate-sized block of input into the state, reading lanes straight from the input. */
+void inline Absorb(uint64_t* st, const unsigned char* block)
+{
+    for (int i = 0; i < 17; ++i) {
+        st[i] ^= ReadLE64(block + 8 * i);
+    }
+}
+
+/** Build the padded final block of a message from its trailing partial block. */
+void inline Pad(unsigned char* block, const unsigned char* data, size_t len)
+{
+    memcpy(block, data, len);
+    memset(block + len, 0, CKeccak256::RATE - len);
+    block[len] ^= 0x01;
+    block[CKeccak256::RATE - 1] ^= 0x80;
+}
+
+void inline Squeeze(unsigned char* out, const uint64_t* st)
+{
+    WriteLE64(out, st[0]);
+    WriteLE64(out + 8, st[1]);
+    WriteLE64(out + 16, st[2]);
+    WriteLE64(out + 24, st[3]);
+}
+
+} // namespace keccak
+
+typedef void (*Permute4wayType)(uint64_t st[4][25]);
+
+Permute4wayType Permute_4way = nullptr;
+
+bool SelfTest() {
+    // Keccak-256 of the empty string and of "abc".
+    static const unsigned char result_empty[32] = {
+        0xc5, 0xd2, 0x46, 0x01, 0x86, 0xf7, 0x23, 0x3c, 0x92, 0x7e, 0x7d, 0xb2, 0xdc, 0xc7, 0x03, 0xc0,
+        0xe5, 0x00, 0xb6, 0x53, 0xca, 0x82, 0x27, 0x3b, 0x7b, 0xfa, 0xd8, 0x04, 0x5d, 0x85, 0xa4, 0x70
+    };
+    static const unsigned char result_abc[32] = {
+        0x4e, 0x03, 0x65, 0x7a, 0xea, 0x45, 0xa9, 0x4f, 0xc7, 0xd4, 0x7b, 0xa8, 0x26, 0xc8, 0xd6, 0x67,
+        0xc0, 0xd1, 0xe6, 0xe3, 0x3a, 0x64, 0xa0, 0x36, 0xec, 0x44, 0xf5, 0x8f, 0xa1, 0x2d, 0x6c, 0x45
+    };
+
+    unsigned char out[32];
+    CKeccak256().Finalize(out);
+    if (!std::equal(out, out + 32, result_empty)) return false;
+    CKeccak256().Write((const unsigned char*)"abc", 3).Finalize(out);
+    if (!std::equal(out, out + 32, result_abc)) return false;
+
+    // Test Permute_4way against the single-state permutation, if available.
+    if (Permute_4way) {
+        uint64_t st[4][25];
+        uint64_t expected[4][25];
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 25; ++j) {
+                st[i][j] = expected[i][j] = 0x9e3779b97f4a7c15ull * (uint64_t)(i * 25 + j + 1);
+            }
+            keccak::Permute(expected[i]);
+        }
+        Permute_4way(st);
+        for (int i = 0; i < 4; ++i) {
+            if (!std::equal(st[i], st[i] + 25, expected[i])) return false;
+        }
+    }
+
+    return true;
+}
+
+#if defined(USE_ASM) && defined(ENABLE_AVX2) && !defined(BUILD_SYSCOIN_INTERNAL) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+// We can't use cpuid.h's __get_cpuid as it does not support subleafs.
+void inline cpuid(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d)
+{
+#ifdef __GNUC__
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+#else
+  __asm__ ("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "0"(leaf), "2"(subleaf));
+#endif
+}
+
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
+} // namespace
+
+
+void KeccakF1600(uint64_t st[25])
+{
+    keccak::Permute(st);
+}
+
+std::string KeccakAutoDetect()
+{
+    std::string ret = "standard";
+#if defined(USE_ASM) && defined(ENABLE_AVX2) && !defined(BUILD_SYSCOIN_INTERNAL) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, 0, eax, ebx, ecx, edx);
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    const bool enabled_avx = have_xsave && have_avx && AVXEnabled();
+    bool have_avx2 = false;
+    cpuid(0, 0, eax, ebx, ecx, edx);
+    if (eax >= 7) {
+        cpuid(7, 0, eax, ebx, ecx, edx);
+        have_avx2 = (ebx >> 5) & 1;
+    }
+
+    if (have_avx2 && enabled_avx) {
+        Permute_4way = keccak_avx2::Permute_4way;
+        ret += ",avx2(4way)";
+    }
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
+
+////// Keccak-256
+
+CKeccak256::CKeccak256() : bufsize(0)
+{
+    memset(s, 0, sizeof(s));
+}
+
+CKeccak256& CKeccak256::Write(const unsigned char* data, size_t len)
+{
+    if (bufsize && bufsize + len >= RATE) {
+        // Fill the buffer, and process it.
+        memcpy(buf + bufsize, data, RATE - bufsize);
+        data += RATE - bufsize;
+        len -= RATE - bufsize;
+        keccak::Absorb(s, buf);
+        keccak::Permute(s);
+        bufsize = 0;
+    }
+    while (len >= RATE) {
+        // Full blocks are absorbed directly from the input.
+        keccak::Absorb(s, data);
+        keccak::Permute(s);
+        data += RATE;
+        len -= RATE;
+    }
+    if (len > 0) {
+        // Fill the buffer with what remains.
+        memcpy(buf + bufsize, data, len);
+        bufsize += len;
+    }
+    return *this;
+}
+
+void CKeccak256::Finalize(unsigned char hash[OUTPUT_SIZE])
+{
+    unsigned char block[RATE];
+    keccak::Pad(block, buf, bufsize);
+    keccak::Absorb(s, block);
+    keccak::Permute(s);
+    keccak::Squeeze(hash, s);
+}
+
+CKeccak256& CKeccak256::Reset()
+{
+    memset(s, 0, sizeof(s));
+    bufsize = 0;
+    return *this;
+}
+
+void Keccak256Batch(unsigned char* out, const unsigned char* const* in, const size_t* len, size_t count)
+{
+    if (Permute_4way) {
+        while (count >= 4) {
+            // Every lane runs the same number of permutations; a lane whose message is shorter
+            // skips absorbing once it is done and its digest is taken right after its last block.
+            uint64_t st[4][25] = {};
+            size_t blocks[4];
+            size_t max_blocks = 0;
+            for (int i = 0; i < 4; ++i) {
+                blocks[i] = len[i] / CKeccak256::RATE + 1;
+                max_blocks = std::max(max_blocks, blocks[i]);
+            }
+            for (size_t b = 0; b < max_blocks; ++b) {
+                for (int i = 0; i < 4; ++i) {
+                    if (b + 1 < blocks[i]) {
+                        keccak::Absorb(st[i], in[i] + b * CKeccak256::RATE);
+                    } else if (b + 1 == blocks[i]) {
+                        unsigned char block[CKeccak256::RATE];
+                        keccak::Pad(block, in[i] + b * CKeccak256::RATE, len[i] % CKeccak256::RATE);
+                        keccak::Absorb(st[i], block);
+                    }
+                }
+                Permute_4way(st);
+                for (int i = 0; i < 4; ++i) {
+                    if (b + 1 == blocks[i]) {
+                        keccak::Squeeze(out + 32 * i, st[i]);
+                    }
+                }
+            }
+            out += 128;
+            in += 4;
+            len += 4;
+            count -= 4;
+        }
+    }
+    while (count > 0) {
+        CKeccak256().Write(in[0], len[0]).Finalize(out);
+        out += 32;
+        ++in;
+        ++len;
+        --count;
+    }
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SYSCOIN_CRYPTO_KECCAK_H
+#define SYSCOIN_CRYPTO_KECCAK_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+
+/** Apply the Keccak-f[1600] permutation to a state of 25 little-endian lanes. */
+void KeccakF1600(uint64_t st[25]);
+
+/** A hasher class for Keccak-256, the original Keccak padding used by Ethereum (not FIPS-202 SHA3-256). */
+class CKeccak256
+{
+private:
+    uint64_t s[25];
+    unsigned char buf[136];
+    size_t bufsize;
+
+public:
+    static const size_t OUTPUT_SIZE = 32;
+    static const size_t RATE = 136;
+
+    CKeccak256();
+    CKeccak256& Write(const unsigned char* data, size_t len);
+    void Finalize(unsigned char hash[OUTPUT_SIZE]);
+    CKeccak256& Reset();
+};
+
+/** Autodetect the best available Keccak-f[1600] implementation.
+ *  Returns the name of the implementation.
+ */
+std::string KeccakAutoDetect();
+
+/** Compute the Keccak-256 of multiple independent messages, four at a time
+ *  when a multi-buffer implementation is available.
+ *  output:  pointer to a count*32 byte output buffer
+ *  inputs:  pointers to the count messages
+ *  lengths: the byte lengths of the count messages
+ */
+void Keccak256Batch(unsigned char* output, const unsigned char* const* inputs, const size_t* lengths, size_t count);
+
+#endif // SYSCOIN_CRYPTO_KECCAK_H
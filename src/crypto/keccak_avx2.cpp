@@ -0,0 +1,126 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/keccak.h>
+
+namespace keccak_avx2 {
+namespace {
+
+const uint64_t RNDC[24] = {
+    0x0000000000000001ull, 0x0000000000008082ull, 0x800000000000808aull, 0x8000000080008000ull,
+    0x000000000000808bull, 0x0000000080000001ull, 0x8000000080008081ull, 0x8000000000008009ull,
+    0x000000000000008aull, 0x0000000000000088ull, 0x0000000080008009ull, 0x000000008000000aull,
+    0x000000008000808bull, 0x800000000000008bull, 0x8000000000008089ull, 0x8000000000008003ull,
+    0x8000000000008002ull, 0x8000000000000080ull, 0x000000000000800aull, 0x800000008000000aull,
+    0x8000000080008081ull, 0x8000000000008080ull, 0x0000000080000001ull, 0x8000000080008008ull
+};
+
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z, __m256i w, __m256i v) { return Xor(Xor(Xor(x, y), Xor(z, w)), v); }
+__m256i inline AndNot(__m256i x, __m256i y) { return _mm256_andnot_si256(x, y); }
+template<int n> __m256i inline Rotl(__m256i x) { return _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - n)); }
+
+}
+
+/** Keccak-f[1600] on four independent states, one per 64-bit element of each vector lane. */
+void Permute_4way(uint64_t st[4][25])
+{
+    __m256i a[25];
+    for (int i = 0; i < 25; ++i) {
+        a[i] = _mm256_set_epi64x(st[3][i], st[2][i], st[1][i], st[0][i]);
+    }
+
+    __m256i bc0, bc1, bc2, bc3, bc4, t;
+    for (int round = 0; round < 24; ++round) {
+        // Theta
+        bc0 = Xor(a[0], a[5], a[10], a[15], a[20]);
+        bc1 = Xor(a[1], a[6], a[11], a[16], a[21]);
+        bc2 = Xor(a[2], a[7], a[12], a[17], a[22]);
+        bc3 = Xor(a[3], a[8], a[13], a[18], a[23]);
+        bc4 = Xor(a[4], a[9], a[14], a[19], a[24]);
+        t = Xor(bc4, Rotl<1>(bc1)); a[0] = Xor(a[0], t); a[5] = Xor(a[5], t); a[10] = Xor(a[10], t); a[15] = Xor(a[15], t); a[20] = Xor(a[20], t);
+        t = Xor(bc0, Rotl<1>(bc2)); a[1] = Xor(a[1], t); a[6] = Xor(a[6], t); a[11] = Xor(a[11], t); a[16] = Xor(a[16], t); a[21] = Xor(a[21], t);
+        t = Xor(bc1, Rotl<1>(bc3)); a[2] = Xor(a[2], t); a[7] = Xor(a[7], t); a[12] = Xor(a[12], t); a[17] = Xor(a[17], t); a[22] = Xor(a[22], t);
+        t = Xor(bc2, Rotl<1>(bc4)); a[3] = Xor(a[3], t); a[8] = Xor(a[8], t); a[13] = Xor(a[13], t); a[18] = Xor(a[18], t); a[23] = Xor(a[23], t);
+        t = Xor(bc3, Rotl<1>(bc0)); a[4] = Xor(a[4], t); a[9] = Xor(a[9], t); a[14] = Xor(a[14], t); a[19] = Xor(a[19], t); a[24] = Xor(a[24], t);
+
+        // Rho and pi
+        t = a[1];
+        bc0 = a[10]; a[10] = Rotl<1>(t); t = bc0;
+        bc0 = a[7]; a[7] = Rotl<3>(t); t = bc0;
+        bc0 = a[11]; a[11] = Rotl<6>(t); t = bc0;
+        bc0 = a[17]; a[17] = Rotl<10>(t); t = bc0;
+        bc0 = a[18]; a[18] = Rotl<15>(t); t = bc0;
+        bc0 = a[3]; a[3] = Rotl<21>(t); t = bc0;
+        bc0 = a[5]; a[5] = Rotl<28>(t); t = bc0;
+        bc0 = a[16]; a[16] = Rotl<36>(t); t = bc0;
+        bc0 = a[8]; a[8] = Rotl<45>(t); t = bc0;
+        bc0 = a[21]; a[21] = Rotl<55>(t); t = bc0;
+        bc0 = a[24]; a[24] = Rotl<2>(t); t = bc0;
+        bc0 = a[4]; a[4] = Rotl<14>(t); t = bc0;
+        bc0 = a[15]; a[15] = Rotl<27>(t); t = bc0;
+        bc0 = a[23]; a[23] = Rotl<41>(t); t = bc0;
+        bc0 = a[19]; a[19] = Rotl<56>(t); t = bc0;
+        bc0 = a[13]; a[13] = Rotl<8>(t); t = bc0;
+        bc0 = a[12]; a[12] = Rotl<25>(t); t = bc0;
+        bc0 = a[2]; a[2] = Rotl<43>(t); t = bc0;
+        bc0 = a[20]; a[20] = Rotl<62>(t); t = bc0;
+        bc0 = a[14]; a[14] = Rotl<18>(t); t = bc0;
+        bc0 = a[22]; a[22] = Rotl<39>(t); t = bc0;
+        bc0 = a[9]; a[9] = Rotl<61>(t); t = bc0;
+        bc0 = a[6]; a[6] = Rotl<20>(t); t = bc0;
+        a[1] = Rotl<44>(t);
+
+        // Chi and iota
+        bc0 = a[0]; bc1 = a[1]; bc2 = a[2]; bc3 = a[3]; bc4 = a[4];
+        a[0] = Xor(bc0, AndNot(bc1, bc2));
+        a[1] = Xor(bc1, AndNot(bc2, bc3));
+        a[2] = Xor(bc2, AndNot(bc3, bc4));
+        a[3] = Xor(bc3, AndNot(bc4, bc0));
+        a[4] = Xor(bc4, AndNot(bc0, bc1));
+        bc0 = a[5]; bc1 = a[6]; bc2 = a[7]; bc3 = a[8]; bc4 = a[9];
+        a[5] = Xor(bc0, AndNot(bc1, bc2));
+        a[6] = Xor(bc1, AndNot(bc2, bc3));
+        a[7] = Xor(bc2, AndNot(bc3, bc4));
+        a[8] = Xor(bc3, AndNot(bc4, bc0));
+        a[9] = Xor(bc4, AndNot(bc0, bc1));
+        bc0 = a[10]; bc1 = a[11]; bc2 = a[12]; bc3 = a[13]; bc4 = a[14];
+        a[10] = Xor(bc0, AndNot(bc1, bc2));
+        a[11] = Xor(bc1, AndNot(bc2, bc3));
+        a[12] = Xor(bc2, AndNot(bc3, bc4));
+        a[13] = Xor(bc3, AndNot(bc4, bc0));
+        a[14] = Xor(bc4, AndNot(bc0, bc1));
+        bc0 = a[15]; bc1 = a[16]; bc2 = a[17]; bc3 = a[18]; bc4 = a[19];
+        a[15] = Xor(bc0, AndNot(bc1, bc2));
+        a[16] = Xor(bc1, AndNot(bc2, bc3));
+        a[17] = Xor(bc2, AndNot(bc3, bc4));
+        a[18] = Xor(bc3, AndNot(bc4, bc0));
+        a[19] = Xor(bc4, AndNot(bc0, bc1));
+        bc0 = a[20]; bc1 = a[21]; bc2 = a[22]; bc3 = a[23]; bc4 = a[24];
+        a[20] = Xor(bc0, AndNot(bc1, bc2));
+        a[21] = Xor(bc1, AndNot(bc2, bc3));
+        a[22] = Xor(bc2, AndNot(bc3, bc4));
+        a[23] = Xor(bc3, AndNot(bc4, bc0));
+        a[24] = Xor(bc4, AndNot(bc0, bc1));
+        a[0] = Xor(a[0], _mm256_set1_epi64x(RNDC[round]));
+    }
+
+    alignas(32) uint64_t lanes[4];
+    for (int i = 0; i < 25; ++i) {
+        _mm256_store_si256((__m256i*)lanes, a[i]);
+        st[0][i] = lanes[0];
+        st[1][i] = lanes[1];
+        st[2][i] = lanes[2];
+        st[3][i] = lanes[3];
+    }
+}
+
+}
+
+#endif
@@ -97,10 +97,46 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+/** Forwards to an LRU cache, counting lookups that hit and miss. */
+class CDBBlockCache::CountingCache : public leveldb::Cache
+{
+    CDBBlockCache& parent;
+    std::unique_ptr<leveldb::Cache> cache;
+
+public:
+    CountingCache(CDBBlockCache& parentIn, size_t nCapacity) : parent(parentIn), cache(leveldb::NewLRUCache(nCapacity)) {}
+
+    Handle* Insert(const leveldb::Slice& key, void* value, size_t charge, void (*deleter)(const leveldb::Slice& key, void* value)) override
+    {
+        return cache->Insert(key, value, charge, deleter);
+    }
+    Handle* Lookup(const leveldb::Slice& key) override
+    {
+        Handle* handle = cache->Lookup(key);
+        ++(handle ? parent.nHits : parent.nMisses);
+        return handle;
+    }
+    void Release(Handle* handle) override { cache->Release(handle); }
+    void* Value(Handle* handle) override { return cache->Value(handle); }
+    void Erase(const leveldb::Slice& key) override { cache->Erase(key); }
+    uint64_t NewId() override { return cache->NewId(); }
+    void Prune() override { cache->Prune(); }
+    size_t TotalCharge() const override { return cache->TotalCharge(); }
+};
+
+CDBBlockCache::CDBBlockCache(size_t nCapacityIn) : nCapacity(nCapacityIn), pcache(new CountingCache(*this, nCapacityIn)) {}
+
+CDBBlockCache::~CDBBlockCache() {}
+
+size_t CDBBlockCache::Usage() const
+{
+    return pcache->TotalCharge();
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, leveldb::Cache* block_cache)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
+    options.block_cache = block_cache ? block_cache : leveldb::NewLRUCache(nCacheSize / 2);
     options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
     options.filter_policy = leveldb::NewBloomFilterPolicy(10);
     options.compression = leveldb::kNoCompression;
@@ -114,15 +150,15 @@ static leveldb::Options GetOptions(size_t nCacheSize)
     return options;
 }
 
-CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate)
-    : m_name(fs::basename(path))
+CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate, CDBBlockCache* pBlockCache)
+    : m_owns_block_cache(pBlockCache == nullptr), m_name(fs::basename(path))
 {
     penv = nullptr;
     readoptions.verify_checksums = true;
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache = false;
     syncoptions.sync = true;
-    options = GetOptions(nCacheSize);
+    options = GetOptions(nCacheSize, pBlockCache ? pBlockCache->pcache.get() : nullptr);
     options.create_if_missing = true;
     if (fMemory) {
         penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -174,7 +210,8 @@ CDBWrapper::~CDBWrapper()
     options.filter_policy = nullptr;
     delete options.info_log;
     options.info_log = nullptr;
-    delete options.block_cache;
+    if (m_owns_block_cache)
+        delete options.block_cache;
     options.block_cache = nullptr;
     delete penv;
     options.env = nullptr;
@@ -203,7 +240,11 @@ size_t CDBWrapper::DynamicMemoryUsage() const {
         LogPrint(BCLog::LEVELDB, "Failed to get approximate-memory-usage property\n");
         return 0;
     }
-    return stoul(memory);
+    size_t usage = stoul(memory);
+    // LevelDB counts the whole block cache, which other databases may be sharing
+    if (!m_owns_block_cache)
+        usage -= std::min(usage, options.block_cache->TotalCharge());
+    return usage;
 }
 
 // Prefixed with null character to avoid collisions with other keys
@@ -233,6 +274,21 @@ bool CDBWrapper::IsEmpty()
     return !(it->Valid());
 }
 
+std::shared_ptr<const leveldb::Snapshot> CDBWrapper::GetSnapshot() const
+{
+    leveldb::DB* db = pdb;
+    return std::shared_ptr<const leveldb::Snapshot>(db->GetSnapshot(), [db](const leveldb::Snapshot* snapshot) {
+        db->ReleaseSnapshot(snapshot);
+    });
+}
+
+CDBIterator *CDBWrapper::NewIterator(const std::shared_ptr<const leveldb::Snapshot>& snapshot) const
+{
+    leveldb::ReadOptions options = iteroptions;
+    options.snapshot = snapshot.get();
+    return new CDBIterator(*this, pdb->NewIterator(options));
+}
+
 CDBIterator::~CDBIterator() { delete piter; }
 bool CDBIterator::Valid() const { return piter->Valid(); }
 void CDBIterator::SeekToFirst() { piter->SeekToFirst(); }
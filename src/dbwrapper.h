@@ -16,6 +16,9 @@
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
+#include <atomic>
+#include <memory>
+
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 
@@ -27,6 +30,36 @@ public:
 
 class CDBWrapper;
 
+/**
+ * A LevelDB block cache shared by several databases, so that together they stay
+ * within one budget while each holds as much of it as its reads call for.
+ * Lookups are counted so that the hit rate can be reported.
+ */
+class CDBBlockCache
+{
+public:
+    explicit CDBBlockCache(size_t nCapacityIn);
+    ~CDBBlockCache();
+
+    CDBBlockCache(const CDBBlockCache&) = delete;
+    CDBBlockCache& operator=(const CDBBlockCache&) = delete;
+
+    size_t Capacity() const { return nCapacity; }
+    //! Bytes of blocks currently held
+    size_t Usage() const;
+    uint64_t Hits() const { return nHits; }
+    uint64_t Misses() const { return nMisses; }
+
+private:
+    friend class CDBWrapper;
+    class CountingCache;
+
+    const size_t nCapacity;
+    std::atomic<uint64_t> nHits{0};
+    std::atomic<uint64_t> nMisses{0};
+    std::unique_ptr<leveldb::Cache> pcache;
+};
+
 /** These should be considered an implementation detail of the specific database.
  */
 namespace dbwrapper_private {
@@ -198,6 +231,9 @@ private:
     //! the database itself
     leveldb::DB* pdb;
 
+    //! whether options.block_cache is ours, rather than a CDBBlockCache shared with other databases
+    bool m_owns_block_cache;
+
     //! the name of this database
     std::string m_name;
 
@@ -220,23 +256,28 @@ public:
      * @param[in] fWipe       If true, remove all existing data.
      * @param[in] obfuscate   If true, store data obfuscated via simple XOR. If false, XOR
      *                        with a zero'd byte array.
+     * @param[in] pBlockCache If set, read blocks into this cache, which must outlive the
+     *                        database, instead of one of nCacheSize / 2 of our own.
      */
-    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false);
+    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false, CDBBlockCache* pBlockCache = nullptr);
     ~CDBWrapper();
 
     CDBWrapper(const CDBWrapper&) = delete;
     CDBWrapper& operator=(const CDBWrapper&) = delete;
 
+    /** Read a value, as of @a snapshot if one is given (see GetSnapshot). */
     template <typename K, typename V>
-    bool Read(const K& key, V& value) const
+    bool Read(const K& key, V& value, const std::shared_ptr<const leveldb::Snapshot>& snapshot = nullptr) const
     {
         CDataStream ssKey(SER_DISK, CLIENT_VERSION);
         ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
         ssKey << key;
         leveldb::Slice slKey(ssKey.data(), ssKey.size());
 
+        leveldb::ReadOptions options = readoptions;
+        options.snapshot = snapshot.get();
         std::string strValue;
-        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        leveldb::Status status = pdb->Get(options, slKey, &strValue);
         if (!status.ok()) {
             if (status.IsNotFound())
                 return false;
@@ -290,7 +331,7 @@ public:
 
     bool WriteBatch(CDBBatch& batch, bool fSync = false);
 
-    // Get an estimate of LevelDB memory usage (in bytes).
+    // Get an estimate of LevelDB memory usage (in bytes). A shared block cache is not included.
     size_t DynamicMemoryUsage() const;
 
     // not available for LevelDB; provide for compatibility with BDB
@@ -310,6 +351,16 @@ public:
         return new CDBIterator(*this, pdb->NewIterator(iteroptions));
     }
 
+    /**
+     * Take a consistent, read-only view of the database as of now. Writes made
+     * afterwards are not visible through it. It must be released before the
+     * database is closed.
+     */
+    std::shared_ptr<const leveldb::Snapshot> GetSnapshot() const;
+
+    /** Iterate over the database as it was when @a snapshot was taken. */
+    CDBIterator *NewIterator(const std::shared_ptr<const leveldb::Snapshot>& snapshot) const;
+
     /**
      * Return true if the database managed by this class contains no entries.
      */
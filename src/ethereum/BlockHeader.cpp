@@ -136,11 +136,23 @@ void BlockHeader::streamRLPFields(RLPStream& _s) const
 		<< m_difficulty << m_number << m_gasLimit << m_gasUsed << m_timestamp << m_extraData;
 }
 
+size_t BlockHeader::rlpFieldsSize() const
+{
+	return rlpSize(m_parentHash) + rlpSize(m_sha3Uncles) + rlpSize(m_author) + rlpSize(m_stateRoot) + rlpSize(m_transactionsRoot) + rlpSize(m_receiptsRoot) + rlpSize(m_logBloom)
+		+ rlpSize(m_difficulty) + rlpSize(m_number) + rlpSize(m_gasLimit) + rlpSize(m_gasUsed) + rlpSize(m_timestamp) + rlpSize(m_extraData);
+}
+
 void BlockHeader::streamRLP(RLPStream& _s, IncludeSeal _i) const
 {
 	if (_i != OnlySeal)
 	{
-		_s.appendList(BlockHeader::BasicFields + (_i == WithoutSeal ? 0 : m_seal.size()));
+		// Size the list first so its header is written in place
+		size_t payloadSize = rlpFieldsSize();
+		if (_i != WithoutSeal)
+			for (auto const& s: m_seal)
+				payloadSize += s.size();
+		_s.reserve(rlpListSize(payloadSize));
+		_s.appendList(BlockHeader::BasicFields + (_i == WithoutSeal ? 0 : m_seal.size()), payloadSize);
 		BlockHeader::streamRLPFields(_s);
 	}
 	if (_i != WithoutSeal)
@@ -209,7 +221,7 @@ void BlockHeader::populateFromParent(BlockHeader const& _parent)
 	m_gasUsed = 0;
 }
 
-void BlockHeader::verify(Strictness _s, BlockHeader const& _parent, bytesConstRef _block) const
+void BlockHeader::verify(Strictness _s, BlockHeader const& _parent, bytesConstRef _block, tp::ThreadPool* _pool) const
 {
 	if (m_number > ~(unsigned)0)
 		BOOST_THROW_EXCEPTION(InvalidNumber());
@@ -234,7 +246,11 @@ void BlockHeader::verify(Strictness _s, BlockHeader const& _parent, bytesConstRe
 		RLP root(_block);
 
 		auto txList = root[1];
-		auto expectedRoot = trieRootOver(txList.itemCount(), [&](unsigned i){ return rlp(i); }, [&](unsigned i){ return txList[i].data().toBytes(); });
+		vector<bytesConstRef> txData;
+		txData.reserve(txList.itemCount());
+		for (auto const& tx: txList)
+			txData.push_back(tx.data());
+		auto expectedRoot = orderedTrieRoot(txData, _pool);
 
 		//clog(BlockInfoDiagnosticsChannel) << "Expected trie root:" << toString(expectedRoot);
 		if (m_transactionsRoot != expectedRoot)
@@ -31,6 +31,8 @@
 //#include "ChainOperationParams.h"
 #include "Exceptions.h"
 
+#include <thread_pool/thread_pool.hpp>
+
 namespace dev
 {
 extern const h256 EmptyTrie;
@@ -149,7 +151,8 @@ public:
 	void populateFromParent(BlockHeader const& parent);
 
 	// TODO: pull out into abstract class Verifier.
-	void verify(Strictness _s = CheckEverything, BlockHeader const& _parent = BlockHeader(), bytesConstRef _block = bytesConstRef()) const;
+	/// The transactions root of @a _block is recomputed on @a _pool as well as the calling thread if one is given.
+	void verify(Strictness _s = CheckEverything, BlockHeader const& _parent = BlockHeader(), bytesConstRef _block = bytesConstRef(), tp::ThreadPool* _pool = nullptr) const;
 	void verify(Strictness _s, bytesConstRef _block) const { verify(_s, BlockHeader(), _block); }
 
 	h256 hash(IncludeSeal _i = WithSeal) const;
@@ -188,6 +191,7 @@ public:
 private:
 	void populate(RLP const& _header);
 	void streamRLPFields(RLPStream& _s) const;
+	size_t rlpFieldsSize() const;
 	std::vector<bytes> seal() const
 	{
 		Guard l(m_sealLock);
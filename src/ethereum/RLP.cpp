@@ -105,6 +105,54 @@ RLPs RLP::toList(int _flags) const
 	return ret;
 }
 
+RLPItemsRef RLP::toList(RLPArena& _arena, int _flags) const
+{
+	if (!isList())
+	{
+		if (_flags & ThrowOnFail)
+			BOOST_THROW_EXCEPTION(BadCast());
+		else
+			return RLPItemsRef();
+	}
+	size_t n = items();
+	RLP* ret = _arena.alloc<RLP>(n);
+	size_t i = 0;
+	for (auto const& item: *this)
+		new (ret + i++) RLP(item);
+	return RLPItemsRef(ret, i);
+}
+
+void* RLPArena::allocate(size_t _size, size_t _align)
+{
+	size_t offset = (m_blockUsed + _align - 1) & ~(_align - 1);
+	if (m_blocks.empty() || offset + _size > m_blocks.back().second)
+	{
+		// Oversized requests get a block of their own
+		size_t capacity = std::max(m_blockSize, _size);
+		m_blocks.emplace_back(std::unique_ptr<byte[]>(new byte[capacity]), capacity);
+		offset = 0;
+	}
+	m_blockUsed = offset + _size;
+	m_used += _size;
+	return m_blocks.back().first.get() + offset;
+}
+
+bytesConstRef RLPArena::copy(bytesConstRef _data)
+{
+	byte* b = alloc<byte>(_data.size());
+	if (!_data.empty())
+		memcpy(b, _data.data(), _data.size());
+	return bytesConstRef(b, _data.size());
+}
+
+void RLPArena::clear()
+{
+	if (m_blocks.size() > 1)
+		m_blocks.erase(m_blocks.begin() + 1, m_blocks.end());
+	m_blockUsed = 0;
+	m_used = 0;
+}
+
 size_t RLP::actualSize() const
 {
 	if (isNull())
@@ -241,14 +289,23 @@ void RLPStream::noteAppended(size_t _itemCount)
 //	cdebug << "noteAppended(" << _itemCount << ")";
 	while (m_listStack.size())
 	{
-		if (m_listStack.back().first < _itemCount)
-			BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("itemCount too large") << RequirementError((bigint)m_listStack.back().first, (bigint)_itemCount));
-		m_listStack.back().first -= _itemCount;
-		if (m_listStack.back().first)
+		if (m_listStack.back().items < _itemCount)
+			BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("itemCount too large") << RequirementError((bigint)m_listStack.back().items, (bigint)_itemCount));
+		m_listStack.back().items -= _itemCount;
+		if (m_listStack.back().end != c_unsized && m_out.size() > m_listStack.back().end)
+			BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("list payload larger than its declared size"));
+		if (m_listStack.back().items)
 			break;
+		else if (m_listStack.back().end != c_unsized)
+		{
+			// The header was written by appendList(_items, _payloadSize)
+			if (m_out.size() != m_listStack.back().end)
+				BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("list payload smaller than its declared size"));
+			m_listStack.pop_back();
+		}
 		else
 		{
-			auto p = m_listStack.back().second;
+			auto p = m_listStack.back().start;
 			m_listStack.pop_back();
 			size_t s = m_out.size() - p;		// list size
 			auto brs = bytesRequired(s);
@@ -277,12 +334,28 @@ RLPStream& RLPStream::appendList(size_t _items)
 {
 //	cdebug << "appendList(" << _items << ")";
 	if (_items)
-		m_listStack.push_back(std::make_pair(_items, m_out.size()));
+		m_listStack.push_back(ListInfo{_items, m_out.size(), c_unsized});
 	else
 		appendList(bytes());
 	return *this;
 }
 
+RLPStream& RLPStream::appendList(size_t _items, size_t _payloadSize)
+{
+	if (!_items)
+	{
+		if (_payloadSize)
+			BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("empty list with a payload"));
+		return appendList(bytes());
+	}
+	if (_payloadSize < c_rlpListImmLenCount)
+		m_out.push_back((byte)(_payloadSize + c_rlpListStart));
+	else
+		pushCount(_payloadSize, c_rlpListIndLenZero);
+	m_listStack.push_back(ListInfo{_items, m_out.size(), m_out.size() + _payloadSize});
+	return *this;
+}
+
 RLPStream& RLPStream::appendList(bytesConstRef _rlp)
 {
 	if (_rlp.size() < c_rlpListImmLenCount)
@@ -314,31 +387,6 @@ RLPStream& RLPStream::append(bytesConstRef _s, bool _compact)
 	return *this;
 }
 
-RLPStream& RLPStream::append(bigint _i)
-{
-	if (!_i)
-		m_out.push_back(c_rlpDataImmLenStart);
-	else if (_i < c_rlpDataImmLenStart)
-		m_out.push_back((byte)_i);
-	else
-	{
-		unsigned br = bytesRequired(_i);
-		if (br < c_rlpDataImmLenCount)
-			m_out.push_back((byte)(br + c_rlpDataImmLenStart));
-		else
-		{
-			auto brbr = bytesRequired(br);
-			if (c_rlpDataIndLenZero + brbr > 0xff)
-				BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("Number too large for RLP"));
-			m_out.push_back((byte)(c_rlpDataIndLenZero + brbr));
-			pushInt(br, brbr);
-		}
-		pushInt(_i, br);
-	}
-	noteAppended();
-	return *this;
-}
-
 void RLPStream::pushCount(size_t _count, byte _base)
 {
 	auto br = bytesRequired(_count);
@@ -24,6 +24,8 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <type_traits>
 #include <array>
 #include <exception>
 #include <iosfwd>
@@ -36,6 +38,8 @@ namespace dev
 {
 
 class RLP;
+class RLPArena;
+class RLPItemsRef;
 using RLPs = std::vector<RLP>;
 
 template <class _T> struct intTraits { static const unsigned maxSize = sizeof(_T); };
@@ -316,6 +320,10 @@ public:
 	/// Converts to RLPs collection object. Useful if you need random access to sub items or will iterate over multiple times.
 	RLPs toList(int _flags = Strict) const;
 
+	/// Converts to a view of the list items, decoded in one pass and allocated in @a _arena.
+	/// The view stays valid until @a _arena is cleared or destroyed.
+	RLPItemsRef toList(RLPArena& _arena, int _flags = Strict) const;
+
 	/// @returns the data payload. Valid for all types.
 	bytesConstRef payload() const { auto l = length(); if (l > m_data.size()) BOOST_THROW_EXCEPTION(BadRLP()); return m_data.cropped(payloadOffset(), l); }
 
@@ -376,6 +384,94 @@ template <class T, size_t N> struct Converter<std::array<T, N>> { static std::ar
 
 template <class T> inline T RLP::convert(int _flags) const { return Converter<T>::convert(*this, _flags); }
 
+/// A view of list items that were decoded into an RLPArena.
+class RLPItemsRef
+{
+public:
+	RLPItemsRef(): m_data(nullptr), m_count(0) {}
+	RLPItemsRef(RLP const* _data, size_t _count): m_data(_data), m_count(_count) {}
+
+	size_t size() const { return m_count; }
+	bool empty() const { return !m_count; }
+	RLP const& operator[](size_t _i) const { assert(_i < m_count); return m_data[_i]; }
+	RLP const* begin() const { return m_data; }
+	RLP const* end() const { return m_data + m_count; }
+
+private:
+	RLP const* m_data;
+	size_t m_count;
+};
+
+/**
+ * @brief Bump allocator for decoded RLP items.
+ *
+ * Allocations are carved from fixed-size blocks and are only released all at
+ * once, by clear() or on destruction, e.g. after verifying one proof.
+ * Only trivially destructible types may be allocated.
+ */
+class RLPArena
+{
+public:
+	explicit RLPArena(size_t _blockSize = 4096): m_blockSize(_blockSize) {}
+	RLPArena(RLPArena const&) = delete;
+	RLPArena& operator=(RLPArena const&) = delete;
+
+	/// @returns uninitialised storage for @a _count objects of type T.
+	template <class T> T* alloc(size_t _count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+		return static_cast<T*>(allocate(_count * sizeof(T), alignof(T)));
+	}
+
+	/// @returns a copy of @a _data that lives as long as the arena's contents.
+	bytesConstRef copy(bytesConstRef _data);
+
+	/// Release everything allocated so far. The first block is kept for reuse.
+	void clear();
+
+	/// @returns the number of bytes handed out since the last clear().
+	size_t used() const { return m_used; }
+
+private:
+	void* allocate(size_t _size, size_t _align);
+
+	size_t const m_blockSize;
+	/// Blocks with their capacities; allocations come from the last one.
+	std::vector<std::pair<std::unique_ptr<byte[]>, size_t>> m_blocks;
+	size_t m_blockUsed = 0;
+	size_t m_used = 0;
+};
+
+/// @returns the size of @a _s when encoded as an RLP data item.
+inline size_t rlpSize(bytesConstRef _s)
+{
+	size_t s = _s.size();
+	if (s == 1 && _s[0] < c_rlpDataImmLenStart)
+		return 1;
+	return s < c_rlpDataImmLenCount ? 1 + s : 1 + bytesRequired(s) + s;
+}
+inline size_t rlpSize(bytes const& _s) { return rlpSize(bytesConstRef(&_s)); }
+inline size_t rlpSize(std::string const& _s) { return rlpSize(bytesConstRef(_s)); }
+template <unsigned N> size_t rlpSize(FixedHash<N> const& _s) { return rlpSize(_s.ref()); }
+
+/// @returns the size of the unsigned integer @a _i when encoded as an RLP data item.
+template <class _T> size_t rlpSizeInt(_T const& _i)
+{
+	if (_i < c_rlpDataImmLenStart)
+		return 1;
+	size_t br = bytesRequired(_i);
+	return br < c_rlpDataImmLenCount ? 1 + br : 1 + bytesRequired(br) + br;
+}
+inline size_t rlpSize(unsigned _i) { return rlpSizeInt(_i); }
+inline size_t rlpSize(u256 const& _i) { return _i < c_rlpDataImmLenStart ? 1 : 2 + boost::multiprecision::msb(_i) / 8; }
+inline size_t rlpSize(bigint const& _i) { return rlpSizeInt(_i); }
+
+/// @returns the size of a list whose encoded items take @a _payloadSize bytes, including its header.
+inline size_t rlpListSize(size_t _payloadSize)
+{
+	return _payloadSize < c_rlpListImmLenCount ? 1 + _payloadSize : 1 + bytesRequired(_payloadSize) + _payloadSize;
+}
+
 /**
  * @brief Class for writing to an RLP bytestream.
  */
@@ -388,13 +484,17 @@ public:
 	/// Initializes the RLPStream as a list of @a _listItems items.
 	explicit RLPStream(size_t _listItems) { appendList(_listItems); }
 
+	/// Initializes the RLPStream as a list of @a _listItems items taking @a _payloadSize bytes,
+	/// reserving exactly the space the encoding needs.
+	RLPStream(size_t _listItems, size_t _payloadSize) { m_out.reserve(rlpListSize(_payloadSize)); appendList(_listItems, _payloadSize); }
+
 	~RLPStream() {}
 
 	/// Append given datum to the byte stream.
-	RLPStream& append(unsigned _s) { return append(bigint(_s)); }
-	RLPStream& append(u160 _s) { return append(bigint(_s)); }
-	RLPStream& append(u256 _s) { return append(bigint(_s)); }
-	RLPStream& append(bigint _s);
+	RLPStream& append(unsigned _s) { return appendInt(_s); }
+	RLPStream& append(u160 _s) { return appendInt(_s); }
+	RLPStream& append(u256 _s) { return appendInt(_s); }
+	RLPStream& append(bigint _s) { return appendInt(_s); }
 	RLPStream& append(bytesConstRef _s, bool _compact = false);
 	RLPStream& append(bytes const& _s) { return append(bytesConstRef(&_s)); }
 	RLPStream& append(std::string const& _s) { return append(bytesConstRef(_s)); }
@@ -413,7 +513,13 @@ public:
 	template <class T, class U> RLPStream& append(std::pair<T, U> const& _s) { appendList(2); append(_s.first); append(_s.second); return *this; }
 
 	/// Appends a list.
+	/// The list header is inserted in front of the items once they are complete, which moves them;
+	/// prefer the sized overload when the payload size is known.
 	RLPStream& appendList(size_t _items);
+
+	/// Appends a list of @a _items items whose encodings take @a _payloadSize bytes in total.
+	/// The header is written up front, so nothing is moved when the list completes.
+	RLPStream& appendList(size_t _items, size_t _payloadSize);
 	RLPStream& appendList(bytesConstRef _rlp);
 	RLPStream& appendList(bytes const& _rlp) { return appendList(&_rlp); }
 	RLPStream& appendList(RLPStream const& _s) { return appendList(&_s.out()); }
@@ -428,6 +534,9 @@ public:
 	/// Clear the output stream so far.
 	void clear() { m_out.clear(); m_listStack.clear(); }
 
+	/// Reserve space for @a _size more bytes of output.
+	void reserve(size_t _size) { m_out.reserve(m_out.size() + _size); }
+
 	/// Read the byte stream.
 	bytes const& out() const { if(!m_listStack.empty()) BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("listStack is not empty")); return m_out; }
 
@@ -440,6 +549,32 @@ public:
 private:
 	void noteAppended(size_t _itemCount = 1);
 
+	/// Append an unsigned integer without widening it to a bigint first.
+	template <class _T> RLPStream& appendInt(_T const& _i)
+	{
+		if (!_i)
+			m_out.push_back(c_rlpDataImmLenStart);
+		else if (_i < c_rlpDataImmLenStart)
+			m_out.push_back((byte)_i);
+		else
+		{
+			unsigned br = bytesRequired(_i);
+			if (br < c_rlpDataImmLenCount)
+				m_out.push_back((byte)(br + c_rlpDataImmLenStart));
+			else
+			{
+				auto brbr = bytesRequired(br);
+				if (c_rlpDataIndLenZero + brbr > 0xff)
+					BOOST_THROW_EXCEPTION(RLPException() << errinfo_comment("Number too large for RLP"));
+				m_out.push_back((byte)(c_rlpDataIndLenZero + brbr));
+				pushInt(br, brbr);
+			}
+			pushInt(_i, br);
+		}
+		noteAppended();
+		return *this;
+	}
+
 	/// Push the node-type byte (using @a _base) along with the item count @a _count.
 	/// @arg _count is number of characters for strings, data-bytes for ints, or items for lists.
 	void pushCount(size_t _count, byte _offset);
@@ -453,10 +588,21 @@ private:
 			*(b--) = (byte)_i;
 	}
 
+	/// An open list: the items still expected, and where its payload starts.
+	/// Sized lists already have their header and record where the payload must end.
+	struct ListInfo
+	{
+		size_t items;
+		size_t start;
+		size_t end;
+	};
+
+	static const size_t c_unsized = (size_t)-1;
+
 	/// Our output byte stream.
 	bytes m_out;
 
-	std::vector<std::pair<size_t, size_t>> m_listStack;
+	std::vector<ListInfo> m_listStack;
 };
 
 template <class _T> void rlpListAux(RLPStream& _out, _T _t) { _out << _t; }
@@ -24,6 +24,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "FixedHash.h"
 #include "vector_ref.h"
 
@@ -61,6 +62,9 @@ template<unsigned N> inline SecureFixedHash<32> sha3Secure(SecureFixedHash<N> co
 /// Calculate SHA3-256 hash of the given input, possibly interpreting it as nibbles, and return the hash as a string filled with binary data.
 inline std::string sha3(std::string const& _input, bool _isNibbles) { return asString((_isNibbles ? sha3(fromHex(_input)) : sha3(bytesConstRef(&_input))).asBytes()); }
 
+/// Calculate the SHA3-256 hashes of independent inputs, several at a time where the CPU allows.
+std::vector<h256> sha3Batch(std::vector<bytesConstRef> const& _inputs);
+
 /// Calculate SHA3-256 MAC
 inline void sha3mac(bytesConstRef _secret, bytesConstRef _plain, bytesRef _output) { sha3(_secret.toBytes() + _plain.toBytes()).ref().populate(_output); }
 
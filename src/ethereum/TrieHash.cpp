@@ -19,10 +19,19 @@
 #include "TrieCommon.h"
 #include "TrieDB.h"	// @TODO replace ASAP!
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
 namespace dev
 {
 
-void hash256aux(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp);
+/// Largest encoded reference to a child node: a 32-byte hash with its RLP prefix.
+static const size_t c_maxNodeRefSize = 33;
+
+size_t hash256ref(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, byte* _ref);
 
 void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp)
 {
@@ -31,7 +40,8 @@ void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_i
 	else if (std::next(_begin) == _end)
 	{
 		// only one left - terminate with the pair.
-		_rlp.appendList(2) << hexPrefixEncode(_begin->first, true, _preLen) << _begin->second;
+		std::string key = hexPrefixEncode(_begin->first, true, _preLen);
+		_rlp.appendList(2, rlpSize(key) + rlpSize(_begin->second)) << key << _begin->second;
 	}
 	else
 	{
@@ -49,13 +59,18 @@ void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_i
 		if (sharedPre > _preLen)
 		{
 			// if they all have the same next nibble, we also want a pair.
-			_rlp.appendList(2) << hexPrefixEncode(_begin->first, false, _preLen, (int)sharedPre);
-			hash256aux(_s, _begin, _end, (unsigned)sharedPre, _rlp);
+			std::string key = hexPrefixEncode(_begin->first, false, _preLen, (int)sharedPre);
+			byte ref[c_maxNodeRefSize];
+			size_t refSize = hash256ref(_s, _begin, _end, (unsigned)sharedPre, ref);
+			_rlp.appendList(2, rlpSize(key) + refSize) << key;
+			_rlp.appendRaw(bytesConstRef(ref, refSize));
 		}
 		else
 		{
-			// otherwise enumerate all 16+1 entries.
-			_rlp.appendList(17);
+			// otherwise enumerate all 16+1 entries; the children are encoded first so the list can be sized.
+			byte refs[16][c_maxNodeRefSize];
+			size_t refSizes[16];
+			size_t payloadSize = 0;
 			auto b = _begin;
 			if (_preLen == b->first.size())
 				++b;
@@ -64,31 +79,42 @@ void hash256rlp(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_i
 				auto n = b;
 				for (; n != _end && n->first[_preLen] == i; ++n) {}
 				if (b == n)
-					_rlp << "";
+				{
+					refs[i][0] = c_rlpDataImmLenStart;
+					refSizes[i] = 1;
+				}
 				else
-					hash256aux(_s, b, n, _preLen + 1, _rlp);
+					refSizes[i] = hash256ref(_s, b, n, _preLen + 1, refs[i]);
+				payloadSize += refSizes[i];
 				b = n;
 			}
-			if (_preLen == _begin->first.size())
-				_rlp << _begin->second;
-			else
-				_rlp << "";
+			bytesConstRef value = _preLen == _begin->first.size() ? bytesConstRef(&_begin->second) : bytesConstRef();
+			payloadSize += rlpSize(value);
 
+			_rlp.appendList(17, payloadSize);
+			for (auto i = 0; i < 16; ++i)
+				_rlp.appendRaw(bytesConstRef(refs[i], refSizes[i]));
+			_rlp << value;
 		}
 	}
 }
 
-void hash256aux(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, RLPStream& _rlp)
+/// Write the reference to the node for [_begin, _end) to @a _ref: the node itself if its RLP is
+/// shorter than 32 bytes, otherwise its hash. @returns the number of bytes written.
+size_t hash256ref(HexMap const& _s, HexMap::const_iterator _begin, HexMap::const_iterator _end, unsigned _preLen, byte* _ref)
 {
 	RLPStream rlp;
 	hash256rlp(_s, _begin, _end, _preLen, rlp);
-	if (rlp.out().size() < 32)
+	bytes const& out = rlp.out();
+	if (out.size() < 32)
 	{
 		// RECURSIVE RLP
-		_rlp.appendRaw(rlp.out());
+		memcpy(_ref, out.data(), out.size());
+		return out.size();
 	}
-	else
-		_rlp << sha3(rlp.out());
+	_ref[0] = c_rlpDataImmLenStart + 32;
+	sha3(out).ref().copyTo(bytesRef(_ref + 1, 32));
+	return c_maxNodeRefSize;
 }
 
 bytes rlp256(BytesMap const& _s)
@@ -109,22 +135,272 @@ h256 hash256(BytesMap const& _s)
 	return sha3(rlp256(_s));
 }
 
-h256 orderedTrieRoot(std::vector<bytes> const& _data)
+namespace
+{
+
+/// Ordered tries with fewer entries than this are not worth splitting across threads.
+static const size_t c_minParallelTrieEntries = 64;
+
+/// A key/value pair of a trie being hashed. Both are views; keys are raw bytes, read nibble by nibble.
+struct TrieEntry
+{
+	bytesConstRef key;
+	bytesConstRef value;
+	bool operator<(TrieEntry const& _o) const { return std::lexicographical_compare(key.begin(), key.end(), _o.key.begin(), _o.key.end()); }
+};
+using TrieEntryIt = std::vector<TrieEntry>::const_iterator;
+
+/**
+ * Hashes tries over a sorted, flat vector of entries, producing the same nodes as
+ * hash256rlp(). Children are encoded before their parent into fixed buffers, so
+ * one scratch stream per hasher is reused for every node.
+ */
+class FlatTrieHasher
+{
+public:
+	/// Write the reference to the node for [_begin, _end) to @a _ref and @returns its size.
+	size_t nodeRef(TrieEntryIt _begin, TrieEntryIt _end, unsigned _preLen, byte* _ref)
+	{
+		encodeNode(_begin, _end, _preLen);
+		bytes const& out = m_scratch.out();
+		if (out.size() < 32)
+		{
+			memcpy(_ref, out.data(), out.size());
+			return out.size();
+		}
+		_ref[0] = c_rlpDataImmLenStart + 32;
+		sha3(out).ref().copyTo(bytesRef(_ref + 1, 32));
+		return c_maxNodeRefSize;
+	}
+
+	/// Hash of the node for [_begin, _end), as the root of a trie.
+	h256 rootHash(TrieEntryIt _begin, TrieEntryIt _end)
+	{
+		encodeNode(_begin, _end, 0);
+		return sha3(m_scratch.out());
+	}
+
+	/// Encode the branch node at depth 0 given its 16 child references; see branchChildren().
+	h256 rootBranchHash(byte const (&_refs)[16][c_maxNodeRefSize], size_t const (&_refSizes)[16], bytesConstRef _value)
+	{
+		writeBranch(_refs, _refSizes, _value);
+		return sha3(m_scratch.out());
+	}
+
+	/// @returns the ends of the 16 child ranges of a branch at @a _preLen, and sets @a _value if one entry ends there.
+	static void branchChildren(TrieEntryIt _begin, TrieEntryIt _end, unsigned _preLen, TrieEntryIt (&_childEnds)[16], TrieEntryIt& _childBegin, bytesConstRef& _value)
+	{
+		_childBegin = _begin;
+		_value = bytesConstRef();
+		if (_preLen == _begin->key.size() * 2)
+			_value = (_childBegin++)->value;
+		auto b = _childBegin;
+		for (unsigned i = 0; i < 16; ++i)
+		{
+			auto n = b;
+			for (; n != _end && nibble(n->key, _preLen) == i; ++n) {}
+			_childEnds[i] = n;
+			b = n;
+		}
+	}
+
+	/// @returns the number of nibbles shared by all entries in [_begin, _end), which must hold at least two.
+	static unsigned sharedPrefix(TrieEntryIt _begin, TrieEntryIt _end, unsigned _preLen)
+	{
+		// Sorted keys share with each other exactly what the first and last share
+		TrieEntry const& first = *_begin;
+		TrieEntry const& last = *std::prev(_end);
+		unsigned x = std::min(first.key.size(), last.key.size()) * 2;
+		unsigned shared = _preLen;
+		for (; shared < x && nibble(first.key, shared) == nibble(last.key, shared); ++shared) {}
+		return shared;
+	}
+
+private:
+	void encodeNode(TrieEntryIt _begin, TrieEntryIt _end, unsigned _preLen)
+	{
+		if (_begin == _end)
+		{
+			m_scratch.clear();
+			m_scratch << "";
+		}
+		else if (std::next(_begin) == _end)
+		{
+			std::string key = hexPrefixEncode(_begin->key, true, _preLen, -1, 0);
+			m_scratch.clear();
+			m_scratch.appendList(2, rlpSize(key) + rlpSize(_begin->value)) << key << _begin->value;
+		}
+		else
+		{
+			unsigned sharedPre = sharedPrefix(_begin, _end, _preLen);
+			if (sharedPre > _preLen)
+			{
+				byte ref[c_maxNodeRefSize];
+				size_t refSize = nodeRef(_begin, _end, sharedPre, ref);
+				std::string key = hexPrefixEncode(_begin->key, false, _preLen, sharedPre, 0);
+				m_scratch.clear();
+				m_scratch.appendList(2, rlpSize(key) + refSize) << key;
+				m_scratch.appendRaw(bytesConstRef(ref, refSize));
+			}
+			else
+			{
+				TrieEntryIt childEnds[16];
+				TrieEntryIt b;
+				bytesConstRef value;
+				branchChildren(_begin, _end, _preLen, childEnds, b, value);
+				byte refs[16][c_maxNodeRefSize];
+				size_t refSizes[16];
+				for (unsigned i = 0; i < 16; ++i)
+				{
+					if (b == childEnds[i])
+					{
+						refs[i][0] = c_rlpDataImmLenStart;
+						refSizes[i] = 1;
+					}
+					else
+						refSizes[i] = nodeRef(b, childEnds[i], _preLen + 1, refs[i]);
+					b = childEnds[i];
+				}
+				writeBranch(refs, refSizes, value);
+			}
+		}
+	}
+
+	void writeBranch(byte const (&_refs)[16][c_maxNodeRefSize], size_t const (&_refSizes)[16], bytesConstRef _value)
+	{
+		size_t payloadSize = rlpSize(_value);
+		for (unsigned i = 0; i < 16; ++i)
+			payloadSize += _refSizes[i];
+		m_scratch.clear();
+		m_scratch.appendList(17, payloadSize);
+		for (unsigned i = 0; i < 16; ++i)
+			m_scratch.appendRaw(bytesConstRef(_refs[i], _refSizes[i]));
+		m_scratch << _value;
+	}
+
+	RLPStream m_scratch;
+};
+
+/// The 16 subtrees of a root branch, handed out one at a time to whichever thread asks next.
+struct ParallelTrieRoot
+{
+	TrieEntryIt begin[16];
+	TrieEntryIt end[16];
+	byte refs[16][c_maxNodeRefSize];
+	size_t refSizes[16];
+	std::atomic<unsigned> next{0};
+	std::atomic<unsigned> done{0};
+	std::mutex cs;
+	std::condition_variable cond;
+
+	/// Hash subtrees until none are left.
+	void work()
+	{
+		FlatTrieHasher hasher;
+		for (unsigned i = next++; i < 16; i = next++)
+		{
+			if (begin[i] == end[i])
+			{
+				refs[i][0] = c_rlpDataImmLenStart;
+				refSizes[i] = 1;
+			}
+			else
+				refSizes[i] = hasher.nodeRef(begin[i], end[i], 1, refs[i]);
+			if (++done == 16)
+			{
+				std::lock_guard<std::mutex> l(cs);
+				cond.notify_all();
+			}
+		}
+	}
+};
+
+h256 flatTrieRoot(std::vector<TrieEntry>& _entries, tp::ThreadPool* _pool)
 {
-	BytesMap m;
-	unsigned j = 0;
-	for (auto i: _data)
-		m[rlp(j++)] = i;
-	return hash256(m);
+	if (_entries.empty())
+		return sha3(rlp(""));
+	std::sort(_entries.begin(), _entries.end());
+
+	FlatTrieHasher hasher;
+	auto begin = _entries.cbegin();
+	auto end = _entries.cend();
+	if (!_pool || _entries.size() < c_minParallelTrieEntries || FlatTrieHasher::sharedPrefix(begin, end, 0) > 0)
+		return hasher.rootHash(begin, end);
+
+	// The root is a branch: hash its first-nibble subtrees in parallel. The calling thread
+	// takes part, so this completes even if no task can be posted or the pool is busy.
+	auto job = std::make_shared<ParallelTrieRoot>();
+	TrieEntryIt b;
+	bytesConstRef value;
+	FlatTrieHasher::branchChildren(begin, end, 0, job->end, b, value);
+	for (unsigned i = 0; i < 16; ++i)
+	{
+		job->begin[i] = b;
+		b = job->end[i];
+	}
+	unsigned nNonEmpty = 0;
+	for (unsigned i = 0; i < 16; ++i)
+		nNonEmpty += job->begin[i] != job->end[i];
+	// Tasks that start after all subtrees are taken return without touching the entries
+	for (unsigned i = 1; i < nNonEmpty; ++i)
+		if (!_pool->tryPost([job]() { job->work(); }))
+			break;
+	job->work();
+	{
+		std::unique_lock<std::mutex> l(job->cs);
+		job->cond.wait(l, [&job]() { return job->done == 16; });
+	}
+	return hasher.rootBranchHash(job->refs, job->refSizes, value);
+}
+
+}
+
+h256 orderedTrieRoot(std::vector<bytesConstRef> const& _data, tp::ThreadPool* _pool)
+{
+	// All keys live in one buffer; rlp(i) takes at most 1 + sizeof(unsigned) bytes
+	static const size_t c_maxKeySize = 1 + sizeof(unsigned);
+	bytes keys(_data.size() * c_maxKeySize);
+	std::vector<TrieEntry> entries(_data.size());
+	for (unsigned i = 0; i < _data.size(); ++i)
+	{
+		byte* k = keys.data() + i * c_maxKeySize;
+		size_t keySize;
+		if (i == 0)
+		{
+			k[0] = c_rlpDataImmLenStart;
+			keySize = 1;
+		}
+		else if (i < c_rlpDataImmLenStart)
+		{
+			k[0] = (byte)i;
+			keySize = 1;
+		}
+		else
+		{
+			unsigned br = bytesRequired(i);
+			k[0] = (byte)(c_rlpDataImmLenStart + br);
+			for (unsigned j = 0; j < br; ++j)
+				k[br - j] = (byte)(i >> (8 * j));
+			keySize = 1 + br;
+		}
+		entries[i].key = bytesConstRef(k, keySize);
+		entries[i].value = _data[i];
+	}
+	return flatTrieRoot(entries, _pool);
 }
 
 h256 orderedTrieRoot(std::vector<bytesConstRef> const& _data)
 {
-	BytesMap m;
-	unsigned j = 0;
-	for (auto i: _data)
-		m[rlp(j++)] = i.toBytes();
-	return hash256(m);
+	return orderedTrieRoot(_data, nullptr);
+}
+
+h256 orderedTrieRoot(std::vector<bytes> const& _data)
+{
+	std::vector<bytesConstRef> refs;
+	refs.reserve(_data.size());
+	for (auto const& i: _data)
+		refs.push_back(&i);
+	return orderedTrieRoot(refs, nullptr);
 }
 
 }
@@ -23,6 +23,8 @@
 
 #include "FixedHash.h"
 
+#include <thread_pool/thread_pool.hpp>
+
 #include <vector>
 
 namespace dev
@@ -44,4 +46,9 @@ template <class T, class U> inline h256 trieRootOver(unsigned _itemCount, T cons
 h256 orderedTrieRoot(std::vector<bytesConstRef> const& _data);
 h256 orderedTrieRoot(std::vector<bytes> const& _data);
 
+/// Root of the ordered trie over @a _data, keyed by rlp(index). Large tries hash the
+/// 16 subtrees under their root branch on @a _pool as well as the calling thread.
+/// Gives the same root as hash256() over the equivalent BytesMap.
+h256 orderedTrieRoot(std::vector<bytesConstRef> const& _data, tp::ThreadPool* _pool);
+
 }
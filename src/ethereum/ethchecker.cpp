@@ -4,7 +4,11 @@
 
 #include "ethereum/ethchecker.h"
 #include "ethereum/ethereum.h"
+#include "services/ethheaders.h"
 
 bool EthCachingTransactionSignatureChecker::CheckEthHeader(const std::vector<unsigned char>& header) const {
+    // SYSCOIN a header already in the store was decoded and linked when it was imported
+    if (pethheaderdb && pethheaderdb->HaveHeaderRLP(header))
+        return true;
     return VerifyHeader(header);
 }
@@ -0,0 +1,223 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "ethproof.h"
+#include "RLP.h"
+#include "SHA3.h"
+#include "TrieCommon.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+#include <boost/functional/hash.hpp>
+
+using namespace dev;
+
+namespace {
+
+bool SameBytes(bytesConstRef a, bytesConstRef b)
+{
+    return a.size() == b.size() && (a.empty() || memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+struct NodeContentHasher
+{
+    size_t operator()(bytesConstRef node) const { return boost::hash_range(node.begin(), node.end()); }
+};
+
+struct NodeContentEqual
+{
+    bool operator()(bytesConstRef a, bytesConstRef b) const { return SameBytes(a, b); }
+};
+
+/**
+ * Follow key from the root node down to its value. lookup(hash, items) must
+ * return the decoded items of the node with that hash; nodes shorter than 32
+ * bytes are embedded in their parent and are decoded into arena in place.
+ */
+template <typename Lookup>
+bool WalkProof(const h256& root, bytesConstRef key, bytesConstRef value, RLPArena& arena, Lookup lookup)
+{
+    NibbleSlice path(key);
+    RLPItemsRef items;
+    if (!lookup(root, items))
+        return false;
+    while (true) {
+        RLP child;
+        if (items.size() == 17) {
+            if (path.empty())
+                return SameBytes(items[16].toBytesConstRef(), value);
+            child = items[path[0]];
+            path = path.mid(1);
+        } else if (items.size() == 2) {
+            if (!items[0].isData() || items[0].size() == 0)
+                return false;
+            const bytesConstRef encodedPath = items[0].payload();
+            const NibbleSlice nodePath = keyOf(encodedPath);
+            if (encodedPath[0] & 0x20)
+                return path == nodePath && SameBytes(items[1].toBytesConstRef(), value);
+            if (nodePath.empty() || !path.contains(nodePath))
+                return false;
+            path = path.mid(nodePath.size());
+            child = items[1];
+        } else {
+            return false;
+        }
+        if (child.isList()) {
+            items = child.toList(arena);
+        } else if (child.isData() && child.size() == h256::size) {
+            if (!lookup(child.toHash<h256>(), items))
+                return false;
+        } else {
+            return false;
+        }
+    }
+}
+
+} // namespace
+
+bool ParseEthProofNodes(bytesConstRef rlpNodes, std::vector<bytesConstRef>& nodes)
+{
+    try {
+        const RLP rlp(rlpNodes);
+        if (!rlp.isList())
+            return false;
+        nodes.clear();
+        nodes.reserve(rlp.itemCount());
+        for (const RLP& item : rlp) {
+            // Nodes are either relayed as lists or wrapped in byte strings
+            nodes.push_back(item.isList() ? item.data() : item.toBytesConstRef());
+        }
+    } catch (const std::exception& e) {
+        return false;
+    }
+    return true;
+}
+
+CEthProofVerifier::CEthProofVerifier(size_t nMaxCachedIn) : nMaxCached(nMaxCachedIn)
+{
+}
+
+h256 CEthProofVerifier::CacheKey(const h256& root, bytesConstRef key)
+{
+    bytes data(root.begin(), root.end());
+    data.insert(data.end(), key.begin(), key.end());
+    return sha3(data);
+}
+
+bool CEthProofVerifier::IsCached(const h256& cacheKey, const h256& valueHash)
+{
+    Guard l(cs);
+    auto it = mapCached.find(cacheKey);
+    if (it == mapCached.end() || it->second->second != valueHash)
+        return false;
+    listCached.splice(listCached.begin(), listCached, it->second);
+    return true;
+}
+
+void CEthProofVerifier::AddCached(const h256& cacheKey, const h256& valueHash)
+{
+    Guard l(cs);
+    if (nMaxCached == 0 || mapCached.count(cacheKey))
+        return;
+    listCached.emplace_front(cacheKey, valueHash);
+    mapCached[cacheKey] = listCached.begin();
+    if (listCached.size() > nMaxCached) {
+        mapCached.erase(listCached.back().first);
+        listCached.pop_back();
+    }
+}
+
+size_t CEthProofVerifier::CacheSize() const
+{
+    Guard l(cs);
+    return listCached.size();
+}
+
+void CEthProofVerifier::ClearCache()
+{
+    Guard l(cs);
+    listCached.clear();
+    mapCached.clear();
+}
+
+bool CEthProofVerifier::Verify(const h256& root, const CEthProof& proof)
+{
+    const h256 cacheKey = CacheKey(root, proof.key);
+    const h256 valueHash = sha3(proof.value);
+    if (IsCached(cacheKey, valueHash))
+        return true;
+
+    // Decoded nodes are freed together once the proof is walked
+    RLPArena arena(std::max<size_t>(proof.nodes.size(), 1) * 17 * sizeof(RLP));
+    size_t nNext = 0;
+    auto lookup = [&proof, &nNext, &arena](const h256& hash, RLPItemsRef& items) {
+        if (nNext >= proof.nodes.size())
+            return false;
+        const bytesConstRef node = proof.nodes[nNext++];
+        if (sha3(node) != hash)
+            return false;
+        items = RLP(node).toList(arena);
+        return true;
+    };
+    bool fValid;
+    try {
+        fValid = WalkProof(root, proof.key, proof.value, arena, lookup);
+    } catch (const std::exception& e) {
+        fValid = false;
+    }
+    if (fValid)
+        AddCached(cacheKey, valueHash);
+    return fValid;
+}
+
+bool CEthProofVerifier::VerifyBatch(const h256& root, const std::vector<CEthProof>& vProofs, std::vector<bool>& vResults)
+{
+    vResults.assign(vProofs.size(), false);
+    std::vector<std::pair<h256, h256> > vKeys(vProofs.size());
+    std::unordered_set<bytesConstRef, NodeContentHasher, NodeContentEqual> setNodes;
+    for (size_t i = 0; i < vProofs.size(); i++) {
+        vKeys[i] = std::make_pair(CacheKey(root, vProofs[i].key), sha3(vProofs[i].value));
+        if (IsCached(vKeys[i].first, vKeys[i].second)) {
+            vResults[i] = true;
+            continue;
+        }
+        setNodes.insert(vProofs[i].nodes.begin(), vProofs[i].nodes.end());
+    }
+
+    // Each distinct node is hashed once, several at a time, and decoded once on first use, for all proofs
+    RLPArena arena;
+    const std::vector<bytesConstRef> vNodes(setNodes.begin(), setNodes.end());
+    const std::vector<h256> vNodeHashes = sha3Batch(vNodes);
+    std::unordered_map<h256, std::pair<bytesConstRef, RLPItemsRef> > mapNodes;
+    mapNodes.reserve(vNodes.size());
+    for (size_t i = 0; i < vNodes.size(); i++)
+        mapNodes.emplace(vNodeHashes[i], std::make_pair(vNodes[i], RLPItemsRef()));
+    auto lookup = [&mapNodes, &arena](const h256& hash, RLPItemsRef& items) {
+        auto it = mapNodes.find(hash);
+        if (it == mapNodes.end())
+            return false;
+        if (it->second.second.empty())
+            it->second.second = RLP(it->second.first).toList(arena);
+        items = it->second.second;
+        return true;
+    };
+
+    bool fAllValid = true;
+    for (size_t i = 0; i < vProofs.size(); i++) {
+        if (vResults[i])
+            continue;
+        try {
+            vResults[i] = WalkProof(root, vProofs[i].key, vProofs[i].value, arena, lookup);
+        } catch (const std::exception& e) {
+            vResults[i] = false;
+        }
+        if (vResults[i])
+            AddCached(vKeys[i].first, vKeys[i].second);
+        else
+            fAllValid = false;
+    }
+    return fAllValid;
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SYSCOIN_ETHEREUM_ETHPROOF_H
+#define SYSCOIN_ETHEREUM_ETHPROOF_H
+
+#include "Common.h"
+#include "FixedHash.h"
+#include "Guards.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/** Number of verified (root, key) results remembered by default */
+static const size_t DEFAULT_ETH_PROOF_CACHE_SIZE = 4096;
+
+/**
+ * A Merkle-Patricia inclusion proof: the value expected at a key and the trie
+ * nodes on the path to it, starting with the root. All members are views into
+ * buffers owned by the caller.
+ */
+struct CEthProof
+{
+    dev::bytesConstRef key;
+    dev::bytesConstRef value;
+    std::vector<dev::bytesConstRef> nodes;
+};
+
+/** Split an RLP list of trie nodes, as relayed with bridge transactions, into views of its items. */
+bool ParseEthProofNodes(dev::bytesConstRef rlpNodes, std::vector<dev::bytesConstRef>& nodes);
+
+/**
+ * Stateless verifier for Ethereum transaction and receipt inclusion proofs.
+ *
+ * Nodes are decoded in place through RLP views and each is hashed once.
+ * Proofs that verified are remembered by (root, key) with the hash of their
+ * value, so checking the same proof again costs two small hashes.
+ */
+class CEthProofVerifier
+{
+public:
+    explicit CEthProofVerifier(size_t nMaxCachedIn = DEFAULT_ETH_PROOF_CACHE_SIZE);
+
+    /** Verify that proof.value is stored at proof.key in the trie with the given root. */
+    bool Verify(const dev::h256& root, const CEthProof& proof);
+
+    /**
+     * Verify several proofs against one root, e.g. all bridge receipts of a
+     * block. Nodes may be shared between proofs and in any order; each
+     * distinct node is hashed once. Returns true if every proof verified.
+     */
+    bool VerifyBatch(const dev::h256& root, const std::vector<CEthProof>& vProofs, std::vector<bool>& vResults);
+
+    size_t CacheSize() const;
+    void ClearCache();
+
+private:
+    typedef std::pair<dev::h256, dev::h256> CacheEntry;
+
+    const size_t nMaxCached;
+    mutable dev::Mutex cs;
+    std::list<CacheEntry> listCached;
+    std::unordered_map<dev::h256, std::list<CacheEntry>::iterator> mapCached;
+
+    static dev::h256 CacheKey(const dev::h256& root, dev::bytesConstRef key);
+    bool IsCached(const dev::h256& cacheKey, const dev::h256& valueHash);
+    void AddCached(const dev::h256& cacheKey, const dev::h256& valueHash);
+};
+
+#endif // SYSCOIN_ETHEREUM_ETHPROOF_H
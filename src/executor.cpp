@@ -0,0 +1,169 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <executor.h>
+
+#include <util.h>
+#include <utiltime.h>
+
+#include <assert.h>
+
+CExecutor g_executor;
+
+std::string TaskClassToString(TaskClass cls)
+{
+    switch (cls) {
+    case TaskClass::BLOCK: return "block";
+    case TaskClass::MEMPOOL: return "mempool";
+    case TaskClass::RPC: return "rpc";
+    case TaskClass::NOTIFY: return "notify";
+    case TaskClass::BACKGROUND: return "background";
+    }
+    assert(false);
+}
+
+CExecutor::CExecutor() : m_running(false)
+{
+}
+
+CExecutor::~CExecutor()
+{
+    Stop();
+}
+
+void CExecutor::Start(int nThreads)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(!m_running && m_threads.empty());
+    m_running = true;
+    StartThreads(std::max({nThreads, GetLimitedThreadCount(), 1}));
+}
+
+int CExecutor::GetLimitedThreadCount() const
+{
+    int nThreads = 0;
+    for (const Class& c : m_classes)
+        nThreads += c.stats.nMaxRunning;
+    return nThreads;
+}
+
+void CExecutor::StartThreads(int nThreads)
+{
+    while ((int)m_threads.size() < nThreads)
+        m_threads.emplace_back(&CExecutor::ThreadWorker, this);
+}
+
+void CExecutor::Stop()
+{
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+        threads.swap(m_threads);
+    }
+    m_cond.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+bool CExecutor::IsRunning() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_running;
+}
+
+int CExecutor::GetThreadCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_threads.size();
+}
+
+void CExecutor::SetClassLimits(TaskClass cls, int nMaxRunning, size_t nMaxQueued)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        CExecutorClassStats& stats = m_classes[(int)cls].stats;
+        stats.nMaxRunning = std::max(nMaxRunning, 0);
+        stats.nMaxQueued = nMaxQueued;
+        if (m_running)
+            StartThreads(GetLimitedThreadCount());
+    }
+    // A raised limit may let queued tasks run
+    m_cond.notify_all();
+}
+
+bool CExecutor::TrySubmit(TaskClass cls, Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Class& c = m_classes[(int)cls];
+        if (!m_running || (c.stats.nMaxQueued != 0 && c.queue.size() >= c.stats.nMaxQueued)) {
+            c.stats.nRejected++;
+            return false;
+        }
+        c.queue.push_back(QueuedTask{std::move(task), GetTimeMicros()});
+        c.stats.nPeakQueued = std::max(c.stats.nPeakQueued, c.queue.size());
+    }
+    m_cond.notify_one();
+    return true;
+}
+
+CExecutorClassStats CExecutor::GetStats(TaskClass cls) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CExecutorClassStats stats = m_classes[(int)cls].stats;
+    stats.nQueued = m_classes[(int)cls].queue.size();
+    return stats;
+}
+
+bool CExecutor::PopTask(QueuedTask& task, int& nClass)
+{
+    for (nClass = 0; nClass < TASK_CLASS_COUNT; nClass++) {
+        Class& c = m_classes[nClass];
+        if (c.queue.empty() || (c.stats.nMaxRunning != 0 && c.stats.nRunning >= c.stats.nMaxRunning))
+            continue;
+        task = std::move(c.queue.front());
+        c.queue.pop_front();
+        c.stats.nRunning++;
+        return true;
+    }
+    return false;
+}
+
+void CExecutor::ThreadWorker()
+{
+    RenameThread("syscoin-exec");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        QueuedTask task;
+        int nClass;
+        if (!PopTask(task, nClass)) {
+            // Tasks held back by their class limit are taken by the threads running that class
+            if (!m_running)
+                break;
+            m_cond.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        const int64_t nTimeStart = GetTimeMicros();
+        try {
+            task.task();
+        } catch (const std::exception& e) {
+            PrintExceptionContinue(&e, "CExecutor task");
+        } catch (...) {
+            PrintExceptionContinue(nullptr, "CExecutor task");
+        }
+        const int64_t nTimeEnd = GetTimeMicros();
+        // Free what the task holds before taking the lock again
+        task.task = nullptr;
+        lock.lock();
+
+        CExecutorClassStats& stats = m_classes[nClass].stats;
+        stats.nRunning--;
+        stats.nExecuted++;
+        stats.nWaitMicros += nTimeStart - task.nTimeQueued;
+        stats.nRunMicros += nTimeEnd - nTimeStart;
+    }
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SYSCOIN_EXECUTOR_H
+#define SYSCOIN_EXECUTOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** The kinds of work run on the executor, highest priority first */
+enum class TaskClass {
+    //! script and signature checks of blocks being connected
+    BLOCK,
+    //! checks of transactions and messages relayed by peers
+    MEMPOOL,
+    //! HTTP and RPC requests
+    RPC,
+    //! validation interface callbacks, one at a time for each subscriber
+    NOTIFY,
+    //! scheduler tasks
+    BACKGROUND,
+};
+static const int TASK_CLASS_COUNT = 5;
+
+std::string TaskClassToString(TaskClass cls);
+
+/** Limits of a task class and what it has done since startup */
+struct CExecutorClassStats {
+    //! how many of its tasks may run at once, 0 for as many as there are threads
+    int nMaxRunning = 0;
+    //! how many of its tasks may wait to run, 0 for no limit
+    size_t nMaxQueued = 0;
+    int nRunning = 0;
+    size_t nQueued = 0;
+    //! the most tasks that ever waited at once
+    size_t nPeakQueued = 0;
+    uint64_t nExecuted = 0;
+    //! tasks refused because the queue was full or the executor stopped
+    uint64_t nRejected = 0;
+    //! total time executed tasks spent waiting and running
+    int64_t nWaitMicros = 0;
+    int64_t nRunMicros = 0;
+};
+
+/**
+ * One set of threads running the work of every subsystem that used to start
+ * threads of its own. Each task is submitted under a TaskClass, and a thread
+ * that becomes free takes the oldest task of the highest priority class that
+ * has not reached its concurrency limit. Block validation can so use every
+ * thread while nothing else is going on, and work of other classes waits
+ * until it is done.
+ *
+ * Tasks may wait on tasks of other classes, e.g. an RPC request on a wallet
+ * callback. So that a class busy up to its limit never keeps another class
+ * from its threads, the executor runs at least as many threads as the limits
+ * of the limited classes add up to, and starts more when a limit is raised.
+ * A class without a limit can still take every thread.
+ */
+class CExecutor
+{
+public:
+    typedef std::function<void()> Task;
+
+    CExecutor();
+    ~CExecutor();
+
+    CExecutor(const CExecutor&) = delete;
+    CExecutor& operator=(const CExecutor&) = delete;
+
+    /** Start nThreads threads, or as many as the class limits add up to if that is more */
+    void Start(int nThreads);
+    /** Run what is queued, then stop the threads. Tasks submitted from then on are refused. */
+    void Stop();
+    bool IsRunning() const;
+    int GetThreadCount() const;
+
+    void SetClassLimits(TaskClass cls, int nMaxRunning, size_t nMaxQueued);
+    /** Queue a task. Returns false if the executor is not running or the class queue is full. */
+    bool TrySubmit(TaskClass cls, Task task);
+    CExecutorClassStats GetStats(TaskClass cls) const;
+
+private:
+    struct QueuedTask {
+        Task task;
+        int64_t nTimeQueued;
+    };
+    struct Class {
+        std::deque<QueuedTask> queue;
+        CExecutorClassStats stats;
+    };
+
+    void ThreadWorker();
+    /** The number of threads the class limits need, see the class comment */
+    int GetLimitedThreadCount() const;
+    void StartThreads(int nThreads);
+    /** Take the next task a free thread should run */
+    bool PopTask(QueuedTask& task, int& nClass);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+    Class m_classes[TASK_CLASS_COUNT];
+    std::vector<std::thread> m_threads;
+    bool m_running;
+};
+
+extern CExecutor g_executor;
+
+#endif // SYSCOIN_EXECUTOR_H
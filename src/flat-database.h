@@ -8,12 +8,18 @@
 
 #include "chainparams.h"
 #include "clientversion.h"
+#include "fs.h"
 #include "hash.h"
 #include "streams.h"
 #include "util.h"
 
 #include <boost/filesystem.hpp>
 
+/** Size of the stdio buffer used while streaming flat database files */
+static const size_t FLATDB_FILE_BUFFER_SIZE = 1 << 20;
+/** Default interval in minutes between background dumps of the flat database files, 0 to only dump them on shutdown */
+static const int64_t DEFAULT_FLATDB_DUMP_INTERVAL = 0;
+
 /** 
 *   Generic Dumping and Loading
 *   ---------------------------
@@ -44,86 +50,52 @@ private:
 
         int64_t nStart = GetTimeMillis();
 
-        // serialize, checksum data up to that point, then append checksum
-        CDataStream ssObj(SER_DISK, CLIENT_VERSION);
-        ssObj << strMagicMessage; // specific magic message for this type of object
-        ssObj << FLATDATA(Params().MessageStart()); // network specific magic number
-        ssObj << objToSave;
-        uint256 hash = Hash(ssObj.begin(), ssObj.end());
-        ssObj << hash;
+        // write into a temporary file and move it over the old one once it is complete,
+        // so that a crash or a failed write never leaves a truncated file behind
+        boost::filesystem::path pathTmp = pathDB;
+        pathTmp += ".new";
 
         // open output file, and associate with CAutoFile
-        FILE *file = fopen(pathDB.string().c_str(), "wb");
+        FILE *file = fsbridge::fopen(pathTmp, "wb");
         CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
         if (fileout.IsNull())
-            return error("%s: Failed to open file %s", __func__, pathDB.string());
+            return error("%s: Failed to open file %s", __func__, pathTmp.string());
+        setvbuf(file, nullptr, _IOFBF, FLATDB_FILE_BUFFER_SIZE);
 
-        // Write and commit header, data
+        // serialize straight into the file while hashing what is written, then append checksum;
+        // the object's lock is only held by its serialization, not while the file is synced
         try {
-            fileout << ssObj;
+            CHashForwarder<CAutoFile> hashwriter(&fileout);
+            hashwriter << strMagicMessage; // specific magic message for this type of object
+            hashwriter << FLATDATA(Params().MessageStart()); // network specific magic number
+            hashwriter << objToSave;
+            fileout << hashwriter.GetHash();
         }
         catch (std::exception &e) {
             return error("%s: Serialize or I/O error - %s", __func__, e.what());
         }
+        if (fflush(fileout.Get()) != 0 || !FileCommit(fileout.Get()))
+            return error("%s: Failed to flush file %s", __func__, pathTmp.string());
         fileout.fclose();
 
+        if (!RenameOver(pathTmp, pathDB))
+            return error("%s: Rename-into-place failed for %s", __func__, pathDB.string());
+
         LogPrintf("Written info to %s  %dms\n", strFilename, GetTimeMillis() - nStart);
         LogPrintf("     %s\n", objToSave.ToString());
 
         return true;
     }
 
-    ReadResult Read(T& objToLoad, bool fDryRun = false)
+    /// Check the file specific magic message and network specific magic number at the start of the file
+    template <typename Stream>
+    ReadResult ReadMagic(Stream& s)
     {
-        //LOCK(objToLoad.cs);
-
-        int64_t nStart = GetTimeMillis();
-        // open input file, and associate with CAutoFile
-        FILE *file = fopen(pathDB.string().c_str(), "rb");
-        CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
-        if (filein.IsNull())
-        {
-            error("%s: Failed to open file %s", __func__, pathDB.string());
-            return FileError;
-        }
-
-        // use file size to size memory buffer
-        int fileSize = boost::filesystem::file_size(pathDB);
-        int dataSize = fileSize - sizeof(uint256);
-        // Don't try to resize to a negative number if file is small
-        if (dataSize < 0)
-            dataSize = 0;
-        std::vector<unsigned char> vchData;
-        vchData.resize(dataSize);
-        uint256 hashIn;
-
-        // read data and checksum from file
-        try {
-            filein.read((char *)&vchData[0], dataSize);
-            filein >> hashIn;
-        }
-        catch (std::exception &e) {
-            error("%s: Deserialize or I/O error - %s", __func__, e.what());
-            return HashReadError;
-        }
-        filein.fclose();
-
-        CDataStream ssObj(vchData, SER_DISK, CLIENT_VERSION);
-
-        // verify stored checksum matches input data
-        uint256 hashTmp = Hash(ssObj.begin(), ssObj.end());
-        if (hashIn != hashTmp)
-        {
-            error("%s: Checksum mismatch, data corrupted", __func__);
-            return IncorrectHash;
-        }
-
-
         unsigned char pchMsgTmp[4];
         std::string strMagicMessageTmp;
         try {
             // de-serialize file header (file specific magic message) and ..
-            ssObj >> strMagicMessageTmp;
+            s >> strMagicMessageTmp;
 
             // ... verify the message matches predefined one
             if (strMagicMessage != strMagicMessageTmp)
@@ -134,7 +106,7 @@ private:
 
 
             // de-serialize file header (network specific magic number) and ..
-            ssObj >> FLATDATA(pchMsgTmp);
+            s >> FLATDATA(pchMsgTmp);
 
             // ... verify the network matches ours
             if (memcmp(pchMsgTmp, Params().MessageStart(), sizeof(pchMsgTmp)))
@@ -142,15 +114,89 @@ private:
                 error("%s: Invalid network magic number", __func__);
                 return IncorrectMagicNumber;
             }
+        }
+        catch (std::exception &e) {
+            error("%s: Deserialize or I/O error - %s", __func__, e.what());
+            return IncorrectFormat;
+        }
+        return Ok;
+    }
 
+    /// Hash the data part of the file in chunks and compare it to the checksum that follows it
+    bool CheckFileHash(CAutoFile& filein, uint64_t nDataSize)
+    {
+        CHash256 hasher;
+        std::vector<char> vchBuf(FLATDB_FILE_BUFFER_SIZE);
+        uint256 hashIn, hashTmp;
+        try {
+            while (nDataSize > 0) {
+                size_t nChunk = std::min<uint64_t>(nDataSize, vchBuf.size());
+                filein.read(vchBuf.data(), nChunk);
+                hasher.Write((const unsigned char*)vchBuf.data(), nChunk);
+                nDataSize -= nChunk;
+            }
+            filein >> hashIn;
+        }
+        catch (std::exception &e) {
+            return false;
+        }
+        hasher.Finalize(hashTmp.begin());
+        return hashIn == hashTmp;
+    }
+
+    ReadResult Read(T& objToLoad, bool fDryRun = false)
+    {
+        //LOCK(objToLoad.cs);
+
+        int64_t nStart = GetTimeMillis();
+        // open input file, and associate with CAutoFile
+        FILE *file = fsbridge::fopen(pathDB, "rb");
+        CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull())
+        {
+            error("%s: Failed to open file %s", __func__, pathDB.string());
+            return FileError;
+        }
+        setvbuf(file, nullptr, _IOFBF, FLATDB_FILE_BUFFER_SIZE);
+
+        // everything but the trailing checksum is data
+        uint64_t fileSize = boost::filesystem::file_size(pathDB);
+        if (fileSize < sizeof(uint256))
+        {
+            error("%s: File %s is too small", __func__, pathDB.string());
+            return HashReadError;
+        }
+        uint64_t nDataSize = fileSize - sizeof(uint256);
+
+        // verify stored checksum matches the data before anything is loaded from it,
+        // hashing the file in chunks instead of reading a full copy of it into memory
+        if (!CheckFileHash(filein, nDataSize))
+        {
+            error("%s: Checksum mismatch, data corrupted", __func__);
+            return IncorrectHash;
+        }
+        if (fseek(file, 0, SEEK_SET) != 0)
+        {
+            error("%s: Failed to rewind file %s", __func__, pathDB.string());
+            return FileError;
+        }
+
+        // de-serialize straight from the file
+        ReadResult readResult = ReadMagic(filein);
+        if (readResult != Ok)
+            return readResult;
+        try {
             // de-serialize data into T object
-            ssObj >> objToLoad;
+            filein >> objToLoad;
+            if ((uint64_t)ftell(file) != nDataSize)
+                throw std::ios_base::failure("unexpected data size");
         }
         catch (std::exception &e) {
             objToLoad.Clear();
             error("%s: Deserialize or I/O error - %s", __func__, e.what());
             return IncorrectFormat;
         }
+        filein.fclose();
 
         LogPrintf("Loaded info from %s  %dms\n", strFilename, GetTimeMillis() - nStart);
         LogPrintf("     %s\n", objToLoad.ToString());
@@ -163,6 +209,16 @@ private:
         return Ok;
     }
 
+    /// Only check the header of an existing file, so that files of unknown format are not overwritten
+    ReadResult ReadHeader()
+    {
+        FILE *file = fsbridge::fopen(pathDB, "rb");
+        CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull())
+            return FileError;
+        return ReadMagic(filein);
+    }
+
 
 public:
     CFlatDB(std::string strFilenameIn, std::string strMagicMessageIn)
@@ -199,8 +255,7 @@ public:
         int64_t nStart = GetTimeMillis();
 
         LogPrintf("Verifying %s format...\n", strFilename);
-        T tmpObjToLoad;
-        ReadResult readResult = Read(tmpObjToLoad, true);
+        ReadResult readResult = ReadHeader();
 
         // there was an error and it was not an error on file opening => do not proceed
         if (readResult == FileError)
@@ -218,7 +273,8 @@ public:
         }
 
         LogPrintf("Writing info to %s...\n", strFilename);
-        Write(objToSave);
+        if (!Write(objToSave))
+            return false;
         LogPrintf("%s dump finished  %dms\n", strFilename, GetTimeMillis() - nStart);
 
         return true;
@@ -40,6 +40,7 @@ CGovernanceObject::CGovernanceObject():
     cmmapOrphanVotes(),
     fileVotes()
 {
+    RebuildVoteTally();
     // PARSE JSON DATA STORAGE (VCHDATA)
     LoadData();
 }
@@ -68,6 +69,7 @@ CGovernanceObject::CGovernanceObject(const uint256& nHashParentIn, int nRevision
     cmmapOrphanVotes(),
     fileVotes()
 {
+    RebuildVoteTally();
     // PARSE JSON DATA STORAGE (VCHDATA)
     LoadData();
 }
@@ -95,7 +97,9 @@ CGovernanceObject::CGovernanceObject(const CGovernanceObject& other):
     mapCurrentMNVotes(other.mapCurrentMNVotes),
     cmmapOrphanVotes(other.cmmapOrphanVotes),
     fileVotes(other.fileVotes)
-{}
+{
+    memcpy(nVoteTally, other.nVoteTally, sizeof(nVoteTally));
+}
 
 bool CGovernanceObject::ProcessVote(CNode* pfrom,
                                     const CGovernanceVote& vote,
@@ -199,6 +203,7 @@ bool CGovernanceObject::ProcessVote(CNode* pfrom,
         return false;
     }
 
+    UpdateVoteTally(eSignal, voteInstanceRef.eOutcome, vote.GetOutcome());
     voteInstanceRef = vote_instance_t(vote.GetOutcome(), nVoteTimeUpdate, vote.GetTimestamp());
     fileVotes.AddVote(vote);
     fDirtyCache = true;
@@ -212,6 +217,9 @@ void CGovernanceObject::ClearMasternodeVotes()
     vote_m_it it = mapCurrentMNVotes.begin();
     while(it != mapCurrentMNVotes.end()) {
         if(!mnodeman.Has(it->first)) {
+            for (const auto& instancepair : it->second.mapInstances) {
+                UpdateVoteTally(instancepair.first, instancepair.second.eOutcome, VOTE_OUTCOME_NONE);
+            }
             fileVotes.RemoveVotesFromMasternode(it->first);
             mapCurrentMNVotes.erase(it++);
         }
@@ -221,6 +229,31 @@ void CGovernanceObject::ClearMasternodeVotes()
     }
 }
 
+void CGovernanceObject::UpdateVoteTally(int nSignal, vote_outcome_enum_t eOutcomeOld, vote_outcome_enum_t eOutcomeNew)
+{
+    AssertLockHeld(cs);
+
+    if(nSignal <= VOTE_SIGNAL_NONE || nSignal > MAX_SUPPORTED_VOTE_SIGNAL) return;
+    if(eOutcomeOld > VOTE_OUTCOME_NONE && eOutcomeOld <= VOTE_OUTCOME_ABSTAIN) {
+        --nVoteTally[nSignal][eOutcomeOld];
+    }
+    if(eOutcomeNew > VOTE_OUTCOME_NONE && eOutcomeNew <= VOTE_OUTCOME_ABSTAIN) {
+        ++nVoteTally[nSignal][eOutcomeNew];
+    }
+}
+
+void CGovernanceObject::RebuildVoteTally()
+{
+    LOCK(cs);
+
+    memset(nVoteTally, 0, sizeof(nVoteTally));
+    for (const auto& votepair : mapCurrentMNVotes) {
+        for (const auto& instancepair : votepair.second.mapInstances) {
+            UpdateVoteTally(instancepair.first, VOTE_OUTCOME_NONE, instancepair.second.eOutcome);
+        }
+    }
+}
+
 std::string CGovernanceObject::GetSignatureMessage() const
 {
     LOCK(cs);
@@ -611,17 +644,11 @@ bool CGovernanceObject::IsCollateralValid(std::string& strError, bool& fMissingC
 
 int CGovernanceObject::CountMatchingVotes(vote_signal_enum_t eVoteSignalIn, vote_outcome_enum_t eVoteOutcomeIn) const
 {
-    LOCK(cs);
+    if(eVoteSignalIn <= VOTE_SIGNAL_NONE || eVoteSignalIn > MAX_SUPPORTED_VOTE_SIGNAL) return 0;
+    if(eVoteOutcomeIn <= VOTE_OUTCOME_NONE || eVoteOutcomeIn > VOTE_OUTCOME_ABSTAIN) return 0;
 
-    int nCount = 0;
-    for (const auto& votepair : mapCurrentMNVotes) {
-        const vote_rec_t& recVote = votepair.second;
-        vote_instance_m_cit it2 = recVote.mapInstances.find(eVoteSignalIn);
-        if(it2 != recVote.mapInstances.end() && it2->second.eOutcome == eVoteOutcomeIn) {
-            ++nCount;
-        }
-    }
-    return nCount;
+    LOCK(cs);
+    return nVoteTally[eVoteSignalIn][eVoteOutcomeIn];
 }
 
 /**
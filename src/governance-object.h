@@ -28,6 +28,7 @@ class CGovernanceVote;
 static const int MAX_GOVERNANCE_OBJECT_DATA_SIZE = 16 * 1024;
 static const int MIN_GOVERNANCE_PEER_PROTO_VERSION = MIN_PEER_PROTO_VERSION;
 static const int GOVERNANCE_FILTER_PROTO_VERSION = MIN_PEER_PROTO_VERSION;
+static const int GOVERNANCE_VOTE_PAGE_PROTO_VERSION = 70228;
 
 static const double GOVERNANCE_FILTER_FP_RATE = 0.001;
 
@@ -183,6 +184,9 @@ private:
 
     vote_m_t mapCurrentMNVotes;
 
+    /// Number of current masternode votes per (signal, outcome), kept in sync with mapCurrentMNVotes
+    int nVoteTally[MAX_SUPPORTED_VOTE_SIGNAL + 1][VOTE_OUTCOME_ABSTAIN + 1];
+
     /// Limited map of votes orphaned by MN
     vote_cmm_t cmmapOrphanVotes;
 
@@ -326,6 +330,9 @@ public:
             READWRITE(fExpired);
             READWRITE(mapCurrentMNVotes);
             READWRITE(fileVotes);
+            if(ser_action.ForRead()) {
+                RebuildVoteTally();
+            }
             LogPrint(BCLog::GOBJECT, "CGovernanceObject::SerializationOp hash = %s, vote count = %d\n", GetHash().ToString(), fileVotes.GetVoteCount());
         }
 
@@ -345,6 +352,12 @@ private:
     /// Called when MN's which have voted on this object have been removed
     void ClearMasternodeVotes();
 
+    /// Move one masternode vote for a signal from one outcome to another in the vote tally
+    void UpdateVoteTally(int nSignal, vote_outcome_enum_t eOutcomeOld, vote_outcome_enum_t eOutcomeNew);
+
+    /// Recalculate the vote tally from mapCurrentMNVotes, used after loading votes from disk
+    void RebuildVoteTally();
+
     void CheckOrphanVotes(CConnman& connman);
 
 };
@@ -8,13 +8,19 @@
 CGovernanceObjectVoteFile::CGovernanceObjectVoteFile()
     : nMemoryVotes(0),
       listVotes(),
-      mapVoteIndex()
+      mapVoteIndex(),
+      nVoteDataVersion(0),
+      mapVoteData(),
+      listVoteData()
 {}
 
 CGovernanceObjectVoteFile::CGovernanceObjectVoteFile(const CGovernanceObjectVoteFile& other)
     : nMemoryVotes(other.nMemoryVotes),
       listVotes(other.listVotes),
-      mapVoteIndex()
+      mapVoteIndex(),
+      nVoteDataVersion(0),
+      mapVoteData(),
+      listVoteData()
 {
     RebuildIndex();
 }
@@ -41,7 +47,29 @@ bool CGovernanceObjectVoteFile::SerializeVoteToStream(const uint256& nHash, CDat
     if(it == mapVoteIndex.end()) {
         return false;
     }
-    ss << *(it->second);
+    if(ss.GetType() != SER_NETWORK) {
+        ss << *(it->second);
+        return true;
+    }
+    // votes are requested by many syncing peers, serialize each one only once
+    if(ss.GetVersion() != nVoteDataVersion) {
+        mapVoteData.clear();
+        listVoteData.clear();
+        nVoteDataVersion = ss.GetVersion();
+    }
+    std::vector<unsigned char>& vchData = mapVoteData[nHash].first;
+    if(vchData.empty()) {
+        CDataStream ssVote(SER_NETWORK, ss.GetVersion());
+        ssVote << *(it->second);
+        vchData.assign(ssVote.begin(), ssVote.end());
+        mapVoteData[nHash].second = listVoteData.insert(listVoteData.end(), nHash);
+        if(listVoteData.size() > MAX_VOTE_DATA_CACHE) {
+            // syncing peers walk the votes in the same order, drop the ones served first
+            mapVoteData.erase(listVoteData.front());
+            listVoteData.pop_front();
+        }
+    }
+    ss.write((const char*)vchData.data(), vchData.size());
     return true;
 }
 
@@ -54,6 +82,41 @@ std::vector<CGovernanceVote> CGovernanceObjectVoteFile::GetVotes() const
     return vecResult;
 }
 
+bool CGovernanceObjectVoteFile::GetVotesPage(const uint256& hashContinuation, const CBloomFilter& filter, size_t nMaxVotes, size_t nMaxScan,
+                                             std::vector<CGovernanceVote>& vecVotesRet, uint256& hashNextRet) const
+{
+    // new votes are pushed to the front, walk from the back so that the
+    // continuation token stays valid while more votes arrive
+    vote_l_crit it = listVotes.rbegin();
+    if(!hashContinuation.IsNull()) {
+        vote_m_cit itIndex = mapVoteIndex.find(hashContinuation);
+        if(itIndex != mapVoteIndex.end()) {
+            it = vote_l_crit(vote_l_cit(itIndex->second));
+        }
+    }
+
+    uint256 hashLast;
+    size_t nFound = 0;
+    size_t nScanned = 0;
+    for(; it != listVotes.rend(); ++it) {
+        if(nFound >= nMaxVotes || nScanned >= nMaxScan) {
+            if(nScanned == 0) {
+                return false;
+            }
+            hashNextRet = hashLast;
+            return true;
+        }
+        ++nScanned;
+        hashLast = it->GetHash();
+        if(!filter.contains(hashLast)) {
+            vecVotesRet.push_back(*it);
+            ++nFound;
+        }
+    }
+    hashNextRet.SetNull();
+    return true;
+}
+
 void CGovernanceObjectVoteFile::RemoveVotesFromMasternode(const COutPoint& outpointMasternode)
 {
     vote_l_it it = listVotes.begin();
@@ -61,6 +124,11 @@ void CGovernanceObjectVoteFile::RemoveVotesFromMasternode(const COutPoint& outpo
         if(it->GetMasternodeOutpoint() == outpointMasternode) {
             --nMemoryVotes;
             mapVoteIndex.erase(it->GetHash());
+            auto itData = mapVoteData.find(it->GetHash());
+            if(itData != mapVoteData.end()) {
+                listVoteData.erase(itData->second.second);
+                mapVoteData.erase(itData);
+            }
             listVotes.erase(it++);
         }
         else {
@@ -8,7 +8,9 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
+#include "bloom.h"
 #include "governance-vote.h"
 #include "serialize.h"
 #include "streams.h"
@@ -31,6 +33,8 @@ public: // Types
 
     typedef vote_l_t::const_iterator vote_l_cit;
 
+    typedef vote_l_t::const_reverse_iterator vote_l_crit;
+
     typedef std::map<uint256,vote_l_it> vote_m_t;
 
     typedef vote_m_t::iterator vote_m_it;
@@ -46,6 +50,16 @@ private:
 
     vote_m_t mapVoteIndex;
 
+    static const size_t MAX_VOTE_DATA_CACHE = 1000;
+
+    // network serialization of the votes last served to peers, in the
+    // serialization version of nVoteDataVersion, oldest first in listVoteData
+    mutable int nVoteDataVersion;
+
+    mutable std::map<uint256, std::pair<std::vector<unsigned char>, std::list<uint256>::iterator> > mapVoteData;
+
+    mutable std::list<uint256> listVoteData;
+
 public:
     CGovernanceObjectVoteFile();
 
@@ -72,6 +86,19 @@ public:
 
     std::vector<CGovernanceVote> GetVotes() const;
 
+    /**
+     * Append the next page of votes not matched by filter to vecVotesRet, oldest first.
+     *
+     * The page starts right after the vote with hash hashContinuation (or at the
+     * oldest vote if it is null or no longer known). At most nMaxVotes votes are
+     * appended and at most nMaxScan votes are examined. hashNextRet is set to
+     * the hash of the last examined vote, or null if the file was exhausted.
+     * Returns false, leaving hashNextRet alone, if votes are left but none could
+     * be examined: the same page has to be asked for again.
+     */
+    bool GetVotesPage(const uint256& hashContinuation, const CBloomFilter& filter, size_t nMaxVotes, size_t nMaxScan,
+                      std::vector<CGovernanceVote>& vecVotesRet, uint256& hashNextRet) const;
+
     void RemoveVotesFromMasternode(const COutPoint& outpointMasternode);
 
     ADD_SERIALIZE_METHODS;
@@ -82,6 +109,8 @@ public:
         READWRITE(nMemoryVotes);
         READWRITE(listVotes);
         if(ser_action.ForRead()) {
+            mapVoteData.clear();
+            listVoteData.clear();
             RebuildIndex();
         }
     }
@@ -37,6 +37,7 @@ CGovernanceManager::CGovernanceManager()
       cmmapOrphanVotes(MAX_CACHE_SIZE),
       mapLastMasternodeObject(),
       setRequestedObjects(),
+      mapVoteSyncPages(),
       fRateChecksEnabled(true),
       cs()
 {}
@@ -107,6 +108,7 @@ void CGovernanceManager::ProcessMessage(CNode* pfrom, const std::string& strComm
 
         uint256 nProp;
         CBloomFilter filter;
+        uint256 hashContinuation;
 
         vRecv >> nProp;
 
@@ -118,14 +120,57 @@ void CGovernanceManager::ProcessMessage(CNode* pfrom, const std::string& strComm
             filter.clear();
         }
 
+        if(nProp != uint256() && pfrom->nVersion >= GOVERNANCE_VOTE_PAGE_PROTO_VERSION) {
+            vRecv >> hashContinuation;
+        }
+
         if(nProp == uint256()) {
             SyncAll(pfrom, connman);
         } else {
-            SyncSingleObjAndItsVotes(pfrom, nProp, filter, connman);
+            SyncSingleObjAndItsVotes(pfrom, nProp, filter, hashContinuation, connman);
         }
         LogPrint(BCLog::GOBJECT, "MNGOVERNANCESYNC -- syncing governance objects to our peer at %s\n", pfrom->addr.ToString());
     }
 
+    // A PAGE OF VOTES WE ASKED FOR HAS BEEN ANNOUNCED
+    else if (strCommand == NetMsgType::MNGOVERNANCESYNCPAGE)
+    {
+        uint256 nProp;
+        int nVoteCount;
+        uint256 hashContinuation;
+        bool fProgress;
+
+        vRecv >> nProp >> nVoteCount >> hashContinuation >> fProgress;
+
+        LOCK(cs);
+
+        vote_sync_m_it it = mapVoteSyncPages.find(std::make_pair(nProp, CService(pfrom->addr)));
+        if(it == mapVoteSyncPages.end()) {
+            LogPrint(BCLog::GOBJECT, "MNGOVERNANCESYNCPAGE -- unrequested vote page for %s, peer=%d\n", nProp.ToString(), pfrom->GetId());
+            return;
+        }
+
+        LogPrint(BCLog::GOBJECT, "MNGOVERNANCESYNCPAGE -- %s nVoteCount %d hashContinuation %s fProgress %d peer=%d\n",
+                    nProp.ToString(), nVoteCount, hashContinuation.ToString(), fProgress, pfrom->GetId());
+
+        if((fProgress && hashContinuation.IsNull()) || !mapObjects.count(nProp)) {
+            mapVoteSyncPages.erase(it);
+            return;
+        }
+
+        // Ask for the next page right away unless the peer is throttling us
+        // or we are still busy fetching the announced votes, then resume
+        // from ResumeVoteSyncPages later. A page the peer had no budget for
+        // is asked for again from where it should have started.
+        size_t nProjectedSize = pfrom->setAskFor.size() + GOVERNANCE_VOTE_SYNC_PAGE_SIZE;
+        if(fProgress && nVoteCount > 0 && nProjectedSize <= SETASKFOR_MAX_SZ/2) {
+            RequestGovernanceObject(pfrom, nProp, connman, true, hashContinuation);
+        } else {
+            it->second.hashContinuation = hashContinuation;
+            it->second.fParked = true;
+        }
+    }
+
     // A NEW GOVERNANCE OBJECT HAS ARRIVED
     else if (strCommand == NetMsgType::MNGOVERNANCEOBJECT)
     {
@@ -582,6 +627,12 @@ void CGovernanceManager::DoMaintenance(CConnman& connman)
 
     RequestOrphanObjects(connman);
 
+    // CONTINUE PAGED VOTE SYNCS PUT ON HOLD, masternodeSync only drives them while requesting votes
+
+    std::vector<CNode*> vNodesCopy = connman.CopyNodeVector(CConnman::FullyConnectedOnly);
+    ResumeVoteSyncPages(vNodesCopy, connman);
+    connman.ReleaseNodeVector(vNodesCopy);
+
     // CHECK AND REMOVE - REPROCESS GOVERNANCE OBJECTS
 
     UpdateCachesAndClean();
@@ -642,16 +693,18 @@ bool CGovernanceManager::ConfirmInventoryRequest(const CInv& inv)
     return true;
 }
 
-void CGovernanceManager::SyncSingleObjAndItsVotes(CNode* pnode, const uint256& nProp, const CBloomFilter& filter, CConnman& connman)
+void CGovernanceManager::SyncSingleObjAndItsVotes(CNode* pnode, const uint256& nProp, const CBloomFilter& filter, const uint256& hashContinuation, CConnman& connman)
 {
     // do not provide any data until our node is synced
     if(!masternodeSync.IsSynced()) return;
 
+    int nObjCount = 0;
     int nVoteCount = 0;
 
     // SYNC GOVERNANCE OBJECTS WITH OTHER CLIENT
 
-    LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- syncing single object to peer=%d, nProp = %s\n", __func__, pnode->GetId(), nProp.ToString());
+    LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- syncing single object to peer=%d, nProp = %s, hashContinuation = %s\n", __func__,
+                pnode->GetId(), nProp.ToString(), hashContinuation.ToString());
 
     LOCK2(cs_main, cs);
 
@@ -672,25 +725,49 @@ void CGovernanceManager::SyncSingleObjAndItsVotes(CNode* pnode, const uint256& n
         return;
     }
 
-    // Push the govobj inventory message over to the other client
-    LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- syncing govobj: %s, peer=%d\n", __func__, strHash, pnode->GetId());
-    pnode->PushInventory(CInv(MSG_GOVERNANCE_OBJECT, it->first));
+    // Peers which understand paging get a bounded chunk of what they are missing,
+    // paced by a per-peer budget, older peers still get everything at once.
+    bool fPaged = pnode->nVersion >= GOVERNANCE_VOTE_PAGE_PROTO_VERSION;
+    size_t nMaxVotes = std::numeric_limits<size_t>::max();
+    size_t nMaxScan = std::numeric_limits<size_t>::max();
+    if(fPaged) {
+        int64_t nNow = GetTime();
+        int64_t nRefill = (nNow - pnode->nTimeGovVoteSyncBudget) * GOVERNANCE_VOTE_SYNC_RATE;
+        pnode->nGovVoteSyncBudget = std::min<int64_t>(GOVERNANCE_VOTE_SYNC_PAGE_SIZE, pnode->nGovVoteSyncBudget + nRefill);
+        pnode->nTimeGovVoteSyncBudget = nNow;
+        nMaxVotes = pnode->nGovVoteSyncBudget;
+        nMaxScan = GOVERNANCE_VOTE_SYNC_MAX_SCAN;
+    }
 
-    auto fileVotes = govobj.GetVoteFile();
+    std::vector<CGovernanceVote> vecVotes;
+    // out of budget, the peer asks for the same page again
+    uint256 hashNext = hashContinuation;
+    bool fProgress = govobj.GetVoteFile().GetVotesPage(hashContinuation, filter, nMaxVotes, nMaxScan, vecVotes, hashNext);
 
-    for (const auto& vote : fileVotes.GetVotes()) {
-        uint256 nVoteHash = vote.GetHash();
-        if(filter.contains(nVoteHash) || !vote.IsValid(true)) {
+    // Push the govobj inventory message over to the other client, only once per paged sync
+    if(hashContinuation.IsNull() && fProgress) {
+        LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- syncing govobj: %s, peer=%d\n", __func__, strHash, pnode->GetId());
+        pnode->PushInventory(CInv(MSG_GOVERNANCE_OBJECT, it->first));
+        ++nObjCount;
+    }
+
+    for (const auto& vote : vecVotes) {
+        if(!vote.IsValid(true)) {
             continue;
         }
-        pnode->PushInventory(CInv(MSG_GOVERNANCE_OBJECT_VOTE, nVoteHash));
+        pnode->PushInventory(CInv(MSG_GOVERNANCE_OBJECT_VOTE, vote.GetHash()));
         ++nVoteCount;
     }
 
     CNetMsgMaker msgMaker(pnode->GetSendVersion());
-    connman.PushMessage(pnode, msgMaker.Make(NetMsgType::SYNCSTATUSCOUNT, MASTERNODE_SYNC_GOVOBJ, 1));
+    connman.PushMessage(pnode, msgMaker.Make(NetMsgType::SYNCSTATUSCOUNT, MASTERNODE_SYNC_GOVOBJ, nObjCount));
     connman.PushMessage(pnode, msgMaker.Make(NetMsgType::SYNCSTATUSCOUNT, MASTERNODE_SYNC_GOVOBJ_VOTE, nVoteCount));
-    LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- sent 1 object and %d votes to peer=%d\n", __func__, nVoteCount, pnode->GetId());
+    if(fPaged) {
+        pnode->nGovVoteSyncBudget -= vecVotes.size();
+        connman.PushMessage(pnode, msgMaker.Make(NetMsgType::MNGOVERNANCESYNCPAGE, nProp, (int)vecVotes.size(), hashNext, fProgress));
+    }
+    LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- sent %d objects and %d votes to peer=%d, hashNext = %s\n", __func__,
+                nObjCount, nVoteCount, pnode->GetId(), hashNext.ToString());
 }
 
 void CGovernanceManager::SyncAll(CNode* pnode, CConnman& connman) const
@@ -714,7 +791,8 @@ void CGovernanceManager::SyncAll(CNode* pnode, CConnman& connman) const
 
     LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- syncing all objects to peer=%d\n", __func__, pnode->GetId());
 	{
-		LOCK2(cs_main, cs);
+		// SYSCOIN only announcing inventory, which needs nothing from cs_main
+		LOCK(cs);
 
 		// all valid objects, no votes
 		for (const auto& objPair : mapObjects) {
@@ -1006,7 +1084,7 @@ void CGovernanceManager::CheckPostponedObjects(CConnman& connman)
     }
 }
 
-void CGovernanceManager::RequestGovernanceObject(CNode* pfrom, const uint256& nHash, CConnman& connman, bool fUseFilter)
+void CGovernanceManager::RequestGovernanceObject(CNode* pfrom, const uint256& nHash, CConnman& connman, bool fUseFilter, const uint256& hashContinuation)
 {
     if(!pfrom) {
         return;
@@ -1039,8 +1117,56 @@ void CGovernanceManager::RequestGovernanceObject(CNode* pfrom, const uint256& nH
         }
     }
 
-    LogPrint(BCLog::GOBJECT, "CGovernanceManager::RequestGovernanceObject -- nHash %s nVoteCount %d peer=%d\n", nHash.ToString(), nVoteCount, pfrom->GetId());
-    connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::MNGOVERNANCESYNC, nHash, filter));
+    LogPrint(BCLog::GOBJECT, "CGovernanceManager::RequestGovernanceObject -- nHash %s nVoteCount %d hashContinuation %s peer=%d\n",
+                nHash.ToString(), nVoteCount, hashContinuation.ToString(), pfrom->GetId());
+
+    if(pfrom->nVersion < GOVERNANCE_VOTE_PAGE_PROTO_VERSION) {
+        connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::MNGOVERNANCESYNC, nHash, filter));
+        return;
+    }
+
+    if(fUseFilter) {
+        // the peer answers with MNGOVERNANCESYNCPAGE telling us where to continue
+        LOCK(cs);
+        mapVoteSyncPages[std::make_pair(nHash, CService(pfrom->addr))] = vote_sync_rec(GetTime());
+    }
+    connman.PushMessage(pfrom, msgMaker.Make(NetMsgType::MNGOVERNANCESYNC, nHash, filter, hashContinuation));
+}
+
+void CGovernanceManager::ResumeVoteSyncPages(const std::vector<CNode*>& vNodesCopy, CConnman& connman)
+{
+    int64_t nNow = GetTime();
+    int nTimeout = 60 * 60;
+
+    std::vector<std::pair<CNode*, std::pair<uint256, uint256> > > vecToResume;
+    {
+        LOCK(cs);
+
+        vote_sync_m_it it = mapVoteSyncPages.begin();
+        while(it != mapVoteSyncPages.end()) {
+            if(it->second.nTime + nTimeout < nNow || !mapObjects.count(it->first.first)) {
+                mapVoteSyncPages.erase(it++);
+                continue;
+            }
+            if(it->second.fParked) {
+                for (const auto& pnode : vNodesCopy) {
+                    if(CService(pnode->addr) != it->first.second) continue;
+                    // stop early to prevent setAskFor overflow
+                    size_t nProjectedSize = pnode->setAskFor.size() + GOVERNANCE_VOTE_SYNC_PAGE_SIZE;
+                    if(nProjectedSize > SETASKFOR_MAX_SZ/2) break;
+                    vecToResume.emplace_back(pnode, std::make_pair(it->first.first, it->second.hashContinuation));
+                    break;
+                }
+            }
+            ++it;
+        }
+    }
+
+    for (const auto& item : vecToResume) {
+        LogPrint(BCLog::GOBJECT, "CGovernanceManager::%s -- resuming vote sync of %s from %s, peer=%d\n", __func__,
+                    item.second.first.ToString(), item.second.second.ToString(), item.first->GetId());
+        RequestGovernanceObject(item.first, item.second.first, connman, true, item.second.second);
+    }
 }
 
 int CGovernanceManager::RequestGovernanceObjectVotes(CNode* pnode, CConnman& connman)
@@ -1057,6 +1183,9 @@ int CGovernanceManager::RequestGovernanceObjectVotes(const std::vector<CNode*>&
 
     if(vNodesCopy.empty()) return -1;
 
+    // continue paged syncs which were put on hold first
+    ResumeVoteSyncPages(vNodesCopy, connman);
+
     int64_t nNow = GetTime();
     int nTimeout = 60 * 60;
     size_t nPeersPerHashMax = 3;
@@ -40,6 +40,13 @@ typedef std::pair<CGovernanceObject, ExpirationInfo> object_info_pair_t;
 
 static const int RATE_BUFFER_SIZE = 5;
 
+// maximum number of vote inventories sent to a peer in response to a single paged vote sync request
+static const int GOVERNANCE_VOTE_SYNC_PAGE_SIZE = 2000;
+// maximum number of votes examined against the peer's filter for a single page
+static const int GOVERNANCE_VOTE_SYNC_MAX_SCAN = 8 * GOVERNANCE_VOTE_SYNC_PAGE_SIZE;
+// number of votes per second a peer may page through, up to GOVERNANCE_VOTE_SYNC_PAGE_SIZE at once
+static const int GOVERNANCE_VOTE_SYNC_RATE = 500;
+
 class CRateCheckBuffer
 {
 private:
@@ -172,6 +179,21 @@ public: // Types
         bool fStatusOK;
     };
 
+    // state of a paged vote sync of one object from one peer
+    struct vote_sync_rec {
+        vote_sync_rec(int64_t nTimeIn = 0)
+            : hashContinuation(),
+              fParked(false),
+              nTime(nTimeIn)
+            {}
+
+        // where to resume once the peer has room again, null to start over
+        uint256 hashContinuation;
+        // false while a page is in flight
+        bool fParked;
+        int64_t nTime;
+    };
+
 
     typedef std::map<uint256, CGovernanceObject> object_m_t;
 
@@ -219,6 +241,10 @@ public: // Types
 
     typedef hash_time_m_t::const_iterator hash_time_m_cit;
 
+    typedef std::map<std::pair<uint256, CService>, vote_sync_rec> vote_sync_m_t;
+
+    typedef vote_sync_m_t::iterator vote_sync_m_it;
+
 private:
     static const int MAX_CACHE_SIZE = 1000000;
 
@@ -258,6 +284,9 @@ private:
 
     hash_s_t setRequestedVotes;
 
+    // paged vote syncs we are running against our peers, not persisted
+    vote_sync_m_t mapVoteSyncPages;
+
     bool fRateChecksEnabled;
 
     class ScopedLockBool
@@ -294,7 +323,7 @@ public:
      */
     bool ConfirmInventoryRequest(const CInv& inv);
 
-    void SyncSingleObjAndItsVotes(CNode* pnode, const uint256& nProp, const CBloomFilter& filter, CConnman& connman);
+    void SyncSingleObjAndItsVotes(CNode* pnode, const uint256& nProp, const CBloomFilter& filter, const uint256& hashContinuation, CConnman& connman);
     void SyncAll(CNode* pnode, CConnman& connman) const;
 
     void ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, CConnman& connman);
@@ -325,6 +354,7 @@ public:
         cmapInvalidVotes.Clear();
         cmmapOrphanVotes.Clear();
         mapLastMasternodeObject.clear();
+        mapVoteSyncPages.clear();
     }
 
     std::string ToString() const;
@@ -413,7 +443,9 @@ public:
     int RequestGovernanceObjectVotes(const std::vector<CNode*>& vNodesCopy, CConnman& connman);
 
 private:
-    void RequestGovernanceObject(CNode* pfrom, const uint256& nHash, CConnman& connman, bool fUseFilter = false);
+    void RequestGovernanceObject(CNode* pfrom, const uint256& nHash, CConnman& connman, bool fUseFilter = false, const uint256& hashContinuation = uint256());
+
+    void ResumeVoteSyncPages(const std::vector<CNode*>& vNodesCopy, CConnman& connman);
 
     void AddInvalidVote(const CGovernanceVote& vote)
     {
@@ -6,6 +6,7 @@
 
 #include <chainparamsbase.h>
 #include <compat.h>
+#include <executor.h>
 #include <util.h>
 #include <utilstrencodings.h>
 #include <netbase.h>
@@ -63,6 +64,8 @@ private:
 
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
+ * SYSCOIN Every item enqueued has a task on the shared executor run it, so
+ * how many items run at once is up to the executor's RPC class limit.
  */
 template <typename WorkItem>
 class WorkQueue
@@ -74,13 +77,36 @@ private:
     std::deque<std::unique_ptr<WorkItem>> queue;
     bool running;
     size_t maxDepth;
+    /** Executor tasks submitted that have not returned yet */
+    int numTasks;
+
+    /** Executor task, running the oldest item */
+    void RunOne()
+    {
+        std::unique_ptr<WorkItem> i;
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            if (running && !queue.empty()) {
+                i = std::move(queue.front());
+                queue.pop_front();
+            }
+        }
+        if (i) {
+            (*i)();
+            i.reset();
+        }
+        std::unique_lock<std::mutex> lock(cs);
+        if (--numTasks == 0)
+            cond.notify_all();
+    }
 
 public:
     explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
+                                 maxDepth(_maxDepth),
+                                 numTasks(0)
     {
     }
-    /** Precondition: worker threads have all stopped (they have been joined).
+    /** Precondition: WaitExit() has returned.
      */
     ~WorkQueue()
     {
@@ -89,36 +115,28 @@ public:
     bool Enqueue(WorkItem* item)
     {
         std::unique_lock<std::mutex> lock(cs);
-        if (queue.size() >= maxDepth) {
+        if (!running || queue.size() >= maxDepth) {
             return false;
         }
+        if (!g_executor.TrySubmit(TaskClass::RPC, [this] { RunOne(); })) {
+            return false;
+        }
+        numTasks++;
         queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
         return true;
     }
-    /** Thread function */
-    void Run()
-    {
-        while (true) {
-            std::unique_ptr<WorkItem> i;
-            {
-                std::unique_lock<std::mutex> lock(cs);
-                while (running && queue.empty())
-                    cond.wait(lock);
-                if (!running)
-                    break;
-                i = std::move(queue.front());
-                queue.pop_front();
-            }
-            (*i)();
-        }
-    }
     /** Interrupt and exit loops */
     void Interrupt()
     {
         std::unique_lock<std::mutex> lock(cs);
         running = false;
-        cond.notify_all();
+    }
+    /** Wait for the items being run to finish and for the tasks of the others to return */
+    void WaitExit()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        while (numTasks > 0)
+            cond.wait(lock);
     }
 };
 
@@ -335,13 +353,6 @@ static bool HTTPBindAddresses(struct evhttp* http)
     return !boundSockets.empty();
 }
 
-/** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue)
-{
-    RenameThread("syscoin-httpworker");
-    queue->Run();
-}
-
 /** libevent event log callback */
 static void libevent_log_cb(int severity, const char *msg)
 {
@@ -438,20 +449,17 @@ bool UpdateHTTPServerLogging(bool enable) {
 
 std::thread threadHTTP;
 std::future<bool> threadResult;
-static std::vector<std::thread> g_thread_http_workers;
 
 void StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
     int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
+    // SYSCOIN requests run on the shared executor, rpcThreads at a time
+    LogPrintf("HTTP: running up to %d requests at a time\n", rpcThreads);
+    g_executor.SetClassLimits(TaskClass::RPC, rpcThreads, 0);
     std::packaged_task<bool(event_base*)> task(ThreadHTTP);
     threadResult = task.get_future();
     threadHTTP = std::thread(std::move(task), eventBase);
-
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
-    }
 }
 
 void InterruptHTTPServer()
@@ -473,11 +481,8 @@ void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
     if (workQueue) {
-        LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
-        for (auto& thread: g_thread_http_workers) {
-            thread.join();
-        }
-        g_thread_http_workers.clear();
+        LogPrint(BCLog::HTTP, "Waiting for HTTP requests to finish\n");
+        workQueue->WaitExit();
         delete workQueue;
         workQueue = nullptr;
     }
@@ -0,0 +1,157 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <coins.h>
+#include <hash.h>
+#include <index/addressindex.h>
+#include <undo.h>
+#include <util.h>
+#include <validation.h>
+
+constexpr char DB_ADDRESSUNSPENT = 'u';
+
+std::unique_ptr<AddressIndex> g_addressindex;
+
+struct CAddressUnspentKey
+{
+    uint160 hashScript;
+    COutPoint outpoint;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(hashScript);
+        READWRITE(outpoint);
+    }
+
+    CAddressUnspentKey() {}
+    CAddressUnspentKey(const uint160& hashScriptIn, const COutPoint& outpointIn) : hashScript(hashScriptIn), outpoint(outpointIn) {}
+};
+
+static uint160 GetScriptHash(const CScript& script)
+{
+    return Hash160(script.begin(), script.end());
+}
+
+/**
+ * Access to the address index database (indexes/addressindex/)
+ *
+ * Entries are keyed by the hash of the output script followed by the
+ * outpoint, so all unspent outputs of a script can be read with one seek.
+ */
+class AddressIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Read all unspent outputs whose script hashes to hashScript.
+    bool ReadUnspents(const uint160& hashScript, std::vector<std::pair<COutPoint, CAddressUnspentValue>>& vUnspents) const;
+};
+
+AddressIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(GetDataDir() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe)
+{}
+
+bool AddressIndex::DB::ReadUnspents(const uint160& hashScript, std::vector<std::pair<COutPoint, CAddressUnspentValue>>& vUnspents) const
+{
+    std::unique_ptr<CDBIterator> pcursor(const_cast<DB*>(this)->NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENT, CAddressUnspentKey(hashScript, COutPoint(uint256(), 0))));
+    while (pcursor->Valid()) {
+        std::pair<char, CAddressUnspentKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSUNSPENT || key.second.hashScript != hashScript) {
+            break;
+        }
+        CAddressUnspentValue value;
+        if (!pcursor->GetValue(value)) {
+            return error("%s: failed to read value", __func__);
+        }
+        vUnspents.emplace_back(key.second.outpoint, value);
+        pcursor->Next();
+    }
+    return true;
+}
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<AddressIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+AddressIndex::~AddressIndex() {}
+
+bool AddressIndex::UpdateBlock(const CBlock& block, const CBlockIndex* pindex, bool f_undo)
+{
+    CBlockUndo blockundo;
+    if (pindex->nHeight > 0 && !UndoReadFromDisk(blockundo, pindex)) {
+        return error("%s: failed to read undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size() && pindex->nHeight > 0) {
+        return error("%s: undo data mismatch for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    // Batches apply in order, so an output created and spent within the same
+    // block is written and then erased again when connecting. Disconnecting
+    // walks the block backwards for the same reason.
+    CDBBatch batch(*m_db);
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        const size_t nTx = f_undo ? block.vtx.size() - 1 - i : i;
+        const CTransaction& tx = *block.vtx[nTx];
+        const uint256& txid = tx.GetHash();
+        for (size_t j = 0; j < tx.vout.size(); j++) {
+            const CTxOut& out = tx.vout[j];
+            if (out.scriptPubKey.IsUnspendable()) {
+                continue;
+            }
+            const auto key = std::make_pair(DB_ADDRESSUNSPENT, CAddressUnspentKey(GetScriptHash(out.scriptPubKey), COutPoint(txid, j)));
+            if (f_undo) {
+                batch.Erase(key);
+            } else {
+                batch.Write(key, CAddressUnspentValue(out.nValue, pindex->nHeight));
+            }
+        }
+        if (tx.IsCoinBase()) {
+            continue;
+        }
+        const CTxUndo& txundo = blockundo.vtxundo[nTx - 1];
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const Coin& coin = txundo.vprevout[j];
+            const auto key = std::make_pair(DB_ADDRESSUNSPENT, CAddressUnspentKey(GetScriptHash(coin.out.scriptPubKey), tx.vin[j].prevout));
+            if (f_undo) {
+                batch.Write(key, CAddressUnspentValue(coin.out.nValue, coin.nHeight));
+            } else {
+                batch.Erase(key);
+            }
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    return UpdateBlock(block, pindex, false);
+}
+
+bool AddressIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    const Consensus::Params& consensus_params = Params().GetConsensus();
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString());
+        }
+        if (!UpdateBlock(block, pindex, true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+BaseIndex::DB& AddressIndex::GetDB() const { return *m_db; }
+
+bool AddressIndex::FindUnspents(const CScript& script, std::vector<std::pair<COutPoint, CAddressUnspentValue>>& vUnspents) const
+{
+    return m_db->ReadUnspents(GetScriptHash(script), vUnspents);
+}
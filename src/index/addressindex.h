@@ -0,0 +1,78 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SYSCOIN_INDEX_ADDRESSINDEX_H
+#define SYSCOIN_INDEX_ADDRESSINDEX_H
+
+#include <amount.h>
+#include <chain.h>
+#include <index/base.h>
+#include <script/script.h>
+#include <serialize.h>
+
+/** Amount and confirmation height of an output tracked by the address index. */
+struct CAddressUnspentValue
+{
+    CAmount nValue;
+    int nHeight;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nValue);
+        READWRITE(nHeight);
+    }
+
+    CAddressUnspentValue() : nValue(0), nHeight(0) {}
+    CAddressUnspentValue(CAmount nValueIn, int nHeightIn) : nValue(nValueIn), nHeight(nHeightIn) {}
+};
+
+/**
+ * AddressIndex is used to look up the unspent outputs paying to a script.
+ * The index is written to a LevelDB database keyed by script hash and
+ * outpoint, so that all outputs of an address are adjacent on disk. It is
+ * kept in step with the active chain by adding the outputs and removing the
+ * spent inputs of each connected block, and reversing both on disconnect
+ * using the block undo data.
+ */
+class AddressIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    /// Apply (or, when f_undo is set, revert) the UTXO changes of a block.
+    bool UpdateBlock(const CBlock& block, const CBlockIndex* pindex, bool f_undo);
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "addressindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~AddressIndex() override;
+
+    /// Look up the unspent outputs paying to a script.
+    ///
+    /// @param[in]   script  The scriptPubKey of the address.
+    /// @param[out]  vUnspents  The outpoints of its unspent outputs with their amounts and heights.
+    /// @return  true unless the database could not be read
+    bool FindUnspents(const CScript& script, std::vector<std::pair<COutPoint, CAddressUnspentValue>>& vUnspents) const;
+};
+
+/// The global address index, used by the Syscoin asset RPCs. May be null.
+extern std::unique_ptr<AddressIndex> g_addressindex;
+
+#endif // SYSCOIN_INDEX_ADDRESSINDEX_H
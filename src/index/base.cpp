@@ -61,6 +61,15 @@ bool BaseIndex::Init()
 
     LOCK(cs_main);
     m_best_block_index = FindForkInGlobalIndex(chainActive, locator);
+    const CBlockIndex* fork_index = m_best_block_index.load();
+    if (fork_index && !locator.IsNull()) {
+        // Start from the block the index last stopped at, even if it has since
+        // been reorged out of the active chain, so that ThreadSync rewinds it.
+        const CBlockIndex* locator_tip_index = LookupBlockIndex(locator.vHave.front());
+        if (locator_tip_index && locator_tip_index->GetAncestor(fork_index->nHeight) == fork_index) {
+            m_best_block_index = locator_tip_index;
+        }
+    }
     m_synced = m_best_block_index.load() == chainActive.Tip();
     return true;
 }
@@ -97,6 +106,15 @@ void BaseIndex::ThreadSync()
 
             {
                 LOCK(cs_main);
+                if (pindex && !chainActive.Contains(pindex)) {
+                    const CBlockIndex* pindex_fork = chainActive.FindFork(pindex);
+                    if (!Rewind(pindex, pindex_fork)) {
+                        FatalError("%s: Failed to rewind index %s to a previous chain tip",
+                                   __func__, GetName());
+                        return;
+                    }
+                    pindex = pindex_fork;
+                }
                 const CBlockIndex* pindex_next = NextSyncBlock(pindex);
                 if (!pindex_next) {
                     WriteBestBlock(pindex);
@@ -140,6 +158,12 @@ void BaseIndex::ThreadSync()
     }
 }
 
+bool BaseIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+    return true;
+}
+
 bool BaseIndex::WriteBestBlock(const CBlockIndex* block_index)
 {
     LOCK(cs_main);
@@ -187,6 +211,38 @@ void BaseIndex::BlockConnected(const std::shared_ptr<const CBlock>& block, const
     }
 }
 
+void BaseIndex::BlockDisconnected(const std::shared_ptr<const CBlock>& block)
+{
+    if (!m_synced) {
+        return;
+    }
+
+    const CBlockIndex* pindex;
+    {
+        LOCK(cs_main);
+        pindex = LookupBlockIndex(block->GetHash());
+    }
+
+    // Only the current best block can be disconnected. As with BlockConnected, this may not hold
+    // immediately after the sync thread catches up and sets m_synced, in which case the blocks on
+    // the stale branch were never indexed. Log a warning and let the queue clear.
+    const CBlockIndex* best_block_index = m_best_block_index.load();
+    if (!pindex || pindex != best_block_index) {
+        LogPrintf("%s: WARNING: Block %s is not the known best block (tip=%s); not rewinding index\n",
+                  __func__, block->GetHash().ToString(),
+                  best_block_index ? best_block_index->GetBlockHash().ToString() : "null");
+        return;
+    }
+
+    if (Rewind(pindex, pindex->pprev)) {
+        m_best_block_index = pindex->pprev;
+    } else {
+        FatalError("%s: Failed to rewind index %s to a previous chain tip",
+                   __func__, GetName());
+        return;
+    }
+}
+
 void BaseIndex::ChainStateFlushed(const CBlockLocator& locator)
 {
     if (!m_synced) {
@@ -245,7 +301,8 @@ bool BaseIndex::BlockUntilSyncedToCurrentChain()
     }
 
     LogPrintf("%s: %s is catching up on block notifications\n", __func__, GetName());
-    SyncWithValidationInterfaceQueue();
+    // SYSCOIN
+    SyncWithValidationInterfaceQueue(this);
     return true;
 }
 
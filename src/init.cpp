@@ -15,10 +15,14 @@
 #include <chainparams.h>
 #include <checkpoints.h>
 #include <compat/sanity.h>
+#include <crypto/keccak.h>
 #include <consensus/validation.h>
+#include <executor.h>
 #include <fs.h>
 #include <httpserver.h>
 #include <httprpc.h>
+// SYSCOIN
+#include <index/addressindex.h>
 #include <index/txindex.h>
 #include <key.h>
 #include <validation.h>
@@ -29,6 +33,7 @@
 #include <policy/feerate.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
+#include <relaycache.h>
 #include <rpc/auxpow_miner.h>
 #include <rpc/mining.h>
 #include <rpc/server.h>
@@ -40,6 +45,7 @@
 #include <shutdown.h>
 #include <timedata.h>
 #include <txdb.h>
+#include <txoutsetscan.h>
 #include <txmempool.h>
 #include <torcontrol.h>
 #include <ui_interface.h>
@@ -65,9 +71,10 @@
 // SYSCOIN services
 #include <services/asset.h>
 #include <services/assetallocation.h>
+#include <services/ethheaders.h>
 extern AssetBalanceMap mempoolMapAssetBalances;
 extern ArrivalTimesMapImpl arrivalTimesMap; 
-#include <thread_pool/thread_pool.hpp>
+extern AssetAllocationSendsMap mempoolMapAssetAllocationSends;
 #include <key_io.h>
 #include <wallet/wallet.h>
 #ifndef WIN32
@@ -202,6 +209,28 @@ void Interrupt()
     if (g_txindex) {
         g_txindex->Interrupt();
     }
+    // SYSCOIN
+    if (g_addressindex) {
+        g_addressindex->Interrupt();
+    }
+}
+
+// SYSCOIN
+static CCriticalSection cs_dumpcaches;
+
+/** Store the masternode, payment, governance and fulfilled request caches into their dat files.
+ *  Called periodically from the scheduler and once more on shutdown. */
+static void DumpSyscoinCaches()
+{
+    LOCK(cs_dumpcaches);
+    CFlatDB<CMasternodeMan> flatdb1("mncache.dat", "magicMasternodeCache");
+    flatdb1.Dump(mnodeman);
+    CFlatDB<CMasternodePayments> flatdb2("mnpayments.dat", "magicMasternodePaymentsCache");
+    flatdb2.Dump(mnpayments);
+    CFlatDB<CGovernanceManager> flatdb3("governance.dat", "magicGovernanceCache");
+    flatdb3.Dump(governance);
+    CFlatDB<CNetFulfilledRequestManager> flatdb4("netfulfilled.dat", "magicFulfilledCache");
+    flatdb4.Dump(netfulfilledman);
 }
 
 void PrepareShutdown()
@@ -219,6 +248,8 @@ void PrepareShutdown()
     RenameThread("syscoin-shutoff");
     mempool.AddTransactionsUpdated(1);
 
+    // SYSCOIN abort UTXO set scans first, RPC workers may be waiting on them
+    StopTxOutSetScans();
     StopHTTPRPC();
     StopREST();
     StopRPC();
@@ -227,20 +258,15 @@ void PrepareShutdown()
     StopMapPort();
     if (!fLiteMode) {
         // STORE DATA CACHES INTO SERIALIZED DAT FILES
-        CFlatDB<CMasternodeMan> flatdb1("mncache.dat", "magicMasternodeCache");
-        flatdb1.Dump(mnodeman);
-        CFlatDB<CMasternodePayments> flatdb2("mnpayments.dat", "magicMasternodePaymentsCache");
-        flatdb2.Dump(mnpayments);
-        CFlatDB<CGovernanceManager> flatdb3("governance.dat", "magicGovernanceCache");
-        flatdb3.Dump(governance);
-        CFlatDB<CNetFulfilledRequestManager> flatdb4("netfulfilled.dat", "magicFulfilledCache");
-        flatdb4.Dump(netfulfilledman);
+        DumpSyscoinCaches();
     }
     // Because these depend on each-other, we make sure that neither can be
     // using the other before destroying them.
     if (peerLogic) UnregisterValidationInterface(peerLogic.get());
     if (g_connman) g_connman->Stop();
     if (g_txindex) g_txindex->Stop();
+    // SYSCOIN
+    if (g_addressindex) g_addressindex->Stop();
 
     if (g_auxpow_miner != nullptr) {
         g_auxpow_miner.reset();
@@ -251,12 +277,16 @@ void PrepareShutdown()
     // CScheduler/checkqueue threadGroup
     threadGroup.interrupt_all();
     threadGroup.join_all();
+    // SYSCOIN then run what the scheduler and mempool handed to the executor
+    g_executor.Stop();
 
     // After the threads that potentially access these pointers have been stopped,
     // destruct and reset all to nullptr.
     peerLogic.reset();
     g_connman.reset();
     g_txindex.reset();
+    // SYSCOIN
+    g_addressindex.reset();
 
     if (g_is_mempool_loaded && gArgs.GetArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
         DumpMempool();
@@ -291,14 +321,13 @@ void PrepareShutdown()
     // SYSCOIN
     mempoolMapAssetBalances.clear();
     arrivalTimesMap.clear();
+    mempoolMapAssetAllocationSends.clear();
     FlushSyscoinDBs();
     passetdb.reset();
     passetallocationdb.reset();
     passetallocationtransactionsdb.reset();
-    if (threadpool)
-        delete threadpool;
-    threadpool = NULL;
-    LogPrint(BCLog::THREADPOOL, "THREADPOOL::Destroyed threadpool\n");
+    passetdbblockcache.reset();
+    pethheaderdb.reset();
     {
         LOCK(cs_main);
         if (pcoinsTip != nullptr) {
@@ -353,6 +382,8 @@ void Shutdown()
     globalVerifyHandle.reset();
     ECC_Stop();
     LogPrintf("%s: done\n", __func__);
+    // SYSCOIN
+    g_logger->StopAsync();
 }
 /**
  * Signal handlers are very limited in what they are allowed to do.
@@ -424,17 +455,21 @@ void SetupServerArgs()
     gArgs.AddArg("-blocksdir=<dir>", "Specify blocks directory (default: <datadir>/blocks)", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocknotify=<cmd>", "Execute command when the best block changes (%s in cmd is replaced by block hash)", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blockreconstructionextratxn=<n>", strprintf("Extra transactions to keep in memory for compact block reconstructions (default: %u)", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN), false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-blockreconstructionextraassettxn=<n>", strprintf("Extra asset transactions to keep in memory for compact block reconstructions, apart from -blockreconstructionextratxn (default: %u)", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_ASSET_TXN), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-blocksonly", strprintf("Whether to operate in a blocks only mode (default: %u)", DEFAULT_BLOCKSONLY), true, OptionsCategory::OPTIONS);
     gArgs.AddArg("-conf=<file>", strprintf("Specify configuration file. Relative paths will be prefixed by datadir location. (default: %s)", SYSCOIN_CONF_FILENAME), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-datadir=<dir>", "Specify data directory", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-dbbatchsize", strprintf("Maximum database write batch size in bytes (default: %u)", nDefaultDbBatchSize), true, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-assetdbcache=<n>", strprintf("Set asset database cache size in megabytes, taken out of -dbcache (minimum: %d, default: a quarter of -dbcache after the block and index databases)", nMinAssetDBCache), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-dbcache=<n>", strprintf("Set database cache size in megabytes (%d to %d, default: %d)", nMinDbCache, nMaxDbCache, nDefaultDbCache), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-debuglogfile=<file>", strprintf("Specify location of debug log file. Relative paths will be prefixed by a net-specific datadir location. (-nodebuglogfile to disable; default: %s)", DEFAULT_DEBUGLOGFILE), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-feefilter", strprintf("Tell other nodes to filter invs to us by our mempool min fee (default: %u)", DEFAULT_FEEFILTER), true, OptionsCategory::OPTIONS);
     gArgs.AddArg("-includeconf=<file>", "Specify additional configuration file, relative to the -datadir path (only useable from configuration file, not command line)", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-loadblock=<file>", "Imports blocks from external blk000??.dat file on startup", false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-maxmempool=<n>", strprintf("Keep the transaction memory pool below <n> megabytes (default: %u)", DEFAULT_MAX_MEMPOOL_SIZE), false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-maxnotifyqueue=<n>", strprintf("Before connecting more blocks, wait for subscribers to validation notifications, such as wallets, indexes and ZMQ, that have more than <n> notifications queued (default: %u)", DEFAULT_MAX_NOTIFY_QUEUE), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-maxorphantx=<n>", strprintf("Keep at most <n> unconnectable transactions in memory (default: %u)", DEFAULT_MAX_ORPHAN_TRANSACTIONS), false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-maxorphanassettx=<n>", strprintf("Keep at most <n> unconnectable asset transactions in memory, apart from -maxorphantx (default: %u)", DEFAULT_MAX_ORPHAN_ASSET_TRANSACTIONS), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-mempoolexpiry=<n>", strprintf("Do not keep transactions in the mempool longer than <n> hours (default: %u)", DEFAULT_MEMPOOL_EXPIRY), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-minimumchainwork=<hex>", strprintf("Minimum work assumed to exist on a valid chain in hex (default: %s, testnet: %s)", defaultChainParams->GetConsensus().nMinimumChainWork.GetHex(), testnetChainParams->GetConsensus().nMinimumChainWork.GetHex()), true, OptionsCategory::OPTIONS);
     gArgs.AddArg("-par=<n>", strprintf("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)",
@@ -457,6 +492,7 @@ void SetupServerArgs()
 #endif
     gArgs.AddArg("-txindex", strprintf("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)", DEFAULT_TXINDEX), false, OptionsCategory::OPTIONS);
     // SYSCOIN
+    gArgs.AddArg("-addressindex", strprintf("Maintain an index of unspent outputs by address, used by the Syscoin asset rpc calls instead of scanning the UTXO set (default: %u)", DEFAULT_ADDRESSINDEX), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-stopatblock", strprintf("For Airdrops it is useful to stop your blockchain from processing at a certain block. Set this block as required by your airdrop schedule. 0 means it is disabled (default: 0)"), 0, OptionsCategory::OPTIONS);
     gArgs.AddArg("-litemode=<n>", strprintf("Disable all Syscoin specific functionality (Masternodes, Governance) (0-1, default: 0)"), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-sporkaddr=<hex>", strprintf("Override spork address. Only useful for regtest. Using this on mainnet or testnet will ban you."), false, OptionsCategory::OPTIONS); 
@@ -464,6 +500,7 @@ void SetupServerArgs()
     gArgs.AddArg("-mnconf=<file>", strprintf("Specify masternode configuration file (default: %s)", "masternode.conf"), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-mnconflock=<n>", strprintf("Lock masternodes from masternode configuration file (default: %u)", 1), true, OptionsCategory::OPTIONS);
     gArgs.AddArg("-masternodeprivkey=<n>", "Set the masternode private key", false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-mncachedumpinterval=<n>", strprintf("Write the masternode, payment and governance caches to disk every <n> minutes, 0 to only write them on shutdown (default: %u)", DEFAULT_FLATDB_DUMP_INTERVAL), false, OptionsCategory::OPTIONS);
     
       
     gArgs.AddArg("-addnode=<ip>", "Add a node to connect to and attempt to keep the connection open (see the `addnode` RPC command help for more info). This option can be specified multiple times to add multiple nodes.", false, OptionsCategory::CONNECTION);
@@ -482,8 +519,11 @@ void SetupServerArgs()
     gArgs.AddArg("-maxconnections=<n>", strprintf("Maintain at most <n> connections to peers (default: %u)", DEFAULT_MAX_PEER_CONNECTIONS), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-maxreceivebuffer=<n>", strprintf("Maximum per-connection receive buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXRECEIVEBUFFER), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-maxsendbuffer=<n>", strprintf("Maximum per-connection send buffer, <n>*1000 bytes (default: %u)", DEFAULT_MAXSENDBUFFER), false, OptionsCategory::CONNECTION);
+    // SYSCOIN
+    gArgs.AddArg("-relaycachesize=<n>", strprintf("Keep up to <n> MiB of transactions and blocks as serialized for one peer, to serve other peers asking for them (default: %d)", DEFAULT_RELAY_CACHE_SIZE), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-maxtimeadjustment", strprintf("Maximum allowed median peer time offset adjustment. Local perspective of time may be influenced by peers forward or backward by this amount. (default: %u seconds)", DEFAULT_MAX_TIME_ADJUSTMENT), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-maxuploadtarget=<n>", strprintf("Tries to keep outbound traffic under the given target (in MiB per 24h), 0 = no limit (default: %d)", DEFAULT_MAX_UPLOAD_TARGET), false, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-msghandlerthreads=<n>", strprintf("Set the number of threads processing peer messages, each peer's messages stay on one thread (1 to %d, default: %d)", MAX_MSGHANDLER_THREADS, DEFAULT_MSGHANDLER_THREADS), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-onion=<ip:port>", "Use separate SOCKS5 proxy to reach peers via Tor hidden services, set -noonion to disable (default: -proxy)", false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-onlynet=<net>", "Make outgoing connections only through network <net> (ipv4, ipv6 or onion). Incoming connections are not affected by this option. This option can be specified multiple times to allow multiple networks.", false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-peerbloomfilters", strprintf("Support filtering of blocks and transaction with bloom filters (default: %u)", DEFAULT_PEERBLOOMFILTERS), false, OptionsCategory::CONNECTION);
@@ -492,6 +532,7 @@ void SetupServerArgs()
     gArgs.AddArg("-proxy=<ip:port>", "Connect through SOCKS5 proxy, set -noproxy to disable (default: disabled)", false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-proxyrandomize", strprintf("Randomize credentials for every proxy connection. This enables Tor stream isolation (default: %u)", DEFAULT_PROXYRANDOMIZE), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-seednode=<ip>", "Connect to a node to retrieve peer addresses, and disconnect. This option can be specified multiple times to connect to multiple nodes.", false, OptionsCategory::CONNECTION);
+    gArgs.AddArg("-socketevents=<mode>", strprintf("Wait for peer sockets through <mode> (%s, default: %s)", SocketEventsModes(), SocketEventsModeToString(DEFAULT_SOCKETEVENTS)), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-timeout=<n>", strprintf("Specify connection timeout in milliseconds (minimum: 1, default: %d)", DEFAULT_CONNECT_TIMEOUT), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-torcontrol=<ip>:<port>", strprintf("Tor control port to use if onion listening enabled (default: %s)", DEFAULT_TOR_CONTROL), false, OptionsCategory::CONNECTION);
     gArgs.AddArg("-torpassword=<pass>", "Tor control port password (default: empty)", false, OptionsCategory::CONNECTION);
@@ -547,11 +588,13 @@ void SetupServerArgs()
         "If <category> is not supplied or if <category> = 1, output all debugging information. <category> can be: " + ListLogCategories() + ".", false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-debugexclude=<category>", strprintf("Exclude debugging information for a category. Can be used in conjunction with -debug=1 to output debug logs for all categories except one or more specified categories."), false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-help-debug", "Show all debugging options (usage: --help -help-debug)", false, OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg("-logasync=<n>", strprintf("Queue up to <n> log lines for a background thread to write, dropping lines while the queue is full, or 0 to write them as they are logged (default: %u)", DEFAULT_LOGASYNC), false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logips", strprintf("Include IP addresses in debug output (default: %u)", DEFAULT_LOGIPS), false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logtimestamps", strprintf("Prepend debug output with timestamp (default: %u)", DEFAULT_LOGTIMESTAMPS), false, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-mocktime=<n>", "Replace actual time with <n> seconds since epoch (default: 0)", true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxsigcachesize=<n>", strprintf("Limit sum of signature cache and script execution cache sizes to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE), true, OptionsCategory::DEBUG_TEST);
+    gArgs.AddArg("-maxmsgsigcachesize=<n>", strprintf("Limit size of the masternode and governance message signature cache to <n> MiB (default: %u)", DEFAULT_MAX_MSG_SIG_CACHE_SIZE), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE), true, OptionsCategory::DEBUG_TEST);
     gArgs.AddArg("-maxtxfee=<amt>", strprintf("Maximum total fees (in %s) to use in a single wallet transaction or raw transaction; setting this too low may abort large transactions (default: %s)",
         CURRENCY_UNIT, FormatMoney(DEFAULT_TRANSACTION_MAXFEE)), false, OptionsCategory::DEBUG_TEST);
@@ -945,6 +988,7 @@ namespace { // Variables internal to initialization process only
 int nMaxConnections;
 int nUserMaxConnections;
 int nFD;
+SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS;
 ServiceFlags nLocalServices = ServiceFlags(NODE_NETWORK | NODE_NETWORK_LIMITED | NODE_WITNESS);
 
 } // namespace
@@ -1027,6 +1071,9 @@ bool AppInitParameterInteraction()
     if (gArgs.GetArg("-prune", 0)) {
         if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        // SYSCOIN
+        if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX))
+            return InitError(_("Prune mode is incompatible with -addressindex."));
     }
 
     // -bind and -whitebind can't be set when not listening
@@ -1035,6 +1082,10 @@ bool AppInitParameterInteraction()
         return InitError("Cannot set -bind or -whitebind together with -listen=0");
     }
 
+    if (gArgs.IsArgSet("-socketevents") && !ParseSocketEventsMode(gArgs.GetArg("-socketevents", ""), socketEventsMode)) {
+        return InitError(strprintf(_("Invalid -socketevents value '%s', expected one of: %s"), gArgs.GetArg("-socketevents", ""), SocketEventsModes()));
+    }
+
     // Make sure enough file descriptors are available
     int nBind = std::max(nUserBind, size_t(1));
     nUserMaxConnections = gArgs.GetArg("-maxconnections", DEFAULT_MAX_PEER_CONNECTIONS);
@@ -1042,6 +1093,8 @@ bool AppInitParameterInteraction()
 
     // Trim requested connection counts, to fit into system limitations
     // <int> in std::min<int>(...) to work around FreeBSD compilation issue described in #2695
+    // SYSCOIN the cap holds under epoll too: sockets at or above FD_SETSIZE are still refused as
+    // non-selectable, netbase waits for connects with select(), and the handler falls back to select()
     nMaxConnections = std::max(std::min<int>(nMaxConnections, FD_SETSIZE - nBind - MIN_CORE_FILEDESCRIPTORS - MAX_ADDNODE_CONNECTIONS), 0);
     nFD = RaiseFileDescriptorLimit(nMaxConnections + MIN_CORE_FILEDESCRIPTORS + MAX_ADDNODE_CONNECTIONS);
     if (nFD < MIN_CORE_FILEDESCRIPTORS)
@@ -1288,6 +1341,9 @@ bool AppInitSanityChecks()
     // Initialize elliptic curve code
     std::string sha256_algo = SHA256AutoDetect();
     LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+    // SYSCOIN
+    std::string keccak_algo = KeccakAutoDetect();
+    LogPrintf("Using the '%s' Keccak implementation\n", keccak_algo);
     RandomInit();
     ECC_Start();
     globalVerifyHandle.reset(new ECCVerifyHandle());
@@ -1332,6 +1388,14 @@ bool AppInitMain()
                                        g_logger->m_file_path.string()));
         }
     }
+    // SYSCOIN
+    const int64_t nLogAsync = gArgs.GetArg("-logasync", DEFAULT_LOGASYNC);
+    if (nLogAsync < 0 || nLogAsync > MAX_LOGASYNC) {
+        return InitError(strprintf(_("-logasync must be between 0 and %d"), MAX_LOGASYNC));
+    }
+    if (nLogAsync > 0) {
+        g_logger->StartAsync(nLogAsync);
+    }
 
     if (!g_logger->m_log_timestamps)
         LogPrintf("Startup time: %s\n", FormatISO8601DateTime(GetTime()));
@@ -1351,16 +1415,33 @@ bool AppInitMain()
 
     InitSignatureCache();
     InitScriptExecutionCache();
+    // SYSCOIN
+    InitMessageSignatureCache();
 
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
-    if (nScriptCheckThreads) {
-        for (int i=0; i<nScriptCheckThreads-1; i++)
-            threadGroup.create_thread(&ThreadScriptCheck);
-    }
     // SYSCOIN
-    if (!threadpool) {
-        threadpool = new tp::ThreadPool;
-        LogPrint(BCLog::THREADPOOL, "THREADPOOL::Created threadpool\n");
+    // Script checks, mempool checks, RPC requests, validation interface
+    // callbacks and scheduler tasks share one executor. RPC requests, mempool
+    // checks and callbacks may wait for cs_main while block validation holds it,
+    // so the executor has a thread for every task the class limits let run at
+    // once: however busy the other classes are, the script check helpers of the
+    // block being connected always find their threads free.
+    const int nBlockThreads = std::max(nScriptCheckThreads - 1, 1);
+    const int nRPCThreads = std::max((int)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1);
+    const int nMempoolThreads = std::max(GetNumCores() / 2, 1);
+    // Each validation interface subscriber runs one callback at a time
+    const int nNotifyThreads = std::max(GetNumCores() / 2, 1);
+    const int nExecutorThreads = nBlockThreads + nRPCThreads + nMempoolThreads + nNotifyThreads + 1;
+    g_executor.SetClassLimits(TaskClass::BLOCK, nBlockThreads, 0);
+    g_executor.SetClassLimits(TaskClass::MEMPOOL, nMempoolThreads, MAX_MEMPOOL_CHECKS_QUEUED);
+    g_executor.SetClassLimits(TaskClass::NOTIFY, nNotifyThreads, 0);
+    g_executor.SetClassLimits(TaskClass::BACKGROUND, 1, 0);
+    // The RPC class limit of nRPCThreads is set when the HTTP server starts
+    g_executor.Start(nExecutorThreads);
+    LogPrintf("Using %d executor threads\n", nExecutorThreads);
+    if (nScriptCheckThreads) {
+        SetScriptCheckExecutor(&g_executor, nScriptCheckThreads - 1);
+        SetMessageSigCheckExecutor(&g_executor, nScriptCheckThreads - 1);
     }
     if (!sporkManager.SetSporkAddress(gArgs.GetArg("-sporkaddr", Params().SporkAddress())))
         return InitError(_("Invalid spork address specified with -sporkaddr"));
@@ -1371,10 +1452,14 @@ bool AppInitMain()
             return InitError(_("Unable to sign spork message, wrong key?"));
     }
     // Start the lightweight task scheduler thread
+    // SYSCOIN which leaves running the tasks to the executor
+    scheduler.SetExecutor(&g_executor, TaskClass::BACKGROUND);
     CScheduler::Function serviceLoop = boost::bind(&CScheduler::serviceQueue, &scheduler);
     threadGroup.create_thread(boost::bind(&TraceThread<CScheduler::Function>, "scheduler", serviceLoop));
 
     GetMainSignals().RegisterBackgroundSignalScheduler(scheduler);
+    // SYSCOIN
+    GetMainSignals().SetExecutor(&g_executor, TaskClass::NOTIFY);
     GetMainSignals().RegisterWithMempoolSignals(mempool);
 
     /* Register RPC commands regardless of -server setting so they will be
@@ -1534,6 +1619,12 @@ bool AppInitMain()
     nTotalCache -= nBlockTreeDBCache;
     int64_t nTxIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX) ? nMaxTxIndexCache << 20 : 0);
     nTotalCache -= nTxIndexCache;
+    // SYSCOIN
+    int64_t nAddressIndexCache = std::min(nTotalCache / 8, gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX) ? nMaxAddressIndexCache << 20 : 0);
+    nTotalCache -= nAddressIndexCache;
+    int64_t nAssetDBCache = gArgs.IsArgSet("-assetdbcache") ? gArgs.GetArg("-assetdbcache", nMinAssetDBCache) << 20 : nTotalCache / 4;
+    nAssetDBCache = std::min(std::max(nAssetDBCache, nMinAssetDBCache << 20), nTotalCache / 2);
+    nTotalCache -= nAssetDBCache;
     int64_t nCoinDBCache = std::min(nTotalCache / 2, (nTotalCache / 4) + (1 << 23)); // use 25%-50% of the remainder for disk cache
     nCoinDBCache = std::min(nCoinDBCache, nMaxCoinsDBCache << 20); // cap total coins db cache
     nTotalCache -= nCoinDBCache;
@@ -1544,6 +1635,11 @@ bool AppInitMain()
     if (gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         LogPrintf("* Using %.1fMiB for transaction index database\n", nTxIndexCache * (1.0 / 1024 / 1024));
     }
+    // SYSCOIN
+    if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
+        LogPrintf("* Using %.1fMiB for address index database\n", nAddressIndexCache * (1.0 / 1024 / 1024));
+    }
+    LogPrintf("* Using %.1fMiB for asset databases\n", nAssetDBCache * (1.0 / 1024 / 1024));
     bool fLoaded = false;
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set (plus up to %.1fMiB of unused mempool space)\n", nCoinCacheUsage * (1.0 / 1024 / 1024), nMempoolSizeMax * (1.0 / 1024 / 1024));
@@ -1569,11 +1665,17 @@ bool AppInitMain()
                 passetdb.reset();
                 passetallocationdb.reset();
                 passetallocationtransactionsdb.reset();
-
-                
-                passetdb.reset(new CAssetDB(nCoinDBCache*16, false, fReset));
-                passetallocationdb.reset(new CAssetAllocationDB(nCoinDBCache*32, false, fReset));
-                passetallocationtransactionsdb.reset(new CAssetAllocationTransactionsDB(0, false, fReset));
+                passetdbblockcache.reset();
+
+                // Half of the asset budget is one block cache the three databases divide by use; with
+                // the block cache shared, each database puts half of its nCacheSize into write buffers.
+                passetdbblockcache.reset(new CDBBlockCache(nAssetDBCache / 2));
+                passetdb.reset(new CAssetDB(nAssetDBCache / 3, false, fReset, passetdbblockcache.get()));
+                passetallocationdb.reset(new CAssetAllocationDB(nAssetDBCache / 3, false, fReset, passetdbblockcache.get()));
+                passetallocationtransactionsdb.reset(new CAssetAllocationTransactionsDB(nAssetDBCache / 3, false, fReset, passetdbblockcache.get()));
+                // Ethereum headers are not derived from our own chain, so a reindex keeps them
+                pethheaderdb.reset();
+                pethheaderdb.reset(new CEthHeaderDB(nMinDbCache << 20, false, false));
 
                 // new CBlockTreeDB tries to delete the existing file, which
                 // fails if it's still open from the previous loop. Close it first:
@@ -1637,6 +1739,11 @@ bool AppInitMain()
                     strLoadError = _("Unable to replay blocks. You will need to rebuild the database using -reindex-chainstate.");
                     break;
                 }
+                // SYSCOIN
+                if (!ReplaySyscoinBlocks(chainparams, pcoinsdbview.get())) {
+                    strLoadError = _("Unable to replay asset changes. You will need to rebuild the database using -reindex.");
+                    break;
+                }
 
                 // The on-disk coinsdb is now in a good state, create the cache
                 pcoinsTip.reset(new CCoinsViewCache(pcoinscatcher.get()));
@@ -1734,6 +1841,11 @@ bool AppInitMain()
         g_txindex = MakeUnique<TxIndex>(nTxIndexCache, false, fReindex);
         g_txindex->Start();
     }
+    // SYSCOIN
+    if (gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX)) {
+        g_addressindex = MakeUnique<AddressIndex>(nAddressIndexCache, false, fReindex);
+        g_addressindex->Start();
+    }
 
     // ********************************************************* Step 9: load wallet
     if (!g_wallet_init_interface.Open()) return false;
@@ -1886,6 +1998,12 @@ bool AppInitMain()
 
         scheduler.scheduleEvery(boost::bind(&CMasternodePayments::DoMaintenance, boost::ref(mnpayments)), 60*1000);
         scheduler.scheduleEvery(boost::bind(&CGovernanceManager::DoMaintenance, boost::ref(governance), boost::ref(*g_connman)), 60 * 5*1000);
+
+        // periodic snapshots so that a crash doesn't lose all masternode and governance state
+        int64_t nDumpInterval = gArgs.GetArg("-mncachedumpinterval", DEFAULT_FLATDB_DUMP_INTERVAL);
+        if (nDumpInterval > 0) {
+            scheduler.scheduleEvery(DumpSyscoinCaches, nDumpInterval * 60 * 1000);
+        }
     }
     // ********************************************************* Step 12: start node
 
@@ -1921,6 +2039,8 @@ bool AppInitMain()
     connOptions.nSendBufferMaxSize = 1000*gArgs.GetArg("-maxsendbuffer", DEFAULT_MAXSENDBUFFER);
     connOptions.nReceiveFloodSize = 1000*gArgs.GetArg("-maxreceivebuffer", DEFAULT_MAXRECEIVEBUFFER);
     connOptions.m_added_nodes = gArgs.GetArgs("-addnode");
+    connOptions.socketEventsMode = socketEventsMode;
+    connOptions.nMsgHandlerThreads = gArgs.GetArg("-msghandlerthreads", DEFAULT_MSGHANDLER_THREADS);
 
     connOptions.nMaxOutboundTimeframe = nMaxOutboundTimeframe;
     connOptions.nMaxOutboundLimit = nMaxOutboundLimit;
@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <logging.h>
+#include <util.h>
 #include <utiltime.h>
 
 const char * const DEFAULT_DEBUGLOGFILE = "debug.log";
@@ -210,9 +211,29 @@ void BCLog::Logger::LogPrintStr(const std::string &str)
 {
     std::string strTimestamped = LogTimestampStr(str);
 
+    // SYSCOIN
+    if (m_async) {
+        // StopAsync waits for pushers that saw m_async set before it cleared it
+        m_async_pushers++;
+        if (m_async) {
+            if (!m_ring->TryPush(std::move(strTimestamped))) {
+                m_dropped++;
+            } else if (m_writer_idle) {
+                m_writer_cond.notify_one();
+            }
+            m_async_pushers--;
+            return;
+        }
+        m_async_pushers--;
+    }
+    WriteStr(strTimestamped);
+}
+
+void BCLog::Logger::WriteStr(const std::string &str)
+{
     if (m_print_to_console) {
         // print to console
-        fwrite(strTimestamped.data(), 1, strTimestamped.size(), stdout);
+        fwrite(str.data(), 1, str.size(), stdout);
         fflush(stdout);
     }
     if (m_print_to_file) {
@@ -220,7 +241,7 @@ void BCLog::Logger::LogPrintStr(const std::string &str)
 
         // buffer if we haven't opened the log yet
         if (m_fileout == nullptr) {
-            m_msgs_before_open.push_back(strTimestamped);
+            m_msgs_before_open.push_back(str);
         }
         else
         {
@@ -234,11 +255,124 @@ void BCLog::Logger::LogPrintStr(const std::string &str)
                 setbuf(m_fileout, nullptr); // unbuffered
             }
 
-            FileWriteStr(strTimestamped, m_fileout);
+            FileWriteStr(str, m_fileout);
+        }
+    }
+}
+
+// SYSCOIN
+/** Upper bound on the bytes of log lines the writer joins into one write */
+static const size_t MAX_LOG_BATCH_SIZE = 64 * 1024;
+/** How long the writer sleeps while nothing is queued, unless a pusher wakes it */
+static const int LOG_WRITER_IDLE_MS = 100;
+
+BCLog::LogRing::LogRing(size_t nCapacity) : m_mask(NextPowerOfTwo(std::max<size_t>(nCapacity, 2)) - 1), m_slots(new Slot[m_mask + 1])
+{
+    for (size_t i = 0; i <= m_mask; i++)
+        m_slots[i].seq.store(i, std::memory_order_relaxed);
+}
+
+size_t BCLog::LogRing::NextPowerOfTwo(size_t n)
+{
+    size_t nPower = 1;
+    while (nPower < n)
+        nPower <<= 1;
+    return nPower;
+}
+
+bool BCLog::LogRing::TryPush(std::string&& str)
+{
+    size_t pos = m_push_pos.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = m_slots[pos & m_mask];
+        const size_t seq = slot.seq.load(std::memory_order_acquire);
+        const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            // The slot is free for this position; claim it before another pusher does
+            if (m_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.str = std::move(str);
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // The slot still holds the line from one lap ago
+            return false;
+        } else {
+            pos = m_push_pos.load(std::memory_order_relaxed);
         }
     }
 }
 
+bool BCLog::LogRing::TryPop(std::string& str)
+{
+    const size_t pos = m_pop_pos.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[pos & m_mask];
+    if (slot.seq.load(std::memory_order_acquire) != pos + 1)
+        return false;
+    str = std::move(slot.str);
+    slot.str.clear();
+    m_pop_pos.store(pos + 1, std::memory_order_relaxed);
+    // Hand the slot to the pusher one lap ahead
+    slot.seq.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+void BCLog::Logger::StartAsync(size_t nCapacity)
+{
+    assert(!m_async && !m_writer.joinable());
+    m_ring.reset(new LogRing(nCapacity));
+    m_writer_stop = false;
+    m_writer = std::thread(&BCLog::Logger::ThreadWriter, this);
+    m_async = true;
+}
+
+void BCLog::Logger::StopAsync()
+{
+    if (!m_writer.joinable())
+        return;
+    m_async = false;
+    while (m_async_pushers > 0)
+        std::this_thread::yield();
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        m_writer_stop = true;
+    }
+    m_writer_cond.notify_one();
+    m_writer.join();
+}
+
+void BCLog::Logger::ThreadWriter()
+{
+    RenameThread("syscoin-logger");
+    std::string strBatch;
+    std::string str;
+    uint64_t nDroppedReported = 0;
+    while (true) {
+        strBatch.clear();
+        while (strBatch.size() < MAX_LOG_BATCH_SIZE && m_ring->TryPop(str))
+            strBatch += str;
+        const uint64_t nDropped = m_dropped;
+        if (nDropped != nDroppedReported) {
+            if (m_log_timestamps)
+                strBatch += FormatISO8601DateTime(GetTime()) + ' ';
+            strBatch += strprintf("%u log messages dropped, the log queue was full\n", nDropped - nDroppedReported);
+            nDroppedReported = nDropped;
+        }
+        if (!strBatch.empty()) {
+            WriteStr(strBatch);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_writer_mutex);
+        // Nothing is pushed any more once stopping, so an empty ring is all written out
+        if (m_writer_stop)
+            break;
+        m_writer_idle = true;
+        m_writer_cond.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_IDLE_MS));
+        m_writer_idle = false;
+    }
+}
+
 void BCLog::Logger::ShrinkDebugFile()
 {
     // Amount of debug.log to save at end when shrinking (must fit in memory)
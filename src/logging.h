@@ -10,16 +10,23 @@
 #include <tinyformat.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 static const bool DEFAULT_LOGTIMEMICROS = false;
 static const bool DEFAULT_LOGIPS        = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
 extern const char * const DEFAULT_DEBUGLOGFILE;
+// SYSCOIN
+/** Default for -logasync, the number of log lines queued for a background writer; 0 writes them on the logging thread */
+static const int64_t DEFAULT_LOGASYNC = 0;
+static const int64_t MAX_LOGASYNC = 1 << 20;
 
 extern bool fLogIPs;
 
@@ -64,6 +71,39 @@ namespace BCLog {
         ALL         = ~(uint32_t)0,
     };
 
+    // SYSCOIN
+    /**
+     * A bounded queue of log lines that any number of threads push to without
+     * taking a lock, and that one thread pops from. Every slot carries a
+     * sequence number telling pushers and the popper whose turn it is, as in
+     * Dmitry Vyukov's bounded MPMC queue. Pushing to a full ring fails instead
+     * of waiting for room.
+     */
+    class LogRing
+    {
+    public:
+        /** nCapacity is rounded up to a power of two */
+        explicit LogRing(size_t nCapacity);
+
+        bool TryPush(std::string&& str);
+        /** Only ever called from one thread at a time */
+        bool TryPop(std::string& str);
+        size_t Capacity() const { return m_mask + 1; }
+
+    private:
+        static size_t NextPowerOfTwo(size_t n);
+
+        struct Slot {
+            std::atomic<size_t> seq;
+            std::string str;
+        };
+
+        const size_t m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+        std::atomic<size_t> m_push_pos{0};
+        std::atomic<size_t> m_pop_pos{0};
+    };
+
     class Logger
     {
     private:
@@ -71,6 +111,23 @@ namespace BCLog {
         std::mutex m_file_mutex;
         std::list<std::string> m_msgs_before_open;
 
+        // SYSCOIN
+        //! Lines go to m_ring for m_writer while set
+        std::atomic<bool> m_async{false};
+        //! Threads between checking m_async and pushing to m_ring
+        std::atomic<int> m_async_pushers{0};
+        std::unique_ptr<LogRing> m_ring;
+        std::thread m_writer;
+        std::mutex m_writer_mutex;
+        std::condition_variable m_writer_cond;
+        bool m_writer_stop = false;
+        std::atomic<bool> m_writer_idle{false};
+        std::atomic<uint64_t> m_dropped{0};
+
+        /** Write to the console and debug.log */
+        void WriteStr(const std::string& str);
+        void ThreadWriter();
+
         /**
          * m_started_new_line is a state variable that will suppress printing of
          * the timestamp when multiple calls are made that don't end in a
@@ -93,9 +150,25 @@ namespace BCLog {
         fs::path m_file_path;
         std::atomic<bool> m_reopen_file{false};
 
+        // SYSCOIN
+        ~Logger() { StopAsync(); }
+
         /** Send a string to the log output */
         void LogPrintStr(const std::string &str);
 
+        // SYSCOIN
+        /**
+         * Queue log lines in a ring of nCapacity lines for a background thread
+         * that writes them out in batches. Lines logged while the ring is full
+         * are dropped and counted, and the writer logs how many were dropped.
+         */
+        void StartAsync(size_t nCapacity);
+        /** Write out the queued lines and go back to writing on the logging thread */
+        void StopAsync();
+        bool IsAsync() const { return m_async; }
+        /** Lines dropped because the ring was full */
+        uint64_t GetDroppedCount() const { return m_dropped; }
+
         /** Returns whether logs will be written to any output */
         bool Enabled() const { return m_print_to_console || m_print_to_file; }
 
@@ -5,6 +5,7 @@
 
 #include "activemasternode.h"
 #include "consensus/validation.h"
+#include "core_memusage.h"
 #include "governance-classes.h"
 #include "masternode-payments.h"
 #include "masternode-sync.h"
@@ -14,8 +15,10 @@
 #include "netmessagemaker.h"
 #include "spork.h"
 #include "util.h"
+#include <memusage.h>
 #include <outputtype.h>
 #include <boost/lexical_cast.hpp>
+#include <univalue.h>
 // SYSCOIN
 extern void Misbehaving(NodeId nodeid, int howmuch, const std::string& message="") EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 extern std::vector<unsigned char> vchFromString(const std::string &str);
@@ -23,10 +26,6 @@ extern std::vector<unsigned char> vchFromString(const std::string &str);
 /** Object for who's going to get paid on which blocks */
 CMasternodePayments mnpayments;
 
-CCriticalSection cs_vecPayees;
-CCriticalSection cs_mapMasternodeBlocks;
-CCriticalSection cs_mapMasternodePaymentVotes;
-
 /**
 * IsBlockValueValid
 *
@@ -200,16 +199,159 @@ std::string GetRequiredPaymentsString(int nBlockHeight)
     return mnpayments.GetRequiredPaymentsString(nBlockHeight);
 }
 
+CMasternodePaymentsRing::CMasternodePaymentsRing()
+    : vecSlots(),
+      mapVotePos(),
+      nFirstHeight(0),
+      nBlocks(0)
+{}
+
+void CMasternodePaymentsRing::ClearSlot(CMasternodeBlockPayees& slot)
+{
+    for (const auto& item : slot.vecVotes) {
+        mapVotePos.erase(item.first);
+    }
+    if (!slot.vecPayees.empty()) {
+        --nBlocks;
+    }
+    // keep the allocations around, the slot is going to be reused for a later height
+    slot.vecPayees.clear();
+    slot.vecVotes.clear();
+    slot.nBlockHeight = -1;
+}
+
+void CMasternodePaymentsRing::Clear()
+{
+    for (auto& slot : vecSlots) {
+        slot.vecPayees.clear();
+        slot.vecVotes.clear();
+        slot.nBlockHeight = -1;
+    }
+    mapVotePos.clear();
+    nFirstHeight = 0;
+    nBlocks = 0;
+}
+
+void CMasternodePaymentsRing::Reserve(int nSize)
+{
+    if (nSize <= (int)vecSlots.size()) return;
+
+    // grow in steps so that a slowly growing masternode list doesn't cause a resize on every block
+    nSize = (nSize + 1023) & ~1023;
+
+    std::vector<CMasternodeBlockPayees> vecOld(nSize);
+    vecSlots.swap(vecOld);
+    for (auto& slot : vecSlots) {
+        slot.nBlockHeight = -1;
+    }
+    for (auto& slotOld : vecOld) {
+        if (slotOld.vecVotes.empty()) continue;
+        CMasternodeBlockPayees& slot = Slot(slotOld.nBlockHeight);
+        if (!slot.vecVotes.empty()) {
+            // two heights which are further apart than the old size can't both be in the window, keep the newer one
+            if (slot.nBlockHeight > slotOld.nBlockHeight) {
+                for (const auto& item : slotOld.vecVotes) {
+                    mapVotePos.erase(item.first);
+                }
+                if (!slotOld.vecPayees.empty()) --nBlocks;
+                continue;
+            }
+            ClearSlot(slot);
+        }
+        slot = std::move(slotOld);
+    }
+}
+
+void CMasternodePaymentsRing::ExpireBelow(int nHeight)
+{
+    if (nHeight <= nFirstHeight) return;
+
+    if (nHeight - nFirstHeight >= (int)vecSlots.size()) {
+        for (auto& slot : vecSlots) {
+            if (slot.nBlockHeight < nHeight) ClearSlot(slot);
+        }
+    } else {
+        for (int h = nFirstHeight; h < nHeight; ++h) {
+            CMasternodeBlockPayees& slot = Slot(h);
+            if (slot.nBlockHeight == h) ClearSlot(slot);
+        }
+    }
+    nFirstHeight = nHeight;
+}
+
+bool CMasternodePaymentsRing::AddVote(const uint256& nHash, const CMasternodePaymentVote& vote)
+{
+    if (vecSlots.empty() || vote.nBlockHeight < nFirstHeight) return false;
+
+    const auto it = mapVotePos.find(nHash);
+    if (it != mapVotePos.end()) {
+        Slot(it->second.nBlockHeight).vecVotes[it->second.nPos].second = vote;
+        return true;
+    }
+
+    CMasternodeBlockPayees& slot = Slot(vote.nBlockHeight);
+    if (slot.nBlockHeight != vote.nBlockHeight) {
+        // the slot still holds a newer height, this one is long gone
+        if (slot.nBlockHeight > vote.nBlockHeight && !slot.vecVotes.empty()) return false;
+        ClearSlot(slot);
+        slot.nBlockHeight = vote.nBlockHeight;
+    }
+
+    mapVotePos.emplace(nHash, vote_pos_t{vote.nBlockHeight, (uint32_t)slot.vecVotes.size()});
+    slot.vecVotes.emplace_back(nHash, vote);
+    return true;
+}
+
+const CMasternodePaymentVote* CMasternodePaymentsRing::GetVote(const uint256& nHash) const
+{
+    const auto it = mapVotePos.find(nHash);
+    if (it == mapVotePos.end()) return nullptr;
+    return &Slot(it->second.nBlockHeight).vecVotes[it->second.nPos].second;
+}
+
+const CMasternodeBlockPayees* CMasternodePaymentsRing::GetBlock(int nBlockHeight) const
+{
+    if (vecSlots.empty() || nBlockHeight < nFirstHeight) return nullptr;
+    const CMasternodeBlockPayees& slot = Slot(nBlockHeight);
+    if (slot.nBlockHeight != nBlockHeight || slot.vecPayees.empty()) return nullptr;
+    return &slot;
+}
+
+bool CMasternodePaymentsRing::AddPayee(const uint256& nHash)
+{
+    const auto it = mapVotePos.find(nHash);
+    if (it == mapVotePos.end()) return false;
+
+    CMasternodeBlockPayees& slot = Slot(it->second.nBlockHeight);
+    if (slot.vecPayees.empty()) ++nBlocks;
+    slot.AddPayee(slot.vecVotes[it->second.nPos].second);
+    return true;
+}
+
+size_t CMasternodePaymentsRing::DynamicMemoryUsage() const
+{
+    size_t nUsage = memusage::DynamicUsage(vecSlots) + memusage::DynamicUsage(mapVotePos);
+    for (const auto& slot : vecSlots) {
+        nUsage += memusage::DynamicUsage(slot.vecPayees) + memusage::DynamicUsage(slot.vecVotes);
+        for (const auto& payee : slot.vecPayees) {
+            nUsage += RecursiveDynamicUsage(payee.GetPayee()) + memusage::DynamicUsage(payee.GetVoteHashes());
+        }
+        for (const auto& item : slot.vecVotes) {
+            nUsage += RecursiveDynamicUsage(item.second.payee) + memusage::DynamicUsage(item.second.vchSig);
+        }
+    }
+    return nUsage;
+}
+
 void CMasternodePayments::Clear()
 {
-    LOCK2(cs_mapMasternodeBlocks, cs_mapMasternodePaymentVotes);
-    mapMasternodeBlocks.clear();
-    mapMasternodePaymentVotes.clear();
+    LOCK(cs);
+    ringVotes.Clear();
 }
 
 bool CMasternodePayments::UpdateLastVote(const CMasternodePaymentVote& vote)
 {
-    LOCK(cs_mapMasternodePaymentVotes);
+    LOCK(cs);
 
     const auto it = mapMasternodesLastVote.find(vote.masternodeOutpoint);
     if (it != mapMasternodesLastVote.end()) {
@@ -326,13 +468,21 @@ void CMasternodePayments::ProcessMessage(CNode* pfrom, const std::string& strCom
 
         // Ignore any payments messages until masternode list is synced
         if(!masternodeSync.IsMasternodeListSynced()) return;
+
+        // Check the range first, the ring only has room for the storage window
+        int nLimit = GetStorageLimit();
+        int nFirstBlock = nCachedBlockHeight - nLimit;
+        if(vote.nBlockHeight < nFirstBlock || vote.nBlockHeight > nCachedBlockHeight + MNPAYMENTS_FUTURE_BLOCKS) {
+            LogPrint(BCLog::MNPAYMENT, "MASTERNODEPAYMENTVOTE -- vote out of range: nFirstBlock=%d, nBlockHeight=%d, nHeight=%d\n", nFirstBlock, vote.nBlockHeight, nCachedBlockHeight);
+            return;
+        }
 		{
-			LOCK(cs_mapMasternodePaymentVotes);
+			LOCK(cs);
 
-			auto res = mapMasternodePaymentVotes.emplace(nHash, vote);
+			const CMasternodePaymentVote* pvote = ringVotes.GetVote(nHash);
 
 			// Avoid processing same vote multiple times if it was already verified earlier
-			if (!res.second && res.first->second.IsVerified()) {
+			if (pvote && pvote->IsVerified()) {
 				LogPrint(BCLog::MNPAYMENT, "MASTERNODEPAYMENTVOTE -- hash=%s, nBlockHeight=%d/%d vote=%s, seen\n",
 					nHash.ToString(), vote.nBlockHeight, nCachedBlockHeight, vote.ToString());
 				return;
@@ -340,13 +490,13 @@ void CMasternodePayments::ProcessMessage(CNode* pfrom, const std::string& strCom
 
 			// Mark vote as non-verified when it's seen for the first time,
 			// AddOrUpdatePaymentVote() below should take care of it if vote is actually ok
-			res.first->second.MarkAsNotVerified();
+			if (!pvote) {
+				CMasternodePaymentVote voteNotVerified(vote);
+				voteNotVerified.MarkAsNotVerified();
+				ringVotes.Reserve(nLimit + MNPAYMENTS_FUTURE_BLOCKS + 1);
+				ringVotes.AddVote(nHash, voteNotVerified);
+			}
 		}
-        int nFirstBlock = nCachedBlockHeight - GetStorageLimit();
-        if(vote.nBlockHeight < nFirstBlock || vote.nBlockHeight > nCachedBlockHeight+20) {
-            LogPrint(BCLog::MNPAYMENT, "MASTERNODEPAYMENTVOTE -- vote out of range: nFirstBlock=%d, nBlockHeight=%d, nHeight=%d\n", nFirstBlock, vote.nBlockHeight, nCachedBlockHeight);
-            return;
-        }
 
         std::string strError = "";
         if(!vote.IsValid(pfrom, nCachedBlockHeight, strError, connman)) {
@@ -437,19 +587,21 @@ bool CMasternodePaymentVote::Sign()
 
 bool CMasternodePayments::GetBlockPayee(int nBlockHeight, CScript& payeeRet) const
 {
-    auto it = mapMasternodeBlocks.find(nBlockHeight);
-    return it != mapMasternodeBlocks.end() && it->second.GetBestPayee(payeeRet);
+    LOCK(cs);
+    const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(nBlockHeight);
+    return pblockPayees && pblockPayees->GetBestPayee(payeeRet);
 }
 bool CMasternodePayments::GetBlockPayee(int nBlockHeight, CScript& payeeRet, int &nStartHeightBlock) const
 {
-	auto it = mapMasternodeBlocks.find(nBlockHeight);
-	return it != mapMasternodeBlocks.end() && it->second.GetBestPayee(payeeRet, nStartHeightBlock);
+	LOCK(cs);
+	const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(nBlockHeight);
+	return pblockPayees && pblockPayees->GetBestPayee(payeeRet, nStartHeightBlock);
 }
 // Is this masternode scheduled to get paid soon?
 // -- Only look ahead up to 8 blocks to allow for propagation of the latest 2 blocks of votes
 bool CMasternodePayments::IsScheduled(const masternode_info_t& mnInfo, int nNotBlockHeight) const
 {
-    LOCK(cs_mapMasternodeBlocks);
+    LOCK(cs);
 
     if(!masternodeSync.IsMasternodeListSynced()) return false;
 
@@ -473,15 +625,17 @@ bool CMasternodePayments::AddOrUpdatePaymentVote(const CMasternodePaymentVote& v
     if(!GetBlockHash(blockHash, vote.nBlockHeight - 101)) return false;
 
     uint256 nVoteHash = vote.GetHash();
+    int nLimit = GetStorageLimit();
 
-    if(HasVerifiedPaymentVote(nVoteHash)) return false;
-
-    LOCK2(cs_mapMasternodeBlocks, cs_mapMasternodePaymentVotes);
+    LOCK(cs);
 
-    mapMasternodePaymentVotes[nVoteHash] = vote;
+    if(HasVerifiedPaymentVote(nVoteHash)) return false;
 
-    auto it = mapMasternodeBlocks.emplace(vote.nBlockHeight, CMasternodeBlockPayees(vote.nBlockHeight)).first;
-    it->second.AddPayee(vote);
+    ringVotes.Reserve(nLimit + MNPAYMENTS_FUTURE_BLOCKS + 1);
+    if(!ringVotes.AddVote(nVoteHash, vote) || !ringVotes.AddPayee(nVoteHash)) {
+        LogPrint(BCLog::MNPAYMENT, "CMasternodePayments::AddOrUpdatePaymentVote -- expired height, hash=%s, nBlockHeight=%d\n", nVoteHash.ToString(), vote.nBlockHeight);
+        return false;
+    }
 
     LogPrint(BCLog::MNPAYMENT, "CMasternodePayments::AddOrUpdatePaymentVote -- added, hash=%s\n", nVoteHash.ToString());
 
@@ -490,15 +644,55 @@ bool CMasternodePayments::AddOrUpdatePaymentVote(const CMasternodePaymentVote& v
 
 bool CMasternodePayments::HasVerifiedPaymentVote(const uint256& hashIn) const
 {
-    LOCK(cs_mapMasternodePaymentVotes);
-    const auto it = mapMasternodePaymentVotes.find(hashIn);
-    return it != mapMasternodePaymentVotes.end() && it->second.IsVerified();
+    LOCK(cs);
+    const CMasternodePaymentVote* pvote = ringVotes.GetVote(hashIn);
+    return pvote && pvote->IsVerified();
 }
 
-void CMasternodeBlockPayees::AddPayee(const CMasternodePaymentVote& vote)
+bool CMasternodePayments::HasPaymentVote(const uint256& hashIn) const
 {
-    LOCK(cs_vecPayees);
+    LOCK(cs);
+    return ringVotes.HasVote(hashIn);
+}
 
+bool CMasternodePayments::GetPaymentVote(const uint256& hashIn, CMasternodePaymentVote& voteRet) const
+{
+    LOCK(cs);
+    const CMasternodePaymentVote* pvote = ringVotes.GetVote(hashIn);
+    if (!pvote) return false;
+    voteRet = *pvote;
+    return true;
+}
+
+bool CMasternodePayments::HasPaymentBlock(int nBlockHeight) const
+{
+    LOCK(cs);
+    return ringVotes.GetBlock(nBlockHeight) != nullptr;
+}
+
+std::vector<CMasternodePaymentVote> CMasternodePayments::GetVerifiedBlockVotes(int nBlockHeight) const
+{
+    LOCK(cs);
+    std::vector<CMasternodePaymentVote> vecVotes;
+    const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(nBlockHeight);
+    if (!pblockPayees) return vecVotes;
+    for (const auto& item : pblockPayees->vecVotes) {
+        if (item.second.IsVerified()) {
+            vecVotes.push_back(item.second);
+        }
+    }
+    return vecVotes;
+}
+
+bool CMasternodePayments::HasPayeeWithVotes(int nBlockHeight, const CScript& payeeIn, int nVotesReq, CMasternodePayee& payeeRet) const
+{
+    LOCK(cs);
+    const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(nBlockHeight);
+    return pblockPayees && pblockPayees->HasPayeeWithVotes(payeeIn, nVotesReq, payeeRet);
+}
+
+void CMasternodeBlockPayees::AddPayee(const CMasternodePaymentVote& vote)
+{
     uint256 nVoteHash = vote.GetHash();
 
     for (auto& payee : vecPayees) {
@@ -513,8 +707,6 @@ void CMasternodeBlockPayees::AddPayee(const CMasternodePaymentVote& vote)
 
 bool CMasternodeBlockPayees::GetBestPayee(CScript& payeeRet) const
 {
-    LOCK(cs_vecPayees);
-
     if(vecPayees.empty()) {
         LogPrint(BCLog::MNPAYMENT, "CMasternodeBlockPayees::GetBestPayee -- ERROR: couldn't find any payee\n");
         return false;
@@ -532,8 +724,6 @@ bool CMasternodeBlockPayees::GetBestPayee(CScript& payeeRet) const
 }
 bool CMasternodeBlockPayees::GetBestPayee(CScript& payeeRet, int& nStartHeightBlock) const
 {
-	LOCK(cs_vecPayees);
-
 	if (vecPayees.empty()) {
 		LogPrint(BCLog::MNPAYMENT, "CMasternodeBlockPayees::GetBestPayee -- ERROR: couldn't find any payee\n");
 		return false;
@@ -552,8 +742,6 @@ bool CMasternodeBlockPayees::GetBestPayee(CScript& payeeRet, int& nStartHeightBl
 }
 bool CMasternodeBlockPayees::HasPayeeWithVotes(const CScript& payeeIn, int nVotesReq, CMasternodePayee& payeeOut) const
 {
-    LOCK(cs_vecPayees);
-
     for (const auto& payee : vecPayees) {
         if (payee.GetVoteCount() >= nVotesReq && payee.GetPayee() == payeeIn) {
 			payeeOut = payee;
@@ -567,7 +755,6 @@ bool CMasternodeBlockPayees::HasPayeeWithVotes(const CScript& payeeIn, int nVote
 
 bool CMasternodeBlockPayees::IsTransactionValid(const CTransaction& txNew, const int64_t &nHeight, const CAmount& fee, CAmount& nTotalRewardWithMasternodes) const
 {
-    LOCK(cs_vecPayees);
 	const CAmount& nHalfFee = fee / 2;
     int nMaxSignatures = 0;
     std::string strPayeesPossible = "";
@@ -624,8 +811,6 @@ bool CMasternodeBlockPayees::IsTransactionValid(const CTransaction& txNew, const
 
 std::string CMasternodeBlockPayees::GetRequiredPaymentsString() const
 {
-    LOCK(cs_vecPayees);
-
     std::string strRequiredPayments = "";
 
     for (const auto& payee : vecPayees)
@@ -647,23 +832,23 @@ std::string CMasternodeBlockPayees::GetRequiredPaymentsString() const
 
 std::string CMasternodePayments::GetRequiredPaymentsString(int nBlockHeight) const
 {
-    LOCK(cs_mapMasternodeBlocks);
+    LOCK(cs);
 
-    const auto it = mapMasternodeBlocks.find(nBlockHeight);
-    return it == mapMasternodeBlocks.end() ? "Unknown" : it->second.GetRequiredPaymentsString();
+    const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(nBlockHeight);
+    return pblockPayees ? pblockPayees->GetRequiredPaymentsString() : "Unknown";
 }
 
 bool CMasternodePayments::IsTransactionValid(const CTransaction& txNew, int nBlockHeight, const CAmount& fee, CAmount& nTotalRewardWithMasternodes) const
 {
-    LOCK(cs_mapMasternodeBlocks);
+    LOCK(cs);
 
-    const auto it = mapMasternodeBlocks.find(nBlockHeight);
-	if (it == mapMasternodeBlocks.end()) {
+    const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(nBlockHeight);
+	if (!pblockPayees) {
 		nTotalRewardWithMasternodes = txNew.GetValueOut();
 		return true;
 	}
 	else {
-		return it->second.IsTransactionValid(txNew, nBlockHeight, fee, nTotalRewardWithMasternodes);
+		return pblockPayees->IsTransactionValid(txNew, nBlockHeight, fee, nTotalRewardWithMasternodes);
 	}
 }
 
@@ -671,22 +856,15 @@ void CMasternodePayments::CheckAndRemove()
 {
     if(!masternodeSync.IsBlockchainSynced()) return;
 
-    LOCK2(cs_mapMasternodeBlocks, cs_mapMasternodePaymentVotes);
-
     int nLimit = GetStorageLimit();
 
-    std::map<uint256, CMasternodePaymentVote>::iterator it = mapMasternodePaymentVotes.begin();
-    while(it != mapMasternodePaymentVotes.end()) {
-        CMasternodePaymentVote vote = (*it).second;
+    LOCK(cs);
+
+    // the window only ever moves forward, expiring a height just frees its slot
+    LogPrint(BCLog::MNPAYMENT, "CMasternodePayments::CheckAndRemove -- Removing Masternode payments below nBlockHeight=%d\n", nCachedBlockHeight - nLimit);
+    ringVotes.ExpireBelow(nCachedBlockHeight - nLimit);
+    ringVotes.Reserve(nLimit + MNPAYMENTS_FUTURE_BLOCKS + 1);
 
-        if(nCachedBlockHeight - vote.nBlockHeight > nLimit) {
-            LogPrint(BCLog::MNPAYMENT, "CMasternodePayments::CheckAndRemove -- Removing old Masternode payment: nBlockHeight=%d\n", vote.nBlockHeight);
-            mapMasternodePaymentVotes.erase(it++);
-            mapMasternodeBlocks.erase(vote.nBlockHeight);
-        } else {
-            ++it;
-        }
-    }
     LogPrint(BCLog::MNPAYMENT, "CMasternodePayments::CheckAndRemove -- %s\n", ToString());
 }
 
@@ -826,25 +1004,26 @@ void CMasternodePayments::CheckBlockVotes(int nBlockHeight)
 
     debugStr += strprintf("CMasternodePayments::CheckBlockVotes -- nBlockHeight=%d,\n  Expected voting MNs:\n", nBlockHeight);
 
-    LOCK2(cs_mapMasternodeBlocks, cs_mapMasternodePaymentVotes);
+    LOCK(cs);
+
+    const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(nBlockHeight);
 
     int i{0};
     for (const auto& mn : mns) {
         CScript payee;
         bool found = false;
 
-        const auto it = mapMasternodeBlocks.find(nBlockHeight);
-        if (it != mapMasternodeBlocks.end()) {
-            for (const auto& p : it->second.vecPayees) {
+        if (pblockPayees) {
+            for (const auto& p : pblockPayees->vecPayees) {
                 for (const auto& voteHash : p.GetVoteHashes()) {
-                    const auto itVote = mapMasternodePaymentVotes.find(voteHash);
-                    if (itVote == mapMasternodePaymentVotes.end()) {
+                    const CMasternodePaymentVote* pvote = ringVotes.GetVote(voteHash);
+                    if (!pvote) {
                         debugStr += strprintf("    - could not find vote %s\n",
                                               voteHash.ToString());
                         continue;
                     }
-                    if (itVote->second.masternodeOutpoint == mn.second.outpoint) {
-                        payee = itVote->second.payee;
+                    if (pvote->masternodeOutpoint == mn.second.outpoint) {
+                        payee = pvote->payee;
                         found = true;
                         break;
                     }
@@ -934,18 +1113,17 @@ std::string CMasternodePaymentVote::ToString() const
 // Send only votes for future blocks, node should request every other missing payment block individually
 void CMasternodePayments::Sync(CNode* pnode, CConnman& connman) const
 {
-    LOCK(cs_mapMasternodeBlocks);
+    LOCK(cs);
 
     if(!masternodeSync.IsWinnersListSynced()) return;
 
     int nInvCount = 0;
 
-    for(int h = nCachedBlockHeight; h < nCachedBlockHeight + 20; h++) {
-        const auto it = mapMasternodeBlocks.find(h);
-        if(it != mapMasternodeBlocks.end()) {
-            for (const auto& payee : it->second.vecPayees) {
-                std::vector<uint256> vecVoteHashes = payee.GetVoteHashes();
-                for (const auto& hash : vecVoteHashes) {
+    for(int h = nCachedBlockHeight; h < nCachedBlockHeight + MNPAYMENTS_FUTURE_BLOCKS; h++) {
+        const CMasternodeBlockPayees* pblockPayees = ringVotes.GetBlock(h);
+        if(pblockPayees) {
+            for (const auto& payee : pblockPayees->vecPayees) {
+                for (const auto& hash : payee.GetVoteHashes()) {
                     if(!HasVerifiedPaymentVote(hash)) continue;
                     pnode->PushInventory(CInv(MSG_MASTERNODE_PAYMENT_VOTE, hash));
                     nInvCount++;
@@ -965,16 +1143,16 @@ void CMasternodePayments::RequestLowDataPaymentBlocks(CNode* pnode, CConnman& co
     if(!masternodeSync.IsMasternodeListSynced()) return;
 
     CNetMsgMaker msgMaker(pnode->GetSendVersion());
-    LOCK2(cs_main, cs_mapMasternodeBlocks);
+    int nLimit = GetStorageLimit();
+
+    LOCK2(cs_main, cs);
 
     std::vector<CInv> vToFetch;
-    int nLimit = GetStorageLimit();
 
     const CBlockIndex *pindex = chainActive.Tip();
 
     while(nCachedBlockHeight - pindex->nHeight < nLimit) {
-        const auto it = mapMasternodeBlocks.find(pindex->nHeight);
-        if(it == mapMasternodeBlocks.end()) {
+        if(!ringVotes.GetBlock(pindex->nHeight)) {
             // We have no idea about this block height, let's ask
             vToFetch.push_back(CInv(MSG_MASTERNODE_PAYMENT_BLOCK, pindex->GetBlockHash()));
             // We should not violate GETDATA rules
@@ -989,11 +1167,11 @@ void CMasternodePayments::RequestLowDataPaymentBlocks(CNode* pnode, CConnman& co
         pindex = pindex->pprev;
     }
 
-    for (auto& mnBlockPayees : mapMasternodeBlocks) {
-        int nBlockHeight = mnBlockPayees.first;
+    ringVotes.ForEachBlock([&](const CMasternodeBlockPayees& mnBlockPayees) {
+        int nBlockHeight = mnBlockPayees.nBlockHeight;
         int nTotalVotes = 0;
         bool fFound = false;
-        for (const auto& payee : mnBlockPayees.second.vecPayees) {
+        for (const auto& payee : mnBlockPayees.vecPayees) {
             if(payee.GetVoteCount() >= MNPAYMENTS_SIGNATURES_REQUIRED) {
                 fFound = true;
                 break;
@@ -1004,12 +1182,12 @@ void CMasternodePayments::RequestLowDataPaymentBlocks(CNode* pnode, CConnman& co
         // or no clear winner was found but there are at least avg number of votes
         if(fFound || nTotalVotes >= (MNPAYMENTS_SIGNATURES_TOTAL + MNPAYMENTS_SIGNATURES_REQUIRED)/2) {
             // so just move to the next block
-            continue;
+            return;
         }
         // DEBUG
         DBG (
             // Let's see why this failed
-            for (const auto& payee : mnBlockPayees.second.vecPayees) {
+            for (const auto& payee : mnBlockPayees.vecPayees) {
                 CTxDestination address1;
                 ExtractDestination(payee.GetPayee(), address1);
                 printf("payee %s votes %d\n", EncodeDestination(address1).c_str(), payee.GetVoteCount());
@@ -1029,7 +1207,7 @@ void CMasternodePayments::RequestLowDataPaymentBlocks(CNode* pnode, CConnman& co
             // Start filling new batch
             vToFetch.clear();
         }
-    }
+    });
     // Ask for the rest of it
     if(!vToFetch.empty()) {
         LogPrint(BCLog::MNPAYMENT, "CMasternodePayments::RequestLowDataPaymentBlocks -- asking peer=%d for %d payment blocks\n", pnode->GetId(), vToFetch.size());
@@ -1041,12 +1219,25 @@ std::string CMasternodePayments::ToString() const
 {
     std::ostringstream info;
 
-    info << "Votes: " << (int)mapMasternodePaymentVotes.size() <<
-            ", Blocks: " << (int)mapMasternodeBlocks.size();
+    info << "Votes: " << GetVoteCount() <<
+            ", Blocks: " << GetBlockCount();
 
     return info.str();
 }
 
+UniValue CMasternodePayments::GetMemoryInfo() const
+{
+    LOCK(cs);
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("heights", ringVotes.Capacity());
+    obj.pushKV("firstheight", ringVotes.GetFirstHeight());
+    obj.pushKV("blocks", ringVotes.GetBlockCount());
+    obj.pushKV("votes", ringVotes.GetVoteCount());
+    obj.pushKV("usage", (uint64_t)ringVotes.DynamicMemoryUsage());
+    return obj;
+}
+
 bool CMasternodePayments::IsEnoughData() const
 {
     float nAverageVotes = (MNPAYMENTS_SIGNATURES_TOTAL + MNPAYMENTS_SIGNATURES_REQUIRED) / 2;
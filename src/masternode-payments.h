@@ -11,14 +11,19 @@
 #include "key.h"
 #include "masternode.h"
 #include "net_processing.h"
+#include "txmempool.h"
 #include "utilstrencodings.h"
 
+#include <unordered_map>
+
 class CMasternodePayments;
 class CMasternodePaymentVote;
 class CMasternodeBlockPayees;
 
 static const int MNPAYMENTS_SIGNATURES_REQUIRED         = 6;
 static const int MNPAYMENTS_SIGNATURES_TOTAL            = 10;
+// votes are accepted for blocks up to this far ahead of the tip
+static const int MNPAYMENTS_FUTURE_BLOCKS               = 20;
 
 //! minimum peer version that can receive and send masternode payment messages,
 //  vote for masternode and be elected as a payment winner
@@ -27,10 +32,6 @@ static const int MNPAYMENTS_SIGNATURES_TOTAL            = 10;
 static const int MIN_MASTERNODE_PAYMENT_PROTO_VERSION_1 = 70206;
 static const int MIN_MASTERNODE_PAYMENT_PROTO_VERSION_2 = MIN_PEER_PROTO_VERSION;
 
-extern CCriticalSection cs_vecPayees;
-extern CCriticalSection cs_mapMasternodeBlocks;
-extern CCriticalSection cs_mapMasternodePayeeVotes;
-
 extern CMasternodePayments mnpayments;
 
 /// TODO: all 4 functions do not belong here really, they should be refactored/moved somewhere (main.cpp ?)
@@ -72,7 +73,7 @@ public:
     CScript GetPayee() const { return scriptPubKey; }
 
     void AddVoteHash(uint256 hashIn) { vecVoteHashes.push_back(hashIn); }
-    std::vector<uint256> GetVoteHashes() const { return vecVoteHashes; }
+    const std::vector<uint256>& GetVoteHashes() const { return vecVoteHashes; }
     int GetVoteCount() const { return vecVoteHashes.size(); }
 };
 
@@ -82,14 +83,18 @@ class CMasternodeBlockPayees
 public:
     int nBlockHeight;
     std::vector<CMasternodePayee> vecPayees;
+    // Memory only. All votes for this height and their hashes, including the ones not verified yet
+    std::vector<std::pair<uint256, CMasternodePaymentVote> > vecVotes;
 
     CMasternodeBlockPayees() :
         nBlockHeight(0),
-        vecPayees()
+        vecPayees(),
+        vecVotes()
         {}
     CMasternodeBlockPayees(int nBlockHeightIn) :
         nBlockHeight(nBlockHeightIn),
-        vecPayees()
+        vecPayees(),
+        vecVotes()
         {}
 
     ADD_SERIALIZE_METHODS;
@@ -167,6 +172,110 @@ public:
     std::string ToString() const;
 };
 
+/**
+ * Payment votes and payees for a window of block heights.
+ *
+ * Every height owns the slot at nBlockHeight % size of a ring, so the window
+ * moves forward by reusing the slot of a height which fell out of it, no
+ * per-vote bookkeeping is needed for expiry. Votes are kept next to the payees
+ * of their height and are found by hash through a single flat index.
+ */
+class CMasternodePaymentsRing
+{
+private:
+    struct vote_pos_t {
+        int nBlockHeight;
+        uint32_t nPos;
+    };
+
+    typedef std::unordered_map<uint256, vote_pos_t, SaltedTxidHasher> vote_pos_m_t;
+
+    std::vector<CMasternodeBlockPayees> vecSlots;
+    vote_pos_m_t mapVotePos;
+    // heights below this one were expired and are not accepted anymore
+    int nFirstHeight;
+    int nBlocks;
+
+    CMasternodeBlockPayees& Slot(int nBlockHeight) { return vecSlots[nBlockHeight % vecSlots.size()]; }
+    const CMasternodeBlockPayees& Slot(int nBlockHeight) const { return vecSlots[nBlockHeight % vecSlots.size()]; }
+
+    void ClearSlot(CMasternodeBlockPayees& slot);
+
+public:
+    CMasternodePaymentsRing();
+
+    void Clear();
+
+    /// Make room for at least nSize consecutive heights, existing data is kept
+    void Reserve(int nSize);
+    int Capacity() const { return vecSlots.size(); }
+    int GetFirstHeight() const { return nFirstHeight; }
+
+    /// Drop all heights below nHeight
+    void ExpireBelow(int nHeight);
+
+    /// Store the vote or replace the stored one with the same hash, false if its height is out of the window
+    bool AddVote(const uint256& nHash, const CMasternodePaymentVote& vote);
+    const CMasternodePaymentVote* GetVote(const uint256& nHash) const;
+    bool HasVote(const uint256& nHash) const { return mapVotePos.count(nHash) != 0; }
+
+    /// Returns the payees of a height, nullptr if we have none for it
+    const CMasternodeBlockPayees* GetBlock(int nBlockHeight) const;
+    /// Add a payee for a stored vote, false if the vote is unknown
+    bool AddPayee(const uint256& nHash);
+
+    template <typename Callable>
+    void ForEachBlock(Callable&& func) const
+    {
+        for (const auto& slot : vecSlots) {
+            if (!slot.vecPayees.empty()) func(slot);
+        }
+    }
+
+    int GetBlockCount() const { return nBlocks; }
+    int GetVoteCount() const { return mapVotePos.size(); }
+    size_t DynamicMemoryUsage() const;
+
+    // Uses the format of the std::map based storage it replaced:
+    // map<vote hash, vote> followed by map<height, payees>
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        WriteCompactSize(s, mapVotePos.size());
+        for (const auto& slot : vecSlots) {
+            for (const auto& item : slot.vecVotes) {
+                s << item.first << item.second;
+            }
+        }
+        WriteCompactSize(s, nBlocks);
+        ForEachBlock([&s](const CMasternodeBlockPayees& slot) {
+            s << slot.nBlockHeight << slot;
+        });
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        Clear();
+        for (uint64_t i = 0, nSize = ReadCompactSize(s); i < nSize; ++i) {
+            uint256 nHash;
+            CMasternodePaymentVote vote;
+            s >> nHash >> vote;
+            AddVote(nHash, vote);
+        }
+        for (uint64_t i = 0, nSize = ReadCompactSize(s); i < nSize; ++i) {
+            int nBlockHeight;
+            CMasternodeBlockPayees blockPayees;
+            s >> nBlockHeight >> blockPayees;
+            for (const auto& payee : blockPayees.vecPayees) {
+                for (const auto& nHash : payee.GetVoteHashes()) {
+                    AddPayee(nHash);
+                }
+            }
+        }
+    }
+};
+
 //
 // Masternode Payments Class
 // Keeps track of who should get paid for which blocks
@@ -183,26 +292,43 @@ private:
     // Keep track of current block height
     int nCachedBlockHeight;
 
+    // protects votes and payees
+    mutable CCriticalSection cs;
+
+    CMasternodePaymentsRing ringVotes;
+
 public:
-    std::map<uint256, CMasternodePaymentVote> mapMasternodePaymentVotes;
-    std::map<int, CMasternodeBlockPayees> mapMasternodeBlocks;
     std::map<COutPoint, int> mapMasternodesLastVote;
     std::map<COutPoint, int> mapMasternodesDidNotVote;
 
-    CMasternodePayments() : nStorageCoeff(1.25), nMinBlocksToStore(5000) {}
+    CMasternodePayments() : nStorageCoeff(1.25), nMinBlocksToStore(5000), nCachedBlockHeight(0) {}
 
-    ADD_SERIALIZE_METHODS;
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        // cache may be dumped from the scheduler thread while votes are being processed
+        LOCK(cs);
+        s << ringVotes;
+    }
 
-    template <typename Stream, typename Operation>
-    inline void SerializationOp(Stream& s, Operation ser_action) {
-        READWRITE(mapMasternodePaymentVotes);
-        READWRITE(mapMasternodeBlocks);
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        int nLimit = GetStorageLimit();
+        LOCK(cs);
+        ringVotes.Reserve(nLimit + MNPAYMENTS_FUTURE_BLOCKS + 1);
+        s >> ringVotes;
     }
 
     void Clear();
 
     bool AddOrUpdatePaymentVote(const CMasternodePaymentVote& vote);
     bool HasVerifiedPaymentVote(const uint256& hashIn) const;
+    bool HasPaymentVote(const uint256& hashIn) const;
+    bool GetPaymentVote(const uint256& hashIn, CMasternodePaymentVote& voteRet) const;
+    bool HasPaymentBlock(int nBlockHeight) const;
+    std::vector<CMasternodePaymentVote> GetVerifiedBlockVotes(int nBlockHeight) const;
+    bool HasPayeeWithVotes(int nBlockHeight, const CScript& payeeIn, int nVotesReq, CMasternodePayee& payeeRet) const;
     bool ProcessBlock(int nBlockHeight, CConnman& connman);
     void CheckBlockVotes(int nBlockHeight);
 
@@ -223,8 +349,9 @@ public:
     void FillBlockPayee(CMutableTransaction& txNew, int nBlockHeight, CAmount &blockReward, CAmount &fees,  CTxOut& txoutMasternodeRet) const;
     std::string ToString() const;
 
-    int GetBlockCount() const { return mapMasternodeBlocks.size(); }
-    int GetVoteCount() const { return mapMasternodePaymentVotes.size(); }
+    int GetBlockCount() const { LOCK(cs); return ringVotes.GetBlockCount(); }
+    int GetVoteCount() const { LOCK(cs); return ringVotes.GetVoteCount(); }
+    UniValue GetMemoryInfo() const;
 
     bool IsEnoughData() const;
     int GetStorageLimit() const;
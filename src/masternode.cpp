@@ -322,12 +322,10 @@ void CMasternode::UpdateLastPaid(const CBlockIndex *pindex, int nMaxBlocksToScan
     CScript mnpayee = GetScriptForDestination(GetDestinationForKey(pubKeyCollateralAddress, OutputType::BECH32));
     // LogPrint(BCLog::MNPAYMENT, "CMasternode::UpdateLastPaidBlock -- searching for block with payment to %s\n", outpoint.ToStringShort());
 
-    LOCK(cs_mapMasternodeBlocks);
 	CMasternodePayee payee;
 	CAmount nTotal;
     for (int i = 0; BlockReading && BlockReading->nHeight > nBlockLastPaid && i < nMaxBlocksToScanBack; i++) {
-        if(mnpayments.mapMasternodeBlocks.count(BlockReading->nHeight) &&
-            mnpayments.mapMasternodeBlocks[BlockReading->nHeight].HasPayeeWithVotes(mnpayee, 2, payee))
+        if(mnpayments.HasPayeeWithVotes(BlockReading->nHeight, mnpayee, 2, payee))
         {
             CBlock block;
 			if (!ReadBlockFromDisk(block, BlockReading, Params().GetConsensus())) {
@@ -4,12 +4,94 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "base58.h"
+#include "checkqueue.h"
+#include "crypto/sha256.h"
+#include "cuckoocache.h"
 #include "hash.h"
-#include "validation.h" // For strMessageMagic
+#include "random.h"
+#include "script/sigcache.h" // For SignatureCacheHasher
+#include "util.h"
+#include "validation.h" // For strMessageMagic and nScriptCheckThreads
 #include "messagesigner.h"
 #include "tinyformat.h"
 #include "utilstrencodings.h"
 #include <key_io.h>
+
+#include <boost/thread.hpp>
+
+namespace {
+/**
+ * Cache of valid masternode/governance message signatures, so that objects
+ * which are relayed to us several times (or were verified ahead of time by
+ * CHashSigner::PreVerifyHashes) are not checked with ECDSA recovery again.
+ */
+class CMessageSignatureCache
+{
+private:
+    //! Entries are SHA256(nonce || signature hash || key id || signature)
+    uint256 nonce;
+    CuckooCache::cache<uint256, SignatureCacheHasher> setValid;
+    boost::shared_mutex cs_msgsigcache;
+    bool fSetup;
+
+public:
+    CMessageSignatureCache() : fSetup(false)
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    void ComputeEntry(uint256& entry, const uint256& hash, const CKeyID& keyID, const std::vector<unsigned char>& vchSig)
+    {
+        CSHA256().Write(nonce.begin(), 32).Write(hash.begin(), 32).Write(keyID.begin(), keyID.size()).Write(vchSig.data(), vchSig.size()).Finalize(entry.begin());
+    }
+
+    bool Get(const uint256& entry)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs_msgsigcache);
+        return fSetup && setValid.contains(entry, false);
+    }
+
+    void Set(uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_msgsigcache);
+        if (fSetup)
+            setValid.insert(entry);
+    }
+
+    uint32_t setup_bytes(size_t n)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs_msgsigcache);
+        fSetup = true;
+        return setValid.setup_bytes(n);
+    }
+};
+
+static CMessageSignatureCache messageSignatureCache;
+static CCheckQueue<CHashSignerCheck> messagesigcheckqueue(16);
+} // namespace
+
+void InitMessageSignatureCache()
+{
+    size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxmsgsigcachesize", DEFAULT_MAX_MSG_SIG_CACHE_SIZE)), MAX_MAX_MSG_SIG_CACHE_SIZE) * ((size_t) 1 << 20);
+    size_t nElems = messageSignatureCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for message signature cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
+void SetMessageSigCheckExecutor(CExecutor* executor, int nHelpers)
+{
+    messagesigcheckqueue.SetExecutor(executor, TaskClass::MEMPOOL, nHelpers);
+}
+
+bool CHashSignerCheck::operator()()
+{
+    // The outcome is only recorded in the signature cache: an invalid signature
+    // must not stop the queue from verifying the rest of the batch, the message
+    // carrying it is rejected when it is processed.
+    std::string strError;
+    CHashSigner::VerifyHash(hash, keyID, vchSig, strError);
+    return true;
+}
 bool CMessageSigner::GetKeysFromSecret(const std::string& strSecret, CKey& keyRet, CPubKey& pubkeyRet)
 {
     keyRet = DecodeSecret(strSecret);
@@ -52,6 +134,11 @@ bool CHashSigner::VerifyHash(const uint256& hash, const CPubKey& pubkey, const s
 
 bool CHashSigner::VerifyHash(const uint256& hash, const CKeyID& keyID, const std::vector<unsigned char>& vchSig, std::string& strErrorRet)
 {
+    uint256 entry;
+    messageSignatureCache.ComputeEntry(entry, hash, keyID, vchSig);
+    if (messageSignatureCache.Get(entry))
+        return true;
+
     CPubKey pubkeyFromSig;
     if(!pubkeyFromSig.RecoverCompact(hash, vchSig)) {
         strErrorRet = "Error recovering public key.";
@@ -65,5 +152,20 @@ bool CHashSigner::VerifyHash(const uint256& hash, const CKeyID& keyID, const std
         return false;
     }
 
+    messageSignatureCache.Set(entry);
     return true;
 }
+
+void CHashSigner::PreVerifyHashes(std::vector<CHashSignerCheck>& vChecks)
+{
+    // Without worker threads the signatures are simply checked when their messages are processed
+    if (nScriptCheckThreads == 0 || vChecks.size() < 2) {
+        vChecks.clear();
+        return;
+    }
+
+    CCheckQueueControl<CHashSignerCheck> control(&messagesigcheckqueue);
+    control.Add(vChecks);
+    vChecks.clear();
+    control.Wait();
+}
@@ -8,6 +8,13 @@
 
 #include "key.h"
 
+#include <vector>
+
+//! Default size of the verified message signature cache in MiB
+static const unsigned int DEFAULT_MAX_MSG_SIG_CACHE_SIZE = 16;
+//! Maximum size of the verified message signature cache in MiB
+static const int64_t MAX_MAX_MSG_SIG_CACHE_SIZE = 1024;
+
 /** Helper class for signing messages and checking their signatures
  */
 class CMessageSigner
@@ -23,6 +30,9 @@ public:
     static bool VerifyMessage(const CKeyID& keyID, const std::vector<unsigned char>& vchSig, const std::string& strMessage, std::string& strErrorRet);
 };
 
+class CExecutor;
+class CHashSignerCheck;
+
 /** Helper class for signing hashes and checking their signatures
  */
 class CHashSigner
@@ -34,6 +44,39 @@ public:
     static bool VerifyHash(const uint256& hash, const CPubKey& pubkey, const std::vector<unsigned char>& vchSig, std::string& strErrorRet);
     /// Verify the hash signature, returns true if succcessful
     static bool VerifyHash(const uint256& hash, const CKeyID& keyID, const std::vector<unsigned char>& vchSig, std::string& strErrorRet);
+    /// Verify a batch of hash signatures in parallel on the message signature check threads.
+    /// Valid signatures are added to the signature cache, so that the VerifyHash() calls made
+    /// when their messages are processed later are cache hits.
+    static void PreVerifyHashes(std::vector<CHashSignerCheck>& vChecks);
+};
+
+/** Closure representing one hash signature verification, see CHashSigner::PreVerifyHashes
+ */
+class CHashSignerCheck
+{
+private:
+    uint256 hash;
+    CKeyID keyID;
+    std::vector<unsigned char> vchSig;
+
+public:
+    CHashSignerCheck() {}
+    CHashSignerCheck(const uint256& hashIn, const CKeyID& keyIDIn, const std::vector<unsigned char>& vchSigIn) :
+        hash(hashIn), keyID(keyIDIn), vchSig(vchSigIn) {}
+
+    bool operator()();
+
+    void swap(CHashSignerCheck& check)
+    {
+        std::swap(hash, check.hash);
+        std::swap(keyID, check.keyID);
+        vchSig.swap(check.vchSig);
+    }
 };
 
+/// Initialize the cache of verified masternode/governance message signatures
+void InitMessageSignatureCache();
+/// Verify batches queued by CHashSigner::PreVerifyHashes on an executor, with up to nHelpers threads helping the caller
+void SetMessageSigCheckExecutor(CExecutor* executor, int nHelpers);
+
 #endif
@@ -24,6 +24,7 @@
 #include <string.h>
 #else
 #include <fcntl.h>
+#include <sys/uio.h>
 #endif
 
 #ifdef USE_UPNP
@@ -54,6 +55,12 @@
 #define MSG_DONTWAIT 0
 #endif
 
+// SYSCOIN
+/** Payload still to come from which on it is received straight into its message instead of through the socket handler's buffer */
+static const unsigned int MIN_DIRECT_RECV_SIZE = 16 * 1024;
+/** Upper bound on the buffers handed to one sendmsg() */
+static const int MAX_SEND_BUFFERS = 64;
+
 // Fix for ancient MinGW versions, that don't have defined these in ws2tcpip.h.
 // Todo: Can be removed when our pull-tester is upgraded to a modern MinGW version.
 #ifdef WIN32
@@ -775,16 +782,7 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete
         nBytes -= handled;
 
         if (msg.complete()) {
-
-            //store received bytes per message command
-            //to prevent a memory DOS, only allow valid commands
-            mapMsgCmdSize::iterator i = mapRecvBytesPerMsgCmd.find(msg.hdr.pchCommand);
-            if (i == mapRecvBytesPerMsgCmd.end())
-                i = mapRecvBytesPerMsgCmd.find(NET_MESSAGE_COMMAND_OTHER);
-            assert(i != mapRecvBytesPerMsgCmd.end());
-            i->second += msg.hdr.nMessageSize + CMessageHeader::HEADER_SIZE;
-
-            msg.nTime = nTimeMicros;
+            MessageComplete(msg, nTimeMicros);
             complete = true;
         }
     }
@@ -792,6 +790,44 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete
     return true;
 }
 
+// SYSCOIN
+char* CNode::GetRecvDataSpace(unsigned int& nSpace)
+{
+    LOCK(cs_vRecv);
+    if (vRecvMsg.empty() || !vRecvMsg.back().in_data || vRecvMsg.back().complete())
+        return nullptr;
+    return vRecvMsg.back().getDataSpace(nSpace);
+}
+
+void CNode::ReceivedDataBytes(unsigned int nBytes, bool& complete)
+{
+    complete = false;
+    int64_t nTimeMicros = GetTimeMicros();
+    LOCK(cs_vRecv);
+    nLastRecv = nTimeMicros / 1000000;
+    nRecvBytes += nBytes;
+    CNetMessage& msg = vRecvMsg.back();
+    msg.dataWritten(nBytes);
+    if (msg.complete()) {
+        MessageComplete(msg, nTimeMicros);
+        complete = true;
+    }
+}
+
+// requires LOCK(cs_vRecv)
+void CNode::MessageComplete(CNetMessage& msg, int64_t nTimeMicros)
+{
+    //store received bytes per message command
+    //to prevent a memory DOS, only allow valid commands
+    mapMsgCmdSize::iterator i = mapRecvBytesPerMsgCmd.find(msg.hdr.pchCommand);
+    if (i == mapRecvBytesPerMsgCmd.end())
+        i = mapRecvBytesPerMsgCmd.find(NET_MESSAGE_COMMAND_OTHER);
+    assert(i != mapRecvBytesPerMsgCmd.end());
+    i->second += msg.hdr.nMessageSize + CMessageHeader::HEADER_SIZE;
+
+    msg.nTime = nTimeMicros;
+}
+
 void CNode::SetSendVersion(int nVersionIn)
 {
     // Send version may only be changed in the version message, and
@@ -847,24 +883,106 @@ int CNetMessage::readHeader(const char *pch, unsigned int nBytes)
     // switch state to reading message data
     in_data = true;
 
+    // SYSCOIN take the payload buffer from the pool
+    if (hdr.nMessageSize > 0) {
+        CSerializeData buffer = GetNetMessageBufferPool().Get(std::min(hdr.nMessageSize, 256u * 1024));
+        vRecv.swap(buffer);
+    }
+
     return nCopy;
 }
 
 int CNetMessage::readData(const char *pch, unsigned int nBytes)
 {
-    unsigned int nRemaining = hdr.nMessageSize - nDataPos;
-    unsigned int nCopy = std::min(nRemaining, nBytes);
+    // SYSCOIN
+    unsigned int nSpace;
+    char* pchData = getDataSpace(nSpace);
+    unsigned int nCopy = std::min(nSpace, nBytes);
 
-    if (vRecv.size() < nDataPos + nCopy) {
-        // Allocate up to 256 KiB ahead, but never more than the total message size.
-        vRecv.resize(std::min(hdr.nMessageSize, nDataPos + nCopy + 256 * 1024));
+    memcpy(pchData, pch, nCopy);
+    dataWritten(nCopy);
+
+    return nCopy;
+}
+
+// SYSCOIN
+char* CNetMessage::getDataSpace(unsigned int& nSpace)
+{
+    assert(in_data);
+    // Allocate up to 256 KiB ahead, but never more than the total message size.
+    nSpace = std::min(hdr.nMessageSize - nDataPos, 256u * 1024);
+    if (vRecv.size() < nDataPos + nSpace)
+        vRecv.resize(nDataPos + nSpace);
+    return vRecv.data() + nDataPos;
+}
+
+void CNetMessage::dataWritten(unsigned int nBytes)
+{
+    assert(nDataPos + nBytes <= vRecv.size());
+    hasher.Write((const unsigned char*)vRecv.data() + nDataPos, nBytes);
+    nDataPos += nBytes;
+}
+
+CNetMessage::~CNetMessage()
+{
+    CSerializeData buffer;
+    vRecv.swap(buffer);
+    GetNetMessageBufferPool().Put(buffer);
+}
+
+CSerializeData CNetMessageBufferPool::Get(size_t nSize)
+{
+    int nClass = 0;
+    while (nClass < BUFFER_CLASSES && (MIN_BUFFER_SIZE << nClass) < nSize)
+        nClass++;
+    CSerializeData buffer;
+    if (nClass == BUFFER_CLASSES)
+        return buffer;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free[nClass].empty()) {
+            buffer.swap(m_free[nClass].back());
+            m_free[nClass].pop_back();
+            return buffer;
+        }
+    }
+    // Round up to the class, so that the buffer comes back to it
+    buffer.reserve(MIN_BUFFER_SIZE << nClass);
+    return buffer;
+}
+
+void CNetMessageBufferPool::Put(CSerializeData& buffer)
+{
+    const size_t nCapacity = buffer.capacity();
+    if (nCapacity >= MIN_BUFFER_SIZE && nCapacity < (MIN_BUFFER_SIZE << BUFFER_CLASSES)) {
+        int nClass = 0;
+        while (nClass + 1 < BUFFER_CLASSES && (MIN_BUFFER_SIZE << (nClass + 1)) <= nCapacity)
+            nClass++;
+        buffer.clear();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if ((m_free[nClass].size() + 1) * (MIN_BUFFER_SIZE << nClass) <= MAX_POOLED_BYTES_PER_CLASS) {
+            m_free[nClass].emplace_back();
+            m_free[nClass].back().swap(buffer);
+            return;
+        }
     }
+    // Not kept; free it now rather than with the caller's vector
+    CSerializeData().swap(buffer);
+}
 
-    hasher.Write((const unsigned char*)pch, nCopy);
-    memcpy(&vRecv[nDataPos], pch, nCopy);
-    nDataPos += nCopy;
+size_t CNetMessageBufferPool::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t nSize = 0;
+    for (const std::vector<CSerializeData>& buffers : m_free)
+        nSize += buffers.size();
+    return nSize;
+}
 
-    return nCopy;
+CNetMessageBufferPool& GetNetMessageBufferPool()
+{
+    static CNetMessageBufferPool pool;
+    return pool;
 }
 
 const uint256& CNetMessage::GetMessageHash() const
@@ -886,30 +1004,65 @@ const uint256& CNetMessage::GetMessageHash() const
 // requires LOCK(cs_vSend)
 size_t CConnman::SocketSendData(CNode *pnode) const
 {
-    auto it = pnode->vSendMsg.begin();
     size_t nSentSize = 0;
     // SYSCOIN
     static int count = 0;
-    while (it != pnode->vSendMsg.end()) {
-        const auto &data = *it;
-        assert(data.size() > pnode->nSendOffset);
+    while (!pnode->vSendMsg.empty()) {
+        // Gather what is left of the queued headers and payloads, so that one call sends as many messages as the socket takes
+        size_t nToSend = 0;
         int nBytes = 0;
+#ifdef WIN32
+        const CSharedNetMsg& msg = *pnode->vSendMsg.front();
+        assert(msg.size() > pnode->nSendOffset);
+        const std::vector<unsigned char>& part = pnode->nSendOffset < msg.header.size() ? msg.header : msg.data;
+        const size_t nPartOffset = pnode->nSendOffset < msg.header.size() ? pnode->nSendOffset : pnode->nSendOffset - msg.header.size();
+        nToSend = part.size() - nPartOffset;
         {
             LOCK(pnode->cs_hSocket);
             if (pnode->hSocket == INVALID_SOCKET)
                 break;
-            nBytes = send(pnode->hSocket, reinterpret_cast<const char*>(data.data()) + pnode->nSendOffset, data.size() - pnode->nSendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+            nBytes = send(pnode->hSocket, reinterpret_cast<const char*>(part.data()) + nPartOffset, nToSend, MSG_NOSIGNAL | MSG_DONTWAIT);
         }
+#else
+        struct iovec iov[MAX_SEND_BUFFERS];
+        int nBuffers = 0;
+        size_t nOffset = pnode->nSendOffset;
+        for (auto it = pnode->vSendMsg.begin(); it != pnode->vSendMsg.end() && nBuffers < MAX_SEND_BUFFERS; ++it) {
+            for (const std::vector<unsigned char>* part : {&(*it)->header, &(*it)->data}) {
+                if (nOffset >= part->size()) {
+                    nOffset -= part->size();
+                    continue;
+                }
+                if (nBuffers == MAX_SEND_BUFFERS)
+                    break;
+                iov[nBuffers].iov_base = const_cast<unsigned char*>(part->data()) + nOffset;
+                iov[nBuffers].iov_len = part->size() - nOffset;
+                nToSend += iov[nBuffers].iov_len;
+                nBuffers++;
+                nOffset = 0;
+            }
+        }
+        assert(nToSend > 0);
+        struct msghdr msghdr{};
+        msghdr.msg_iov = iov;
+        msghdr.msg_iovlen = nBuffers;
+        {
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET)
+                break;
+            nBytes = sendmsg(pnode->hSocket, &msghdr, MSG_NOSIGNAL | MSG_DONTWAIT);
+        }
+#endif
         if (nBytes > 0) {
             pnode->nLastSend = GetSystemTimeInSeconds();
             pnode->nSendBytes += nBytes;
             pnode->nSendOffset += nBytes;
             nSentSize += nBytes;
-            if (pnode->nSendOffset == data.size()) {
-                pnode->nSendOffset = 0;
-                pnode->nSendSize -= data.size();
-                pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
-                it++;
+            while (!pnode->vSendMsg.empty() && pnode->nSendOffset >= pnode->vSendMsg.front()->size()) {
+                const size_t nMessageSize = pnode->vSendMsg.front()->size();
+                pnode->nSendOffset -= nMessageSize;
+                pnode->nSendSize -= nMessageSize;
+                pnode->vSendMsg.pop_front();
                 // SYSCOIN
                 if (fTPSTest && nTPSTestingSendRawStartTime > 0) {
                     count++;
@@ -919,8 +1072,10 @@ size_t CConnman::SocketSendData(CNode *pnode) const
                         nTPSTestingSendRawStartTime = 0;
                     }
                 }
-            } else {
-                // could not send full message; stop sending more
+            }
+            pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
+            if ((size_t)nBytes < nToSend) {
+                // could not send everything gathered; stop sending more
                 break;
             }
         } else {
@@ -938,11 +1093,10 @@ size_t CConnman::SocketSendData(CNode *pnode) const
         }
     }
 
-    if (it == pnode->vSendMsg.end()) {
+    if (pnode->vSendMsg.empty()) {
         assert(pnode->nSendOffset == 0);
         assert(pnode->nSendSize == 0);
     }
-    pnode->vSendMsg.erase(pnode->vSendMsg.begin(), it);
     return nSentSize;
 }
 
@@ -1247,6 +1401,25 @@ void CConnman::ThreadSocketHandler()
                 clientInterface->NotifyNumConnectionsChanged(nPrevNodeCount);
         }
 
+#ifdef USE_EPOLL
+        if (m_socket_events) {
+            std::vector<CNode*> vNodesCopy;
+            {
+                LOCK(cs_vNodes);
+                vNodesCopy = vNodes;
+                for (CNode* pnode : vNodesCopy)
+                    pnode->AddRef();
+            }
+            SocketHandlerEpoll(vNodesCopy);
+            {
+                LOCK(cs_vNodes);
+                for (CNode* pnode : vNodesCopy)
+                    pnode->Release();
+            }
+            continue;
+        }
+#endif
+
         //
         // Find which sockets have data to receive
         //
@@ -1371,57 +1544,7 @@ void CConnman::ThreadSocketHandler()
             }
             if (recvSet || errorSet)
             {
-                // typical socket buffer is 8K-64K
-                char pchBuf[0x10000];
-                int nBytes = 0;
-                {
-                    LOCK(pnode->cs_hSocket);
-                    if (pnode->hSocket == INVALID_SOCKET)
-                        continue;
-                    nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-                }
-                if (nBytes > 0)
-                {
-                    bool notify = false;
-                    if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
-                        pnode->CloseSocketDisconnect();
-                    RecordBytesRecv(nBytes);
-                    if (notify) {
-                        size_t nSizeAdded = 0;
-                        auto it(pnode->vRecvMsg.begin());
-                        for (; it != pnode->vRecvMsg.end(); ++it) {
-                            if (!it->complete())
-                                break;
-                            nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
-                        }
-                        {
-                            LOCK(pnode->cs_vProcessMsg);
-                            pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                            pnode->nProcessQueueSize += nSizeAdded;
-                            pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
-                        }
-                        WakeMessageHandler();
-                    }
-                }
-                else if (nBytes == 0)
-                {
-                    // socket closed gracefully
-                    if (!pnode->fDisconnect) {
-                        LogPrint(BCLog::NET, "socket closed\n");
-                    }
-                    pnode->CloseSocketDisconnect();
-                }
-                else if (nBytes < 0)
-                {
-                    // error
-                    int nErr = WSAGetLastError();
-                    if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
-                    {
-                        if (!pnode->fDisconnect)
-                            LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
-                        pnode->CloseSocketDisconnect();
-                    }
-                }
+                SocketRecvData(pnode);
             }
 
             //
@@ -1436,38 +1559,7 @@ void CConnman::ThreadSocketHandler()
                 }
             }
 
-            //
-            // Inactivity checking
-            //
-            int64_t nTime = GetSystemTimeInSeconds();
-            if (nTime - pnode->nTimeConnected > 60)
-            {
-                if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
-                {
-                    LogPrint(BCLog::NET, "socket no message in first 60 seconds, %d %d from %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->GetId());
-                    pnode->fDisconnect = true;
-                }
-                else if (nTime - pnode->nLastSend > TIMEOUT_INTERVAL)
-                {
-                    LogPrintf("socket sending timeout: %is\n", nTime - pnode->nLastSend);
-                    pnode->fDisconnect = true;
-                }
-                else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? TIMEOUT_INTERVAL : 90*60))
-                {
-                    LogPrintf("socket receive timeout: %is\n", nTime - pnode->nLastRecv);
-                    pnode->fDisconnect = true;
-                }
-                else if (pnode->nPingNonceSent && pnode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
-                {
-                    LogPrintf("ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
-                    pnode->fDisconnect = true;
-                }
-                else if (!pnode->fSuccessfullyConnected)
-                {
-                    LogPrint(BCLog::NET, "version handshake timeout from %d\n", pnode->GetId());
-                    pnode->fDisconnect = true;
-                }
-            }
+            InactivityCheck(pnode);
         }
         {
             LOCK(cs_vNodes);
@@ -1477,13 +1569,216 @@ void CConnman::ThreadSocketHandler()
     }
 }
 
+bool CConnman::SocketRecvData(CNode* pnode)
+{
+    // typical socket buffer is 8K-64K
+    char pchBuf[SOCKET_RECV_BUFFER_SIZE];
+    // SYSCOIN the rest of a large payload goes straight into its message; headers and small messages, several at a time, through pchBuf
+    unsigned int nSpace = 0;
+    char* pchData = pnode->GetRecvDataSpace(nSpace);
+    const bool fDirect = pchData && nSpace >= MIN_DIRECT_RECV_SIZE;
+    const unsigned int nRecvSize = fDirect ? nSpace : sizeof(pchBuf);
+    int nBytes = 0;
+    {
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket == INVALID_SOCKET)
+            return false;
+        nBytes = recv(pnode->hSocket, fDirect ? pchData : pchBuf, nRecvSize, MSG_DONTWAIT);
+    }
+    if (nBytes > 0)
+    {
+        bool notify = false;
+        if (fDirect)
+            pnode->ReceivedDataBytes(nBytes, notify);
+        else if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
+            pnode->CloseSocketDisconnect();
+        RecordBytesRecv(nBytes);
+        if (notify) {
+            size_t nSizeAdded = 0;
+            auto it(pnode->vRecvMsg.begin());
+            for (; it != pnode->vRecvMsg.end(); ++it) {
+                if (!it->complete())
+                    break;
+                nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
+            }
+            {
+                LOCK(pnode->cs_vProcessMsg);
+                pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
+                pnode->nProcessQueueSize += nSizeAdded;
+                pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+            }
+            WakeMessageHandler(pnode);
+        }
+    }
+    else if (nBytes == 0)
+    {
+        // socket closed gracefully
+        if (!pnode->fDisconnect) {
+            LogPrint(BCLog::NET, "socket closed\n");
+        }
+        pnode->CloseSocketDisconnect();
+    }
+    else if (nBytes < 0)
+    {
+        // error
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
+        {
+            if (!pnode->fDisconnect)
+                LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
+            pnode->CloseSocketDisconnect();
+        }
+    }
+    return nBytes > 0 && (unsigned int)nBytes == nRecvSize;
+}
+
+void CConnman::InactivityCheck(CNode* pnode)
+{
+    int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime - pnode->nTimeConnected > 60)
+    {
+        if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
+        {
+            LogPrint(BCLog::NET, "socket no message in first 60 seconds, %d %d from %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->GetId());
+            pnode->fDisconnect = true;
+        }
+        else if (nTime - pnode->nLastSend > TIMEOUT_INTERVAL)
+        {
+            LogPrintf("socket sending timeout: %is\n", nTime - pnode->nLastSend);
+            pnode->fDisconnect = true;
+        }
+        else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? TIMEOUT_INTERVAL : 90*60))
+        {
+            LogPrintf("socket receive timeout: %is\n", nTime - pnode->nLastRecv);
+            pnode->fDisconnect = true;
+        }
+        else if (pnode->nPingNonceSent && pnode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
+        {
+            LogPrintf("ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
+            pnode->fDisconnect = true;
+        }
+        else if (!pnode->fSuccessfullyConnected)
+        {
+            LogPrint(BCLog::NET, "version handshake timeout from %d\n", pnode->GetId());
+            pnode->fDisconnect = true;
+        }
+    }
+}
+
+#ifdef USE_EPOLL
+/** Tags the values listening sockets are added to m_socket_events with; nodes are added with their address */
+static const uint64_t LISTEN_SOCKET_EVENT = uint64_t{1} << 63;
+/** Reads of one peer per loop, so that a fast peer cannot starve the others */
+static const int MAX_SOCKET_READS_PER_LOOP = 4;
+
+void CConnman::SocketHandlerEpoll(const std::vector<CNode*>& vNodesCopy)
+{
+    int nTimeoutMs = 50; // frequency to look at fPauseRecv, disconnects and timeouts
+    for (CNode* pnode : vNodesCopy) {
+        bool fWantSend;
+        {
+            LOCK(pnode->cs_vSend);
+            fWantSend = !pnode->vSendMsg.empty();
+        }
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket == INVALID_SOCKET)
+            continue;
+        const uint64_t nData = reinterpret_cast<uintptr_t>(pnode);
+        if (!pnode->fSocketRegistered) {
+            if (!m_socket_events->Add(pnode->hSocket, nData)) {
+                pnode->fDisconnect = true;
+                continue;
+            }
+            pnode->fSocketRegistered = true;
+            // no event reports data that arrived before the socket was added
+            pnode->fSocketRecvReady = true;
+        }
+        // Only ask to hear about writability while there is something to write
+        if (fWantSend != pnode->fSocketWantSend && m_socket_events->SetWantSend(pnode->hSocket, nData, fWantSend))
+            pnode->fSocketWantSend = fWantSend;
+        if (pnode->fSocketRecvReady && !fWantSend && !pnode->fPauseRecv)
+            nTimeoutMs = 0;
+    }
+
+    std::vector<SocketEvent> events;
+    if (!m_socket_events->Wait(nTimeoutMs, events)) {
+        LogPrintf("socket epoll error %s\n", NetworkErrorString(WSAGetLastError()));
+        interruptNet.sleep_for(std::chrono::milliseconds(nTimeoutMs));
+    }
+    if (interruptNet)
+        return;
+
+    for (const SocketEvent& event : events) {
+        if (event.nData & LISTEN_SOCKET_EVENT) {
+            AcceptConnection(vhListenSocket[event.nData & ~LISTEN_SOCKET_EVENT]);
+            continue;
+        }
+        // Nodes are only deleted by this thread after their socket is closed, which drops its events
+        CNode* pnode = reinterpret_cast<CNode*>(static_cast<uintptr_t>(event.nData));
+        pnode->fSocketRecvReady |= event.fRecv;
+        pnode->fSocketSendReady |= event.fSend;
+    }
+
+    for (CNode* pnode : vNodesCopy) {
+        if (interruptNet)
+            return;
+
+        // As with select(), drain the write buffer before receiving more
+        bool fSendPending = false;
+        {
+            LOCK(pnode->cs_vSend);
+            if (pnode->fSocketSendReady) {
+                pnode->fSocketSendReady = false;
+                size_t nBytes = SocketSendData(pnode);
+                if (nBytes) {
+                    RecordBytesSent(nBytes);
+                }
+                // send() stopped short; ask again so that we hear when it can go on
+                if (!pnode->vSendMsg.empty())
+                    pnode->fSocketWantSend = false;
+            }
+            fSendPending = !pnode->vSendMsg.empty();
+        }
+
+        if (pnode->fSocketRecvReady && !fSendPending) {
+            for (int i = 0; i < MAX_SOCKET_READS_PER_LOOP && !pnode->fPauseRecv; i++) {
+                // A short read emptied the socket, a new edge reports more
+                if (!SocketRecvData(pnode)) {
+                    pnode->fSocketRecvReady = false;
+                    break;
+                }
+            }
+        }
+
+        InactivityCheck(pnode);
+    }
+}
+#endif
+
 void CConnman::WakeMessageHandler()
 {
     {
         std::lock_guard<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = true;
+        for (const auto& handler : vMessageHandlers)
+            handler->fMsgProcWake = true;
     }
-    condMsgProc.notify_one();
+    for (const auto& handler : vMessageHandlers)
+        handler->condMsgProc.notify_one();
+}
+
+void CConnman::WakeMessageHandler(const CNode* pnode)
+{
+    MessageHandler& handler = *vMessageHandlers[GetMessageHandler(pnode)];
+    {
+        std::lock_guard<std::mutex> lock(mutexMsgProc);
+        handler.fMsgProcWake = true;
+    }
+    handler.condMsgProc.notify_one();
+}
+
+int CConnman::GetMessageHandler(const CNode* pnode) const
+{
+    return pnode->GetId() % vMessageHandlers.size();
 }
 
 
@@ -2086,16 +2381,20 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
 void CConnman::OpenMasternodeConnection(const CAddress &addrConnect) {
     OpenNetworkConnection(addrConnect, false, NULL, NULL, false, false, false, true);
 }
-void CConnman::ThreadMessageHandler()
+void CConnman::ThreadMessageHandler(int nThread)
 {
+    MessageHandler& handler = *vMessageHandlers[nThread];
     while (!flagInterruptMsgProc)
     {
+        // SYSCOIN only the peers pinned to this thread, so that each peer's messages are processed in order
         std::vector<CNode*> vNodesCopy;
         {
             LOCK(cs_vNodes);
-            vNodesCopy = vNodes;
-            for (CNode* pnode : vNodesCopy) {
-                pnode->AddRef();
+            for (CNode* pnode : vNodes) {
+                if (GetMessageHandler(pnode) == nThread) {
+                    pnode->AddRef();
+                    vNodesCopy.push_back(pnode);
+                }
             }
         }
 
@@ -2129,9 +2428,9 @@ void CConnman::ThreadMessageHandler()
 
         std::unique_lock<std::mutex> lock(mutexMsgProc);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this] { return fMsgProcWake; });
+            handler.condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [&handler] { return handler.fMsgProcWake; });
         }
-        fMsgProcWake = false;
+        handler.fMsgProcWake = false;
     }
 }
 
@@ -2349,6 +2648,22 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+#ifdef USE_EPOLL
+    // SYSCOIN register the listening sockets once, nodes follow as the socket handler first sees them
+    if (socketEventsMode == SocketEventsMode::EPOLL) {
+        m_socket_events = MakeUnique<CSocketEvents>();
+        bool fValid = m_socket_events->IsValid();
+        for (size_t i = 0; i < vhListenSocket.size() && fValid; i++)
+            fValid = m_socket_events->Add(vhListenSocket[i].socket, LISTEN_SOCKET_EVENT | i, true);
+        if (!fValid) {
+            LogPrintf("Failed to set up epoll, falling back to -socketevents=select\n");
+            m_socket_events.reset();
+            socketEventsMode = SocketEventsMode::SELECT;
+        }
+    }
+#endif
+    LogPrintf("Using %s for socket events\n", SocketEventsModeToString(socketEventsMode));
+
     for (const auto& strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
     }
@@ -2413,7 +2728,9 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
 
     {
         std::unique_lock<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = false;
+        vMessageHandlers.clear();
+        for (int i = 0; i < nMsgHandlerThreads; i++)
+            vMessageHandlers.push_back(MakeUnique<MessageHandler>());
     }
 
     // Send and receive from sockets, accept connections
@@ -2442,7 +2759,11 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         threadOpenConnections = std::thread(&TraceThread<std::function<void()> >, "opencon", std::function<void()>(std::bind(&CConnman::ThreadOpenConnections, this, connOptions.m_specified_outgoing)));
 
     // Process messages
-    threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    for (int i = 0; i < nMsgHandlerThreads; i++) {
+        MessageHandler& handler = *vMessageHandlers[i];
+        handler.strName = nMsgHandlerThreads == 1 ? "msghand" : strprintf("msghand.%d", i);
+        handler.thread = std::thread(&TraceThread<std::function<void()> >, handler.strName.c_str(), std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this, i)));
+    }
 
     // Dump network addresses
     scheduler.scheduleEvery(std::bind(&CConnman::DumpData, this), DUMP_ADDRESSES_INTERVAL * 1000);
@@ -2480,7 +2801,8 @@ void CConnman::Interrupt()
         std::lock_guard<std::mutex> lock(mutexMsgProc);
         flagInterruptMsgProc = true;
     }
-    condMsgProc.notify_all();
+    for (const auto& handler : vMessageHandlers)
+        handler->condMsgProc.notify_all();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2506,8 +2828,10 @@ void CConnman::Interrupt()
 
 void CConnman::Stop()
 {
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (const auto& handler : vMessageHandlers) {
+        if (handler->thread.joinable())
+            handler->thread.join();
+    }
     if (threadOpenMasternodeConnections.joinable())
         threadOpenMasternodeConnections.join();    
     if (threadOpenConnections.joinable())
@@ -2518,6 +2842,9 @@ void CConnman::Stop()
         threadDNSAddressSeed.join();
     if (threadSocketHandler.joinable())
         threadSocketHandler.join();
+#ifdef USE_EPOLL
+    m_socket_events.reset();
+#endif
 
     if (fAddressesInitialized)
     {
@@ -2864,13 +3191,20 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     fPingQueued = false;
     // SYSCOIN
     fMasternode = false;
+    nGovVoteSyncBudget = -1;
+    nTimeGovVoteSyncBudget = 0;
     nMinPingUsecTime = std::numeric_limits<int64_t>::max();
     minFeeFilter = 0;
     lastSentFeeFilter = 0;
     nextSendTimeFeeFilter = 0;
     fPauseRecv = false;
     fPauseSend = false;
+    fSocketRegistered = false;
+    fSocketWantSend = false;
+    fSocketRecvReady = false;
+    fSocketSendReady = false;
     nProcessQueueSize = 0;
+    nSigPrefetchedMsgs = 0;
 
     for (const std::string &msg : getAllNetMessageTypes())
         mapRecvBytesPerMsgCmd[msg] = 0;
@@ -2927,19 +3261,32 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
     return pnode && pnode->fSuccessfullyConnected && !pnode->fDisconnect;
 }
 
-void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
+CSharedNetMsgRef MakeSharedNetMsg(CSerializedNetMsg&& msg)
 {
-    size_t nMessageSize = msg.data.size();
-    size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
-    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg.command.c_str()), nMessageSize, pnode->GetId());
+    std::shared_ptr<CSharedNetMsg> shared = std::make_shared<CSharedNetMsg>();
+    shared->command = std::move(msg.command);
+    shared->data = std::move(msg.data);
 
-    std::vector<unsigned char> serializedHeader;
-    serializedHeader.reserve(CMessageHeader::HEADER_SIZE);
-    uint256 hash = Hash(msg.data.data(), msg.data.data() + nMessageSize);
-    CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), nMessageSize);
+    shared->header.reserve(CMessageHeader::HEADER_SIZE);
+    uint256 hash = Hash(shared->data.data(), shared->data.data() + shared->data.size());
+    CMessageHeader hdr(Params().MessageStart(), shared->command.c_str(), shared->data.size());
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
-    CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
+    CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, shared->header, 0, hdr};
+    return shared;
+}
+
+void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
+{
+    // SYSCOIN
+    PushMessage(pnode, MakeSharedNetMsg(std::move(msg)));
+}
+
+void CConnman::PushMessage(CNode* pnode, const CSharedNetMsgRef& msg)
+{
+    size_t nMessageSize = msg->data.size();
+    size_t nTotalSize = msg->size();
+    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg->command.c_str()), nMessageSize, pnode->GetId());
 
     size_t nBytesSent = 0;
     {
@@ -2947,14 +3294,12 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         bool optimisticSend(pnode->vSendMsg.empty());
 
         //log total amount of bytes per command
-        pnode->mapSendBytesPerMsgCmd[msg.command] += nTotalSize;
+        pnode->mapSendBytesPerMsgCmd[msg->command] += nTotalSize;
         pnode->nSendSize += nTotalSize;
 
         if (pnode->nSendSize > nSendBufferMaxSize)
             pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize)
-            pnode->vSendMsg.push_back(std::move(msg.data));
+        pnode->vSendMsg.push_back(msg);
 
         // If write queue empty, attempt "optimistic write"
         if (optimisticSend == true)
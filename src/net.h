@@ -17,6 +17,7 @@
 #include <policy/feerate.h>
 #include <protocol.h>
 #include <random.h>
+#include <socketevents.h>
 #include <streams.h>
 #include <sync.h>
 #include <uint256.h>
@@ -41,6 +42,8 @@ class CNode;
 static const int PING_INTERVAL = 2 * 60;
 /** Time after which to disconnect, after waiting for a ping response (or inactivity). */
 static const int TIMEOUT_INTERVAL = 20 * 60;
+/** Size of the buffer each recv() from a peer reads into */
+static const int SOCKET_RECV_BUFFER_SIZE = 0x10000;
 /** Run the feeler connection loop once every 2 minutes or 120 seconds. **/
 static const int FEELER_INTERVAL = 120;
 /** The maximum number of entries in an 'inv' protocol message */
@@ -90,6 +93,9 @@ static const bool DEFAULT_FORCEDNSSEED = false;
 // SYSCOIN
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 50 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 10 * 1000;
+/** Number of threads running ProcessMessages/SendMessages, each peer is handled by one of them */
+static const int DEFAULT_MSGHANDLER_THREADS = 1;
+static const int MAX_MSGHANDLER_THREADS = 16;
 
 // NOTE: When adjusting this, update rpcnet:setban's help ("24h")
 static const unsigned int DEFAULT_MISBEHAVING_BANTIME = 60 * 60 * 24;  // Default 24-hour ban
@@ -120,6 +126,25 @@ struct CSerializedNetMsg
     std::string command;
 };
 
+// SYSCOIN
+/**
+ * A message with its header, serialized once and then queued for any number
+ * of peers. Relaying a block or transaction to every peer shares these bytes
+ * instead of copying them per peer.
+ */
+struct CSharedNetMsg
+{
+    std::string command;
+    std::vector<unsigned char> header;
+    std::vector<unsigned char> data;
+
+    size_t size() const { return header.size() + data.size(); }
+};
+typedef std::shared_ptr<const CSharedNetMsg> CSharedNetMsgRef;
+
+/** Add the header to msg and make it shareable */
+CSharedNetMsgRef MakeSharedNetMsg(CSerializedNetMsg&& msg);
+
 class NetEventsInterface;
 class CConnman
 {
@@ -152,6 +177,8 @@ public:
         bool m_use_addrman_outgoing = true;
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
+        SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS;
+        int nMsgHandlerThreads = DEFAULT_MSGHANDLER_THREADS;
     };
 
     void Init(const Options& connOptions) {
@@ -165,6 +192,8 @@ public:
         m_msgproc = connOptions.m_msgproc;
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
+        socketEventsMode = connOptions.socketEventsMode;
+        nMsgHandlerThreads = std::max(1, std::min(connOptions.nMsgHandlerThreads, MAX_MSGHANDLER_THREADS));
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
@@ -192,6 +221,8 @@ public:
 
     void PushMessage(CNode* pnode, CSerializedNetMsg&& msg);
     // SYSCOIN
+    void PushMessage(CNode* pnode, const CSharedNetMsgRef& msg);
+    // SYSCOIN
     bool ForNode(const CService& addr, std::function<bool(const CNode* pnode)> cond, std::function<bool(CNode* pnode)> func);
 
     struct CAllNodes {
@@ -383,7 +414,10 @@ public:
 
     unsigned int GetReceiveFloodSize() const;
 
+    /** Wake all message handler threads */
     void WakeMessageHandler();
+    /** Wake the message handler thread pnode is pinned to */
+    void WakeMessageHandler(const CNode* pnode);
 
     /** Attempts to obfuscate tx time through exponentially distributed emitting.
         Works assuming that a single interval is used.
@@ -415,9 +449,22 @@ private:
     void AddOneShot(const std::string& strDest);
     void ProcessOneShot();
     void ThreadOpenConnections(std::vector<std::string> connect);
-    void ThreadMessageHandler();
+    void ThreadMessageHandler(int nThread);
+    /** The message handler thread that processes all messages of pnode, keeping them in order */
+    int GetMessageHandler(const CNode* pnode) const;
     void AcceptConnection(const ListenSocket& hListenSocket);
     void ThreadSocketHandler();
+    /**
+     * Read once from pnode's socket and hand complete messages to the message
+     * handler. Returns true if recv() filled all the room it was given, so that
+     * more may be waiting.
+     */
+    bool SocketRecvData(CNode* pnode);
+    void InactivityCheck(CNode* pnode);
+#ifdef USE_EPOLL
+    /** Wait for and service the sockets of vNodesCopy and the listening sockets through m_socket_events */
+    void SocketHandlerEpoll(const std::vector<CNode*>& vNodesCopy);
+#endif
     void ThreadDNSAddressSeed();
     void ThreadOpenMasternodeConnections();
 
@@ -474,6 +521,10 @@ private:
     unsigned int nReceiveFloodSize;
 
     std::vector<ListenSocket> vhListenSocket;
+    SocketEventsMode socketEventsMode;
+#ifdef USE_EPOLL
+    std::unique_ptr<CSocketEvents> m_socket_events;
+#endif
     std::atomic<bool> fNetworkActive;
     banmap_t setBanned;
     CCriticalSection cs_setBanned;
@@ -510,10 +561,16 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake;
+    /** A message handler thread and the flag for waking it, which is guarded by mutexMsgProc */
+    struct MessageHandler {
+        std::string strName;
+        std::thread thread;
+        std::condition_variable condMsgProc;
+        bool fMsgProcWake = false;
+    };
 
-    std::condition_variable condMsgProc;
+    int nMsgHandlerThreads;
+    std::vector<std::unique_ptr<MessageHandler>> vMessageHandlers;
     std::mutex mutexMsgProc;
     std::atomic<bool> flagInterruptMsgProc;
 
@@ -524,7 +581,6 @@ private:
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
     std::thread threadOpenMasternodeConnections;
-    std::thread threadMessageHandler;
 
     /** flag for deciding to connect to an extra outbound peer,
      *  in excess of nMaxOutbound
@@ -657,6 +713,37 @@ public:
 
 
 
+// SYSCOIN
+/**
+ * Payload buffers of received messages, kept for reuse. A message takes one
+ * when its header is complete and gives it back when it is destroyed after
+ * processing, so the steady stream of small messages from every peer does not
+ * allocate and free a buffer each. Buffers are kept in size classes of powers
+ * of two, each class up to MAX_POOLED_BYTES_PER_CLASS, so that it holds many
+ * small buffers and few large ones; the rest and bigger ones are freed.
+ */
+class CNetMessageBufferPool
+{
+public:
+    static const size_t MIN_BUFFER_SIZE = 256;
+    static const int BUFFER_CLASSES = 11;
+    //! upper bound on the bytes kept by each size class
+    static const size_t MAX_POOLED_BYTES_PER_CLASS = 512 * 1024;
+
+    /** An empty buffer with room for at least nSize bytes, or an empty one if nSize is more than the largest class */
+    CSerializeData Get(size_t nSize);
+    /** Take buffer for reuse. It is left empty. */
+    void Put(CSerializeData& buffer);
+    /** The number of buffers kept for reuse */
+    size_t size() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<CSerializeData> m_free[BUFFER_CLASSES];
+};
+
+CNetMessageBufferPool& GetNetMessageBufferPool();
+
 class CNetMessage {
 private:
     mutable CHash256 hasher;
@@ -680,6 +767,10 @@ public:
         nDataPos = 0;
         nTime = 0;
     }
+    // SYSCOIN
+    CNetMessage(CNetMessage&&) = default;
+    CNetMessage& operator=(CNetMessage&&) = default;
+    ~CNetMessage();
 
     bool complete() const
     {
@@ -698,6 +789,15 @@ public:
 
     int readHeader(const char *pch, unsigned int nBytes);
     int readData(const char *pch, unsigned int nBytes);
+    // SYSCOIN
+    /**
+     * Room for the next bytes of the payload, at most 256 KiB of them, for
+     * receiving straight into. Only valid once the header is complete and
+     * until dataWritten is called.
+     */
+    char* getDataSpace(unsigned int& nSpace);
+    /** Take in nBytes written to the room returned by getDataSpace */
+    void dataWritten(unsigned int nBytes);
 };
 
 
@@ -712,7 +812,7 @@ public:
     size_t nSendSize; // total size of all vSendMsg entries
     size_t nSendOffset; // offset inside the first vSendMsg already sent
     uint64_t nSendBytes;
-    std::deque<std::vector<unsigned char>> vSendMsg;
+    std::deque<CSharedNetMsgRef> vSendMsg;
     CCriticalSection cs_vSend;
     CCriticalSection cs_hSocket;
     CCriticalSection cs_vRecv;
@@ -720,6 +820,8 @@ public:
     CCriticalSection cs_vProcessMsg;
     std::list<CNetMessage> vProcessMsg;
     size_t nProcessQueueSize;
+    // SYSCOIN number of messages at the front of vProcessMsg whose signatures were already pre-verified
+    size_t nSigPrefetchedMsgs;
 
     CCriticalSection cs_sendProcessing;
 
@@ -759,6 +861,9 @@ public:
     bool fSentAddr;
     // SYSCOIN If 'true' this node will be disconnected on CMasternodeMan::ProcessMasternodeConnections()
     bool fMasternode;
+    // SYSCOIN number of governance votes this peer may still page through and when it was last refilled, protected by governance.cs
+    int64_t nGovVoteSyncBudget;
+    int64_t nTimeGovVoteSyncBudget;
     CSemaphoreGrant grantOutbound;
     CSemaphoreGrant grantMasternodeOutbound;
     CCriticalSection cs_filter;
@@ -768,6 +873,12 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv;
     std::atomic_bool fPauseSend;
+    // SYSCOIN how the socket stands with -socketevents=epoll, only touched by the socket handler thread
+    bool fSocketRegistered;
+    bool fSocketWantSend;
+    // the last read stopped before recv() would block, so data may be left that no new event will report
+    bool fSocketRecvReady;
+    bool fSocketSendReady;
 protected:
 
     mapMsgCmdSize mapSendBytesPerMsgCmd;
@@ -778,8 +889,10 @@ public:
     std::atomic<int> nStartingHeight;
 
     // flood relay
-    std::vector<CAddress> vAddrToSend;
-    CRollingBloomFilter addrKnown;
+    // SYSCOIN other peers' message handler threads push addresses to relay
+    CCriticalSection cs_addrSend;
+    std::vector<CAddress> vAddrToSend GUARDED_BY(cs_addrSend);
+    CRollingBloomFilter addrKnown GUARDED_BY(cs_addrSend);
     bool fGetAddr;
     std::set<uint256> setKnown;
     int64_t nNextAddrSend;
@@ -842,6 +955,8 @@ private:
     const int nMyStartingHeight;
     int nSendVersion;
     std::list<CNetMessage> vRecvMsg;  // Used only by SocketHandler thread
+    // SYSCOIN
+    void MessageComplete(CNetMessage& msg, int64_t nTimeMicros);
 
     mutable CCriticalSection cs_addrName;
     std::string addrName;
@@ -870,6 +985,11 @@ public:
     }
 
     bool ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete);
+    // SYSCOIN
+    /** Room to receive the payload of the message being received straight into, or nullptr if a header comes next */
+    char* GetRecvDataSpace(unsigned int& nSpace);
+    /** Like ReceiveMsgBytes, for nBytes received into the room returned by GetRecvDataSpace */
+    void ReceivedDataBytes(unsigned int nBytes, bool& complete);
 
     void SetRecvVersion(int nVersionIn)
     {
@@ -901,6 +1021,7 @@ public:
 
     void AddAddressKnown(const CAddress& _addr)
     {
+        LOCK(cs_addrSend);
         addrKnown.insert(_addr.GetKey());
     }
 
@@ -909,6 +1030,7 @@ public:
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
+        LOCK(cs_addrSend);
         if (_addr.IsValid() && !addrKnown.contains(_addr.GetKey())) {
             if (vAddrToSend.size() >= MAX_ADDR_TO_SEND) {
                 vAddrToSend[insecure_rand.randrange(vAddrToSend.size())] = _addr;
@@ -20,6 +20,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <random.h>
+#include <relaycache.h>
 #include <reverse_iterator.h>
 #include <scheduler.h>
 #include <tinyformat.h>
@@ -36,6 +37,8 @@
 #include <masternode-payments.h>
 #include <masternode-sync.h>
 #include <masternodeman.h>
+#include <messagesigner.h>
+#include <services/asset.h>
 
 #if defined(NDEBUG)
 # error "Syscoin cannot be compiled without assertions."
@@ -75,9 +78,13 @@ struct COrphanTx {
     CTransactionRef tx;
     NodeId fromPeer;
     int64_t nTimeExpire;
+    // SYSCOIN asset transactions are limited separately, by -maxorphanassettx
+    bool fAsset;
 };
 static CCriticalSection g_cs_orphans;
 std::map<uint256, COrphanTx> mapOrphanTransactions GUARDED_BY(g_cs_orphans);
+// SYSCOIN number of entries in mapOrphanTransactions that are asset transactions
+size_t nOrphanAssetTransactions GUARDED_BY(g_cs_orphans) = 0;
 
 void EraseOrphansFor(NodeId peer);
 
@@ -98,6 +105,9 @@ static const unsigned int AVG_ADDRESS_BROADCAST_INTERVAL = 30;
 static constexpr unsigned int AVG_FEEFILTER_BROADCAST_INTERVAL = 10 * 60;
 /** Maximum feefilter broadcast delay after significant change. */
 static constexpr unsigned int MAX_FEEFILTER_CHANGE_DELAY = 5 * 60;
+// SYSCOIN
+/** Maximum number of queued messages scanned for masternode/governance signatures to verify ahead of processing. */
+static constexpr size_t MAX_SIG_PREFETCH_MESSAGES = 256;
 
 // Internal stuff
 namespace {
@@ -163,6 +173,9 @@ namespace {
     MapRelay mapRelay GUARDED_BY(cs_main);
     /** Expiration-time ordered list of (expire time, relay map entry) pairs. */
     std::deque<std::pair<int64_t, MapRelay::iterator>> vRelayExpiration GUARDED_BY(cs_main);
+    // SYSCOIN
+    /** Transactions and blocks as sent to one peer, for the next peer that asks for them */
+    CRelayCache relayCache(DEFAULT_RELAY_CACHE_SIZE << 20);
 
     std::atomic<int64_t> nTimeBestReceived(0); // Used only to inform the wallet of when we last received a block
 
@@ -178,6 +191,19 @@ namespace {
 
     static size_t vExtraTxnForCompactIt GUARDED_BY(g_cs_orphans) = 0;
     static std::vector<std::pair<uint256, CTransactionRef>> vExtraTxnForCompact GUARDED_BY(g_cs_orphans);
+    // SYSCOIN asset transactions come in bursts, so they get their own ring and cannot push the others out
+    static size_t vExtraAssetTxnForCompactIt GUARDED_BY(g_cs_orphans) = 0;
+    static std::vector<std::pair<uint256, CTransactionRef>> vExtraAssetTxnForCompact GUARDED_BY(g_cs_orphans);
+
+    /** Counters behind GetCompactBlockStats */
+    std::atomic<uint64_t> nCompactBlocks(0);
+    std::atomic<uint64_t> nCompactBlocksReconstructed(0);
+    std::atomic<uint64_t> nCompactBlockRoundTrips(0);
+    std::atomic<uint64_t> nCompactTxPrefilled(0);
+    std::atomic<uint64_t> nCompactTxFromMempool(0);
+    std::atomic<uint64_t> nCompactTxFromExtra(0);
+    std::atomic<uint64_t> nCompactTxFromAssetExtra(0);
+    std::atomic<uint64_t> nCompactTxRequested(0);
 } // namespace
 
 namespace {
@@ -681,15 +707,75 @@ bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) {
 // mapOrphanTransactions
 //
 
-static void AddToCompactExtraTransactions(const CTransactionRef& tx) EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
+// SYSCOIN only transactions carrying an asset or asset allocation that parses count as asset
+// transactions, so a peer cannot fill the asset pools by setting the version alone
+static bool IsAssetTx(const CTransaction& tx)
+{
+    if (tx.nVersion != SYSCOIN_TX_VERSION_ASSET)
+        return false;
+    int op = 0;
+    std::vector<std::vector<unsigned char> > vvch;
+    char type;
+    return DecodeAndParseSyscoinTx(tx, op, vvch, type);
+}
+
+static void AddToCompactExtraTransactions(const CTransactionRef& tx, bool fAsset) EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
 {
-    size_t max_extra_txn = gArgs.GetArg("-blockreconstructionextratxn", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN);
+    size_t max_extra_txn = fAsset ? gArgs.GetArg("-blockreconstructionextraassettxn", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_ASSET_TXN) :
+                                    gArgs.GetArg("-blockreconstructionextratxn", DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN);
     if (max_extra_txn <= 0)
         return;
-    if (!vExtraTxnForCompact.size())
-        vExtraTxnForCompact.resize(max_extra_txn);
-    vExtraTxnForCompact[vExtraTxnForCompactIt] = std::make_pair(tx->GetWitnessHash(), tx);
-    vExtraTxnForCompactIt = (vExtraTxnForCompactIt + 1) % max_extra_txn;
+    std::vector<std::pair<uint256, CTransactionRef>>& vExtra = fAsset ? vExtraAssetTxnForCompact : vExtraTxnForCompact;
+    size_t& vExtraIt = fAsset ? vExtraAssetTxnForCompactIt : vExtraTxnForCompactIt;
+    if (!vExtra.size())
+        vExtra.resize(max_extra_txn);
+    vExtra[vExtraIt] = std::make_pair(tx->GetWitnessHash(), tx);
+    vExtraIt = (vExtraIt + 1) % max_extra_txn;
+}
+
+// SYSCOIN
+/** Count where the transactions of a compact block came from, once InitData has matched them. */
+static void RecordCompactBlockStats(const PartiallyDownloadedBlock& partialBlock, size_t nRequested, bool fReconstructed = true)
+{
+    nCompactBlocks++;
+    nCompactTxPrefilled += partialBlock.GetPrefilledCount();
+    nCompactTxFromMempool += partialBlock.GetMempoolCount();
+    nCompactTxFromExtra += partialBlock.GetExtraCount();
+    nCompactTxFromAssetExtra += partialBlock.GetAssetExtraCount();
+    nCompactTxRequested += nRequested;
+    if (nRequested > 0)
+        nCompactBlockRoundTrips++;
+    else if (fReconstructed)
+        nCompactBlocksReconstructed++;
+}
+
+void GetCompactBlockStats(CCompactBlockStats &stats)
+{
+    stats.nBlocks = nCompactBlocks;
+    stats.nReconstructed = nCompactBlocksReconstructed;
+    stats.nRoundTrips = nCompactBlockRoundTrips;
+    stats.nTxPrefilled = nCompactTxPrefilled;
+    stats.nTxFromMempool = nCompactTxFromMempool;
+    stats.nTxFromExtra = nCompactTxFromExtra;
+    stats.nTxFromAssetExtra = nCompactTxFromAssetExtra;
+    stats.nTxRequested = nCompactTxRequested;
+    LOCK(g_cs_orphans);
+    stats.nOrphans = mapOrphanTransactions.size() - nOrphanAssetTransactions;
+    stats.nAssetOrphans = nOrphanAssetTransactions;
+}
+
+/** Serialize obj into a command message, send it to pfrom and keep it in relayCache for other peers asking for the same object */
+template <typename T>
+static void PushRelayMessage(CNode* pfrom, CConnman* connman, const CNetMsgMaker& msgMaker, int nSendFlags, const uint256& hash, const std::string& command, const T& obj)
+{
+    CSharedNetMsgRef msg = MakeSharedNetMsg(msgMaker.Make(nSendFlags, command, obj));
+    relayCache.Put(hash, command, !(nSendFlags & SERIALIZE_TRANSACTION_NO_WITNESS), msg);
+    connman->PushMessage(pfrom, msg);
+}
+
+void GetRelayCacheStats(CRelayCacheStats &stats)
+{
+    stats = relayCache.GetStats();
 }
 
 bool AddOrphanTx(const CTransactionRef& tx, NodeId peer) EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
@@ -712,16 +798,19 @@ bool AddOrphanTx(const CTransactionRef& tx, NodeId peer) EXCLUSIVE_LOCKS_REQUIRE
         return false;
     }
 
-    auto ret = mapOrphanTransactions.emplace(hash, COrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME});
+    const bool fAsset = IsAssetTx(*tx);
+    auto ret = mapOrphanTransactions.emplace(hash, COrphanTx{tx, peer, GetTime() + ORPHAN_TX_EXPIRE_TIME, fAsset});
     assert(ret.second);
+    if (fAsset)
+        nOrphanAssetTransactions++;
     for (const CTxIn& txin : tx->vin) {
         mapOrphanTransactionsByPrev[txin.prevout].insert(ret.first);
     }
 
-    AddToCompactExtraTransactions(tx);
+    AddToCompactExtraTransactions(tx, fAsset);
 
-    LogPrint(BCLog::MEMPOOL, "stored orphan tx %s (mapsz %u outsz %u)\n", hash.ToString(),
-             mapOrphanTransactions.size(), mapOrphanTransactionsByPrev.size());
+    LogPrint(BCLog::MEMPOOL, "stored orphan tx %s (mapsz %u assetsz %u outsz %u)\n", hash.ToString(),
+             mapOrphanTransactions.size(), nOrphanAssetTransactions, mapOrphanTransactionsByPrev.size());
     return true;
 }
 
@@ -739,6 +828,8 @@ int static EraseOrphanTx(uint256 hash) EXCLUSIVE_LOCKS_REQUIRED(g_cs_orphans)
         if (itPrev->second.empty())
             mapOrphanTransactionsByPrev.erase(itPrev);
     }
+    if (it->second.fAsset)
+        nOrphanAssetTransactions--;
     mapOrphanTransactions.erase(it);
     return 1;
 }
@@ -760,7 +851,7 @@ void EraseOrphansFor(NodeId peer)
 }
 
 
-unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans)
+unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans, unsigned int nMaxAssetOrphans)
 {
     LOCK(g_cs_orphans);
 
@@ -785,13 +876,19 @@ unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans)
         nNextSweep = nMinExpTime + ORPHAN_TX_EXPIRE_INTERVAL;
         if (nErased > 0) LogPrint(BCLog::MEMPOOL, "Erased %d orphan tx due to expiration\n", nErased);
     }
-    while (mapOrphanTransactions.size() > nMaxOrphans)
+    // SYSCOIN asset and other orphans are limited separately, so that neither can push the other out
+    while (mapOrphanTransactions.size() - nOrphanAssetTransactions > nMaxOrphans || nOrphanAssetTransactions > nMaxAssetOrphans)
     {
-        // Evict a random orphan:
+        const bool fAsset = nOrphanAssetTransactions > nMaxAssetOrphans;
+        // Evict a random orphan of the kind that is over its limit:
         uint256 randomhash = GetRandHash();
         std::map<uint256, COrphanTx>::iterator it = mapOrphanTransactions.lower_bound(randomhash);
-        if (it == mapOrphanTransactions.end())
-            it = mapOrphanTransactions.begin();
+        for (size_t i = 0; i < mapOrphanTransactions.size(); i++, it++) {
+            if (it == mapOrphanTransactions.end())
+                it = mapOrphanTransactions.begin();
+            if (it->second.fAsset == fAsset)
+                break;
+        }
         EraseOrphanTx(it->first);
         ++nEvicted;
     }
@@ -851,6 +948,9 @@ PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn, CScheduler &schedu
 
     // Initialize global variables that cannot be constructed at startup.
     recentRejects.reset(new CRollingBloomFilter(120000, 0.000001));
+    // SYSCOIN
+    relayCache.Clear();
+    relayCache.SetMaxBytes(std::max<int64_t>(0, gArgs.GetArg("-relaycachesize", DEFAULT_RELAY_CACHE_SIZE)) << 20);
 
     const Consensus::Params& consensusParams = Params().GetConsensus();
     // Stale tip checking and peer eviction are on two different timers, but we
@@ -901,6 +1001,8 @@ void PeerLogicValidation::BlockConnected(const std::shared_ptr<const CBlock>& pb
 static CCriticalSection cs_most_recent_block;
 static std::shared_ptr<const CBlock> most_recent_block GUARDED_BY(cs_most_recent_block);
 static std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_block GUARDED_BY(cs_most_recent_block);
+// SYSCOIN most_recent_compact_block serialized once for every peer it is sent to
+static CSharedNetMsgRef most_recent_compact_block_msg GUARDED_BY(cs_most_recent_block);
 static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
 static bool fWitnessesPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_block);
 
@@ -911,6 +1013,8 @@ static bool fWitnessesPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_
 void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) {
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> pcmpctblock = std::make_shared<const CBlockHeaderAndShortTxIDs> (*pblock, true);
     const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    // SYSCOIN
+    const CSharedNetMsgRef pcmpctblockmsg = MakeSharedNetMsg(msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
 
     LOCK(cs_main);
 
@@ -927,13 +1031,13 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
         most_recent_block_hash = hashBlock;
         most_recent_block = pblock;
         most_recent_compact_block = pcmpctblock;
+        most_recent_compact_block_msg = pcmpctblockmsg;
         fWitnessesPresentInMostRecentCompactBlock = fWitnessEnabled;
     }
 
-    connman->ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) {
+    connman->ForEachNode([this, &pcmpctblockmsg, pindex, fWitnessEnabled, &hashBlock](CNode* pnode) {
         AssertLockHeld(cs_main);
 
-        // TODO: Avoid the repeated-serialization here
         if (pnode->nVersion < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
             return;
         ProcessBlockAvailability(pnode->GetId());
@@ -945,10 +1049,14 @@ void PeerLogicValidation::NewPoWValidBlock(const CBlockIndex *pindex, const std:
 
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerLogicValidation::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
-            connman->PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+            connman->PushMessage(pnode, pcmpctblockmsg);
             state.pindexBestHeaderSent = pindex;
         }
     });
+
+    // SYSCOIN serialize the full block once the announces are out, ahead of the getdata requests that follow them.
+    // Most peers that still want the full block ask for it with witnesses
+    relayCache.Put(hashBlock, NetMsgType::BLOCK, true, MakeSharedNetMsg(msgMaker.Make(NetMsgType::BLOCK, *pblock)));
 }
 
 /**
@@ -1076,12 +1184,12 @@ bool static AlreadyHave(const CInv& inv) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
         return mapSporks.count(inv.hash);
 
     case MSG_MASTERNODE_PAYMENT_VOTE:
-        return mnpayments.mapMasternodePaymentVotes.count(inv.hash);
+        return mnpayments.HasPaymentVote(inv.hash);
 
     case MSG_MASTERNODE_PAYMENT_BLOCK:
         {
             BlockMap::iterator mi = mapBlockIndex.find(inv.hash);
-            return mi != mapBlockIndex.end() && mnpayments.mapMasternodeBlocks.find(mi->second->nHeight) != mnpayments.mapMasternodeBlocks.end();
+            return mi != mapBlockIndex.end() && mnpayments.HasPaymentBlock(mi->second->nHeight);
         }
 
     case MSG_MASTERNODE_ANNOUNCE:
@@ -1151,12 +1259,15 @@ void static ProcessGetBlockData(CNode* pfrom, const CChainParams& chainparams, c
     bool send = false;
     std::shared_ptr<const CBlock> a_recent_block;
     std::shared_ptr<const CBlockHeaderAndShortTxIDs> a_recent_compact_block;
+    // SYSCOIN
+    CSharedNetMsgRef a_recent_compact_block_msg;
     bool fWitnessesPresentInARecentCompactBlock;
     const Consensus::Params& consensusParams = chainparams.GetConsensus();
     {
         LOCK(cs_most_recent_block);
         a_recent_block = most_recent_block;
         a_recent_compact_block = most_recent_compact_block;
+        a_recent_compact_block_msg = most_recent_compact_block_msg;
         fWitnessesPresentInARecentCompactBlock = fWitnessesPresentInMostRecentCompactBlock;
     }
 
@@ -1217,7 +1328,14 @@ void static ProcessGetBlockData(CNode* pfrom, const CChainParams& chainparams, c
     if (send && (pindex->nStatus & BLOCK_HAVE_DATA))
     {
         std::shared_ptr<const CBlock> pblock;
-        if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
+        // SYSCOIN full blocks already sent to another peer go out as they were serialized then
+        CSharedNetMsgRef cached;
+        if (inv.type == MSG_BLOCK || inv.type == MSG_WITNESS_BLOCK)
+            cached = relayCache.Get(pindex->GetBlockHash(), NetMsgType::BLOCK, inv.type == MSG_WITNESS_BLOCK);
+        if (cached) {
+            connman->PushMessage(pfrom, cached);
+            // Don't set pblock as we've sent the block
+        } else if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
             pblock = a_recent_block;
         } else if (inv.type == MSG_WITNESS_BLOCK) {
             // Fast-path: in this case it is possible to serve the block directly from disk,
@@ -1226,7 +1344,7 @@ void static ProcessGetBlockData(CNode* pfrom, const CChainParams& chainparams, c
             if (!ReadRawBlockFromDisk(block_data, pindex, chainparams.MessageStart())) {
                 assert(!"cannot load block from disk");
             }
-            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, MakeSpan(block_data)));
+            PushRelayMessage(pfrom, connman, msgMaker, 0, pindex->GetBlockHash(), NetMsgType::BLOCK, MakeSpan(block_data));
             // Don't set pblock as we've sent the block
         } else {
             // Send block from disk
@@ -1237,9 +1355,9 @@ void static ProcessGetBlockData(CNode* pfrom, const CChainParams& chainparams, c
         }
         if (pblock) {
             if (inv.type == MSG_BLOCK)
-                connman->PushMessage(pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, *pblock));
+                PushRelayMessage(pfrom, connman, msgMaker, SERIALIZE_TRANSACTION_NO_WITNESS, pindex->GetBlockHash(), NetMsgType::BLOCK, *pblock);
             else if (inv.type == MSG_WITNESS_BLOCK)
-                connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
+                PushRelayMessage(pfrom, connman, msgMaker, 0, pindex->GetBlockHash(), NetMsgType::BLOCK, *pblock);
             else if (inv.type == MSG_FILTERED_BLOCK)
             {
                 bool sendMerkleBlock = false;
@@ -1276,7 +1394,7 @@ void static ProcessGetBlockData(CNode* pfrom, const CChainParams& chainparams, c
                 int nSendFlags = fPeerWantsWitness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
                 if (CanDirectFetch(consensusParams) && pindex->nHeight >= chainActive.Height() - MAX_CMPCTBLOCK_DEPTH) {
                     if ((fPeerWantsWitness || !fWitnessesPresentInARecentCompactBlock) && a_recent_compact_block && a_recent_compact_block->header.GetHash() == pindex->GetBlockHash()) {
-                        connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *a_recent_compact_block));
+                        connman->PushMessage(pfrom, a_recent_compact_block_msg);
                     } else {
                         CBlockHeaderAndShortTxIDs cmpctblock(*pblock, fPeerWantsWitness);
                         connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
@@ -1330,17 +1448,26 @@ void static ProcessGetData(CNode* pfrom, const CChainParams& chainparams, CConnm
             if(inv.type == MSG_TX || inv.type == MSG_WITNESS_TX){
                 auto mi = mapRelay.find(inv.hash);
                 int nSendFlags = (inv.type == MSG_TX ? SERIALIZE_TRANSACTION_NO_WITNESS : 0);
+                CTransactionRef tx;
                 if (mi != mapRelay.end()) {
-                    connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::TX, *mi->second));
-                    push = true;
+                    tx = mi->second;
                 } else if (pfrom->timeLastMempoolReq) {
                     auto txinfo = mempool.info(inv.hash);
                     // To protect privacy, do not answer getdata using the mempool when
                     // that TX couldn't have been INVed in reply to a MEMPOOL request.
-                    if (txinfo.tx && txinfo.nTime <= pfrom->timeLastMempoolReq) {
-                        connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::TX, *txinfo.tx));
-                        push = true;
-                    }
+                    if (txinfo.tx && txinfo.nTime <= pfrom->timeLastMempoolReq)
+                        tx = txinfo.tx;
+                }
+                if (tx) {
+                    // Witness serializations are cached by wtxid, so that a transaction relayed
+                    // with other witnesses under the same txid is never served in their place
+                    const uint256 hash = nSendFlags ? tx->GetHash() : tx->GetWitnessHash();
+                    CSharedNetMsgRef cached = relayCache.Get(hash, NetMsgType::TX, !nSendFlags);
+                    if (cached)
+                        connman->PushMessage(pfrom, cached);
+                    else
+                        PushRelayMessage(pfrom, connman, msgMaker, nSendFlags, hash, NetMsgType::TX, *tx);
+                    push = true;
                 }
             }
 
@@ -1352,23 +1479,18 @@ void static ProcessGetData(CNode* pfrom, const CChainParams& chainparams, CConnm
             }
 
             if (!push && inv.type == MSG_MASTERNODE_PAYMENT_VOTE) {
-                if(mnpayments.HasVerifiedPaymentVote(inv.hash)) {
-                    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::MASTERNODEPAYMENTVOTE, mnpayments.mapMasternodePaymentVotes[inv.hash]));
+                CMasternodePaymentVote vote;
+                if(mnpayments.GetPaymentVote(inv.hash, vote) && vote.IsVerified()) {
+                    connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::MASTERNODEPAYMENTVOTE, vote));
                     push = true;
                 }
             }
 
             if (!push && inv.type == MSG_MASTERNODE_PAYMENT_BLOCK) {
                 BlockMap::iterator mi = mapBlockIndex.find(inv.hash);
-                LOCK(cs_mapMasternodeBlocks);
-                if (mi != mapBlockIndex.end() && mnpayments.mapMasternodeBlocks.count(mi->second->nHeight)) {
-                    for(auto& payee: mnpayments.mapMasternodeBlocks[mi->second->nHeight].vecPayees) {
-                        std::vector<uint256> vecVoteHashes = payee.GetVoteHashes();
-                        for(auto& hash: vecVoteHashes) {
-                            if(mnpayments.HasVerifiedPaymentVote(hash)) {
-                                connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::MASTERNODEPAYMENTVOTE, mnpayments.mapMasternodePaymentVotes[hash]));
-                            }
-                        }
+                if (mi != mapBlockIndex.end() && mnpayments.HasPaymentBlock(mi->second->nHeight)) {
+                    for(const auto& vote: mnpayments.GetVerifiedBlockVotes(mi->second->nHeight)) {
+                        connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::MASTERNODEPAYMENTVOTE, vote));
                     }
                     push = true;
                 }
@@ -2392,21 +2514,23 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         CInv inv(MSG_TX, tx.GetHash());
         pfrom->AddInventoryKnown(inv);
 
-        LOCK2(cs_main, g_cs_orphans);
-
         bool fMissingInputs = false;
         CValidationState state;
+        std::list<CTransactionRef> lRemovedTxn;
+        // SYSCOIN relayed after cs_main is released, pushing to every peer need not hold up the other message handler threads
+        std::vector<CTransactionRef> vRelay;
+
+        {
+        LOCK2(cs_main, g_cs_orphans);
 
         pfrom->setAskFor.erase(inv.hash);
         mapAlreadyAskedFor.erase(inv.hash);
 
-        std::list<CTransactionRef> lRemovedTxn;
-
         if (!AlreadyHave(inv) &&
             AcceptToMemoryPool(mempool, state, ptx, &fMissingInputs, &lRemovedTxn, false /* bypass_limits */, 0 /* nAbsurdFee */, false /* fDryRun */, true /* bMultiThreaded */)) {
             // SYSCOIN
             //mempool.check(pcoinsTip.get());
-            RelayTransaction(tx, connman);
+            vRelay.push_back(ptx);
             for (unsigned int i = 0; i < tx.vout.size(); i++) {
                 vWorkQueue.emplace_back(inv.hash, i);
             }
@@ -2419,20 +2543,34 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 mempool.size(), mempool.DynamicMemoryUsage() / 1000);
 
             // Recursively process any orphan transactions that depended on this one
+            // SYSCOIN in rounds: every orphan spending any of the queued outpoints is tried once per
+            // round, oldest first, however many of its inputs were queued. A burst of asset
+            // transactions chained off one another then costs one ATMP call per orphan, not per input.
             std::set<NodeId> setMisbehaving;
+            // Orphans already accepted or removed, which stay in the pool until vEraseQueue is processed
+            std::set<std::map<uint256, COrphanTx>::iterator, IteratorComparator> setDone;
             while (!vWorkQueue.empty()) {
-                auto itByPrev = mapOrphanTransactionsByPrev.find(vWorkQueue.front());
-                vWorkQueue.pop_front();
-                if (itByPrev == mapOrphanTransactionsByPrev.end())
-                    continue;
-                for (auto mi = itByPrev->second.begin();
-                     mi != itByPrev->second.end();
-                     ++mi)
+                std::set<std::map<uint256, COrphanTx>::iterator, IteratorComparator> setRound;
+                for (const COutPoint& outpoint : vWorkQueue) {
+                    auto itByPrev = mapOrphanTransactionsByPrev.find(outpoint);
+                    if (itByPrev == mapOrphanTransactionsByPrev.end())
+                        continue;
+                    for (const auto& mi : itByPrev->second) {
+                        if (!setDone.count(mi))
+                            setRound.insert(mi);
+                    }
+                }
+                vWorkQueue.clear();
+                std::vector<std::map<uint256, COrphanTx>::iterator> vRound(setRound.begin(), setRound.end());
+                std::sort(vRound.begin(), vRound.end(), [](const std::map<uint256, COrphanTx>::iterator& a, const std::map<uint256, COrphanTx>::iterator& b) {
+                    return a->second.nTimeExpire < b->second.nTimeExpire;
+                });
+                for (const auto& mi : vRound)
                 {
-                    const CTransactionRef& porphanTx = (*mi)->second.tx;
+                    const CTransactionRef& porphanTx = mi->second.tx;
                     const CTransaction& orphanTx = *porphanTx;
                     const uint256& orphanHash = orphanTx.GetHash();
-                    NodeId fromPeer = (*mi)->second.fromPeer;
+                    NodeId fromPeer = mi->second.fromPeer;
                     bool fMissingInputs2 = false;
                     // Use a dummy CValidationState so someone can't setup nodes to counter-DoS based on orphan
                     // resolution (that is, feeding people an invalid transaction based on LegitTxX in order to get
@@ -2444,11 +2582,12 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                         continue;
                     if (AcceptToMemoryPool(mempool, stateDummy, porphanTx, &fMissingInputs2, &lRemovedTxn, false /* bypass_limits */, 0 /* nAbsurdFee */)) {
                         LogPrint(BCLog::MEMPOOL, "   accepted orphan tx %s\n", orphanHash.ToString());
-                        RelayTransaction(orphanTx, connman);
+                        vRelay.push_back(porphanTx);
                         for (unsigned int i = 0; i < orphanTx.vout.size(); i++) {
                             vWorkQueue.emplace_back(orphanHash, i);
                         }
                         vEraseQueue.push_back(orphanHash);
+                        setDone.insert(mi);
                     }
                     else if (!fMissingInputs2)
                     {
@@ -2464,6 +2603,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                         // Probably non-standard or insufficient fee
                         LogPrint(BCLog::MEMPOOL, "   removed orphan tx %s\n", orphanHash.ToString());
                         vEraseQueue.push_back(orphanHash);
+                        setDone.insert(mi);
                         if (!orphanTx.HasWitness() && !stateDummy.CorruptionPossible()) {
                             // Do not use rejection cache for witness transactions or
                             // witness-stripped transactions, as they can have been malleated.
@@ -2499,7 +2639,9 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
                 // DoS prevention: do not allow mapOrphanTransactions to grow unbounded
                 unsigned int nMaxOrphanTx = (unsigned int)std::max((int64_t)0, gArgs.GetArg("-maxorphantx", DEFAULT_MAX_ORPHAN_TRANSACTIONS));
-                unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTx);
+                // SYSCOIN
+                unsigned int nMaxOrphanAssetTx = (unsigned int)std::max((int64_t)0, gArgs.GetArg("-maxorphanassettx", DEFAULT_MAX_ORPHAN_ASSET_TRANSACTIONS));
+                unsigned int nEvicted = LimitOrphanTxSize(nMaxOrphanTx, nMaxOrphanAssetTx);
                 if (nEvicted > 0) {
                     LogPrint(BCLog::MEMPOOL, "mapOrphan overflow, removed %u tx\n", nEvicted);
                 }
@@ -2517,10 +2659,10 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 assert(recentRejects);
                 recentRejects->insert(tx.GetHash());
                 if (RecursiveDynamicUsage(*ptx) < 100000) {
-                    AddToCompactExtraTransactions(ptx);
+                    AddToCompactExtraTransactions(ptx, IsAssetTx(*ptx));
                 }
             } else if (tx.HasWitness() && RecursiveDynamicUsage(*ptx) < 100000) {
-                AddToCompactExtraTransactions(ptx);
+                AddToCompactExtraTransactions(ptx, IsAssetTx(*ptx));
             }
 
             if (pfrom->fWhitelisted && gArgs.GetBoolArg("-whitelistforcerelay", DEFAULT_WHITELISTFORCERELAY)) {
@@ -2535,7 +2677,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 int nDoS = 0;
                 if (!state.IsInvalid(nDoS) || nDoS == 0) {
                     LogPrintf("Force relaying tx %s from whitelisted peer=%d\n", tx.GetHash().ToString(), pfrom->GetId());
-                    RelayTransaction(tx, connman);
+                    vRelay.push_back(ptx);
                 } else {
                     LogPrintf("Not relaying invalid transaction %s from whitelisted peer=%d (%s)\n", tx.GetHash().ToString(), pfrom->GetId(), FormatStateMessage(state));
                 }
@@ -2543,7 +2685,11 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         }
 
         for (const CTransactionRef& removedTx : lRemovedTxn)
-            AddToCompactExtraTransactions(removedTx);
+            AddToCompactExtraTransactions(removedTx, IsAssetTx(*removedTx));
+        }
+
+        for (const CTransactionRef& relayTx : vRelay)
+            RelayTransaction(*relayTx, connman);
 
         int nDoS = 0;
         if (state.IsInvalid(nDoS))
@@ -2556,6 +2702,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                                    state.GetRejectReason().substr(0, MAX_REJECT_MESSAGE_LENGTH), inv.hash));
             }
             if (nDoS > 0) {
+                LOCK(cs_main);
                 Misbehaving(pfrom->GetId(), nDoS);
             }
         }
@@ -2674,7 +2821,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 }
 
                 PartiallyDownloadedBlock& partialBlock = *(*queuedBlockIt)->partialBlock;
-                ReadStatus status = partialBlock.InitData(cmpctblock, vExtraTxnForCompact);
+                ReadStatus status = partialBlock.InitData(cmpctblock, vExtraTxnForCompact, vExtraAssetTxnForCompact);
                 if (status == READ_STATUS_INVALID) {
                     MarkBlockAsReceived(pindex->GetBlockHash()); // Reset in-flight state in case of whitelist
                     Misbehaving(pfrom->GetId(), 100, strprintf("Peer %d sent us invalid compact block\n", pfrom->GetId()));
@@ -2692,6 +2839,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     if (!partialBlock.IsTxAvailable(i))
                         req.indexes.push_back(i);
                 }
+                // SYSCOIN
+                RecordCompactBlockStats(partialBlock, req.indexes.size());
                 if (req.indexes.empty()) {
                     // Dirty hack to jump to BLOCKTXN code (TODO: move message handling into their own functions)
                     BlockTransactions txn;
@@ -2709,7 +2858,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 // Optimistically try to reconstruct anyway since we might be
                 // able to without any round trips.
                 PartiallyDownloadedBlock tempBlock(&mempool);
-                ReadStatus status = tempBlock.InitData(cmpctblock, vExtraTxnForCompact);
+                ReadStatus status = tempBlock.InitData(cmpctblock, vExtraTxnForCompact, vExtraAssetTxnForCompact);
                 if (status != READ_STATUS_OK) {
                     // TODO: don't ignore failures
                     return true;
@@ -2719,6 +2868,8 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 if (status == READ_STATUS_OK) {
                     fBlockReconstructed = true;
                 }
+                // SYSCOIN nothing is requested for this block, so what was missing counts as neither
+                RecordCompactBlockStats(tempBlock, 0, status == READ_STATUS_OK);
             }
         } else {
             if (fAlreadyInFlight) {
@@ -2932,7 +3083,10 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         }
         pfrom->fSentAddr = true;
 
-        pfrom->vAddrToSend.clear();
+        {
+            LOCK(pfrom->cs_addrSend);
+            pfrom->vAddrToSend.clear();
+        }
         std::vector<CAddress> vAddr = connman->GetAddresses();
         FastRandomContext insecure_rand;
         for (const CAddress &addr : vAddr)
@@ -3175,6 +3329,94 @@ static bool SendRejectsAndCheckIfBanned(CNode* pnode, CConnman* connman, bool en
     return false;
 }
 
+// SYSCOIN
+static bool IsSigPrefetchCommand(const std::string& strCommand)
+{
+    return strCommand == NetMsgType::MNANNOUNCE || strCommand == NetMsgType::MNPING ||
+           strCommand == NetMsgType::MASTERNODEPAYMENTVOTE || strCommand == NetMsgType::MNGOVERNANCEOBJECTVOTE;
+}
+
+/**
+ * Collect the signatures carried by a masternode broadcast, ping, payment vote
+ * or governance vote. Messages which fail to deserialize or refer to an unknown
+ * masternode are skipped, they are dealt with when processed.
+ */
+static void GetMessageSignatureChecks(const std::string& strCommand, CDataStream& vRecv, std::vector<CHashSignerCheck>& vChecks)
+{
+    try {
+        if (strCommand == NetMsgType::MNANNOUNCE) {
+            CMasternodeBroadcast mnb;
+            vRecv >> mnb;
+            vChecks.emplace_back(mnb.GetSignatureHash(), mnb.pubKeyCollateralAddress.GetID(), mnb.vchSig);
+            vChecks.emplace_back(mnb.lastPing.GetSignatureHash(), mnb.pubKeyMasternode.GetID(), mnb.lastPing.vchSig);
+        } else if (strCommand == NetMsgType::MNPING) {
+            CMasternodePing mnp;
+            vRecv >> mnp;
+            masternode_info_t infoMn;
+            if (mnodeman.GetMasternodeInfo(mnp.masternodeOutpoint, infoMn))
+                vChecks.emplace_back(mnp.GetSignatureHash(), infoMn.pubKeyMasternode.GetID(), mnp.vchSig);
+        } else if (strCommand == NetMsgType::MASTERNODEPAYMENTVOTE) {
+            CMasternodePaymentVote vote;
+            vRecv >> vote;
+            masternode_info_t infoMn;
+            if (mnodeman.GetMasternodeInfo(vote.masternodeOutpoint, infoMn))
+                vChecks.emplace_back(vote.GetSignatureHash(), infoMn.pubKeyMasternode.GetID(), vote.vchSig);
+        } else if (strCommand == NetMsgType::MNGOVERNANCEOBJECTVOTE) {
+            CGovernanceVote vote;
+            vRecv >> vote;
+            masternode_info_t infoMn;
+            if (mnodeman.GetMasternodeInfo(vote.GetMasternodeOutpoint(), infoMn))
+                vChecks.emplace_back(vote.GetSignatureHash(), infoMn.pubKeyMasternode.GetID(), vote.GetSignature());
+        }
+    } catch (const std::exception&) {
+        // malformed message, ProcessMessage will reject it
+    }
+}
+
+/**
+ * Verify the signatures of the given message and of the masternode/governance
+ * messages queued behind it as one parallel batch. The messages are still
+ * processed one at a time and in order by ProcessMessage, where their
+ * CheckSignature() calls now hit the message signature cache. A message with
+ * nothing queued behind it is verified right here, which keeps the check out
+ * of the cs_main scope the masternode managers run it in.
+ */
+static void PrefetchMessageSignatures(CNode* pfrom, const CNetMessage& msg)
+{
+    if (fLiteMode || !masternodeSync.IsBlockchainSynced() || !sporkManager.IsSporkActive(SPORK_6_NEW_SIGS))
+        return;
+
+    std::vector<std::pair<std::string, CDataStream> > vQueued;
+    vQueued.emplace_back(msg.hdr.GetCommand(), msg.vRecv);
+    {
+        LOCK(pfrom->cs_vProcessMsg);
+        size_t nScanned = 0;
+        for (const CNetMessage& queued : pfrom->vProcessMsg) {
+            if (nScanned == MAX_SIG_PREFETCH_MESSAGES)
+                break;
+            ++nScanned;
+            std::string strCommand = queued.hdr.GetCommand();
+            if (IsSigPrefetchCommand(strCommand))
+                vQueued.emplace_back(strCommand, queued.vRecv);
+        }
+        pfrom->nSigPrefetchedMsgs = nScanned;
+    }
+
+    std::vector<CHashSignerCheck> vChecks;
+    vChecks.reserve(vQueued.size() * 2);
+    for (auto& queued : vQueued) {
+        queued.second.SetVersion(pfrom->GetRecvVersion());
+        GetMessageSignatureChecks(queued.first, queued.second, vChecks);
+    }
+    if (vQueued.size() < 2) {
+        for (CHashSignerCheck& check : vChecks)
+            check();
+        return;
+    }
+    LogPrint(BCLog::NET, "%s: pre-verifying %u signatures from %u queued messages, peer=%d\n", __func__, vChecks.size(), vQueued.size(), pfrom->GetId());
+    CHashSigner::PreVerifyHashes(vChecks);
+}
+
 bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptMsgProc)
 {
     const CChainParams& chainparams = Params();
@@ -3202,6 +3444,7 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         return false;
 
     std::list<CNetMessage> msgs;
+    bool fPrefetchSigs = false;
     {
         LOCK(pfrom->cs_vProcessMsg);
         if (pfrom->vProcessMsg.empty())
@@ -3211,10 +3454,19 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
         pfrom->fPauseRecv = pfrom->nProcessQueueSize > connman->GetReceiveFloodSize();
         fMoreWork = !pfrom->vProcessMsg.empty();
+        // SYSCOIN
+        if (pfrom->nSigPrefetchedMsgs > 0) {
+            pfrom->nSigPrefetchedMsgs--;
+        } else {
+            fPrefetchSigs = IsSigPrefetchCommand(msgs.front().hdr.GetCommand());
+        }
     }
     CNetMessage& msg(msgs.front());
 
     msg.SetVersion(pfrom->GetRecvVersion());
+    // SYSCOIN
+    if (fPrefetchSigs)
+        PrefetchMessageSignatures(pfrom, msg);
     // Scan for message start
     if (memcmp(msg.hdr.pchMessageStart, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE) != 0) {
         LogPrint(BCLog::NET, "PROCESSMESSAGE: INVALID MESSAGESTART %s peer=%d\n", SanitizeString(msg.hdr.GetCommand()), pfrom->GetId());
@@ -3511,6 +3763,7 @@ bool PeerLogicValidation::SendMessages(CNode* pto)
         if (pto->nNextAddrSend < nNow) {
             pto->nNextAddrSend = PoissonNextSend(nNow, AVG_ADDRESS_BROADCAST_INTERVAL);
             std::vector<CAddress> vAddr;
+            LOCK(pto->cs_addrSend);
             vAddr.reserve(pto->vAddrToSend.size());
             for (const CAddress& addr : pto->vAddrToSend)
             {
@@ -3647,7 +3900,7 @@ bool PeerLogicValidation::SendMessages(CNode* pto)
                         LOCK(cs_most_recent_block);
                         if (most_recent_block_hash == pBestIndex->GetBlockHash()) {
                             if (state.fWantsCmpctWitness || !fWitnessesPresentInMostRecentCompactBlock)
-                                connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, *most_recent_compact_block));
+                                connman->PushMessage(pto, most_recent_compact_block_msg);
                             else {
                                 CBlockHeaderAndShortTxIDs cmpctblock(*most_recent_block, state.fWantsCmpctWitness);
                                 connman->PushMessage(pto, msgMaker.Make(nSendFlags, NetMsgType::CMPCTBLOCK, cmpctblock));
@@ -4001,5 +4254,6 @@ public:
         // orphan transactions
         mapOrphanTransactions.clear();
         mapOrphanTransactionsByPrev.clear();
+        nOrphanAssetTransactions = 0;
     }
 } instance_of_cnetprocessingcleanup;
@@ -14,6 +14,12 @@
 static const unsigned int DEFAULT_MAX_ORPHAN_TRANSACTIONS = 100;
 /** Default number of orphan+recently-replaced txn to keep around for block reconstruction */
 static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_TXN = 100;
+// SYSCOIN
+/** Default for -maxorphanassettx, maximum number of orphan asset transactions kept in memory next to the others.
+ *  Larger than -maxorphantx since ZDAG senders chain many small allocation sends that often arrive out of order */
+static const unsigned int DEFAULT_MAX_ORPHAN_ASSET_TRANSACTIONS = 300;
+/** Default number of orphan+recently-replaced asset txn to keep around for block reconstruction, sized like the asset orphan pool */
+static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_EXTRA_ASSET_TXN = 300;
 /** Default for BIP61 (sending reject messages) */
 static constexpr bool DEFAULT_ENABLE_BIP61 = true;
 
@@ -83,4 +89,25 @@ struct CNodeStateStats {
 
 /** Get statistics from node state */
 bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats);
+
+// SYSCOIN
+/** How well compact blocks were reconstructed since startup, and what the orphan pools hold */
+struct CCompactBlockStats {
+    uint64_t nBlocks = 0;            //!< compact blocks we started reconstructing
+    uint64_t nReconstructed = 0;     //!< of those, completed without asking the peer for transactions
+    uint64_t nRoundTrips = 0;        //!< of those, that needed a getblocktxn round trip
+    uint64_t nTxPrefilled = 0;       //!< transactions sent along in the compact block
+    uint64_t nTxFromMempool = 0;     //!< transactions found in the mempool
+    uint64_t nTxFromExtra = 0;       //!< transactions found among the extra transactions
+    uint64_t nTxFromAssetExtra = 0;  //!< transactions found among the extra asset transactions
+    uint64_t nTxRequested = 0;       //!< transactions that had to be requested
+    size_t nOrphans = 0;
+    size_t nAssetOrphans = 0;
+};
+
+void GetCompactBlockStats(CCompactBlockStats &stats);
+
+struct CRelayCacheStats;
+/** How often getdata for transactions and blocks was answered from the relay cache */
+void GetRelayCacheStats(CRelayCacheStats &stats);
 #endif // SYSCOIN_NET_PROCESSING_H
@@ -52,6 +52,7 @@ const char *MNPING="mnp";
 const char *DSEG="dseg";
 const char *SYNCSTATUSCOUNT="ssc";
 const char *MNGOVERNANCESYNC="govsync";
+const char *MNGOVERNANCESYNCPAGE="govsyncpage";
 const char *MNGOVERNANCEOBJECT="govobj";
 const char *MNGOVERNANCEOBJECTVOTE="govobjvote";
 const char *MNVERIFY="mnv";
@@ -99,6 +100,7 @@ const static std::string allNetMessageTypes[] = {
     NetMsgType::SYNCSTATUSCOUNT,
     NetMsgType::MNGOVERNANCEOBJECT,
     NetMsgType::MNGOVERNANCESYNC,
+    NetMsgType::MNGOVERNANCESYNCPAGE,
     NetMsgType::MNGOVERNANCEOBJECTVOTE,
     NetMsgType::MNVERIFY,    
 };
@@ -0,0 +1,86 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <relaycache.h>
+
+/** Allowance for an entry's list and index nodes and its key */
+static const size_t ENTRY_OVERHEAD = 256;
+
+CRelayCache::CRelayCache(size_t nMaxBytes) : m_max_bytes(nMaxBytes), m_bytes(0), m_hits(0), m_misses(0)
+{
+}
+
+size_t CRelayCache::EntryBytes(const Entry& entry)
+{
+    // The message is counted in full even while peers still hold it, as it is freed with the last of them
+    return entry.msg->size() + ENTRY_OVERHEAD;
+}
+
+CSharedNetMsgRef CRelayCache::Get(const uint256& hash, const std::string& command, bool fWitness)
+{
+    LOCK(cs);
+    auto it = m_index.find(Key(hash, command, fWitness));
+    if (it == m_index.end()) {
+        m_misses++;
+        return nullptr;
+    }
+    m_hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->msg;
+}
+
+void CRelayCache::Put(const uint256& hash, const std::string& command, bool fWitness, const CSharedNetMsgRef& msg)
+{
+    Key key(hash, command, fWitness);
+    LOCK(cs);
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_bytes -= EntryBytes(*it->second);
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+    // A message that does not fit at all would only push everything else out
+    if (msg->size() + ENTRY_OVERHEAD > m_max_bytes)
+        return;
+    m_entries.push_front(Entry{key, msg});
+    m_index.emplace(std::move(key), m_entries.begin());
+    m_bytes += EntryBytes(m_entries.front());
+    Trim();
+}
+
+void CRelayCache::SetMaxBytes(size_t nMaxBytes)
+{
+    LOCK(cs);
+    m_max_bytes = nMaxBytes;
+    Trim();
+}
+
+void CRelayCache::Clear()
+{
+    LOCK(cs);
+    m_index.clear();
+    m_entries.clear();
+    m_bytes = 0;
+}
+
+CRelayCacheStats CRelayCache::GetStats() const
+{
+    LOCK(cs);
+    CRelayCacheStats stats;
+    stats.nEntries = m_entries.size();
+    stats.nBytes = m_bytes;
+    stats.nHits = m_hits;
+    stats.nMisses = m_misses;
+    return stats;
+}
+
+void CRelayCache::Trim()
+{
+    while (m_bytes > m_max_bytes && !m_entries.empty()) {
+        const Entry& entry = m_entries.back();
+        m_bytes -= EntryBytes(entry);
+        m_index.erase(entry.key);
+        m_entries.pop_back();
+    }
+}
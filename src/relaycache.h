@@ -0,0 +1,73 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SYSCOIN_RELAYCACHE_H
+#define SYSCOIN_RELAYCACHE_H
+
+#include <net.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <tuple>
+
+/** Default for -relaycachesize, in MiB */
+static const int64_t DEFAULT_RELAY_CACHE_SIZE = 32;
+
+/** What a CRelayCache holds and has done since startup */
+struct CRelayCacheStats {
+    size_t nEntries = 0;
+    size_t nBytes = 0;
+    uint64_t nHits = 0;
+    uint64_t nMisses = 0;
+};
+
+/**
+ * Wire messages of transactions and blocks, serialized for one peer and
+ * served as they are to every other peer that asks for the same object.
+ * Entries are keyed by the object's hash, the message command and whether
+ * witnesses are included, and the least recently used ones make room once the
+ * cached messages take more than the given number of bytes.
+ *
+ * The cached bytes only depend on the object they serialize, so entries never
+ * go stale. Whether a peer may be sent an object at all is up to the caller.
+ */
+class CRelayCache
+{
+public:
+    explicit CRelayCache(size_t nMaxBytes);
+
+    /** The cached message for an object, or nullptr if there is none */
+    CSharedNetMsgRef Get(const uint256& hash, const std::string& command, bool fWitness);
+    /** Cache msg for an object, replacing an entry it already had */
+    void Put(const uint256& hash, const std::string& command, bool fWitness, const CSharedNetMsgRef& msg);
+
+    void SetMaxBytes(size_t nMaxBytes);
+    void Clear();
+    CRelayCacheStats GetStats() const;
+
+private:
+    typedef std::tuple<uint256, std::string, bool> Key;
+    struct Entry {
+        Key key;
+        CSharedNetMsgRef msg;
+    };
+
+    /** Drop least recently used entries until the rest fit */
+    void Trim() EXCLUSIVE_LOCKS_REQUIRED(cs);
+    static size_t EntryBytes(const Entry& entry);
+
+    mutable CCriticalSection cs;
+    size_t m_max_bytes GUARDED_BY(cs);
+    size_t m_bytes GUARDED_BY(cs);
+    uint64_t m_hits GUARDED_BY(cs);
+    uint64_t m_misses GUARDED_BY(cs);
+    //! most recently used first
+    std::list<Entry> m_entries GUARDED_BY(cs);
+    std::map<Key, std::list<Entry>::iterator> m_index GUARDED_BY(cs);
+};
+
+#endif // SYSCOIN_RELAYCACHE_H
@@ -26,6 +26,7 @@
 #include <sync.h>
 #include <txdb.h>
 #include <txmempool.h>
+#include <txoutsetscan.h>
 #include <util.h>
 #include <utilstrencodings.h>
 #include <hash.h>
@@ -2010,71 +2011,97 @@ static UniValue savemempool(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
-//! Search for a given set of pubkey scripts
-bool FindScriptPubKey(std::atomic<int>& scan_progress, const std::atomic<bool>& should_abort, int64_t& count, CCoinsViewCursor* cursor, const std::set<CScript>& needles, std::map<COutPoint, Coin>& out_results) {
-    scan_progress = 0;
-    count = 0;
-    while (cursor->Valid()) {
-        COutPoint key;
-        Coin coin;
-        if (!cursor->GetKey(key) || !cursor->GetValue(coin)) return false;
-        if (++count % 8192 == 0) {
-            boost::this_thread::interruption_point();
-            if (should_abort) {
-                // allow to abort the scan via the abort reference
-                return false;
+//! Expand the scan objects of scantxoutset into the set of scripts to look for
+static std::set<CScript> GetScanNeedles(const UniValue& scanobjects)
+{
+    std::set<CScript> needles;
+    // loop through the scan objects
+    for (const UniValue& scanobject : scanobjects.get_array().getValues()) {
+        std::string desc_str;
+        int range = 1000;
+        if (scanobject.isStr()) {
+            desc_str = scanobject.get_str();
+        } else if (scanobject.isObject()) {
+            UniValue desc_uni = find_value(scanobject, "desc");
+            if (desc_uni.isNull()) throw JSONRPCError(RPC_INVALID_PARAMETER, "Descriptor needs to be provided in scan object");
+            desc_str = desc_uni.get_str();
+            UniValue range_uni = find_value(scanobject, "range");
+            if (!range_uni.isNull()) {
+                range = range_uni.get_int();
+                if (range < 0 || range > 1000000) throw JSONRPCError(RPC_INVALID_PARAMETER, "range out of range");
             }
+        } else {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Scan object needs to be either a string or an object");
         }
-        if (count % 256 == 0) {
-            // update progress reference every 256 item
-            uint32_t high = 0x100 * *key.hash.begin() + *(key.hash.begin() + 1);
-            scan_progress = (int)(high * 100.0 / 65536.0 + 0.5);
+
+        FlatSigningProvider provider;
+        auto desc = Parse(desc_str, provider);
+        if (!desc) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Invalid descriptor '%s'", desc_str));
         }
-        if (needles.count(coin.out.scriptPubKey)) {
-            out_results.emplace(key, coin);
+        if (!desc->IsRange()) range = 0;
+        for (int i = 0; i <= range; ++i) {
+            std::vector<CScript> scripts;
+            if (!desc->Expand(i, provider, scripts, provider)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Cannot derive script without private keys: '%s'", desc_str));
+            }
+            needles.insert(scripts.begin(), scripts.end());
         }
-        cursor->Next();
     }
-    scan_progress = 100;
-    return true;
+    return needles;
 }
 
-/** RAII object to prevent concurrency issue when scanning the txout set */
-static std::mutex g_utxosetscan;
-static std::atomic<int> g_scan_progress;
-static std::atomic<bool> g_scan_in_progress;
-static std::atomic<bool> g_should_abort_scan;
-class CoinsViewScanReserver
+//! Flush the coins cache and start scanning a snapshot of the UTXO set for needles
+static std::shared_ptr<CTxOutSetScan> StartTxOutSetScan(std::set<CScript> needles)
 {
-private:
-    bool m_could_reserve;
-public:
-    explicit CoinsViewScanReserver() : m_could_reserve(false) {}
-
-    bool reserve() {
-        assert (!m_could_reserve);
-        std::lock_guard<std::mutex> lock(g_utxosetscan);
-        if (g_scan_in_progress) {
-            return false;
-        }
-        g_scan_in_progress = true;
-        m_could_reserve = true;
-        return true;
+    // A full registry is turned down before the flush and the scan threads. Another request may
+    // still take the last slot in between, which AddTxOutSetScan then refuses.
+    if (!HaveRoomForTxOutSetScan()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Too many scans in progress, use action \"fetch\" or \"abort\"");
     }
+    const unsigned int nThreads = std::min<unsigned int>(std::max(GetNumCores(), 1), MAX_TXOUTSET_SCAN_THREADS);
+    std::shared_ptr<CTxOutSetScan> scan = std::make_shared<CTxOutSetScan>(std::move(needles), nThreads);
+    LOCK(cs_main);
+    FlushStateToDisk();
+    scan->Start(*pcoinsdbview);
+    return scan;
+}
 
-    ~CoinsViewScanReserver() {
-        if (m_could_reserve) {
-            std::lock_guard<std::mutex> lock(g_utxosetscan);
-            g_scan_in_progress = false;
-        }
-    }
-};
+//! Append the unspents to result and return their total amount
+static CAmount PushUnspents(const std::vector<std::pair<COutPoint, Coin>>& coins, UniValue& unspents)
+{
+    CAmount total_in = 0;
+    for (const auto& it : coins) {
+        const COutPoint& outpoint = it.first;
+        const Coin& coin = it.second;
+        const CTxOut& txo = coin.out;
+        total_in += txo.nValue;
+
+        UniValue unspent(UniValue::VOBJ);
+        unspent.pushKV("txid", outpoint.hash.GetHex());
+        unspent.pushKV("vout", (int32_t)outpoint.n);
+        unspent.pushKV("scriptPubKey", HexStr(txo.scriptPubKey.begin(), txo.scriptPubKey.end()));
+        unspent.pushKV("amount", ValueFromAmount(txo.nValue));
+        unspent.pushKV("height", (int32_t)coin.nHeight);
+
+        unspents.push_back(unspent);
+    }
+    return total_in;
+}
+
+static uint64_t GetScanJobId(const UniValue& param)
+{
+    RPCTypeCheckArgument(param, UniValue::VNUM);
+    const int64_t id = param.get_int64();
+    if (id <= 0) throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid jobid");
+    return id;
+}
 
 UniValue scantxoutset(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
         throw std::runtime_error(
-            "scantxoutset <action> ( <scanobjects> )\n"
+            "scantxoutset <action> ( <scanobjects> | <jobid> )\n"
             "\nEXPERIMENTAL warning: this call may be removed or changed in future releases.\n"
             "\nScans the unspent transaction output set for entries that match certain output descriptors.\n"
             "Examples of output descriptors are:\n"
@@ -2088,12 +2115,16 @@ UniValue scantxoutset(const JSONRPCRequest& request)
             "unhardened or hardened child keys.\n"
             "In the latter case, a range needs to be specified by below if different from 1000.\n"
             "For more information on output descriptors, see the documentation in the doc/descriptors.md file.\n"
+            "\nEvery scan reads a consistent snapshot of the UTXO set taken when it starts, split across several threads,\n"
+            "and does not block block processing or other scans. Up to " + std::to_string(MAX_TXOUTSET_SCANS) + " scans may be held at once.\n"
             "\nArguments:\n"
             "1. \"action\"                       (string, required) The action to execute\n"
-            "                                      \"start\" for starting a scan\n"
-            "                                      \"abort\" for aborting the current scan (returns true when abort was successful)\n"
-            "                                      \"status\" for progress report (in %) of the current scan\n"
-            "2. \"scanobjects\"                  (array, required) Array of scan objects\n"
+            "                                      \"start\" for running a scan and waiting for its result\n"
+            "                                      \"begin\" for starting a scan in the background (returns its jobid)\n"
+            "                                      \"fetch\" for the unspents a background scan found since the last fetch\n"
+            "                                      \"abort\" for aborting a scan, or all scans without a jobid (returns true when abort was successful)\n"
+            "                                      \"status\" for progress report (in %) of a scan, or of the running scan without a jobid\n"
+            "2. \"scanobjects\"                  (array, required for \"start\" and \"begin\") Array of scan objects\n"
             "    [                             Every scan object is either a string descriptor or an object:\n"
             "        \"descriptor\",             (string, optional) An output descriptor\n"
             "        {                         (object, optional) An object with output descriptor and metadata\n"
@@ -2102,8 +2133,11 @@ UniValue scantxoutset(const JSONRPCRequest& request)
             "        },\n"
             "        ...\n"
             "    ]\n"
-            "\nResult:\n"
+            "2. jobid                          (numeric, required for \"fetch\", optional for \"status\" and \"abort\") The id returned by \"begin\"\n"
+            "\nResult (for \"start\"):\n"
             "{\n"
+            "  \"success\": true|false,          (boolean) Whether the whole UTXO set was scanned\n"
+            "  \"searched_items\": n,            (numeric) The number of unspent outputs scanned\n"
             "  \"unspents\": [\n"
             "    {\n"
             "    \"txid\" : \"transactionid\",     (string) The transaction id\n"
@@ -2115,104 +2149,117 @@ UniValue scantxoutset(const JSONRPCRequest& request)
             "   ,...], \n"
             " \"total_amount\" : x.xxx,          (numeric) The total amount of all found unspent outputs in " + CURRENCY_UNIT + "\n"
             "]\n"
+            "\nResult (for \"begin\"):\n"
+            "{\n"
+            "  \"jobid\": n                      (numeric) The id to pass to \"fetch\", \"status\" and \"abort\"\n"
+            "}\n"
+            "\nResult (for \"fetch\"):\n"
+            "{\n"
+            "  \"done\": true|false,             (boolean) Whether the scan has finished; the job is forgotten once done and fetched\n"
+            "  \"success\": true|false,          (boolean, only when done) Whether the whole UTXO set was scanned\n"
+            "  \"unspents\": [ ... ],            (array) The unspents found since the last fetch, as for \"start\"\n"
+            "  \"total_amount\" : x.xxx,         (numeric) The total amount of these unspents in " + CURRENCY_UNIT + "\n"
+            "}\n"
+            "\nResult (for \"status\" with a jobid):\n"
+            "{\n"
+            "  \"progress\": n,                  (numeric) Percentage of the UTXO set scanned\n"
+            "  \"done\": true|false,             (boolean) Whether the scan has finished\n"
+            "  \"success\": true|false,          (boolean) Whether the scan finished and scanned the whole UTXO set\n"
+            "  \"searched_items\": n,            (numeric) The number of unspent outputs scanned so far\n"
+            "  \"threads\": n                    (numeric) The number of threads the scan runs on\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("scantxoutset", "start \"[\\\"addr(<address>)\\\"]\"")
+            + HelpExampleCli("scantxoutset", "begin \"[\\\"addr(<address>)\\\"]\"")
+            + HelpExampleCli("scantxoutset", "fetch 1")
         );
 
-    RPCTypeCheck(request.params, {UniValue::VSTR, UniValue::VARR});
+    RPCTypeCheckArgument(request.params[0], UniValue::VSTR);
+    const std::string& action = request.params[0].get_str();
 
     UniValue result(UniValue::VOBJ);
-    if (request.params[0].get_str() == "status") {
-        CoinsViewScanReserver reserver;
-        if (reserver.reserve()) {
+    if (action == "status") {
+        if (request.params[1].isNull()) {
+            // the legacy form reports on the oldest scan that is still running
+            for (const auto& entry : GetTxOutSetScans()) {
+                if (!entry.second->IsDone()) {
+                    result.pushKV("progress", entry.second->Progress());
+                    return result;
+                }
+            }
             // no scan in progress
             return NullUniValue;
         }
-        result.pushKV("progress", g_scan_progress);
+        std::shared_ptr<CTxOutSetScan> scan = GetTxOutSetScan(GetScanJobId(request.params[1]));
+        if (!scan) throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown jobid");
+        result.pushKV("progress", scan->Progress());
+        result.pushKV("done", scan->IsDone());
+        result.pushKV("success", scan->Succeeded());
+        result.pushKV("searched_items", scan->SearchedItems());
+        result.pushKV("threads", (uint64_t)scan->Threads());
         return result;
-    } else if (request.params[0].get_str() == "abort") {
-        CoinsViewScanReserver reserver;
-        if (reserver.reserve()) {
-            // reserve was possible which means no scan was running
-            return false;
-        }
-        // set the abort flag
-        g_should_abort_scan = true;
-        return true;
-    } else if (request.params[0].get_str() == "start") {
-        CoinsViewScanReserver reserver;
-        if (!reserver.reserve()) {
-            throw JSONRPCError(RPC_INVALID_PARAMETER, "Scan already in progress, use action \"abort\" or \"status\"");
-        }
-        std::set<CScript> needles;
-        CAmount total_in = 0;
-
-        // loop through the scan objects
-        for (const UniValue& scanobject : request.params[1].get_array().getValues()) {
-            std::string desc_str;
-            int range = 1000;
-            if (scanobject.isStr()) {
-                desc_str = scanobject.get_str();
-            } else if (scanobject.isObject()) {
-                UniValue desc_uni = find_value(scanobject, "desc");
-                if (desc_uni.isNull()) throw JSONRPCError(RPC_INVALID_PARAMETER, "Descriptor needs to be provided in scan object");
-                desc_str = desc_uni.get_str();
-                UniValue range_uni = find_value(scanobject, "range");
-                if (!range_uni.isNull()) {
-                    range = range_uni.get_int();
-                    if (range < 0 || range > 1000000) throw JSONRPCError(RPC_INVALID_PARAMETER, "range out of range");
+    } else if (action == "abort") {
+        bool fAborted = false;
+        if (request.params[1].isNull()) {
+            for (const auto& entry : GetTxOutSetScans()) {
+                if (!entry.second->IsDone()) {
+                    entry.second->Abort();
+                    fAborted = true;
                 }
-            } else {
-                throw JSONRPCError(RPC_INVALID_PARAMETER, "Scan object needs to be either a string or an object");
-            }
-
-            FlatSigningProvider provider;
-            auto desc = Parse(desc_str, provider);
-            if (!desc) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Invalid descriptor '%s'", desc_str));
             }
-            if (!desc->IsRange()) range = 0;
-            for (int i = 0; i <= range; ++i) {
-                std::vector<CScript> scripts;
-                if (!desc->Expand(i, provider, scripts, provider)) {
-                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("Cannot derive script without private keys: '%s'", desc_str));
-                }
-                needles.insert(scripts.begin(), scripts.end());
+        } else {
+            std::shared_ptr<CTxOutSetScan> scan = GetTxOutSetScan(GetScanJobId(request.params[1]));
+            if (scan && !scan->IsDone()) {
+                scan->Abort();
+                fAborted = true;
             }
         }
+        // false means there was no running scan to abort
+        return fAborted;
+    } else if (action == "fetch") {
+        const uint64_t id = GetScanJobId(request.params[1]);
+        std::shared_ptr<CTxOutSetScan> scan = GetTxOutSetScan(id);
+        if (!scan) throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown jobid");
+        // Check for completion first so that nothing found after the fetch is missed
+        const bool fDone = scan->IsDone();
+        std::vector<std::pair<COutPoint, Coin>> coins;
+        scan->FetchResults(coins);
+        if (fDone) RemoveTxOutSetScan(id);
 
-        // Scan the unspent transaction output set for inputs
         UniValue unspents(UniValue::VARR);
-        std::vector<CTxOut> input_txos;
-        std::map<COutPoint, Coin> coins;
-        g_should_abort_scan = false;
-        g_scan_progress = 0;
-        int64_t count = 0;
-        std::unique_ptr<CCoinsViewCursor> pcursor;
-        {
-            LOCK(cs_main);
-            FlushStateToDisk();
-            pcursor = std::unique_ptr<CCoinsViewCursor>(pcoinsdbview->Cursor());
-            assert(pcursor);
+        const CAmount total_in = PushUnspents(coins, unspents);
+        result.pushKV("done", fDone);
+        if (fDone) result.pushKV("success", scan->Succeeded());
+        result.pushKV("unspents", unspents);
+        result.pushKV("total_amount", ValueFromAmount(total_in));
+    } else if (action == "begin") {
+        RPCTypeCheckArgument(request.params[1], UniValue::VARR);
+        std::shared_ptr<CTxOutSetScan> scan = StartTxOutSetScan(GetScanNeedles(request.params[1]));
+        const uint64_t id = AddTxOutSetScan(scan);
+        if (!id) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Too many scans in progress, use action \"fetch\" or \"abort\"");
         }
-        bool res = FindScriptPubKey(g_scan_progress, g_should_abort_scan, count, pcursor.get(), needles, coins);
-        result.pushKV("success", res);
-        result.pushKV("searched_items", count);
-
-        for (const auto& it : coins) {
-            const COutPoint& outpoint = it.first;
-            const Coin& coin = it.second;
-            const CTxOut& txo = coin.out;
-            input_txos.push_back(txo);
-            total_in += txo.nValue;
-
-            UniValue unspent(UniValue::VOBJ);
-            unspent.pushKV("txid", outpoint.hash.GetHex());
-            unspent.pushKV("vout", (int32_t)outpoint.n);
-            unspent.pushKV("scriptPubKey", HexStr(txo.scriptPubKey.begin(), txo.scriptPubKey.end()));
-            unspent.pushKV("amount", ValueFromAmount(txo.nValue));
-            unspent.pushKV("height", (int32_t)coin.nHeight);
-
-            unspents.push_back(unspent);
+        result.pushKV("jobid", id);
+    } else if (action == "start") {
+        RPCTypeCheckArgument(request.params[1], UniValue::VARR);
+        std::shared_ptr<CTxOutSetScan> scan = StartTxOutSetScan(GetScanNeedles(request.params[1]));
+        // Registered so that "status" and "abort" without a jobid still reach it
+        const uint64_t id = AddTxOutSetScan(scan);
+        if (!id) {
+            throw JSONRPCError(RPC_MISC_ERROR, "Too many scans in progress, use action \"fetch\" or \"abort\"");
         }
+        scan->Wait();
+        RemoveTxOutSetScan(id);
+        std::vector<std::pair<COutPoint, Coin>> coins;
+        scan->FetchResults(coins);
+        std::sort(coins.begin(), coins.end(), [](const std::pair<COutPoint, Coin>& a, const std::pair<COutPoint, Coin>& b) {
+            return a.first < b.first;
+        });
+
+        result.pushKV("success", scan->Succeeded());
+        result.pushKV("searched_items", scan->SearchedItems());
+        UniValue unspents(UniValue::VARR);
+        const CAmount total_in = PushUnspents(coins, unspents);
         result.pushKV("unspents", unspents);
         result.pushKV("total_amount", ValueFromAmount(total_in));
     } else {
@@ -2246,7 +2293,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "verifychain",            &verifychain,            {"checklevel","nblocks"} },
 
     { "blockchain",         "preciousblock",          &preciousblock,          {"blockhash"} },
-    { "blockchain",         "scantxoutset",           &scantxoutset,           {"action", "scanobjects"} },
+    { "blockchain",         "scantxoutset",           &scantxoutset,           {"action", "scanobjects|jobid"} },
 
     /* Not shown in help */
     { "hidden",             "invalidateblock",        &invalidateblock,        {"blockhash"} },
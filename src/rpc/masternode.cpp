@@ -52,7 +52,7 @@ UniValue masternode(const JSONRPCRequest& request)
 #endif // ENABLE_WALLET
          strCommand != "list" && strCommand != "list-conf" && strCommand != "count" &&
          strCommand != "debug" && strCommand != "current" && strCommand != "winner" && strCommand != "winners" && strCommand != "genkey" &&
-         strCommand != "connect" && strCommand != "status"))
+         strCommand != "connect" && strCommand != "status" && strCommand != "memory"))
             throw std::runtime_error(
                 "masternode \"command\"...\n"
                 "Set of commands to execute masternode related actions\n"
@@ -70,6 +70,7 @@ UniValue masternode(const JSONRPCRequest& request)
                 "  status       - Print masternode status information\n"
                 "  list         - Print list of all known masternodes (see masternodelist for more info)\n"
                 "  list-conf    - Print masternode.conf in JSON format\n"
+                "  memory       - Print memory usage of the masternode payment vote storage\n"
                 "  winner       - Print info on next masternode winner to vote for\n"
                 "  winners      - Print list of masternode winners\n"
                 );
@@ -85,6 +86,11 @@ UniValue masternode(const JSONRPCRequest& request)
         return masternodelist(newRequest);
     }
 
+    if (strCommand == "memory")
+    {
+        return mnpayments.GetMemoryInfo();
+    }
+
     if(strCommand == "connect")
     {
         if (request.params.size() < 2)
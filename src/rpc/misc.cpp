@@ -7,8 +7,10 @@
 #include <clientversion.h>
 #include <core_io.h>
 #include <crypto/ripemd160.h>
+#include <executor.h>
 #include <key_io.h>
 #include <validation.h>
+#include <validationinterface.h>
 #include <httpserver.h>
 #include <net.h>
 #include <netbase.h>
@@ -16,6 +18,7 @@
 #include <rpc/blockchain.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
+#include <services/asset.h>
 #include <timedata.h>
 #include <util.h>
 #include <utilstrencodings.h>
@@ -408,6 +411,34 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+// SYSCOIN
+static UniValue RPCDBCacheInfo()
+{
+    LOCK(cs_main);
+    UniValue coins(UniValue::VOBJ);
+    coins.pushKV("usage", uint64_t(pcoinsTip ? pcoinsTip->DynamicMemoryUsage() : 0));
+    coins.pushKV("limit", uint64_t(nCoinCacheUsage));
+    UniValue assets(UniValue::VOBJ);
+    if (passetdbblockcache) {
+        assets.pushKV("blockcache_size", uint64_t(passetdbblockcache->Capacity()));
+        assets.pushKV("blockcache_used", uint64_t(passetdbblockcache->Usage()));
+        assets.pushKV("blockcache_hits", passetdbblockcache->Hits());
+        assets.pushKV("blockcache_misses", passetdbblockcache->Misses());
+    }
+    size_t nWriteBuffers = 0;
+    if (passetdb)
+        nWriteBuffers += passetdb->DynamicMemoryUsage();
+    if (passetallocationdb)
+        nWriteBuffers += passetallocationdb->DynamicMemoryUsage();
+    if (passetallocationtransactionsdb)
+        nWriteBuffers += passetallocationtransactionsdb->DynamicMemoryUsage();
+    assets.pushKV("write_buffers", uint64_t(nWriteBuffers));
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("coins", coins);
+    obj.pushKV("assets", assets);
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -450,6 +481,19 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
             "  }\n"
+            "  \"dbcache\": {              (json object) How the -dbcache budget is used\n"
+            "    \"coins\": {              (json object) In-memory UTXO cache\n"
+            "      \"usage\": xxxxx,       (numeric) Bytes used\n"
+            "      \"limit\": xxxxx        (numeric) Bytes it may use before being flushed, besides unused mempool and asset cache space\n"
+            "    },\n"
+            "    \"assets\": {             (json object) Asset databases, sized by -assetdbcache\n"
+            "      \"blockcache_size\": xxxxx,   (numeric) Bytes of block cache shared by the asset databases\n"
+            "      \"blockcache_used\": xxxxx,   (numeric) Bytes of it in use\n"
+            "      \"blockcache_hits\": xxxxx,   (numeric) Block reads served from it since startup\n"
+            "      \"blockcache_misses\": xxxxx, (numeric) Block reads that went to disk since startup\n"
+            "      \"write_buffers\": xxxxx      (numeric) Bytes held in write buffers\n"
+            "    }\n"
+            "  }\n"
             "}\n"
             "\nResult (mode \"mallocinfo\"):\n"
             "\"<malloc version=\"1\">...\"\n"
@@ -462,6 +506,7 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("dbcache", RPCDBCacheInfo());
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -474,6 +519,97 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
     }
 }
 
+// SYSCOIN
+static UniValue getexecutorinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getexecutorinfo\n"
+            "Returns how the threads shared by block and mempool checks, RPC requests, validation interface callbacks and background tasks are used.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"threads\": n,              (numeric) Number of executor threads\n"
+            "  \"classes\": {               (json object) Task classes, highest priority first: block, mempool, rpc, notify, background\n"
+            "    \"block\": {\n"
+            "      \"maxrunning\": n,       (numeric) Tasks that may run at once, 0 for as many as there are threads\n"
+            "      \"maxqueued\": n,        (numeric) Tasks that may wait to run, 0 for no limit\n"
+            "      \"running\": n,          (numeric) Tasks running now\n"
+            "      \"queued\": n,           (numeric) Tasks waiting to run now\n"
+            "      \"peakqueued\": n,       (numeric) The most tasks that waited at once\n"
+            "      \"executed\": n,         (numeric) Tasks run since startup\n"
+            "      \"rejected\": n,         (numeric) Tasks refused since startup because the queue was full or the executor stopped\n"
+            "      \"avgwait_us\": n,       (numeric) Average time tasks waited to run, in microseconds\n"
+            "      \"avgrun_us\": n         (numeric) Average time tasks ran, in microseconds\n"
+            "    },\n"
+            "    ...\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getexecutorinfo", "")
+            + HelpExampleRpc("getexecutorinfo", "")
+        );
+
+    UniValue classes(UniValue::VOBJ);
+    for (int i = 0; i < TASK_CLASS_COUNT; i++) {
+        const TaskClass cls = (TaskClass)i;
+        const CExecutorClassStats stats = g_executor.GetStats(cls);
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("maxrunning", stats.nMaxRunning);
+        obj.pushKV("maxqueued", uint64_t(stats.nMaxQueued));
+        obj.pushKV("running", stats.nRunning);
+        obj.pushKV("queued", uint64_t(stats.nQueued));
+        obj.pushKV("peakqueued", uint64_t(stats.nPeakQueued));
+        obj.pushKV("executed", stats.nExecuted);
+        obj.pushKV("rejected", stats.nRejected);
+        obj.pushKV("avgwait_us", stats.nExecuted ? stats.nWaitMicros / (int64_t)stats.nExecuted : 0);
+        obj.pushKV("avgrun_us", stats.nExecuted ? stats.nRunMicros / (int64_t)stats.nExecuted : 0);
+        classes.pushKV(TaskClassToString(cls), obj);
+    }
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("threads", g_executor.GetThreadCount());
+    obj.pushKV("classes", classes);
+    return obj;
+}
+
+static UniValue getvalidationinterfaceinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getvalidationinterfaceinfo\n"
+            "Returns the notification queue of each subscriber to validation events, such as wallets, indexes and ZMQ.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"name\": \"xxx\",          (string) The kind of subscriber\n"
+            "    \"pending\": n,            (numeric) Notifications waiting to be handled now\n"
+            "    \"peakpending\": n,        (numeric) The most notifications that waited at once\n"
+            "    \"executed\": n,           (numeric) Notifications handled since the subscriber registered\n"
+            "    \"avgwait_us\": n,         (numeric) Average time notifications waited to be handled, in microseconds\n"
+            "    \"maxwait_us\": n,         (numeric) Longest time a notification waited to be handled, in microseconds\n"
+            "    \"avgrun_us\": n           (numeric) Average time the subscriber took to handle a notification, in microseconds\n"
+            "  },\n"
+            "  ...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getvalidationinterfaceinfo", "")
+            + HelpExampleRpc("getvalidationinterfaceinfo", "")
+        );
+
+    UniValue ret(UniValue::VARR);
+    for (const CValidationQueueStats& stats : GetMainSignals().GetQueueStats()) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("name", stats.strName);
+        obj.pushKV("pending", uint64_t(stats.nPending));
+        obj.pushKV("peakpending", uint64_t(stats.nPeakPending));
+        obj.pushKV("executed", stats.nExecuted);
+        obj.pushKV("avgwait_us", stats.nExecuted ? stats.nWaitMicros / (int64_t)stats.nExecuted : 0);
+        obj.pushKV("maxwait_us", stats.nMaxWaitMicros);
+        obj.pushKV("avgrun_us", stats.nExecuted ? stats.nRunMicros / (int64_t)stats.nExecuted : 0);
+        ret.push_back(obj);
+    }
+    return ret;
+}
+
 static void EnableOrDisableLogCategories(UniValue cats, bool enable) {
     cats = cats.get_array();
     for (unsigned int i = 0; i < cats.size(); ++i) {
@@ -590,6 +726,8 @@ static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
   //  --------------------- ------------------------  -----------------------  ----------
     { "control",            "getmemoryinfo",          &getmemoryinfo,          {"mode"} },
+    { "control",            "getexecutorinfo",        &getexecutorinfo,        {} },
+    { "control",            "getvalidationinterfaceinfo", &getvalidationinterfaceinfo, {} },
     { "control",            "logging",                &logging,                {"include", "exclude"}},
     { "util",               "validateaddress",        &validateaddress,        {"address"} }, /* uses wallet if enabled */
     { "util",               "createmultisig",         &createmultisig,         {"nrequired","keys","address_type"} },
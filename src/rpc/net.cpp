@@ -12,6 +12,7 @@
 #include <net_processing.h>
 #include <netbase.h>
 #include <policy/policy.h>
+#include <relaycache.h>
 #include <rpc/protocol.h>
 #include <sync.h>
 #include <timedata.h>
@@ -449,6 +450,24 @@ static UniValue getnetworkinfo(const JSONRPCRequest& request)
             "  }\n"
             "  ,...\n"
             "  ]\n"
+            "  \"compactblocks\": {                   (json object) compact block reconstruction since startup\n"
+            "    \"blocks\": xxx,                       (numeric) compact blocks we started reconstructing\n"
+            "    \"reconstructed\": xxx,                (numeric) blocks completed without asking the peer for transactions\n"
+            "    \"roundtrips\": xxx,                   (numeric) blocks that needed a getblocktxn round trip\n"
+            "    \"tx_prefilled\": xxx,                 (numeric) transactions sent along in the compact block\n"
+            "    \"tx_mempool\": xxx,                   (numeric) transactions found in the mempool\n"
+            "    \"tx_extra\": xxx,                     (numeric) transactions found among orphan and replaced transactions\n"
+            "    \"tx_extra_asset\": xxx,               (numeric) transactions found among orphan and replaced asset transactions\n"
+            "    \"tx_requested\": xxx,                 (numeric) transactions that had to be requested\n"
+            "    \"orphans\": xxx,                      (numeric) transactions in the orphan pool\n"
+            "    \"asset_orphans\": xxx                 (numeric) asset transactions in the orphan pool\n"
+            "  }\n"
+            "  \"relaycache\": {                      (json object) transactions and blocks kept serialized for getdata\n"
+            "    \"entries\": xxx,                      (numeric) messages in the cache\n"
+            "    \"bytes\": xxx,                        (numeric) memory they take\n"
+            "    \"hits\": xxx,                         (numeric) requests served from the cache since startup\n"
+            "    \"misses\": xxx                        (numeric) requests that had to serialize the object\n"
+            "  }\n"
             "  \"warnings\": \"...\"                    (string) any network and blockchain warnings\n"
             "}\n"
             "\nExamples:\n"
@@ -485,6 +504,29 @@ static UniValue getnetworkinfo(const JSONRPCRequest& request)
         }
     }
     obj.pushKV("localaddresses", localAddresses);
+    // SYSCOIN
+    CCompactBlockStats cmpctStats;
+    GetCompactBlockStats(cmpctStats);
+    UniValue compactBlocks(UniValue::VOBJ);
+    compactBlocks.pushKV("blocks", cmpctStats.nBlocks);
+    compactBlocks.pushKV("reconstructed", cmpctStats.nReconstructed);
+    compactBlocks.pushKV("roundtrips", cmpctStats.nRoundTrips);
+    compactBlocks.pushKV("tx_prefilled", cmpctStats.nTxPrefilled);
+    compactBlocks.pushKV("tx_mempool", cmpctStats.nTxFromMempool);
+    compactBlocks.pushKV("tx_extra", cmpctStats.nTxFromExtra);
+    compactBlocks.pushKV("tx_extra_asset", cmpctStats.nTxFromAssetExtra);
+    compactBlocks.pushKV("tx_requested", cmpctStats.nTxRequested);
+    compactBlocks.pushKV("orphans", (uint64_t)cmpctStats.nOrphans);
+    compactBlocks.pushKV("asset_orphans", (uint64_t)cmpctStats.nAssetOrphans);
+    obj.pushKV("compactblocks",  compactBlocks);
+    CRelayCacheStats relayStats;
+    GetRelayCacheStats(relayStats);
+    UniValue relayCache(UniValue::VOBJ);
+    relayCache.pushKV("entries", (uint64_t)relayStats.nEntries);
+    relayCache.pushKV("bytes", (uint64_t)relayStats.nBytes);
+    relayCache.pushKV("hits", relayStats.nHits);
+    relayCache.pushKV("misses", relayStats.nMisses);
+    obj.pushKV("relaycache",     relayCache);
     obj.pushKV("warnings",       GetWarnings("statusbar"));
     return obj;
 }
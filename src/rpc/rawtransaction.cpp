@@ -1148,7 +1148,8 @@ UniValue sendrawtransaction(const JSONRPCRequest& request)
             // where a user might call sendrawtransaction with a transaction
             // to/from their wallet, immediately call some wallet RPC, and get
             // a stale result because callbacks have not yet been processed.
-            CallFunctionInValidationInterfaceQueue([&promise] {
+            // SYSCOIN Subscribers that do not serve RPCs are not waited for.
+            CallFunctionInSubmitValidationInterfaceQueues([&promise] {
                 promise.set_value();
             });
         }
@@ -264,6 +264,7 @@ static const CRPCCommand vRPCCommands[] =
     // SYSCOIN rpc functions
     { "wallet", "syscoinburn",          &syscoinburn, {} },
     { "wallet", "syscoinmint",          &syscoinmint, {} },    
+    { "blockchain", "syscoinimportethheaders", &syscoinimportethheaders, {"filename"} },
     { "wallet", "syscointxfund",          &syscointxfund, {}},
     
 	{ "wallet", "syscoinaddscript",        &syscoinaddscript,{} },
@@ -187,6 +187,7 @@ extern CRPCTable tableRPC;
 // SYSCOIN service rpc functions
 extern UniValue syscoinburn(const JSONRPCRequest& request);
 extern UniValue syscoinmint(const JSONRPCRequest& request);
+extern UniValue syscoinimportethheaders(const JSONRPCRequest& request);
 extern UniValue syscointxfund(const JSONRPCRequest& request);
 
 
@@ -11,7 +11,7 @@
 #include <boost/bind.hpp>
 #include <utility>
 
-CScheduler::CScheduler() : nThreadsServicingQueue(0), stopRequested(false), stopWhenEmpty(false)
+CScheduler::CScheduler() : nThreadsServicingQueue(0), stopRequested(false), stopWhenEmpty(false), pexecutor(nullptr), executorClass(TaskClass::BACKGROUND)
 {
 }
 
@@ -76,6 +76,10 @@ void CScheduler::serviceQueue()
             Function f = taskQueue.begin()->second;
             taskQueue.erase(taskQueue.begin());
 
+            // SYSCOIN
+            if (pexecutor && pexecutor->TrySubmit(executorClass, f))
+                continue;
+
             {
                 // Unlock before calling f, so it can reschedule itself or another task
                 // without deadlocking:
@@ -91,6 +95,13 @@ void CScheduler::serviceQueue()
     newTaskScheduled.notify_one();
 }
 
+void CScheduler::SetExecutor(CExecutor* pexecutorIn, TaskClass executorClassIn)
+{
+    boost::unique_lock<boost::mutex> lock(newTaskMutex);
+    pexecutor = pexecutorIn;
+    executorClass = executorClassIn;
+}
+
 void CScheduler::stop(bool drain)
 {
     {
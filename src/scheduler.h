@@ -14,6 +14,7 @@
 #include <boost/thread.hpp>
 #include <map>
 
+#include <executor.h>
 #include <sync.h>
 
 //
@@ -74,6 +75,13 @@ public:
     // Returns true if there are threads actively running in serviceQueue()
     bool AreThreadsServicingQueue() const;
 
+    // SYSCOIN
+    // Hand tasks that are due to an executor instead of running them on
+    // the thread servicing the queue, which then only keeps the time. Tasks
+    // the executor refuses still run on that thread. Limit the class to one
+    // task at a time to keep running them one after the other.
+    void SetExecutor(CExecutor* pexecutorIn, TaskClass executorClassIn);
+
 private:
     std::multimap<boost::chrono::system_clock::time_point, Function> taskQueue;
     boost::condition_variable newTaskScheduled;
@@ -81,6 +89,9 @@ private:
     int nThreadsServicingQueue;
     bool stopRequested;
     bool stopWhenEmpty;
+    // SYSCOIN
+    CExecutor* pexecutor;
+    TaskClass executorClass;
     bool shouldStop() const { return stopRequested || (stopWhenEmpty && taskQueue.empty()); }
 };
 
@@ -14,6 +14,7 @@
 #include "wallet/wallet.h"
 #include "chainparams.h"
 #include "wallet/coincontrol.h"
+#include "index/addressindex.h"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/case_conv.hpp> // for to_upper()
 #include <boost/lexical_cast.hpp>
@@ -30,6 +31,7 @@ unsigned int MAX_UPDATES_PER_BLOCK = 10;
 std::unique_ptr<CAssetDB> passetdb;
 std::unique_ptr<CAssetAllocationDB> passetallocationdb;
 std::unique_ptr<CAssetAllocationTransactionsDB> passetallocationtransactionsdb;
+std::unique_ptr<CDBBlockCache> passetdbblockcache;
 using namespace std::chrono;
 using namespace std;
 bool FindSyscoinScriptOp(const CScript& script, int& op) {
@@ -189,6 +191,74 @@ bool FlushSyscoinDBs() {
 	}
 	return true;
 }
+// True if a database's best block is the block at nHeight with hash hashBlock, or a known block built on top of it
+static bool BestBlockHolds(const SyscoinBestBlock& bestBlock, int nHeight, const uint256& hashBlock) {
+	AssertLockHeld(cs_main);
+	BlockMap::const_iterator it = mapBlockIndex.find(bestBlock.second);
+	if (it == mapBlockIndex.end())
+		return false;
+	const CBlockIndex* pindex = it->second->GetAncestor(nHeight);
+	return pindex && pindex->GetBlockHash() == hashBlock;
+}
+bool FlushSyscoinBlock(const AssetAllocationMap &mapAssetAllocations, const AssetMap &mapLastAssets, const AssetMap &mapAssets, int nHeight, const uint256& hashBlock, const uint256& hashPrevBlock) {
+	if (!passetdb || !passetallocationdb)
+		return true;
+	if (!SyscoinDBsAtBlock(hashPrevBlock)) {
+		// Blocks connected again on top of the databases' own chain find them at the block or a descendant of it,
+		// a database at the same height on another branch holds none of this block's changes
+		SyscoinBestBlock assetBestBlock, assetAllocationBestBlock;
+		if (passetdb->ReadBestBlock(assetBestBlock) && passetallocationdb->ReadBestBlock(assetAllocationBestBlock) &&
+			BestBlockHolds(assetBestBlock, nHeight, hashBlock) && BestBlockHolds(assetAllocationBestBlock, nHeight, hashBlock)) {
+			LogPrint(BCLog::SYS, "Asset databases already hold block %s, leaving them as they are\n", hashBlock.GetHex());
+			return true;
+		}
+		LogPrintf("Asset databases are not at %s, the parent of block %s (%d). Restart to replay them onto the chainstate\n", hashPrevBlock.GetHex(), hashBlock.GetHex(), nHeight);
+		return false;
+	}
+	const SyscoinBestBlock block(nHeight, hashBlock);
+	return passetallocationdb->FlushBlock(mapAssetAllocations, block, hashPrevBlock) && passetdb->FlushBlock(mapLastAssets, mapAssets, block, hashPrevBlock);
+}
+bool UndoSyscoinBlock(int nHeight, const uint256& hashBlock) {
+	if (!passetdb || !passetallocationdb)
+		return false;
+	const SyscoinBestBlock block(nHeight, hashBlock);
+	SyscoinBestBlock assetBestBlock, assetAllocationBestBlock;
+	const bool fAssetAtBlock = passetdb->ReadBestBlock(assetBestBlock) && assetBestBlock == block;
+	const bool fAssetAllocationAtBlock = passetallocationdb->ReadBestBlock(assetAllocationBestBlock) && assetAllocationBestBlock == block;
+	if (!fAssetAtBlock && !fAssetAllocationAtBlock)
+		return false;
+	if ((fAssetAtBlock && !passetdb->HaveUndo(block)) || (fAssetAllocationAtBlock && !passetallocationdb->HaveUndo(block)))
+		return false;
+	return (!fAssetAllocationAtBlock || passetallocationdb->UndoBlock(block)) && (!fAssetAtBlock || passetdb->UndoBlock(block));
+}
+bool SyscoinDBsAtBlock(const uint256& hashBlock) {
+	if (!passetdb || !passetallocationdb)
+		return false;
+	SyscoinBestBlock assetBestBlock, assetAllocationBestBlock;
+	return (!passetdb->ReadBestBlock(assetBestBlock) || assetBestBlock.second == hashBlock) &&
+		(!passetallocationdb->ReadBestBlock(assetAllocationBestBlock) || assetAllocationBestBlock.second == hashBlock);
+}
+bool WriteSyscoinBestBlock(int nHeight, const uint256& hashBlock) {
+	const SyscoinBestBlock block(nHeight, hashBlock);
+	return passetallocationdb->WriteBestBlock(block) && passetdb->WriteBestBlock(block);
+}
+void PruneSyscoinUndo(const CBlockIndex* pindex) {
+	if (!passetdb || !passetallocationdb || !pindex)
+		return;
+	// Disconnecting a block erases its undo record, so the records left below pindex are those of its ancestors
+	// from the lowest height not pruned yet, and only they have to be erased instead of scanning every record
+	int nLowest = pindex->nHeight;
+	int nAssetLowest, nAssetAllocationLowest;
+	if (passetdb->ReadLowestUndoHeight(nAssetLowest))
+		nLowest = std::min(nLowest, nAssetLowest);
+	if (passetallocationdb->ReadLowestUndoHeight(nAssetAllocationLowest))
+		nLowest = std::min(nLowest, nAssetAllocationLowest);
+	std::vector<SyscoinBestBlock> vBlocks;
+	for (const CBlockIndex* pprev = pindex->pprev; pprev && pprev->nHeight >= nLowest; pprev = pprev->pprev)
+		vBlocks.emplace_back(pprev->nHeight, pprev->GetBlockHash());
+	if (!passetallocationdb->PruneUndo(pindex->nHeight, vBlocks) || !passetdb->PruneUndo(pindex->nHeight, vBlocks))
+		LogPrintf("Failed to prune asset undo records below height %d\n", pindex->nHeight);
+}
 bool DecodeAndParseSyscoinTx(const CTransaction& tx, int& op,
 	vector<vector<unsigned char> >& vvch, char& type)
 {
@@ -232,6 +302,48 @@ void CreateFeeRecipient(CScript& scriptPubKey, CRecipient& recipient)
 	CRecipient recp = { scriptPubKey, 0, false };
 	recipient = recp;
 }
+// Unspent outputs of an address in the shape returned by scantxoutset ("unspents", "total_amount"). Served
+// from -addressindex when it is enabled and in sync, so that callers avoid a full pass over the UTXO set.
+// Must not be called with cs_main held as it may wait for the index to catch up.
+UniValue ScanAddressUnspents(const string& strAddress)
+{
+	if (g_addressindex && g_addressindex->BlockUntilSyncedToCurrentChain()) {
+		const CTxDestination& dest = DecodeDestination(strAddress);
+		if (!IsValidDestination(dest))
+			throw runtime_error("SYSCOIN_ASSET_RPC_ERROR: ERRCODE: 5501 - " + _("Invalid address: ") + strAddress);
+		const CScript& scriptPubKey = GetScriptForDestination(dest);
+		const string& strScriptPubKey = HexStr(scriptPubKey.begin(), scriptPubKey.end());
+		std::vector<std::pair<COutPoint, CAddressUnspentValue> > vUnspents;
+		if (!g_addressindex->FindUnspents(scriptPubKey, vUnspents))
+			throw runtime_error("SYSCOIN_ASSET_RPC_ERROR: ERRCODE: 5501 - " + _("Could not read unspent outputs from the address index"));
+		UniValue unspents(UniValue::VARR);
+		CAmount nTotal = 0;
+		for (const auto& unspent : vUnspents) {
+			UniValue utxoObj(UniValue::VOBJ);
+			utxoObj.pushKV("txid", unspent.first.hash.GetHex());
+			utxoObj.pushKV("vout", (int32_t)unspent.first.n);
+			utxoObj.pushKV("scriptPubKey", strScriptPubKey);
+			utxoObj.pushKV("amount", ValueFromAmount(unspent.second.nValue));
+			utxoObj.pushKV("height", unspent.second.nHeight);
+			unspents.push_back(utxoObj);
+			nTotal += unspent.second.nValue;
+		}
+		UniValue result(UniValue::VOBJ);
+		result.pushKV("success", true);
+		result.pushKV("searched_items", (int64_t)vUnspents.size());
+		result.pushKV("unspents", unspents);
+		result.pushKV("total_amount", ValueFromAmount(nTotal));
+		return result;
+	}
+	UniValue paramsUTXO(UniValue::VARR);
+	UniValue utxoParams(UniValue::VARR);
+	utxoParams.push_back("addr(" + strAddress + ")");
+	paramsUTXO.push_back("start");
+	paramsUTXO.push_back(utxoParams);
+	JSONRPCRequest request;
+	request.params = paramsUTXO;
+	return scantxoutset(request);
+}
 UniValue SyscoinListReceived(bool includeempty = true, bool includechange = false)
 {
 	map<string, int> mapAddress;
@@ -253,15 +365,7 @@ UniValue SyscoinListReceived(bool includeempty = true, bool includechange = fals
 		const string& strAddress = EncodeDestination(dest);
 
 
-		UniValue paramsBalance(UniValue::VARR);
-		UniValue param(UniValue::VOBJ);
-		UniValue balanceParams(UniValue::VARR);
-		balanceParams.push_back("addr(" + strAddress + ")");
-		paramsBalance.push_back("start");
-		paramsBalance.push_back(balanceParams);
-		JSONRPCRequest request;
-		request.params = paramsBalance;
-		UniValue resBalance = scantxoutset(request);
+		UniValue resBalance = ScanAddressUnspents(strAddress);
 		UniValue obj(UniValue::VOBJ);
 		obj.pushKV("address", strAddress);
 		const CAmount& nBalance = AmountFromValue(find_value(resBalance.get_obj(), "total_amount"));
@@ -295,15 +399,7 @@ UniValue SyscoinListReceived(bool includeempty = true, bool includechange = fals
 		if (mapAddress.find(strAddress) != mapAddress.end())
 			continue;
 
-		UniValue paramsBalance(UniValue::VARR);
-		UniValue param(UniValue::VOBJ);
-		UniValue balanceParams(UniValue::VARR);
-		balanceParams.push_back("addr(" + strAddress + ")");
-		paramsBalance.push_back("start");
-		paramsBalance.push_back(balanceParams);
-		JSONRPCRequest request;
-		request.params = paramsBalance;
-		UniValue resBalance = scantxoutset(request);
+		UniValue resBalance = ScanAddressUnspents(strAddress);
 		UniValue obj(UniValue::VOBJ);
 		obj.pushKV("address", strAddress);
 		const CAmount& nBalance = AmountFromValue(find_value(resBalance.get_obj(), "total_amount"));
@@ -449,7 +545,7 @@ UniValue syscointxfund(const JSONRPCRequest& request) {
 	if (!DecodeHexTx(tx, hexstring, true, false))
 		throw runtime_error("SYSCOIN_ASSET_RPC_ERROR: ERRCODE: 5500 - " + _("Could not send raw transaction: Cannot decode transaction from hex string: ") + hexstring);
 	
-	UniValue addressArray(UniValue::VARR);	
+	UniValue resUTXOs;
 	bool bFunded = false;
     if (params.size() > 2) {
         COutPoint fundOut;
@@ -472,7 +568,8 @@ UniValue syscointxfund(const JSONRPCRequest& request) {
         CRecipient addressRecipient;
         CScript scriptPubKeyFromOrig = GetScriptForDestination(DecodeDestination(strAddress));
         CreateAssetRecipient(scriptPubKeyFromOrig, addressRecipient);  
-        addressArray.push_back("addr(" + strAddress + ")");
+        // look up the address outputs here as the index may need to catch up, which cannot happen under cs_main
+        resUTXOs = ScanAddressUnspents(strAddress);
         COutPoint addressOutPoint;
         unsigned int unspentcount = addressunspent(strAddress, addressOutPoint);
         if (unspentcount <= 1 && !fTPSTestEnabled)
@@ -517,13 +614,6 @@ UniValue syscointxfund(const JSONRPCRequest& request) {
     
     
 	if(!bFunded){
-    	UniValue paramsBalance(UniValue::VARR);
-    	paramsBalance.push_back("start");
-    	paramsBalance.push_back(addressArray);
-    	JSONRPCRequest request1;
-    	request1.params = paramsBalance;
-
-    	UniValue resUTXOs = scantxoutset(request1);
     	UniValue utxoArray(UniValue::VARR);
     	if (resUTXOs.isObject()) {
     		const UniValue& resUtxoUnspents = find_value(resUTXOs.get_obj(), "unspents");
@@ -752,19 +842,11 @@ int GenerateSyscoinGuid()
 }
 unsigned int addressunspent(const string& strAddressFrom, COutPoint& outpoint)
 {
-	UniValue paramsUTXO(UniValue::VARR);
-	UniValue param(UniValue::VOBJ);
-	UniValue utxoParams(UniValue::VARR);
-	utxoParams.push_back("addr(" + strAddressFrom + ")");
-	paramsUTXO.push_back("start");
-	paramsUTXO.push_back(utxoParams);
-	JSONRPCRequest request;
-	request.params = paramsUTXO;
-	UniValue resUTXOs = scantxoutset(request);
-	UniValue utxoArray(UniValue::VARR);
-	if (resUTXOs.isArray())
-		utxoArray = resUTXOs.get_array();
-	else
+	const UniValue& resUTXOs = ScanAddressUnspents(strAddressFrom);
+	if (!resUTXOs.isObject())
+		return 0;
+	const UniValue& utxoArray = find_value(resUTXOs.get_obj(), "unspents");
+	if (!utxoArray.isArray())
 		return 0;
 	unsigned int count = 0;
 	{
@@ -917,6 +999,22 @@ void CAssetDB::WriteAssetIndex(const CAsset& asset, const int& op) {
 		}
 	}
 }
+bool GetAssetDBSnapshot(CAssetDBSnapshot& snapshot) {
+    if (passetdb == nullptr || passetallocationdb == nullptr)
+        return false;
+    // blocks are written to the asset databases under cs_main, so both snapshots land between the same two blocks
+    LOCK(cs_main);
+    snapshot.assetSnapshot = passetdb->GetSnapshot();
+    snapshot.assetAllocationSnapshot = passetallocationdb->GetSnapshot();
+    // databases from before best blocks were kept are at the tip
+    if (!passetdb->ReadBestBlock(snapshot.bestBlock, snapshot.assetSnapshot) && chainActive.Tip())
+        snapshot.bestBlock = SyscoinBestBlock(chainActive.Height(), chainActive.Tip()->GetBlockHash());
+    return true;
+}
+void AssetDBSnapshotToJSON(const CAssetDBSnapshot& snapshot, UniValue& entry) {
+    entry.pushKV("blockhash", snapshot.bestBlock.second.GetHex());
+    entry.pushKV("height", snapshot.bestBlock.first);
+}
 bool GetAsset(const int &nAsset,
         CAsset& txPos) {
     if (passetdb == nullptr || !passetdb->ReadAsset(nAsset, txPos))
@@ -1628,17 +1726,21 @@ UniValue assetinfo(const JSONRPCRequest& request) {
 	const UniValue &params = request.params;
     if (request.fHelp || 1 != params.size())
         throw runtime_error("assetinfo <asset>\n"
-                "Show stored values of a single asset and its.\n");
+                "Show stored values of a single asset and its.\n"
+                "Includes the blockhash and height of the block the values reflect.\n");
 
     const int &nAsset = params[0].get_int();
 	UniValue oAsset(UniValue::VOBJ);
 
 	CAsset txPos;
-	if (passetdb == nullptr || !passetdb->ReadAsset(nAsset, txPos))
+	CAssetDBSnapshot snapshot;
+	if (!GetAssetDBSnapshot(snapshot) || !passetdb->ReadAsset(nAsset, txPos, snapshot.assetSnapshot))
 		throw runtime_error("SYSCOIN_ASSET_RPC_ERROR: ERRCODE: 2511 - " + _("Failed to read from asset DB"));
 
 	if(!BuildAssetJson(txPos, oAsset))
 		oAsset.clear();
+	else
+		AssetDBSnapshotToJSON(snapshot, oAsset);
     return oAsset;
 }
 bool BuildAssetJson(const CAsset& asset, UniValue& oAsset)
@@ -1787,22 +1889,77 @@ bool CAssetDB::Flush(const AssetMap &mapAssets){
     LogPrint(BCLog::SYS, "Flushing %d assets\n", mapAssets.size());
     return WriteBatch(batch);
 }
-bool CAssetDB::Flush(const AssetMap &mapLastAssets, const AssetMap &mapAssets){
-    if(mapLastAssets.empty() && mapAssets.empty())
-        return true;
+bool CAssetDB::FlushBlock(const AssetMap &mapLastAssets, const AssetMap &mapAssets, const SyscoinBestBlock& block, const uint256& hashPrevBlock){
     CDBBatch batch(*this);
+    CAssetUndo undo;
+    undo.hashPrevBlock = hashPrevBlock;
     for (const auto &key : mapLastAssets) {
         const CAsset &asset = key.second;
+        CAsset prevAsset;
+        if (!ReadLastAsset(asset.nAsset, prevAsset))
+            prevAsset.SetNull();
+        undo.vLastAssets.emplace_back(asset.nAsset, prevAsset);
         batch.Write(make_pair(lastAssetKey, asset.nAsset), asset);
     }
     for (const auto &key : mapAssets) {
         const CAsset &asset = key.second;
+        CAsset prevAsset;
+        if (!ReadAsset(asset.nAsset, prevAsset))
+            prevAsset.SetNull();
+        undo.vAssets.emplace_back(asset.nAsset, prevAsset);
         batch.Write(make_pair(assetKey, asset.nAsset), asset);
     }
-    LogPrint(BCLog::SYS, "Flushing %d assets and %d previous assets\n", mapAssets.size(), mapLastAssets.size());
+    batch.Write(make_pair(assetUndoKey, block), undo);
+    batch.Write(assetBestBlockKey, block);
+    if (!mapAssets.empty() || !mapLastAssets.empty())
+        LogPrint(BCLog::SYS, "Flushing %d assets and %d previous assets\n", mapAssets.size(), mapLastAssets.size());
     return WriteBatch(batch);
 }
-bool CAssetDB::ScanAssets(const int count, const int from, const UniValue& oOptions, UniValue& oRes) {
+bool CAssetDB::UndoBlock(const SyscoinBestBlock& block){
+    CAssetUndo undo;
+    if (!Read(make_pair(assetUndoKey, block), undo))
+        return false;
+    CDBBatch batch(*this);
+    for (const auto &prev : undo.vLastAssets) {
+        if (prev.second.IsNull())
+            batch.Erase(make_pair(lastAssetKey, prev.first));
+        else
+            batch.Write(make_pair(lastAssetKey, prev.first), prev.second);
+    }
+    for (const auto &prev : undo.vAssets) {
+        if (prev.second.IsNull())
+            batch.Erase(make_pair(assetKey, prev.first));
+        else
+            batch.Write(make_pair(assetKey, prev.first), prev.second);
+    }
+    batch.Erase(make_pair(assetUndoKey, block));
+    batch.Write(assetBestBlockKey, SyscoinBestBlock(block.first - 1, undo.hashPrevBlock));
+    LogPrint(BCLog::SYS, "Undoing %d assets and %d previous assets of block %s\n", undo.vAssets.size(), undo.vLastAssets.size(), block.second.GetHex());
+    return WriteBatch(batch);
+}
+bool CAssetDB::PruneUndo(int nHeight, const std::vector<SyscoinBestBlock>& vBlocks){
+    int nLowest;
+    const bool fLowest = ReadLowestUndoHeight(nLowest);
+    if (fLowest && nLowest >= nHeight)
+        return true;
+    CDBBatch batch(*this);
+    if (fLowest) {
+        for (const auto &block : vBlocks) {
+            if (block.first >= nLowest && block.first < nHeight)
+                batch.Erase(make_pair(assetUndoKey, block));
+        }
+    } else {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        pair<string, SyscoinBestBlock> key;
+        for (pcursor->Seek(assetUndoKey); pcursor->Valid() && pcursor->GetKey(key) && key.first == assetUndoKey; pcursor->Next()) {
+            if (key.second.first < nHeight)
+                batch.Erase(key);
+        }
+    }
+    batch.Write(assetUndoHeightKey, nHeight);
+    return WriteBatch(batch);
+}
+bool CAssetDB::ScanAssets(const std::shared_ptr<const leveldb::Snapshot>& snapshot, const int count, const int from, const UniValue& oOptions, UniValue& oRes) {
 	string strTxid = "";
 	vector<vector<uint8_t> > vchAddresses;
     int32_t nAsset = 0;
@@ -1828,15 +1985,18 @@ bool CAssetDB::ScanAssets(const int count, const int from, const UniValue& oOpti
 			}
 		}
 	}
-	boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
-	pcursor->SeekToFirst();
+	// assets are stored next to each other, starting at the bare key prefix
+	boost::scoped_ptr<CDBIterator> pcursor(NewIterator(snapshot));
+	pcursor->Seek(assetKey);
 	CAsset txPos;
 	pair<string, int32_t > key;
 	int index = 0;
 	while (pcursor->Valid()) {
 		boost::this_thread::interruption_point();
 		try {
-			if (pcursor->GetKey(key) && key.first == assetKey && (nAsset == 0 || key.second == nAsset)) {
+			if (!pcursor->GetKey(key) || key.first != assetKey)
+				break;
+			if (nAsset == 0 || key.second == nAsset) {
 				pcursor->GetValue(txPos);
 				if (!strTxid.empty() && strTxid != txPos.txHash.GetHex())
 				{
@@ -1889,6 +2049,7 @@ UniValue listassets(const JSONRPCRequest& request) {
 			"			} \n"
 			"			,...\n"
 			"		]\n"
+			"	   \"includeblock\":bool			(boolean) Return {\"blockhash\",\"height\",\"results\"} with the block the results reflect.\n"
 			"    }\n"
 			+ HelpExampleCli("listassets", "0")
 			+ HelpExampleCli("listassets", "10 10")
@@ -1917,8 +2078,17 @@ UniValue listassets(const JSONRPCRequest& request) {
 		options = params[2];
 	}
 
+	CAssetDBSnapshot snapshot;
+	if (!GetAssetDBSnapshot(snapshot))
+		throw runtime_error("SYSCOIN_ASSET_RPC_ERROR: ERRCODE: 2512 - " + _("Failed to read from asset DB"));
 	UniValue oRes(UniValue::VARR);
-	if (!passetdb->ScanAssets(count, from, options, oRes))
+	if (!passetdb->ScanAssets(snapshot.assetSnapshot, count, from, options, oRes))
 		throw runtime_error("SYSCOIN_ASSET_RPC_ERROR: ERRCODE: 2512 - " + _("Scan failed"));
+	if (options.isObject() && find_value(options, "includeblock").isTrue()) {
+		UniValue oResult(UniValue::VOBJ);
+		AssetDBSnapshotToJSON(snapshot, oResult);
+		oResult.pushKV("results", oRes);
+		return oResult;
+	}
 	return oRes;
 }
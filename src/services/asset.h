@@ -17,6 +17,7 @@ class CTransaction;
 class CReserveKey;
 class CCoinsViewCache;
 class CBlock;
+class CBlockIndex;
 struct CRecipient;
 class COutPoint;
 class UniValue;
@@ -24,6 +25,8 @@ class CTxOut;
 class CWallet;
 const int SYSCOIN_TX_VERSION_ASSET = 0x7401;
 const int SYSCOIN_TX_VERSION_MINT = 0x7402;
+//! -assetdbcache lower bound in MiB
+static const int64_t nMinAssetDBCache = 8;
 static const unsigned int MAX_GUID_LENGTH = 20;
 static const unsigned int MAX_NAME_LENGTH = 256;
 static const unsigned int MAX_VALUE_LENGTH = 512;
@@ -154,15 +157,34 @@ public:
 };
 static const std::string assetKey = "AI";
 static const std::string lastAssetKey = "LAI";
+static const std::string assetBestBlockKey = "ABB";
+static const std::string assetUndoKey = "AU";
+//! the lowest height that may still have an undo record
+static const std::string assetUndoHeightKey = "AUH";
 typedef std::unordered_map<int, CAsset> AssetMap;
+/** What a block overwrote in the asset database, a null asset standing for one that did not exist yet */
+class CAssetUndo {
+public:
+	uint256 hashPrevBlock;
+	std::vector<std::pair<int32_t, CAsset> > vAssets;
+	std::vector<std::pair<int32_t, CAsset> > vLastAssets;
+	ADD_SERIALIZE_METHODS;
+
+	template <typename Stream, typename Operation>
+	inline void SerializationOp(Stream& s, Operation ser_action) {
+		READWRITE(hashPrevBlock);
+		READWRITE(vAssets);
+		READWRITE(vLastAssets);
+	}
+};
 class CAssetDB : public CDBWrapper {
 public:
-    CAssetDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "assets", nCacheSize, fMemory, fWipe) {}
+    CAssetDB(size_t nCacheSize, bool fMemory, bool fWipe, CDBBlockCache* pBlockCache = nullptr) : CDBWrapper(GetDataDir() / "assets", nCacheSize, fMemory, fWipe, false, pBlockCache) {}
     bool EraseAsset(const int32_t& nAsset, bool cleanup = false) {
         return Erase(make_pair(assetKey, nAsset));
     }   
-    bool ReadAsset(const int32_t& nAsset, CAsset& asset) {
-        return Read(make_pair(assetKey, nAsset), asset);
+    bool ReadAsset(const int32_t& nAsset, CAsset& asset, const std::shared_ptr<const leveldb::Snapshot>& snapshot = nullptr) {
+        return Read(make_pair(assetKey, nAsset), asset, snapshot);
     }
     bool ReadLastAsset(const int32_t& nAsset, CAsset& asset) {
         return Read(make_pair(lastAssetKey, nAsset), asset);
@@ -171,10 +193,47 @@ public:
         return Erase(make_pair(lastAssetKey, nAsset));
     }  
 	void WriteAssetIndex(const CAsset& asset, const int &op);
-	bool ScanAssets(const int count, const int from, const UniValue& oOptions, UniValue& oRes);
+	bool ScanAssets(const std::shared_ptr<const leveldb::Snapshot>& snapshot, const int count, const int from, const UniValue& oOptions, UniValue& oRes);
     bool Flush(const AssetMap &mapAssets);
-    bool Flush(const AssetMap &mapLastAssets, const AssetMap &mapAssets);
+    bool ReadBestBlock(SyscoinBestBlock& bestBlock, const std::shared_ptr<const leveldb::Snapshot>& snapshot = nullptr) {
+        return Read(assetBestBlockKey, bestBlock, snapshot);
+    }
+    bool WriteBestBlock(const SyscoinBestBlock& bestBlock) {
+        return Write(assetBestBlockKey, bestBlock);
+    }
+    bool HaveUndo(const SyscoinBestBlock& block) {
+        return Exists(make_pair(assetUndoKey, block));
+    }
+    bool ReadLowestUndoHeight(int& nHeight) {
+        return Read(assetUndoHeightKey, nHeight);
+    }
+    /** Write a connected block's assets together with its undo record and the new best block in one batch */
+    bool FlushBlock(const AssetMap &mapLastAssets, const AssetMap &mapAssets, const SyscoinBestBlock& block, const uint256& hashPrevBlock);
+    /** Restore what block overwrote and move the best block back to its parent in one batch */
+    bool UndoBlock(const SyscoinBestBlock& block);
+    /** Drop the undo records below nHeight: those of vBlocks if the lowest height left is known, all of them otherwise */
+    bool PruneUndo(int nHeight, const std::vector<SyscoinBestBlock>& vBlocks);
+};
+/** Write a connected block's changes to both asset databases. True without writing if they already hold the block (e.g. when it is
+    connected again by -checklevel=4 or -reindex-chainstate), false if they are on another block than its parent. */
+bool FlushSyscoinBlock(const AssetAllocationMap &mapAssetAllocations, const AssetMap &mapLastAssets, const AssetMap &mapAssets, int nHeight, const uint256& hashBlock, const uint256& hashPrevBlock);
+/** Roll the asset databases that are at the block back to its parent. False, without touching either, if one of them has no undo record for it. */
+bool UndoSyscoinBlock(int nHeight, const uint256& hashBlock);
+/** True if neither asset database is known to be at a block other than hashBlock */
+bool SyscoinDBsAtBlock(const uint256& hashBlock);
+bool WriteSyscoinBestBlock(int nHeight, const uint256& hashBlock);
+bool ReadSyscoinBestBlocks(SyscoinBestBlock& assetBestBlock, SyscoinBestBlock& assetAllocationBestBlock);
+/** Drop the undo records of blocks below pindex on the active chain */
+void PruneSyscoinUndo(const CBlockIndex* pindex);
+/** Read-only views of both asset databases as of the same block */
+struct CAssetDBSnapshot {
+    std::shared_ptr<const leveldb::Snapshot> assetSnapshot;
+    std::shared_ptr<const leveldb::Snapshot> assetAllocationSnapshot;
+    SyscoinBestBlock bestBlock;
 };
+/** Snapshot both asset databases between blocks, so that RPC readers only ever see whole blocks and read without holding cs_main */
+bool GetAssetDBSnapshot(CAssetDBSnapshot& snapshot);
+void AssetDBSnapshotToJSON(const CAssetDBSnapshot& snapshot, UniValue& entry);
 bool GetAsset(const int &nAsset,CAsset& txPos);
 bool BuildAssetJson(const CAsset& asset, UniValue& oName);
 bool BuildAssetIndexerJson(const CAsset& asset,UniValue& oName);
@@ -187,4 +246,6 @@ bool DecodeAssetTx(const CTransaction& tx, int& op, std::vector<std::vector<unsi
 extern std::unique_ptr<CAssetDB> passetdb;
 extern std::unique_ptr<CAssetAllocationDB> passetallocationdb;
 extern std::unique_ptr<CAssetAllocationTransactionsDB> passetallocationtransactionsdb;
+/** Block cache shared by the asset databases above, which must be reset after them */
+extern std::unique_ptr<CDBBlockCache> passetdbblockcache;
 #endif // ASSET_H
@@ -14,6 +14,7 @@
 #include "rpc/server.h"
 #include "wallet/wallet.h"
 #include "chainparams.h"
+#include "executor.h"
 #include "wallet/coincontrol.h"
 #include <boost/algorithm/hex.hpp>
 #include <boost/algorithm/string/case_conv.hpp> // for to_lower()
@@ -23,7 +24,10 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/algorithm/string.hpp>
+#include <condition_variable>
 #include <future>
+#include <mutex>
+#include <unordered_set>
 #include <boost/multiprecision/cpp_dec_float.hpp>
 #include <key_io.h>
 #include <bech32.h>
@@ -32,6 +36,7 @@ using namespace boost::multiprecision;
 AssetAllocationIndexItemMap AssetAllocationIndex;
 AssetBalanceMap mempoolMapAssetBalances;
 ArrivalTimesMapImpl arrivalTimesMap;
+AssetAllocationSendsMap mempoolMapAssetAllocationSends;
 bool IsAssetAllocationOp(int op) {
 	return op == OP_ASSET_ALLOCATION_SEND || op == OP_ASSET_ALLOCATION_BURN;
 }
@@ -236,7 +241,243 @@ bool ResetAssetAllocation(const CAssetAllocationTuple &assetAllocationToRemove,
 	return true;
 	
 }
+// the allocation tuples whose balances a transaction moves, sender first for allocation sends
+static bool GetAssetAllocationTuplesTouched(const CTransaction &tx, bool &bAllocation, vector<CAssetAllocationTuple> &vecTuples) {
+    if (tx.nVersion != SYSCOIN_TX_VERSION_ASSET || tx.IsCoinBase())
+        return false;
+    int op;
+    vector<vector<unsigned char> > vvchArgs;
+    bAllocation = DecodeAssetAllocationTx(tx, op, vvchArgs) && IsAssetAllocationOp(op);
+    if (!bAllocation && !(DecodeAssetTx(tx, op, vvchArgs) && op == OP_ASSET_SEND))
+        return false;
+    const CAssetAllocation theAssetAllocation(tx);
+    if (theAssetAllocation.assetAllocationTuple.IsNull())
+        return false;
+    // asset sends debit the asset itself rather than an allocation
+    if (bAllocation)
+        vecTuples.push_back(theAssetAllocation.assetAllocationTuple);
+    for (const auto& amountTuple : theAssetAllocation.listSendingAllocationAmounts)
+        vecTuples.emplace_back(theAssetAllocation.assetAllocationTuple.nAsset, amountTuple.first);
+    return true;
+}
+// index a send that moved mempool balances under its sender and each receiver
+static void IndexAssetAllocationMempoolSend(const uint256& txHash, const CAssetAllocation& theAssetAllocation) {
+    AssertLockHeld(cs_assetallocation);
+    mempoolMapAssetAllocationSends[theAssetAllocation.assetAllocationTuple.ToString()].insert(txHash);
+    for (const auto& amountTuple : theAssetAllocation.listSendingAllocationAmounts)
+        mempoolMapAssetAllocationSends[CAssetAllocationTuple(theAssetAllocation.assetAllocationTuple.nAsset, amountTuple.first).ToString()].insert(txHash);
+}
+void AddAssetAllocationMempoolSend(const CTransaction& tx) {
+    int op;
+    vector<vector<unsigned char> > vvchArgs;
+    if (tx.nVersion != SYSCOIN_TX_VERSION_ASSET || !DecodeAssetAllocationTx(tx, op, vvchArgs) || op != OP_ASSET_ALLOCATION_SEND)
+        return;
+    const CAssetAllocation theAssetAllocation(tx);
+    if (theAssetAllocation.assetAllocationTuple.IsNull())
+        return;
+    // only sends with an arrival time moved the restored balances, the others overran their sender
+    {
+        LOCK(cs_assetallocationarrival);
+        ArrivalTimesMapImpl::const_iterator itSender = arrivalTimesMap.find(theAssetAllocation.assetAllocationTuple.ToString());
+        if (itSender == arrivalTimesMap.end() || !itSender->second.count(tx.GetHash()))
+            return;
+    }
+    LOCK(cs_assetallocation);
+    IndexAssetAllocationMempoolSend(tx.GetHash(), theAssetAllocation);
+}
+void UpdateMempoolAssetBalancesForBlock(const std::vector<CTransactionRef>& vtx) {
+    AssertLockHeld(cs_main);
+    // re-derive only the allocations the block moved, starting from their confirmed balance
+    AssetBalanceMap mapRederived;
+    bool bAllocation;
+    vector<CAssetAllocationTuple> vecTuples;
+    for (const auto& txRef : vtx) {
+        vecTuples.clear();
+        if (!GetAssetAllocationTuplesTouched(*txRef, bAllocation, vecTuples))
+            continue;
+        for (const auto& assetAllocationTuple : vecTuples) {
+            const string& strTuple = assetAllocationTuple.ToString();
+            if (mapRederived.count(strTuple))
+                continue;
+            CAssetAllocation dbAssetAllocation;
+            mapRederived.emplace(strTuple, GetAssetAllocation(assetAllocationTuple, dbAssetAllocation) ? dbAssetAllocation.nBalance : 0);
+        }
+    }
+    if (mapRederived.empty())
+        return;
 
+    // the sends still pending on those allocations are found through the index rather than by walking
+    // the mempool, dropping the entries of sends that were mined, conflicted or evicted on the way
+    struct PendingSend {
+        int64_t nArrivalTime;
+        uint256 txHash;
+        CAssetAllocation assetAllocation;
+    };
+    vector<PendingSend> vecSends;
+    {
+        LOCK(mempool.cs);
+        LOCK(cs_assetallocation);
+        std::unordered_set<uint256, SaltedTxidHasher> setSeen;
+        for (const auto& balance : mapRederived) {
+            AssetAllocationSendsMap::iterator itSends = mempoolMapAssetAllocationSends.find(balance.first);
+            if (itSends == mempoolMapAssetAllocationSends.end())
+                continue;
+            for (auto itHash = itSends->second.begin(); itHash != itSends->second.end();) {
+                CTxMemPool::txiter it = mempool.mapTx.find(*itHash);
+                if (it == mempool.mapTx.end()) {
+                    itHash = itSends->second.erase(itHash);
+                    continue;
+                }
+                if (setSeen.insert(*itHash).second)
+                    vecSends.push_back(PendingSend{it->GetTime() * 1000, *itHash, CAssetAllocation(it->GetTx())});
+                ++itHash;
+            }
+            if (itSends->second.empty())
+                mempoolMapAssetAllocationSends.erase(itSends);
+        }
+    }
+    {
+        // sends without an arrival time (already pruned) fall back to their mempool entry time
+        LOCK(cs_assetallocationarrival);
+        for (auto& send : vecSends) {
+            ArrivalTimesMapImpl::const_iterator itSender = arrivalTimesMap.find(send.assetAllocation.assetAllocationTuple.ToString());
+            if (itSender == arrivalTimesMap.end())
+                continue;
+            ArrivalTimesMap::const_iterator itArrival = itSender->second.find(send.txHash);
+            if (itArrival != itSender->second.end())
+                send.nArrivalTime = itArrival->second;
+        }
+    }
+    // replay them in the order CheckAssetAllocationInputs saw them arrive, by the millisecond and ties
+    // broken by txid, skipping sends that overrun a re-derived sender just like it does on acceptance
+    std::sort(vecSends.begin(), vecSends.end(), [](const PendingSend& a, const PendingSend& b) {
+        if (a.nArrivalTime != b.nArrivalTime)
+            return a.nArrivalTime < b.nArrivalTime;
+        return a.txHash < b.txHash;
+    });
+    std::unordered_set<string> setPending;
+    for (const auto& send : vecSends) {
+        const CAssetAllocation& theAssetAllocation = send.assetAllocation;
+        const string& senderTupleStr = theAssetAllocation.assetAllocationTuple.ToString();
+        setPending.insert(senderTupleStr);
+        CAmount nTotal = 0;
+        for (const auto& amountTuple : theAssetAllocation.listSendingAllocationAmounts)
+            nTotal += amountTuple.second;
+        // senders the block did not move keep their warm balance, which this send was accepted against
+        AssetBalanceMap::iterator mapBalanceSender = mapRederived.find(senderTupleStr);
+        if (mapBalanceSender != mapRederived.end()) {
+            if (mapBalanceSender->second < nTotal)
+                continue;
+            mapBalanceSender->second -= nTotal;
+        }
+        for (const auto& amountTuple : theAssetAllocation.listSendingAllocationAmounts) {
+            const string& receiverTupleStr = CAssetAllocationTuple(theAssetAllocation.assetAllocationTuple.nAsset, amountTuple.first).ToString();
+            setPending.insert(receiverTupleStr);
+            AssetBalanceMap::iterator mapBalanceReceiver = mapRederived.find(receiverTupleStr);
+            if (mapBalanceReceiver != mapRederived.end())
+                mapBalanceReceiver->second += amountTuple.second;
+        }
+    }
+
+    // allocations with a send pending get their re-derived balance, others only have an entry they
+    // already hold brought up to date, so the map does not grow by every allocation a block moves
+    LOCK(cs_assetallocation);
+    for (const auto& balance : mapRederived) {
+        if (setPending.count(balance.first)) {
+            mempoolMapAssetBalances[balance.first] = balance.second;
+            continue;
+        }
+        AssetBalanceMap::iterator it = mempoolMapAssetBalances.find(balance.first);
+        if (it != mempoolMapAssetBalances.end())
+            it->second = balance.second;
+    }
+}
+
+void GetAssetAllocationMempoolState(CAssetAllocationMempoolState& state) {
+    {
+        LOCK(cs_assetallocationarrival);
+        for (const auto& arrivalTimes : arrivalTimesMap) {
+            if (arrivalTimes.second.empty())
+                continue;
+            auto& vecArrivalTimes = state.mapArrivalTimes[arrivalTimes.first];
+            vecArrivalTimes.assign(arrivalTimes.second.begin(), arrivalTimes.second.end());
+        }
+        state.vecConflicts = assetAllocationConflicts.V;
+    }
+    LOCK(cs_assetallocation);
+    state.mapBalances.insert(mempoolMapAssetBalances.begin(), mempoolMapAssetBalances.end());
+}
+void RestoreAssetAllocationMempoolState(const CAssetAllocationMempoolState& state) {
+    {
+        LOCK(cs_assetallocationarrival);
+        // anything accepted meanwhile was checked against the db and keeps its own entry
+        for (const auto& arrivalTimes : state.mapArrivalTimes) {
+            ArrivalTimesMap &mapArrivalTimes = arrivalTimesMap[arrivalTimes.first];
+            for (const auto& arrivalTime : arrivalTimes.second)
+                mapArrivalTimes.emplace(arrivalTime.first, arrivalTime.second);
+        }
+        for (const auto& conflict : state.vecConflicts)
+            assetAllocationConflicts.insert(conflict);
+    }
+    LOCK(cs_assetallocation);
+    for (const auto& balance : state.mapBalances)
+        mempoolMapAssetBalances.emplace(balance.first, balance.second);
+}
+void RevertAssetAllocationMempoolState(const std::vector<CTransactionRef>& vtx) {
+    AssertLockHeld(cs_main);
+    // sends restored from disk that did not make it back into the mempool take their arrival time with them
+    {
+        LOCK(cs_assetallocationarrival);
+        bool bAllocation;
+        vector<CAssetAllocationTuple> vecTuples;
+        for (const auto& txRef : vtx) {
+            vecTuples.clear();
+            if (!GetAssetAllocationTuplesTouched(*txRef, bAllocation, vecTuples) || !bAllocation)
+                continue;
+            ArrivalTimesMapImpl::iterator it = arrivalTimesMap.find(vecTuples[0].ToString());
+            if (it == arrivalTimesMap.end())
+                continue;
+            it->second.erase(txRef->GetHash());
+            if (it->second.empty())
+                arrivalTimesMap.erase(it);
+        }
+    }
+    // and the balances they moved are replayed without them
+    UpdateMempoolAssetBalancesForBlock(vtx);
+}
+void PruneAssetAllocationMempoolState() {
+    AssertLockHeld(cs_main);
+    // keep the arrival times of sends still in the mempool and re-derive every balance they move
+    vector<CTransactionRef> vecPending;
+    {
+        LOCK(mempool.cs);
+        LOCK(cs_assetallocationarrival);
+        for (ArrivalTimesMapImpl::iterator it = arrivalTimesMap.begin(); it != arrivalTimesMap.end();) {
+            for (ArrivalTimesMap::iterator itTx = it->second.begin(); itTx != it->second.end();) {
+                if (!mempool.exists(itTx->first))
+                    itTx = it->second.erase(itTx);
+                else
+                    ++itTx;
+            }
+            if (it->second.empty())
+                it = arrivalTimesMap.erase(it);
+            else
+                ++it;
+        }
+        for (const auto& entry : mempool.mapTx) {
+            if (entry.GetTx().nVersion == SYSCOIN_TX_VERSION_ASSET)
+                vecPending.push_back(entry.GetSharedTx());
+        }
+    }
+    // and index those sends again, as the ones restored before the prune may not be yet
+    {
+        LOCK(cs_assetallocation);
+        mempoolMapAssetAllocationSends.clear();
+    }
+    for (const auto& txRef : vecPending)
+        AddAssetAllocationMempoolSend(*txRef);
+    UpdateMempoolAssetBalancesForBlock(vecPending);
+}
 bool CheckAssetAllocationInputs(const CTransaction &tx, const CCoinsViewCache &inputs, int op, const vector<vector<unsigned char> > &vvchArgs,
         bool fJustCheck, int nHeight, AssetAllocationMap &mapAssetAllocations, AssetBalanceMap &blockMapAssetBalances, string &errorMessage, bool bSanityCheck, bool bMiner) {
     if (passetallocationdb == nullptr)
@@ -635,11 +876,13 @@ bool CheckAssetAllocationInputs(const CTransaction &tx, const CCoinsViewCache &i
 	if (!bBalanceOverrun && !bSanityCheck) {
 		// set the assetallocation's txn-dependent 
 		if(fJustCheck && op == OP_ASSET_ALLOCATION_SEND){
-            LOCK(cs_assetallocationarrival);
-            ArrivalTimesMap &arrivalTimes = arrivalTimesMap[senderTupleStr];
-            arrivalTimes[txHash] = GetTimeMillis();
-        
-            
+            {
+                LOCK(cs_assetallocationarrival);
+                ArrivalTimesMap &arrivalTimes = arrivalTimesMap[senderTupleStr];
+                arrivalTimes[txHash] = GetTimeMillis();
+            }
+            LOCK(cs_assetallocation);
+            IndexAssetAllocationMempoolSend(txHash, theAssetAllocation);
         }
         else if(!fJustCheck){
     		theAssetAllocation.listSendingAllocationAmounts.clear();
@@ -683,6 +926,10 @@ UniValue tpstestinfo(const JSONRPCRequest& request) {
 	oTPSTestResults.pushKV("receivers", oTPSTestReceiversMempool);
 	return oTPSTestResults;
 }
+// SYSCOIN wakes the task sending the tpstestadd transactions when the test is disabled
+static std::mutex cs_tpstest;
+static std::condition_variable cvTPSTest;
+static bool fTPSTestTaskPosted = false;
 UniValue tpstestsetenabled(const JSONRPCRequest& request) {
 	const UniValue &params = request.params;
 	if (request.fHelp || 1 != params.size())
@@ -694,12 +941,17 @@ UniValue tpstestsetenabled(const JSONRPCRequest& request) {
 			+ HelpExampleCli("tpstestsetenabled", "true"));
 	if(!fTPSTest)
 		throw runtime_error("SYSCOIN_ASSET_ALLOCATION_RPC_ERROR: ERRCODE: 1501 - " + _("This function requires tpstest configuration to be set upon startup. Please shutdown and enable it by adding it to your syscoin.conf file and then try again."));
-	fTPSTestEnabled = params[0].get_bool();
-	if (!fTPSTestEnabled) {
-		vecTPSTestReceivedTimesMempool.clear();
-		nTPSTestingSendRawEndTime = 0;
-		nTPSTestingStartTime = 0;
+	{
+		std::lock_guard<std::mutex> lock(cs_tpstest);
+		fTPSTestEnabled = params[0].get_bool();
+		if (!fTPSTestEnabled) {
+			vecTPSTestReceivedTimesMempool.clear();
+			nTPSTestingSendRawEndTime = 0;
+			nTPSTestingStartTime = 0;
+			fTPSTestTaskPosted = false;
+		}
 	}
+	cvTPSTest.notify_all();
 	UniValue result(UniValue::VOBJ);
 	result.pushKV("status", "success");
 	return result;
@@ -723,7 +975,7 @@ UniValue tpstestadd(const JSONRPCRequest& request) {
 	if (!fTPSTest)
 		throw runtime_error("SYSCOIN_ASSET_ALLOCATION_RPC_ERROR: ERRCODE: 1501 - " + _("This function requires tpstest configuration to be set upon startup. Please shutdown and enable it by adding it to your syscoin.conf file and then call 'tpstestsetenabled true'."));
 
-	bool bFirstTime = vecTPSRawTransactions.empty();
+	std::unique_lock<std::mutex> lock(cs_tpstest);
 	nTPSTestingStartTime = params[0].get_int64();
 	UniValue txs;
 	if(params.size() > 1)
@@ -738,25 +990,32 @@ UniValue tpstestadd(const JSONRPCRequest& request) {
 			request.params = paramsRawTx;
 			vecTPSRawTransactions.push_back(request);
 		}
-		if (bFirstTime) {
+		// only post the task once the start time is known, so it holds an RPC slot no longer than until then
+		if (!fTPSTestTaskPosted && nTPSTestingStartTime > 0 && !vecTPSRawTransactions.empty()) {
 			// define a task for the worker to process
-			std::packaged_task<void()> task([]() {
-				while (nTPSTestingStartTime <= 0 || GetTimeMicros() < nTPSTestingStartTime) {
-					MilliSleep(0);
+			auto task = []() {
+				std::unique_lock<std::mutex> lock(cs_tpstest);
+				int64_t nWait;
+				while (fTPSTestEnabled && nTPSTestingStartTime > 0 && (nWait = nTPSTestingStartTime - GetTimeMicros()) > 0) {
+					cvTPSTest.wait_for(lock, std::chrono::microseconds(nWait));
 				}
+				if (!fTPSTestEnabled || nTPSTestingStartTime <= 0)
+					return;
 				nTPSTestingSendRawStartTime = nTPSTestingStartTime;
+				lock.unlock();
 
 				for (auto &txReq : vecTPSRawTransactions) {
 					sendrawtransaction(txReq);
 				}
-			});
+			};
 			bool isThreadPosted = false;
 			for (int numTries = 1; numTries <= 50; numTries++)
 			{
-				// send task to threadpool pointer from init.cpp
-				isThreadPosted = threadpool->tryPost(task);
+				// send task to the shared executor started in init.cpp
+				isThreadPosted = g_executor.TrySubmit(TaskClass::RPC, task);
 				if (isThreadPosted)
 				{
+					fTPSTestTaskPosted = true;
 					break;
 				}
 				MilliSleep(10);
@@ -765,6 +1024,8 @@ UniValue tpstestadd(const JSONRPCRequest& request) {
 				throw runtime_error("SYSCOIN_ASSET_ALLOCATION_RPC_ERROR: ERRCODE: 1501 - " + _("thread pool queue is full"));
 		}
 	}
+	// a posted task waits for the start time it was given last
+	cvTPSTest.notify_all();
 	UniValue result(UniValue::VOBJ);
 	result.pushKV("status", "success");
 	return result;
@@ -945,23 +1206,27 @@ UniValue assetallocationinfo(const JSONRPCRequest& request) {
 	const UniValue &params = request.params;
     if (request.fHelp || 2 != params.size())
         throw runtime_error("assetallocationinfo <asset> <owner>\n"
-                "Show stored values of a single asset allocation.\n");
+                "Show stored values of a single asset allocation.\n"
+                "Includes the blockhash and height of the block the values reflect.\n");
 
     const int &nAsset = params[0].get_int();
 	string strAddressFrom = params[1].get_str();
 	UniValue oAssetAllocation(UniValue::VOBJ);
 	const CAssetAllocationTuple assetAllocationTuple(nAsset, strAddressFrom == "burn"? vchFromStringUint8("burn"): bech32::Decode(strAddressFrom).second);
 	CAssetAllocation txPos;
-	if (passetallocationdb == nullptr || !passetallocationdb->ReadAssetAllocation(assetAllocationTuple, txPos))
+	CAssetDBSnapshot snapshot;
+	if (!GetAssetDBSnapshot(snapshot) || !passetallocationdb->ReadAssetAllocation(assetAllocationTuple, txPos, snapshot.assetAllocationSnapshot))
 		throw runtime_error("SYSCOIN_ASSET_ALLOCATION_RPC_ERROR: ERRCODE: 1507 - " + _("Failed to read from assetallocation DB"));
 
 	CAsset theAsset;
-	if (!GetAsset(nAsset, theAsset))
+	if (!passetdb->ReadAsset(nAsset, theAsset, snapshot.assetSnapshot))
 		throw runtime_error("SYSCOIN_ASSET_ALLOCATION_RPC_ERROR: ERRCODE: 1508 - " + _("Could not find a asset with this key"));
 
 
 	if(!BuildAssetAllocationJson(txPos, theAsset, oAssetAllocation))
 		oAssetAllocation.clear();
+	else
+		AssetDBSnapshotToJSON(snapshot, oAssetAllocation);
     return oAssetAllocation;
 }
 int DetectPotentialAssetAllocationSenderConflicts(const CAssetAllocationTuple& assetAllocationTupleSender, const uint256& lookForTxHash) {
@@ -1258,7 +1523,63 @@ bool CAssetAllocationDB::Flush(const AssetAllocationMap &mapAssetAllocations){
     LogPrint(BCLog::SYS, "Flushing %d asset allocations\n", mapAssetAllocations.size());
     return WriteBatch(batch);
 }
-bool CAssetAllocationDB::ScanAssetAllocations(const int count, const int from, const UniValue& oOptions, UniValue& oRes) {
+bool CAssetAllocationDB::FlushBlock(const AssetAllocationMap &mapAssetAllocations, const SyscoinBestBlock& block, const uint256& hashPrevBlock){
+    CDBBatch batch(*this);
+    CAssetAllocationUndo undo;
+    undo.hashPrevBlock = hashPrevBlock;
+    for (const auto &key : mapAssetAllocations) {
+        const CAssetAllocation &assetallocation = key.second;
+        CAssetAllocation prevAssetAllocation;
+        if (!ReadAssetAllocation(assetallocation.assetAllocationTuple, prevAssetAllocation))
+            prevAssetAllocation.SetNull();
+        undo.vAssetAllocations.emplace_back(assetallocation.assetAllocationTuple, prevAssetAllocation);
+        batch.Write(make_pair(assetAllocationKey, assetallocation.assetAllocationTuple), assetallocation);
+    }
+    batch.Write(make_pair(assetAllocationUndoKey, block), undo);
+    batch.Write(assetAllocationBestBlockKey, block);
+    if (!mapAssetAllocations.empty())
+        LogPrint(BCLog::SYS, "Flushing %d asset allocations\n", mapAssetAllocations.size());
+    return WriteBatch(batch);
+}
+bool CAssetAllocationDB::UndoBlock(const SyscoinBestBlock& block){
+    CAssetAllocationUndo undo;
+    if (!Read(make_pair(assetAllocationUndoKey, block), undo))
+        return false;
+    CDBBatch batch(*this);
+    for (const auto &prev : undo.vAssetAllocations) {
+        if (prev.second.IsNull())
+            batch.Erase(make_pair(assetAllocationKey, prev.first));
+        else
+            batch.Write(make_pair(assetAllocationKey, prev.first), prev.second);
+    }
+    batch.Erase(make_pair(assetAllocationUndoKey, block));
+    batch.Write(assetAllocationBestBlockKey, SyscoinBestBlock(block.first - 1, undo.hashPrevBlock));
+    LogPrint(BCLog::SYS, "Undoing %d asset allocations of block %s\n", undo.vAssetAllocations.size(), block.second.GetHex());
+    return WriteBatch(batch);
+}
+bool CAssetAllocationDB::PruneUndo(int nHeight, const std::vector<SyscoinBestBlock>& vBlocks){
+    int nLowest;
+    const bool fLowest = ReadLowestUndoHeight(nLowest);
+    if (fLowest && nLowest >= nHeight)
+        return true;
+    CDBBatch batch(*this);
+    if (fLowest) {
+        for (const auto &block : vBlocks) {
+            if (block.first >= nLowest && block.first < nHeight)
+                batch.Erase(make_pair(assetAllocationUndoKey, block));
+        }
+    } else {
+        std::unique_ptr<CDBIterator> pcursor(NewIterator());
+        pair<string, SyscoinBestBlock> key;
+        for (pcursor->Seek(assetAllocationUndoKey); pcursor->Valid() && pcursor->GetKey(key) && key.first == assetAllocationUndoKey; pcursor->Next()) {
+            if (key.second.first < nHeight)
+                batch.Erase(key);
+        }
+    }
+    batch.Write(assetAllocationUndoHeightKey, nHeight);
+    return WriteBatch(batch);
+}
+bool CAssetAllocationDB::ScanAssetAllocations(const std::shared_ptr<const leveldb::Snapshot>& snapshot, const int count, const int from, const UniValue& oOptions, UniValue& oRes) {
 	string strTxid = "";
 	vector<vector<uint8_t> > vchAddresses;
 	int32_t nAsset = 0;
@@ -1281,8 +1602,9 @@ bool CAssetAllocationDB::ScanAssetAllocations(const int count, const int from, c
 		}
 	}
 
-	boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
-	pcursor->SeekToFirst();
+	// allocations are stored next to each other, starting at the bare key prefix
+	boost::scoped_ptr<CDBIterator> pcursor(NewIterator(snapshot));
+	pcursor->Seek(assetAllocationKey);
 	CAssetAllocation txPos;
 	pair<string, CAssetAllocationTuple > key;
 	CAsset theAsset;
@@ -1290,7 +1612,9 @@ bool CAssetAllocationDB::ScanAssetAllocations(const int count, const int from, c
 	while (pcursor->Valid()) {
 		boost::this_thread::interruption_point();
 		try {
-			if (pcursor->GetKey(key) && key.first == assetAllocationKey && (nAsset == 0 || nAsset != key.second.nAsset)) {
+			if (!pcursor->GetKey(key) || key.first != assetAllocationKey)
+				break;
+			if (nAsset == 0 || nAsset != key.second.nAsset) {
 				pcursor->GetValue(txPos);
 				if (!vchAddresses.empty() && std::find(vchAddresses.begin(), vchAddresses.end(), txPos.assetAllocationTuple.vchAddress) == vchAddresses.end())
 				{
@@ -1387,6 +1711,7 @@ UniValue listassetallocations(const JSONRPCRequest& request) {
 			"			} \n"
 			"			,...\n"
 			"		]\n"
+			"	   \"includeblock\":bool			(boolean) Return {\"blockhash\",\"height\",\"results\"} with the block the results reflect.\n"
 			"    }\n"
 			+ HelpExampleCli("listassetallocations", "0")
 			+ HelpExampleCli("listassetallocations", "10 10")
@@ -1414,8 +1739,17 @@ UniValue listassetallocations(const JSONRPCRequest& request) {
 	if (params.size() > 2) {
 		options = params[2];
 	}
+	CAssetDBSnapshot snapshot;
+	if (!GetAssetDBSnapshot(snapshot))
+		throw runtime_error("SYSCOIN_ASSET_ALLOCATION_RPC_ERROR: ERRCODE: 1510 - " + _("Failed to read from assetallocation DB"));
 	UniValue oRes(UniValue::VARR);
-	if (!passetallocationdb->ScanAssetAllocations(count, from, options, oRes))
+	if (!passetallocationdb->ScanAssetAllocations(snapshot.assetAllocationSnapshot, count, from, options, oRes))
 		throw runtime_error("SYSCOIN_ASSET_ALLOCATION_RPC_ERROR: ERRCODE: 1510 - " + _("Scan failed"));
+	if (options.isObject() && find_value(options, "includeblock").isTrue()) {
+		UniValue oResult(UniValue::VOBJ);
+		AssetDBSnapshotToJSON(snapshot, oResult);
+		oResult.pushKV("results", oRes);
+		return oResult;
+	}
 	return oRes;
 }
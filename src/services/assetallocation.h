@@ -9,6 +9,7 @@
 #include "dbwrapper.h"
 #include "primitives/transaction.h"
 #include <unordered_map>
+#include <unordered_set>
 #include "services/graph.h"
 class CTransaction;
 class CReserveKey;
@@ -73,6 +74,8 @@ public:
 typedef std::unordered_map<std::string, CAmount> AssetBalanceMap;
 typedef std::unordered_map<uint256, int64_t,SaltedTxidHasher> ArrivalTimesMap;
 typedef std::unordered_map<std::string, ArrivalTimesMap> ArrivalTimesMapImpl;
+// the pending allocation sends that moved each allocation's mempool balance, as sender or receiver
+typedef std::unordered_map<std::string, std::unordered_set<uint256, SaltedTxidHasher> > AssetAllocationSendsMap;
 typedef std::vector<std::pair<std::vector<uint8_t>, CAmount > > RangeAmountTuples;
 typedef std::map<std::string, std::string> AssetAllocationIndexItem;
 typedef std::map<int, AssetAllocationIndexItem> AssetAllocationIndexItemMap;
@@ -140,24 +143,61 @@ public:
 	void Serialize(std::vector<unsigned char>& vchData);
 };
 static const std::string assetAllocationKey = "AAI";
+static const std::string assetAllocationBestBlockKey = "AABB";
+static const std::string assetAllocationUndoKey = "AAU";
+//! the lowest height that may still have an undo record
+static const std::string assetAllocationUndoHeightKey = "AAUH";
 typedef std::unordered_map<std::string, CAssetAllocation> AssetAllocationMap;
+/** The (height, hash) of the block an asset database was last brought up to */
+typedef std::pair<int32_t, uint256> SyscoinBestBlock;
+/** What a block overwrote in the asset allocation database, a null allocation standing for one that did not exist yet */
+class CAssetAllocationUndo {
+public:
+	uint256 hashPrevBlock;
+	std::vector<std::pair<CAssetAllocationTuple, CAssetAllocation> > vAssetAllocations;
+	ADD_SERIALIZE_METHODS;
+
+	template <typename Stream, typename Operation>
+	inline void SerializationOp(Stream& s, Operation ser_action) {
+		READWRITE(hashPrevBlock);
+		READWRITE(vAssetAllocations);
+	}
+};
 class CAssetAllocationDB : public CDBWrapper {
 public:
-	CAssetAllocationDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "assetallocations", nCacheSize, fMemory, fWipe) {}
+	CAssetAllocationDB(size_t nCacheSize, bool fMemory, bool fWipe, CDBBlockCache* pBlockCache = nullptr) : CDBWrapper(GetDataDir() / "assetallocations", nCacheSize, fMemory, fWipe, false, pBlockCache) {}
     
-    bool ReadAssetAllocation(const CAssetAllocationTuple& assetAllocationTuple, CAssetAllocation& assetallocation) {
-        return Read(make_pair(assetAllocationKey, assetAllocationTuple), assetallocation);
+    bool ReadAssetAllocation(const CAssetAllocationTuple& assetAllocationTuple, CAssetAllocation& assetallocation, const std::shared_ptr<const leveldb::Snapshot>& snapshot = nullptr) {
+        return Read(make_pair(assetAllocationKey, assetAllocationTuple), assetallocation, snapshot);
     }
     bool EraseAssetAllocation(const CAssetAllocationTuple& assetAllocationTuple) {
         return Erase(make_pair(assetAllocationKey, assetAllocationTuple));
     }
     bool Flush(const AssetAllocationMap &mapAssetAllocations);
+    bool ReadBestBlock(SyscoinBestBlock& bestBlock, const std::shared_ptr<const leveldb::Snapshot>& snapshot = nullptr) {
+        return Read(assetAllocationBestBlockKey, bestBlock, snapshot);
+    }
+    bool WriteBestBlock(const SyscoinBestBlock& bestBlock) {
+        return Write(assetAllocationBestBlockKey, bestBlock);
+    }
+    bool HaveUndo(const SyscoinBestBlock& block) {
+        return Exists(make_pair(assetAllocationUndoKey, block));
+    }
+    bool ReadLowestUndoHeight(int& nHeight) {
+        return Read(assetAllocationUndoHeightKey, nHeight);
+    }
+    /** Write a connected block's allocations together with its undo record and the new best block in one batch */
+    bool FlushBlock(const AssetAllocationMap &mapAssetAllocations, const SyscoinBestBlock& block, const uint256& hashPrevBlock);
+    /** Restore what block overwrote and move the best block back to its parent in one batch */
+    bool UndoBlock(const SyscoinBestBlock& block);
+    /** Drop the undo records below nHeight: those of vBlocks if the lowest height left is known, all of them otherwise */
+    bool PruneUndo(int nHeight, const std::vector<SyscoinBestBlock>& vBlocks);
 	void WriteAssetAllocationIndex(const CAssetAllocation& assetAllocationTuple, const uint256& txHash, int nHeight, const CAsset& asset, const CAmount& nSenderBalance, const CAmount& nAmount, const std::string& strSender);
-	bool ScanAssetAllocations(const int count, const int from, const UniValue& oOptions, UniValue& oRes);
+	bool ScanAssetAllocations(const std::shared_ptr<const leveldb::Snapshot>& snapshot, const int count, const int from, const UniValue& oOptions, UniValue& oRes);
 };
 class CAssetAllocationTransactionsDB : public CDBWrapper {
 public:
-	CAssetAllocationTransactionsDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "assetallocationtransactions", nCacheSize, fMemory, fWipe) {
+	CAssetAllocationTransactionsDB(size_t nCacheSize, bool fMemory, bool fWipe, CDBBlockCache* pBlockCache = nullptr) : CDBWrapper(GetDataDir() / "assetallocationtransactions", nCacheSize, fMemory, fWipe, false, pBlockCache) {
 		ReadAssetAllocationWalletIndex(AssetAllocationIndex);
 	}
 
@@ -171,6 +211,36 @@ public:
 };
 bool CheckAssetAllocationInputs(const CTransaction &tx, const CCoinsViewCache &inputs, int op, const std::vector<std::vector<unsigned char> > &vvchArgs, bool fJustCheck, int nHeight, AssetAllocationMap &mapAssetAllocations, AssetBalanceMap &blockMapAssetBalances, std::string &errorMessage, bool bSanityCheck = false, bool bMiner = false);
 bool GetAssetAllocation(const CAssetAllocationTuple& assetAllocationTuple,CAssetAllocation& txPos);
+void UpdateMempoolAssetBalancesForBlock(const std::vector<CTransactionRef>& vtx);
+/** The ZDAG view of the mempool, saved alongside mempool.dat so that a restart keeps arrival order and pending balances */
+class CAssetAllocationMempoolState {
+public:
+	static const int CURRENT_VERSION = 1;
+	int nVersion;
+	// the tip the pending balances were derived on, they only carry over onto the same tip
+	uint256 hashBlock;
+	std::map<std::string, std::vector<std::pair<uint256, int64_t> > > mapArrivalTimes;
+	std::map<std::string, CAmount> mapBalances;
+	std::vector<std::string> vecConflicts;
+	CAssetAllocationMempoolState() : nVersion(CURRENT_VERSION) {}
+	ADD_SERIALIZE_METHODS;
+	template <typename Stream, typename Operation>
+	inline void SerializationOp(Stream& s, Operation ser_action) {
+		READWRITE(nVersion);
+		if (ser_action.ForRead() && nVersion != CURRENT_VERSION)
+			throw std::ios_base::failure("Unknown asset allocation mempool state version");
+		READWRITE(hashBlock);
+		READWRITE(mapArrivalTimes);
+		READWRITE(mapBalances);
+		READWRITE(vecConflicts);
+	}
+};
+void GetAssetAllocationMempoolState(CAssetAllocationMempoolState& state);
+void RestoreAssetAllocationMempoolState(const CAssetAllocationMempoolState& state);
+void RevertAssetAllocationMempoolState(const std::vector<CTransactionRef>& vtx);
+void PruneAssetAllocationMempoolState();
+/** Index a send accepted on a restored ZDAG state, which skipped CheckAssetAllocationInputs */
+void AddAssetAllocationMempoolSend(const CTransaction& tx);
 bool BuildAssetAllocationJson(CAssetAllocation& assetallocation, const CAsset& asset, UniValue& oName);
 bool BuildAssetAllocationIndexerJson(const CAssetAllocation& assetallocation, const CAsset& asset, const CAmount& nSenderBalance, const CAmount& nAmount, const std::string& strSender, const std::string& strReceiver, bool &isMine, UniValue& oAssetAllocation);
 #endif // ASSETALLOCATION_H
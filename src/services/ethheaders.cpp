@@ -0,0 +1,264 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "services/ethheaders.h"
+#include "crypto/keccak.h"
+#include "ethereum/BlockHeader.h"
+#include "rpc/server.h"
+#include "util.h"
+#include "utilstrencodings.h"
+
+#include <limits>
+
+#include <boost/algorithm/string.hpp>
+
+std::unique_ptr<CEthHeaderDB> pethheaderdb;
+
+static const char ethHeaderKey = 'h';
+static const char ethHeightKey = 'n';
+static const char ethTipKey = 'T';
+
+static uint256 Uint256FromEthHash(const dev::h256& hash)
+{
+    return uint256(hash.asBytes());
+}
+
+uint256 EthHeaderHash(const std::vector<unsigned char>& vchHeader)
+{
+    uint256 hash;
+    CKeccak256().Write(vchHeader.data(), vchHeader.size()).Finalize(hash.begin());
+    return hash;
+}
+
+CEthHeaderDB::CEthHeaderDB(size_t nCacheSize, bool fMemory, bool fWipe, size_t nMaxDecodedIn) :
+    CDBWrapper(GetDataDir() / "ethheaders", nCacheSize, fMemory, fWipe), nMaxDecoded(nMaxDecodedIn)
+{
+}
+
+void CEthHeaderDB::CacheDecoded(const uint256& hash, const std::shared_ptr<const dev::eth::BlockHeader>& header)
+{
+    AssertLockHeld(cs_ethheaders);
+    if (nMaxDecoded == 0)
+        return;
+    listDecoded.emplace_front(hash, header);
+    mapDecoded[hash] = listDecoded.begin();
+    if (listDecoded.size() > nMaxDecoded) {
+        mapDecoded.erase(listDecoded.back().first);
+        listDecoded.pop_back();
+    }
+}
+
+bool CEthHeaderDB::AddHeader(const std::vector<unsigned char>& vchHeader, std::string& strError)
+{
+    const uint256 hash = EthHeaderHash(vchHeader);
+    LOCK(cs_ethheaders);
+    if (Exists(std::make_pair(ethHeaderKey, hash)))
+        return true;
+
+    std::shared_ptr<const dev::eth::BlockHeader> header;
+    try {
+        header = std::make_shared<const dev::eth::BlockHeader>(vchHeader, dev::eth::HeaderData, dev::h256(hash.begin(), dev::h256::ConstructFromPointer));
+    } catch (const std::exception& e) {
+        strError = strprintf("invalid header %s", HexStr(hash.begin(), hash.end()));
+        return false;
+    }
+    if (header->number() > std::numeric_limits<uint32_t>::max()) {
+        strError = strprintf("header %s height out of range", HexStr(hash.begin(), hash.end()));
+        return false;
+    }
+
+    CEthHeaderInfo info;
+    info.nHeight = (uint32_t)header->number();
+    info.hashParent = Uint256FromEthHash(header->parentHash());
+    info.txRoot = Uint256FromEthHash(header->transactionsRoot());
+    info.receiptRoot = Uint256FromEthHash(header->receiptsRoot());
+    info.vchHeader = vchHeader;
+
+    uint256 hashTip;
+    uint32_t nTipHeight = 0;
+    const bool fHaveTip = ReadTip(hashTip, nTipHeight);
+    if (fHaveTip) {
+        CEthHeaderInfo parent;
+        if (!ReadHeaderInfo(info.hashParent, parent)) {
+            strError = strprintf("header %s at height %u does not connect to a known header", HexStr(hash.begin(), hash.end()), info.nHeight);
+            return false;
+        }
+        if (parent.nHeight + 1 != info.nHeight) {
+            strError = strprintf("header %s at height %u does not follow its parent at height %u", HexStr(hash.begin(), hash.end()), info.nHeight, parent.nHeight);
+            return false;
+        }
+    }
+
+    CDBBatch batch(*this);
+    batch.Write(std::make_pair(ethHeaderKey, hash), info);
+    if (!fHaveTip || info.nHeight > nTipHeight) {
+        // Point the height index at the new best chain, back to where it
+        // meets the previous one.
+        batch.Write(std::make_pair(ethHeightKey, info.nHeight), hash);
+        batch.Write(ethTipKey, hash);
+        uint256 hashWalk = info.hashParent;
+        for (uint32_t nHeight = info.nHeight; fHaveTip && nHeight > 0; nHeight--) {
+            uint256 hashAtHeight;
+            if (ReadHashAtHeight(nHeight - 1, hashAtHeight) && hashAtHeight == hashWalk)
+                break;
+            CEthHeaderInfo walk;
+            if (!ReadHeaderInfo(hashWalk, walk))
+                break;
+            batch.Write(std::make_pair(ethHeightKey, nHeight - 1), hashWalk);
+            hashWalk = walk.hashParent;
+        }
+    }
+    if (!WriteBatch(batch)) {
+        strError = "failed to write to the header database";
+        return false;
+    }
+    CacheDecoded(hash, header);
+    return true;
+}
+
+bool CEthHeaderDB::ImportFile(const fs::path& path, unsigned int& nImported, std::string& strError)
+{
+    nImported = 0;
+    FILE* file = fsbridge::fopen(path, "r");
+    if (!file) {
+        strError = strprintf("cannot open %s", path.string());
+        return false;
+    }
+    std::string strLine;
+    unsigned int nLine = 0;
+    bool fSuccess = true;
+    int c;
+    do {
+        c = fgetc(file);
+        if (c != EOF && c != '\n') {
+            strLine.push_back((char)c);
+            continue;
+        }
+        nLine++;
+        boost::trim(strLine);
+        if (!strLine.empty() && strLine[0] != '#') {
+            if (!IsHex(strLine)) {
+                strError = strprintf("line %u is not hex", nLine);
+                fSuccess = false;
+                break;
+            }
+            if (!AddHeader(ParseHex(strLine), strError)) {
+                strError = strprintf("line %u: %s", nLine, strError);
+                fSuccess = false;
+                break;
+            }
+            nImported++;
+        }
+        strLine.clear();
+    } while (c != EOF);
+    fclose(file);
+    LogPrint(BCLog::SYS, "%s: imported %u Ethereum headers from %s\n", __func__, nImported, path.string());
+    return fSuccess;
+}
+
+bool CEthHeaderDB::HaveHeader(const uint256& hash)
+{
+    {
+        LOCK(cs_ethheaders);
+        if (mapDecoded.count(hash))
+            return true;
+    }
+    return Exists(std::make_pair(ethHeaderKey, hash));
+}
+
+bool CEthHeaderDB::HaveHeaderRLP(const std::vector<unsigned char>& vchHeader)
+{
+    return HaveHeader(EthHeaderHash(vchHeader));
+}
+
+bool CEthHeaderDB::ReadHeaderInfo(const uint256& hash, CEthHeaderInfo& info)
+{
+    return Read(std::make_pair(ethHeaderKey, hash), info);
+}
+
+bool CEthHeaderDB::GetHeader(const uint256& hash, std::shared_ptr<const dev::eth::BlockHeader>& header)
+{
+    LOCK(cs_ethheaders);
+    auto it = mapDecoded.find(hash);
+    if (it != mapDecoded.end()) {
+        listDecoded.splice(listDecoded.begin(), listDecoded, it->second);
+        header = it->second->second;
+        return true;
+    }
+    CEthHeaderInfo info;
+    if (!ReadHeaderInfo(hash, info))
+        return false;
+    try {
+        header = std::make_shared<const dev::eth::BlockHeader>(info.vchHeader, dev::eth::HeaderData, dev::h256(hash.begin(), dev::h256::ConstructFromPointer));
+    } catch (const std::exception& e) {
+        return error("%s: stored header %s failed to decode", __func__, HexStr(hash.begin(), hash.end()));
+    }
+    CacheDecoded(hash, header);
+    return true;
+}
+
+bool CEthHeaderDB::IsAncestor(const uint256& hashAncestor, const uint256& hashDescendant)
+{
+    CEthHeaderInfo ancestor, descendant;
+    if (!ReadHeaderInfo(hashAncestor, ancestor) || !ReadHeaderInfo(hashDescendant, descendant))
+        return false;
+    if (ancestor.nHeight > descendant.nHeight)
+        return false;
+    // Walk back off a side chain until the best chain is reached, after
+    // which the height index answers directly.
+    uint256 hashWalk = hashDescendant;
+    uint256 hashAtHeight;
+    while (hashWalk != hashAncestor) {
+        if (ReadHashAtHeight(descendant.nHeight, hashAtHeight) && hashAtHeight == hashWalk)
+            return ReadHashAtHeight(ancestor.nHeight, hashAtHeight) && hashAtHeight == hashAncestor;
+        if (descendant.nHeight <= ancestor.nHeight)
+            return false;
+        hashWalk = descendant.hashParent;
+        if (!ReadHeaderInfo(hashWalk, descendant))
+            return false;
+    }
+    return true;
+}
+
+bool CEthHeaderDB::ReadHashAtHeight(uint32_t nHeight, uint256& hash)
+{
+    return Read(std::make_pair(ethHeightKey, nHeight), hash);
+}
+
+bool CEthHeaderDB::ReadTip(uint256& hash, uint32_t& nHeight)
+{
+    CEthHeaderInfo info;
+    if (!Read(ethTipKey, hash) || !ReadHeaderInfo(hash, info))
+        return false;
+    nHeight = info.nHeight;
+    return true;
+}
+
+UniValue syscoinimportethheaders(const JSONRPCRequest& request) {
+    const UniValue &params = request.params;
+    if (request.fHelp || 1 != params.size())
+        throw std::runtime_error("syscoinimportethheaders [filename]\n"
+            "Import Ethereum block headers used to validate bridge mints and burns.\n"
+            "<filename> File holding one hex encoded RLP header per line, parents before children. The first header of an empty store is trusted as its anchor.\n");
+    if (!pethheaderdb)
+        throw std::runtime_error("SYSCOIN_RPC_ERROR: ERRCODE: 5513 - " + _("Ethereum header store is not available"));
+    const fs::path path = fs::absolute(params[0].get_str());
+    unsigned int nImported = 0;
+    std::string strError;
+    const bool fSuccess = pethheaderdb->ImportFile(path, nImported, strError);
+    if (!fSuccess && nImported == 0)
+        throw std::runtime_error("SYSCOIN_RPC_ERROR: ERRCODE: 5514 - " + strError);
+
+    UniValue oRes(UniValue::VOBJ);
+    oRes.pushKV("imported", (int)nImported);
+    uint256 hashTip;
+    uint32_t nTipHeight;
+    if (pethheaderdb->ReadTip(hashTip, nTipHeight)) {
+        oRes.pushKV("height", (int)nTipHeight);
+        oRes.pushKV("hash", HexStr(hashTip.begin(), hashTip.end()));
+    }
+    if (!fSuccess)
+        oRes.pushKV("error", strError);
+    return oRes;
+}
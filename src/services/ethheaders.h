@@ -0,0 +1,98 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef ETHHEADERS_H
+#define ETHHEADERS_H
+
+#include "dbwrapper.h"
+#include "fs.h"
+#include "serialize.h"
+#include "sync.h"
+#include "uint256.h"
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace dev { namespace eth { class BlockHeader; } }
+
+/** Number of decoded Ethereum headers kept in memory by default */
+static const unsigned int DEFAULT_ETH_HEADER_CACHE_SIZE = 1024;
+
+/** A stored Ethereum header: the raw RLP plus the fields needed to place it
+ *  in the chain and to check bridge proofs against it without decoding. */
+class CEthHeaderInfo {
+public:
+    uint32_t nHeight;
+    uint256 hashParent;
+    uint256 txRoot;
+    uint256 receiptRoot;
+    std::vector<unsigned char> vchHeader;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(nHeight);
+        READWRITE(hashParent);
+        READWRITE(txRoot);
+        READWRITE(receiptRoot);
+        READWRITE(vchHeader);
+    }
+
+    CEthHeaderInfo() { SetNull(); }
+    void SetNull() { nHeight = 0; hashParent.SetNull(); txRoot.SetNull(); receiptRoot.SetNull(); vchHeader.clear(); }
+};
+
+struct EthHashHasher
+{
+    size_t operator()(const uint256& hash) const { return hash.GetCheapHash(); }
+};
+
+/** Ethereum hashes are kept in their natural byte order, so they print as HexStr(begin, end). */
+uint256 EthHeaderHash(const std::vector<unsigned char>& vchHeader);
+
+/**
+ * Store of Ethereum block headers used to validate bridge mints and burns.
+ *
+ * Headers are keyed by hash, with a height index for the best known chain,
+ * so membership and ancestry along that chain are single lookups. A header
+ * is only accepted if its parent is already stored, except for the first
+ * header which anchors the store. Decoded headers are kept in an LRU cache.
+ */
+class CEthHeaderDB : public CDBWrapper {
+public:
+    CEthHeaderDB(size_t nCacheSize, bool fMemory, bool fWipe, size_t nMaxDecoded = DEFAULT_ETH_HEADER_CACHE_SIZE);
+
+    /** Decode, link and store one RLP encoded header. Storing a known header is a no-op. */
+    bool AddHeader(const std::vector<unsigned char>& vchHeader, std::string& strError);
+    /** Add the headers of a file holding one hex encoded RLP header per line, parents first. */
+    bool ImportFile(const fs::path& path, unsigned int& nImported, std::string& strError);
+
+    bool HaveHeader(const uint256& hash);
+    /** Membership check for an RLP encoded header; hashes it but does not decode it. */
+    bool HaveHeaderRLP(const std::vector<unsigned char>& vchHeader);
+    bool ReadHeaderInfo(const uint256& hash, CEthHeaderInfo& info);
+    /** Get the decoded header, from the in-memory cache when possible. */
+    bool GetHeader(const uint256& hash, std::shared_ptr<const dev::eth::BlockHeader>& header);
+    /** Whether hashAncestor is hashDescendant or one of its parents. */
+    bool IsAncestor(const uint256& hashAncestor, const uint256& hashDescendant);
+    /** Hash of the best chain header at nHeight. */
+    bool ReadHashAtHeight(uint32_t nHeight, uint256& hash);
+    bool ReadTip(uint256& hash, uint32_t& nHeight);
+
+private:
+    typedef std::pair<uint256, std::shared_ptr<const dev::eth::BlockHeader> > DecodedEntry;
+
+    CCriticalSection cs_ethheaders;
+    const size_t nMaxDecoded;
+    std::list<DecodedEntry> listDecoded;
+    std::unordered_map<uint256, std::list<DecodedEntry>::iterator, EthHashHasher> mapDecoded;
+
+    void CacheDecoded(const uint256& hash, const std::shared_ptr<const dev::eth::BlockHeader>& header);
+};
+
+extern std::unique_ptr<CEthHeaderDB> pethheaderdb;
+
+#endif // ETHHEADERS_H
@@ -0,0 +1,107 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <socketevents.h>
+
+#include <netbase.h>
+#include <util.h>
+
+#include <assert.h>
+
+#ifdef USE_EPOLL
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode)
+{
+    if (str == "select") {
+        mode = SocketEventsMode::SELECT;
+        return true;
+    }
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SocketEventsMode::EPOLL;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string SocketEventsModeToString(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SocketEventsMode::SELECT: return "select";
+    case SocketEventsMode::EPOLL: return "epoll";
+    }
+    assert(false);
+}
+
+std::string SocketEventsModes()
+{
+#ifdef USE_EPOLL
+    return "select, epoll";
+#else
+    return "select";
+#endif
+}
+
+#ifdef USE_EPOLL
+/** Upper bound on the events taken from the kernel per wait; more are reported by the next one */
+static const size_t MAX_SOCKET_EVENTS = 1024;
+
+CSocketEvents::CSocketEvents() : m_epoll_fd(epoll_create1(EPOLL_CLOEXEC)), m_ready(MAX_SOCKET_EVENTS)
+{
+    if (m_epoll_fd == -1)
+        LogPrintf("epoll_create1 failed: %s\n", NetworkErrorString(errno));
+}
+
+CSocketEvents::~CSocketEvents()
+{
+    if (m_epoll_fd != -1)
+        close(m_epoll_fd);
+}
+
+bool CSocketEvents::Add(SOCKET hSocket, uint64_t nData, bool fListen)
+{
+    epoll_event event{};
+    event.events = fListen ? EPOLLIN : (EPOLLIN | EPOLLRDHUP | EPOLLET);
+    event.data.u64 = nData;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, hSocket, &event) != 0) {
+        LogPrintf("epoll_ctl add failed: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    return true;
+}
+
+bool CSocketEvents::SetWantSend(SOCKET hSocket, uint64_t nData, bool fWantSend)
+{
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (fWantSend ? (uint32_t)EPOLLOUT : 0u);
+    event.data.u64 = nData;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, hSocket, &event) != 0) {
+        LogPrint(BCLog::NET, "epoll_ctl mod failed: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    return true;
+}
+
+bool CSocketEvents::Remove(SOCKET hSocket)
+{
+    return epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, hSocket, nullptr) == 0;
+}
+
+bool CSocketEvents::Wait(int nTimeoutMs, std::vector<SocketEvent>& events)
+{
+    events.clear();
+    int nReady = epoll_wait(m_epoll_fd, m_ready.data(), m_ready.size(), nTimeoutMs);
+    if (nReady < 0)
+        return errno == EINTR;
+    for (int i = 0; i < nReady; i++) {
+        const uint32_t flags = m_ready[i].events;
+        events.push_back({m_ready[i].data.u64, (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0, (flags & EPOLLOUT) != 0});
+    }
+    return true;
+}
+#endif // USE_EPOLL
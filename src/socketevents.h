@@ -0,0 +1,89 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SYSCOIN_SOCKETEVENTS_H
+#define SYSCOIN_SOCKETEVENTS_H
+
+#if defined(HAVE_CONFIG_H)
+#include <config/syscoin-config.h>
+#endif
+
+#include <compat.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_SYS_EPOLL_H
+#define USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+/** How the socket handler waits for sockets to become ready */
+enum class SocketEventsMode {
+    SELECT,
+    EPOLL,
+};
+
+#ifdef USE_EPOLL
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::EPOLL;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SocketEventsMode::SELECT;
+#endif
+
+/** Parse a -socketevents value. Returns false for modes unknown or not available on this platform. */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+std::string SocketEventsModeToString(SocketEventsMode mode);
+/** The -socketevents values available on this platform, for the help text */
+std::string SocketEventsModes();
+
+#ifdef USE_EPOLL
+/** What became of one socket while waiting */
+struct SocketEvent {
+    //! the value the socket was added with
+    uint64_t nData;
+    //! data arrived, or the socket was closed or failed, which the next recv() tells apart
+    bool fRecv;
+    bool fSend;
+};
+
+/**
+ * Readiness of many sockets through one epoll instance. Sockets are added once
+ * and stay registered until they are removed or closed, so a wait costs
+ * nothing per idle socket.
+ *
+ * Added sockets are edge-triggered: a read event only says that new data
+ * arrived, so the reader has to keep reading until recv() would block, and
+ * remember if it stopped early. Interest in writing is only turned on while a
+ * socket has data queued. Turning it on reports the socket straight away if it
+ * is already writable.
+ */
+class CSocketEvents
+{
+public:
+    CSocketEvents();
+    ~CSocketEvents();
+
+    CSocketEvents(const CSocketEvents&) = delete;
+    CSocketEvents& operator=(const CSocketEvents&) = delete;
+
+    bool IsValid() const { return m_epoll_fd != -1; }
+
+    /** Start watching hSocket for reads. Listening sockets are level-triggered so that one accept() per wait suffices. */
+    bool Add(SOCKET hSocket, uint64_t nData, bool fListen = false);
+    /** Turn interest in writing to an added socket on or off */
+    bool SetWantSend(SOCKET hSocket, uint64_t nData, bool fWantSend);
+    /** Stop watching hSocket. Closing a socket also does this. */
+    bool Remove(SOCKET hSocket);
+
+    /** Wait up to nTimeoutMs for sockets to become ready and replace events with them. */
+    bool Wait(int nTimeoutMs, std::vector<SocketEvent>& events);
+
+private:
+    int m_epoll_fd;
+    std::vector<epoll_event> m_ready;
+};
+#endif // USE_EPOLL
+
+#endif // SYSCOIN_SOCKETEVENTS_H
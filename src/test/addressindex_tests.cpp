@@ -0,0 +1,105 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <index/addressindex.h>
+#include <script/sign.h>
+#include <script/standard.h>
+#include <test/test_syscoin.h>
+#include <util.h>
+#include <utiltime.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+static bool HasUnspent(const std::vector<std::pair<COutPoint, CAddressUnspentValue>>& vUnspents, const COutPoint& outpoint)
+{
+    for (const auto& unspent : vUnspents) {
+        if (unspent.first == outpoint) {
+            return true;
+        }
+    }
+    return false;
+}
+
+BOOST_FIXTURE_TEST_CASE(addressindex_sync_spend_and_rewind, TestChain100Setup)
+{
+    AddressIndex addressindex(1 << 20, true);
+    const CScript coinbase_script = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    const CScript spend_script = GetScriptForDestination(coinbaseKey.GetPubKey().GetID());
+
+    // BlockUntilSyncedToCurrentChain should return false before the index is started.
+    BOOST_CHECK(!addressindex.BlockUntilSyncedToCurrentChain());
+
+    addressindex.Start();
+
+    // Allow the index to catch up with the block index.
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!addressindex.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+
+    // Every coinbase created before the index started pays the coinbase key.
+    std::vector<std::pair<COutPoint, CAddressUnspentValue>> vUnspents;
+    BOOST_CHECK(addressindex.FindUnspents(coinbase_script, vUnspents));
+    for (const auto& txn : m_coinbase_txns) {
+        BOOST_CHECK(HasUnspent(vUnspents, COutPoint(txn->GetHash(), 0)));
+    }
+
+    // Spend the first coinbase to a different script in a new block.
+    const COutPoint spent_outpoint(m_coinbase_txns[0]->GetHash(), 0);
+    CMutableTransaction spend;
+    spend.nVersion = 1;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = spent_outpoint;
+    spend.vout.resize(1);
+    spend.vout[0].nValue = 11 * CENT;
+    spend.vout[0].scriptPubKey = spend_script;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(coinbase_script, spend, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    const CBlock block = CreateAndProcessBlock({spend}, coinbase_script);
+    BOOST_REQUIRE(chainActive.Tip()->GetBlockHash() == block.GetHash());
+    BOOST_CHECK(addressindex.BlockUntilSyncedToCurrentChain());
+
+    const COutPoint new_outpoint(spend.GetHash(), 0);
+    vUnspents.clear();
+    BOOST_CHECK(addressindex.FindUnspents(coinbase_script, vUnspents));
+    BOOST_CHECK(!HasUnspent(vUnspents, spent_outpoint));
+    BOOST_CHECK(HasUnspent(vUnspents, COutPoint(block.vtx[0]->GetHash(), 0)));
+    vUnspents.clear();
+    BOOST_CHECK(addressindex.FindUnspents(spend_script, vUnspents));
+    BOOST_REQUIRE_EQUAL(vUnspents.size(), 1U);
+    BOOST_CHECK(vUnspents[0].first == new_outpoint);
+    BOOST_CHECK_EQUAL(vUnspents[0].second.nValue, 11 * CENT);
+    BOOST_CHECK_EQUAL(vUnspents[0].second.nHeight, chainActive.Height());
+
+    // Disconnecting the block restores the spent coinbase and drops the new outputs.
+    {
+        LOCK(cs_main);
+        CValidationState state;
+        BOOST_CHECK(InvalidateBlock(state, Params(), chainActive.Tip()));
+    }
+    SyncWithValidationInterfaceQueue();
+
+    vUnspents.clear();
+    BOOST_CHECK(addressindex.FindUnspents(coinbase_script, vUnspents));
+    BOOST_CHECK(HasUnspent(vUnspents, spent_outpoint));
+    BOOST_CHECK(!HasUnspent(vUnspents, COutPoint(block.vtx[0]->GetHash(), 0)));
+    vUnspents.clear();
+    BOOST_CHECK(addressindex.FindUnspents(spend_script, vUnspents));
+    BOOST_CHECK(vUnspents.empty());
+
+    addressindex.Stop(); // Stop thread before calling destructor
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -327,6 +327,42 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(ExtraAssetTxnRoundTripTest)
+{
+    CTxMemPool pool;
+    CBlock block(BuildBlockTestCase());
+
+    // vtx[1] is among the extra transactions and vtx[2] among the extra asset transactions
+    std::vector<std::pair<uint256, CTransactionRef>> extra{{block.vtx[1]->GetWitnessHash(), block.vtx[1]}};
+    std::vector<std::pair<uint256, CTransactionRef>> extra_asset{{block.vtx[2]->GetWitnessHash(), block.vtx[2]}};
+
+    CBlockHeaderAndShortTxIDs shortIDs(block, false);
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << shortIDs;
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+
+    {
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs2, extra) == READ_STATUS_OK);
+        BOOST_CHECK(partialBlock.IsTxAvailable(1));
+        BOOST_CHECK(!partialBlock.IsTxAvailable(2));
+    }
+
+    PartiallyDownloadedBlock partialBlock(&pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs2, extra, extra_asset) == READ_STATUS_OK);
+    for (size_t i = 0; i < block.vtx.size(); i++)
+        BOOST_CHECK(partialBlock.IsTxAvailable(i));
+    BOOST_CHECK_EQUAL(partialBlock.GetPrefilledCount(), 1U);
+    BOOST_CHECK_EQUAL(partialBlock.GetMempoolCount(), 0U);
+    BOOST_CHECK_EQUAL(partialBlock.GetExtraCount(), 1U);
+    BOOST_CHECK_EQUAL(partialBlock.GetAssetExtraCount(), 1U);
+
+    CBlock block2;
+    BOOST_CHECK(partialBlock.FillBlock(block2, {}) == READ_STATUS_OK);
+    BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = InsecureRand256();
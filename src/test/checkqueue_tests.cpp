@@ -209,6 +209,37 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_Correct_Random)
     Correct_Queue_range(range);
 }
 
+/** Test that a queue running helpers on the executor instead of threads of its own does every check
+ */
+BOOST_AUTO_TEST_CASE(test_CheckQueue_Executor)
+{
+    BOOST_REQUIRE(g_executor.IsRunning());
+    auto queue = std::unique_ptr<Correct_Queue>(new Correct_Queue {QUEUE_BATCH_SIZE});
+    queue->SetExecutor(&g_executor, TaskClass::BLOCK, nScriptCheckThreads);
+    std::vector<FakeCheckCheckCompletion> vChecks;
+    for (size_t i : {0, 1, 10, 1000, 100000}) {
+        size_t total = i;
+        FakeCheckCheckCompletion::n_calls = 0;
+        CCheckQueueControl<FakeCheckCheckCompletion> control(queue.get());
+        while (total) {
+            vChecks.resize(std::min(total, (size_t) InsecureRandRange(100)));
+            total -= vChecks.size();
+            control.Add(vChecks);
+        }
+        BOOST_REQUIRE(control.Wait());
+        BOOST_REQUIRE_EQUAL(FakeCheckCheckCompletion::n_calls, i);
+    }
+
+    auto fail_queue = std::unique_ptr<Failing_Queue>(new Failing_Queue {QUEUE_BATCH_SIZE});
+    fail_queue->SetExecutor(&g_executor, TaskClass::BLOCK, nScriptCheckThreads);
+    for (size_t i = 0; i < 100; ++i) {
+        CCheckQueueControl<FailingCheck> control(fail_queue.get());
+        std::vector<FailingCheck> vChecks(1000, FailingCheck(false));
+        vChecks[InsecureRandRange(vChecks.size())].fails = i % 2;
+        control.Add(vChecks);
+        BOOST_REQUIRE_EQUAL(control.Wait(), i % 2 == 0);
+    }
+}
 
 /** Test that failing checks are caught */
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Catches_Failure)
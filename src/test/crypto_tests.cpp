@@ -4,6 +4,7 @@
 
 #include <crypto/aes.h>
 #include <crypto/chacha20.h>
+#include <crypto/keccak.h>
 #include <crypto/ripemd160.h>
 #include <crypto/sha1.h>
 #include <crypto/sha256.h>
@@ -54,6 +55,7 @@ static void TestVector(const Hasher &h, const In &in, const Out &out) {
 static void TestSHA1(const std::string &in, const std::string &hexout) { TestVector(CSHA1(), in, ParseHex(hexout));}
 static void TestSHA256(const std::string &in, const std::string &hexout) { TestVector(CSHA256(), in, ParseHex(hexout));}
 static void TestSHA512(const std::string &in, const std::string &hexout) { TestVector(CSHA512(), in, ParseHex(hexout));}
+static void TestKeccak256(const std::string &in, const std::string &hexout) { TestVector(CKeccak256(), in, ParseHex(hexout));}
 static void TestRIPEMD160(const std::string &in, const std::string &hexout) { TestVector(CRIPEMD160(), in, ParseHex(hexout));}
 
 static void TestHMACSHA256(const std::string &hexkey, const std::string &hexin, const std::string &hexout) {
@@ -305,6 +307,42 @@ BOOST_AUTO_TEST_CASE(sha512_testvectors) {
                "37de8c3ef5459d76a52cedc02dc499a3c9ed9dedbfb3281afd9653b8a112fafc");
 }
 
+BOOST_AUTO_TEST_CASE(keccak256_testvectors) {
+    TestKeccak256("", "c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470");
+    TestKeccak256("abc", "4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45");
+    TestKeccak256("The quick brown fox jumps over the lazy dog",
+                  "4d741b6f1eb29cb2a9b9911c82f56fa8d73b04959d3d9d222895df6c0b28aa15");
+    TestKeccak256(std::string(135, 'x'), "16570bdb055e663ea1cb57ac6f09194f4bc7b7070847971fc0b86710366dc34f");
+    TestKeccak256(std::string(136, 'x'), "50da8ef3747b7a7f01d08563aa11c72a2a668563fb928adc6e8d2a1ab4e36096");
+    TestKeccak256(std::string(1000000, 'a'),
+                  "fadae6b49f129bbb812be8407b7b2894f34aecf6dbd1f9b0f0c7e9853098fc96");
+}
+
+BOOST_AUTO_TEST_CASE(keccak256_batch)
+{
+    // Message lengths straddle the 136 byte rate so that lanes of one batch
+    // run a different number of permutations.
+    for (int count = 0; count <= 11; ++count) {
+        std::vector<std::vector<unsigned char>> msgs(count);
+        std::vector<const unsigned char*> inputs(count);
+        std::vector<size_t> lengths(count);
+        for (int i = 0; i < count; ++i) {
+            msgs[i].resize(InsecureRandRange(3 * CKeccak256::RATE));
+            for (auto& c : msgs[i]) {
+                c = InsecureRandBits(8);
+            }
+            inputs[i] = msgs[i].data();
+            lengths[i] = msgs[i].size();
+        }
+        std::vector<unsigned char> out1(32 * count), out2(32 * count);
+        for (int i = 0; i < count; ++i) {
+            CKeccak256().Write(inputs[i], lengths[i]).Finalize(out1.data() + 32 * i);
+        }
+        Keccak256Batch(out2.data(), inputs.data(), lengths.data(), count);
+        BOOST_CHECK(out1 == out2);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(hmac_sha256_testvectors) {
     // test cases 1, 2, 3, 4, 6 and 7 of RFC 4231
     TestHMACSHA256("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b",
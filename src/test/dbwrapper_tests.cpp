@@ -5,6 +5,7 @@
 #include <dbwrapper.h>
 #include <uint256.h>
 #include <random.h>
+#include <services/asset.h>
 #include <test/test_syscoin.h>
 
 #include <memory>
@@ -79,6 +80,65 @@ BOOST_AUTO_TEST_CASE(dbwrapper_batch)
     }
 }
 
+BOOST_AUTO_TEST_CASE(dbwrapper_shared_block_cache)
+{
+    CDBBlockCache cache(8 << 20);
+    BOOST_CHECK_EQUAL(cache.Capacity(), 8U << 20);
+    BOOST_CHECK_EQUAL(cache.Usage(), 0U);
+    {
+        // Small write buffers, so that most of what is written ends up in tables read through the cache
+        CDBWrapper dbw1(SetDataDir("dbwrapper_shared_block_cache_1"), 1 << 16, true, false, false, &cache);
+        CDBWrapper dbw2(SetDataDir("dbwrapper_shared_block_cache_2"), 1 << 16, true, false, false, &cache);
+        const std::string value(1000, 'v');
+        for (uint32_t i = 0; i < 1000; i++) {
+            BOOST_CHECK(dbw1.Write(i, value));
+            BOOST_CHECK(dbw2.Write(i, value));
+        }
+        std::string res;
+        for (int pass = 0; pass < 2; pass++) {
+            for (uint32_t i = 0; i < 1000; i++) {
+                BOOST_CHECK(dbw1.Read(i, res));
+                BOOST_CHECK(dbw2.Read(i, res));
+                BOOST_CHECK(res == value);
+            }
+        }
+        // Both databases filled the one cache, and read blocks back from it the second time around
+        BOOST_CHECK(cache.Usage() > 0);
+        BOOST_CHECK(cache.Usage() <= cache.Capacity());
+        BOOST_CHECK(cache.Misses() > 0);
+        BOOST_CHECK(cache.Hits() > 0);
+        BOOST_CHECK(dbw1.DynamicMemoryUsage() < cache.Usage());
+    }
+    // The databases leave the cache they were given behind
+    BOOST_CHECK(cache.Usage() <= cache.Capacity());
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_snapshot)
+{
+    CDBWrapper dbw(SetDataDir("dbwrapper_snapshot"), 1 << 20, true, false, false);
+    const uint256 in = InsecureRand256(), in2 = InsecureRand256();
+    BOOST_CHECK(dbw.Write('a', in));
+    std::shared_ptr<const leveldb::Snapshot> snapshot = dbw.GetSnapshot();
+    BOOST_CHECK(dbw.Write('a', in2));
+    BOOST_CHECK(dbw.Write('b', in2));
+
+    // Reads and iterators through the snapshot do not see later writes
+    uint256 res;
+    BOOST_CHECK(dbw.Read('a', res, snapshot));
+    BOOST_CHECK_EQUAL(res.ToString(), in.ToString());
+    BOOST_CHECK(!dbw.Read('b', res, snapshot));
+    std::unique_ptr<CDBIterator> it(dbw.NewIterator(snapshot));
+    int nCount = 0;
+    for (it->SeekToFirst(); it->Valid(); it->Next())
+        nCount++;
+    BOOST_CHECK_EQUAL(nCount, 1);
+    it.reset();
+
+    BOOST_CHECK(dbw.Read('a', res));
+    BOOST_CHECK_EQUAL(res.ToString(), in2.ToString());
+    BOOST_CHECK(dbw.Read('b', res));
+}
+
 BOOST_AUTO_TEST_CASE(dbwrapper_iterator)
 {
     // Perform tests both obfuscated and non-obfuscated.
@@ -319,4 +379,84 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
 
 
 
+BOOST_AUTO_TEST_CASE(asset_db_undo)
+{
+    CAssetDB assetdb(1 << 20, true, false);
+    CAssetAllocationDB allocationdb(1 << 20, true, false);
+    const uint256 hash0 = InsecureRand256(), hash1 = InsecureRand256(), hash2 = InsecureRand256();
+    const SyscoinBestBlock block1(1, hash1), block2(2, hash2);
+
+    CAsset asset;
+    asset.nAsset = 1;
+    asset.nBalance = 10;
+    AssetMap mapAssets{{1, asset}};
+    BOOST_CHECK(assetdb.Flush(mapAssets));
+    CAssetAllocation allocation;
+    allocation.assetAllocationTuple = CAssetAllocationTuple(1, std::vector<uint8_t>(20, 1));
+    allocation.nBalance = 5;
+
+    // Block 1 changes asset 1, creates asset 2 and an allocation
+    AssetMap mapLastAssets{{1, asset}};
+    mapAssets[1].nBalance = 20;
+    mapAssets[2] = asset;
+    mapAssets[2].nAsset = 2;
+    BOOST_CHECK(assetdb.FlushBlock(mapLastAssets, mapAssets, block1, hash0));
+    BOOST_CHECK(allocationdb.FlushBlock(AssetAllocationMap{{allocation.assetAllocationTuple.ToString(), allocation}}, block1, hash0));
+    // Block 2 changes asset 2 and the allocation
+    mapAssets.erase(1);
+    mapAssets[2].nBalance = 30;
+    BOOST_CHECK(assetdb.FlushBlock(AssetMap(), mapAssets, block2, hash1));
+    allocation.nBalance = 7;
+    BOOST_CHECK(allocationdb.FlushBlock(AssetAllocationMap{{allocation.assetAllocationTuple.ToString(), allocation}}, block2, hash1));
+
+    SyscoinBestBlock bestBlock;
+    BOOST_CHECK(assetdb.ReadBestBlock(bestBlock) && bestBlock == block2);
+    BOOST_CHECK(allocationdb.ReadBestBlock(bestBlock) && bestBlock == block2);
+    BOOST_CHECK(assetdb.HaveUndo(block1) && assetdb.HaveUndo(block2));
+
+    CAsset dbAsset;
+    CAssetAllocation dbAllocation;
+    BOOST_CHECK(assetdb.UndoBlock(block2));
+    BOOST_CHECK(allocationdb.UndoBlock(block2));
+    BOOST_CHECK(assetdb.ReadBestBlock(bestBlock) && bestBlock == block1);
+    BOOST_CHECK(assetdb.ReadAsset(2, dbAsset) && dbAsset.nBalance == 10);
+    BOOST_CHECK(allocationdb.ReadAssetAllocation(allocation.assetAllocationTuple, dbAllocation) && dbAllocation.nBalance == 5);
+    BOOST_CHECK(!assetdb.HaveUndo(block2));
+    BOOST_CHECK(!assetdb.UndoBlock(block2));
+
+    // Undoing block 1 erases what it created and restores what it overwrote
+    BOOST_CHECK(assetdb.UndoBlock(block1));
+    BOOST_CHECK(allocationdb.UndoBlock(block1));
+    BOOST_CHECK(assetdb.ReadBestBlock(bestBlock) && bestBlock == SyscoinBestBlock(0, hash0));
+    BOOST_CHECK(allocationdb.ReadBestBlock(bestBlock) && bestBlock == SyscoinBestBlock(0, hash0));
+    BOOST_CHECK(assetdb.ReadAsset(1, dbAsset) && dbAsset.nBalance == 10);
+    BOOST_CHECK(!assetdb.ReadAsset(2, dbAsset));
+    BOOST_CHECK(!assetdb.ReadLastAsset(1, dbAsset));
+    BOOST_CHECK(!allocationdb.ReadAssetAllocation(allocation.assetAllocationTuple, dbAllocation));
+
+    // Only the undo records below the given height are pruned: every one the first time, and only
+    // those of the given blocks from the lowest height left up after that
+    std::vector<SyscoinBestBlock> vBlocks;
+    uint256 hashPrev = hash0;
+    for (int nHeight = 1; nHeight <= 300; nHeight++) {
+        const uint256 hash = InsecureRand256();
+        BOOST_CHECK(assetdb.FlushBlock(AssetMap(), AssetMap(), SyscoinBestBlock(nHeight, hash), hashPrev));
+        vBlocks.emplace_back(nHeight, hash);
+        hashPrev = hash;
+    }
+    int nLowest;
+    BOOST_CHECK(!assetdb.ReadLowestUndoHeight(nLowest));
+    BOOST_CHECK(assetdb.PruneUndo(280, std::vector<SyscoinBestBlock>()));
+    BOOST_CHECK(assetdb.ReadLowestUndoHeight(nLowest) && nLowest == 280);
+    BOOST_CHECK(assetdb.PruneUndo(290, std::vector<SyscoinBestBlock>(vBlocks.begin() + 279, vBlocks.end())));
+    BOOST_CHECK(assetdb.PruneUndo(285, vBlocks));
+    BOOST_CHECK(assetdb.ReadLowestUndoHeight(nLowest) && nLowest == 290);
+    BOOST_CHECK(assetdb.ReadBestBlock(bestBlock) && bestBlock.first == 300);
+    for (int nUndone = 0; nUndone <= 10; nUndone++)
+        BOOST_CHECK(assetdb.UndoBlock(bestBlock) && assetdb.ReadBestBlock(bestBlock));
+    BOOST_CHECK_EQUAL(bestBlock.first, 289);
+    BOOST_CHECK(!assetdb.UndoBlock(bestBlock));
+    BOOST_CHECK(assetdb.ReadAsset(1, dbAsset) && dbAsset.nBalance == 10);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
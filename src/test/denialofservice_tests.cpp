@@ -11,6 +11,7 @@
 #include <pow.h>
 #include <script/sign.h>
 #include <serialize.h>
+#include <services/asset.h>
 #include <util.h>
 #include <validation.h>
 
@@ -23,13 +24,14 @@
 // Tests these internal-to-net_processing.cpp methods:
 extern bool AddOrphanTx(const CTransactionRef& tx, NodeId peer);
 extern void EraseOrphansFor(NodeId peer);
-extern unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans);
+extern unsigned int LimitOrphanTxSize(unsigned int nMaxOrphans, unsigned int nMaxAssetOrphans);
 extern void Misbehaving(NodeId nodeid, int howmuch, const std::string& message="");
 
 struct COrphanTx {
     CTransactionRef tx;
     NodeId fromPeer;
     int64_t nTimeExpire;
+    bool fAsset;
 };
 extern std::map<uint256, COrphanTx> mapOrphanTransactions;
 
@@ -405,11 +407,62 @@ BOOST_AUTO_TEST_CASE(DoS_mapOrphans)
     }
 
     // Test LimitOrphanTxSize() function:
-    LimitOrphanTxSize(40);
+    LimitOrphanTxSize(40, 0);
     BOOST_CHECK(mapOrphanTransactions.size() <= 40);
-    LimitOrphanTxSize(10);
+    LimitOrphanTxSize(10, 0);
     BOOST_CHECK(mapOrphanTransactions.size() <= 10);
-    LimitOrphanTxSize(0);
+    LimitOrphanTxSize(0, 0);
+    BOOST_CHECK(mapOrphanTransactions.empty());
+}
+
+static size_t CountAssetOrphans()
+{
+    size_t nCount = 0;
+    for (const auto& entry : mapOrphanTransactions)
+        nCount += entry.second.fAsset;
+    return nCount;
+}
+
+BOOST_AUTO_TEST_CASE(DoS_mapOrphans_asset)
+{
+    CAssetAllocation assetAllocation;
+    assetAllocation.assetAllocationTuple = CAssetAllocationTuple(1, vchFromString("sender"));
+    std::vector<unsigned char> vchData;
+    assetAllocation.Serialize(vchData);
+
+    // 60 orphan transactions: ordinary ones, ones only claiming to be asset
+    // transactions by their version, and asset allocation sends
+    for (int i = 0; i < 60; i++)
+    {
+        CMutableTransaction tx;
+        tx.nVersion = i % 3 ? SYSCOIN_TX_VERSION_ASSET : CTransaction::CURRENT_VERSION;
+        tx.vin.resize(1);
+        tx.vin[0].prevout.n = 0;
+        tx.vin[0].prevout.hash = InsecureRand256();
+        tx.vin[0].scriptSig << OP_1;
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 1*CENT;
+        tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        if (i % 3 == 2) {
+            tx.vout[0].scriptPubKey = CScript() << CScript::EncodeOP_N(OP_SYSCOIN_ASSET_ALLOCATION) << CScript::EncodeOP_N(OP_ASSET_ALLOCATION_SEND) << OP_2DROP << OP_TRUE;
+            tx.vout.emplace_back(0, CScript() << OP_RETURN << CScript::EncodeOP_N(OP_SYSCOIN_ASSET_ALLOCATION) << vchData);
+        }
+
+        BOOST_CHECK(AddOrphanTx(MakeTransactionRef(tx), i));
+    }
+
+    LOCK(cs_main);
+    BOOST_CHECK_EQUAL(CountAssetOrphans(), 20U);
+
+    // Each kind is limited on its own, so filling one up leaves the other alone
+    BOOST_CHECK_EQUAL(LimitOrphanTxSize(5, 100), 35U);
+    BOOST_CHECK_EQUAL(CountAssetOrphans(), 20U);
+    BOOST_CHECK_EQUAL(mapOrphanTransactions.size(), 25U);
+    BOOST_CHECK_EQUAL(LimitOrphanTxSize(100, 10), 10U);
+    BOOST_CHECK_EQUAL(CountAssetOrphans(), 10U);
+    BOOST_CHECK_EQUAL(mapOrphanTransactions.size(), 15U);
+
+    LimitOrphanTxSize(0, 0);
     BOOST_CHECK(mapOrphanTransactions.empty());
 }
 
@@ -4,6 +4,10 @@
 #include "util.h"
 #include "utilstrencodings.h"
 #include "ethereum/ethereum.h"
+#include "ethereum/BlockHeader.h"
+#include "ethereum/RLP.h"
+#include "ethereum/TrieHash.h"
+#include "random.h"
 #include "script/interpreter.h"
 #include "script/standard.h"
 #include "policy/policy.h"
@@ -79,5 +83,88 @@ BOOST_AUTO_TEST_CASE(ethereum_verifyscript)
     BOOST_CHECK_EQUAL(err, SCRIPT_ERR_OK);
 }
 
+BOOST_AUTO_TEST_CASE(ethereum_rlp_sized_lists)
+{
+    // A header re-encodes to the same bytes through the sized list path
+    const std::vector<unsigned char> header = ParseHex(block_header_data);
+    const dev::eth::BlockHeader blockHeader(header, dev::eth::HeaderData);
+    dev::RLPStream s;
+    blockHeader.streamRLP(s);
+    BOOST_CHECK(s.out() == header);
+    BOOST_CHECK(blockHeader.hash() == dev::sha3(header));
+
+    // Sized and unsized nested lists encode identically, short and long
+    for (size_t nLen : {1, 10, 60, 300}) {
+        const dev::bytes data(nLen, 0x42);
+        dev::RLPStream unsized(2);
+        unsized.appendList(2) << data << dev::u256(nLen);
+        unsized << "";
+        const size_t innerSize = dev::rlpSize(data) + dev::rlpSize(dev::u256(nLen));
+        dev::RLPStream sized(2, dev::rlpListSize(innerSize) + dev::rlpSize(std::string()));
+        sized.appendList(2, innerSize) << data << dev::u256(nLen);
+        sized << "";
+        BOOST_CHECK(sized.out() == unsized.out());
+        BOOST_CHECK_EQUAL(sized.out().size(), dev::rlpListSize(dev::rlpListSize(innerSize) + 1));
+    }
+
+    // A declared size that does not match the items is an error
+    dev::RLPStream tooSmall(2, 1);
+    BOOST_CHECK_THROW(tooSmall << "ab", dev::RLPException);
+    dev::RLPStream tooLarge(1, 5);
+    BOOST_CHECK_THROW(tooLarge << "ab", dev::RLPException);
+}
+
+BOOST_AUTO_TEST_CASE(ethereum_rlp_arena)
+{
+    const std::vector<unsigned char> header = ParseHex(block_header_data);
+    const dev::RLP rlp(header);
+    dev::RLPArena arena(64);
+    const dev::RLPItemsRef items = rlp.toList(arena);
+    BOOST_CHECK_EQUAL(items.size(), rlp.itemCount());
+    for (size_t i = 0; i < items.size(); i++)
+        BOOST_CHECK(items[i].data() == rlp[i].data());
+    BOOST_CHECK(arena.used() >= items.size() * sizeof(dev::RLP));
+
+    const dev::bytes data(1000, 7);
+    const dev::bytesConstRef copy = arena.copy(&data);
+    BOOST_CHECK(copy.toBytes() == data);
+    arena.clear();
+    BOOST_CHECK_EQUAL(arena.used(), 0U);
+    const dev::bytes notList = dev::rlp("");
+    BOOST_CHECK(dev::RLP(notList).toList(arena, dev::RLP::LaissezFaire).empty());
+    BOOST_CHECK_THROW(dev::RLP(notList).toList(arena), dev::BadCast);
+}
+
+BOOST_AUTO_TEST_CASE(ethereum_ordered_trie_root)
+{
+    tp::ThreadPoolOptions options;
+    options.setThreadCount(4);
+    tp::ThreadPool pool(options);
+    options.setThreadCount(1);
+    tp::ThreadPool singlePool(options);
+
+    // The flat builder must match hash256() over a map, with and without threads,
+    // across root shapes: empty, leaf, extension and branches with long rlp(i) keys
+    FastRandomContext rng(true);
+    for (size_t nCount : {0, 1, 2, 3, 16, 17, 63, 64, 127, 128, 129, 200, 256, 257, 1000, 5000}) {
+        std::vector<dev::bytes> vValues;
+        std::vector<dev::bytesConstRef> vRefs;
+        dev::BytesMap mapTrie;
+        for (size_t i = 0; i < nCount; i++) {
+            // Short values make some nodes small enough to be embedded in their parent
+            const std::vector<unsigned char> value = rng.randbytes(rng.randrange(4) == 0 ? 1 + rng.randrange(8) : 1 + rng.randrange(200));
+            vValues.push_back(dev::bytes(value.begin(), value.end()));
+            mapTrie[dev::rlp(i)] = vValues.back();
+        }
+        for (const auto& value : vValues)
+            vRefs.push_back(&value);
+        const dev::h256 expected = dev::hash256(mapTrie);
+        BOOST_CHECK(dev::orderedTrieRoot(vValues) == expected);
+        BOOST_CHECK(dev::orderedTrieRoot(vRefs, nullptr) == expected);
+        BOOST_CHECK(dev::orderedTrieRoot(vRefs, &pool) == expected);
+        BOOST_CHECK(dev::orderedTrieRoot(vRefs, &singlePool) == expected);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
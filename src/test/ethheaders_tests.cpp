@@ -0,0 +1,162 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "ethereum/BlockHeader.h"
+#include "services/ethheaders.h"
+#include "test/test_syscoin.h"
+#include "util.h"
+#include "utilstrencodings.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(ethheaders_tests, BasicTestingSetup)
+
+static std::vector<unsigned char> MakeHeader(const uint256& hashParent, unsigned int nNumber, unsigned char nSalt)
+{
+    dev::eth::BlockHeader header;
+    header.clear();
+    header.setParentHash(dev::h256(hashParent.begin(), dev::h256::ConstructFromPointer));
+    header.setNumber(nNumber);
+    header.setTimestamp(1500000000 + nNumber);
+    header.setDifficulty(131072);
+    header.setGasLimit(8000000);
+    header.setExtraData(dev::bytes(1, nSalt));
+    header.setSeal(0, dev::h256());
+    header.setSeal(1, dev::h64());
+    dev::RLPStream s;
+    header.streamRLP(s);
+    return s.out();
+}
+
+// Build a chain of nCount headers on top of hashParent, starting at nNumber.
+static std::vector<std::vector<unsigned char> > MakeChain(uint256 hashParent, unsigned int nNumber, unsigned int nCount, unsigned char nSalt)
+{
+    std::vector<std::vector<unsigned char> > vHeaders;
+    for (unsigned int i = 0; i < nCount; i++) {
+        vHeaders.push_back(MakeHeader(hashParent, nNumber + i, nSalt));
+        hashParent = EthHeaderHash(vHeaders.back());
+    }
+    return vHeaders;
+}
+
+BOOST_AUTO_TEST_CASE(ethheaders_add_and_ancestry)
+{
+    CEthHeaderDB db(1 << 20, true, true);
+    std::string strError;
+    const std::vector<std::vector<unsigned char> > vMain = MakeChain(uint256(), 100, 10, 0);
+    for (const auto& vchHeader : vMain)
+        BOOST_CHECK(db.AddHeader(vchHeader, strError));
+    // Adding a known header again is a no-op
+    BOOST_CHECK(db.AddHeader(vMain[3], strError));
+
+    uint256 hashTip;
+    uint32_t nTipHeight;
+    BOOST_CHECK(db.ReadTip(hashTip, nTipHeight));
+    BOOST_CHECK(hashTip == EthHeaderHash(vMain.back()));
+    BOOST_CHECK_EQUAL(nTipHeight, 109U);
+    for (unsigned int i = 0; i < vMain.size(); i++) {
+        uint256 hash;
+        BOOST_CHECK(db.HaveHeaderRLP(vMain[i]));
+        BOOST_CHECK(db.ReadHashAtHeight(100 + i, hash));
+        BOOST_CHECK(hash == EthHeaderHash(vMain[i]));
+    }
+    BOOST_CHECK(db.IsAncestor(EthHeaderHash(vMain[2]), EthHeaderHash(vMain[8])));
+    BOOST_CHECK(db.IsAncestor(EthHeaderHash(vMain[8]), EthHeaderHash(vMain[8])));
+    BOOST_CHECK(!db.IsAncestor(EthHeaderHash(vMain[8]), EthHeaderHash(vMain[2])));
+
+    // Headers that do not connect or skip a height are rejected
+    BOOST_CHECK(!db.AddHeader(MakeHeader(uint256S("0x01"), 200, 0), strError));
+    BOOST_CHECK(!db.AddHeader(MakeHeader(EthHeaderHash(vMain[4]), 106, 1), strError));
+    BOOST_CHECK(!db.AddHeader(std::vector<unsigned char>(10, 0xc0), strError));
+
+    std::shared_ptr<const dev::eth::BlockHeader> header;
+    BOOST_CHECK(db.GetHeader(EthHeaderHash(vMain[5]), header));
+    BOOST_CHECK(header->number() == 105);
+    BOOST_CHECK(header->hash() == dev::h256(EthHeaderHash(vMain[5]).begin(), dev::h256::ConstructFromPointer));
+    BOOST_CHECK(!db.GetHeader(uint256S("0x01"), header));
+}
+
+BOOST_AUTO_TEST_CASE(ethheaders_fork)
+{
+    CEthHeaderDB db(1 << 20, true, true, 4);
+    std::string strError;
+    const std::vector<std::vector<unsigned char> > vMain = MakeChain(uint256(), 0, 10, 0);
+    for (const auto& vchHeader : vMain)
+        BOOST_CHECK(db.AddHeader(vchHeader, strError));
+
+    // A shorter side chain forking after height 5 is stored but not indexed by height
+    std::vector<std::vector<unsigned char> > vSide = MakeChain(EthHeaderHash(vMain[5]), 6, 3, 1);
+    for (const auto& vchHeader : vSide)
+        BOOST_CHECK(db.AddHeader(vchHeader, strError));
+    uint256 hash;
+    BOOST_CHECK(db.ReadHashAtHeight(7, hash));
+    BOOST_CHECK(hash == EthHeaderHash(vMain[7]));
+    BOOST_CHECK(db.IsAncestor(EthHeaderHash(vMain[3]), EthHeaderHash(vSide[2])));
+    BOOST_CHECK(db.IsAncestor(EthHeaderHash(vSide[0]), EthHeaderHash(vSide[2])));
+    BOOST_CHECK(!db.IsAncestor(EthHeaderHash(vMain[7]), EthHeaderHash(vSide[2])));
+    BOOST_CHECK(!db.IsAncestor(EthHeaderHash(vSide[0]), EthHeaderHash(vMain[9])));
+
+    // Extending it past the best chain moves the height index over
+    const std::vector<std::vector<unsigned char> > vSideExt = MakeChain(EthHeaderHash(vSide.back()), 9, 2, 1);
+    vSide.insert(vSide.end(), vSideExt.begin(), vSideExt.end());
+    for (const auto& vchHeader : vSideExt)
+        BOOST_CHECK(db.AddHeader(vchHeader, strError));
+    uint256 hashTip;
+    uint32_t nTipHeight;
+    BOOST_CHECK(db.ReadTip(hashTip, nTipHeight));
+    BOOST_CHECK_EQUAL(nTipHeight, 10U);
+    BOOST_CHECK(hashTip == EthHeaderHash(vSide.back()));
+    for (unsigned int i = 0; i < vSide.size(); i++) {
+        BOOST_CHECK(db.ReadHashAtHeight(6 + i, hash));
+        BOOST_CHECK(hash == EthHeaderHash(vSide[i]));
+    }
+    BOOST_CHECK(db.ReadHashAtHeight(5, hash));
+    BOOST_CHECK(hash == EthHeaderHash(vMain[5]));
+    BOOST_CHECK(db.IsAncestor(EthHeaderHash(vMain[5]), hashTip));
+    BOOST_CHECK(!db.IsAncestor(EthHeaderHash(vMain[7]), hashTip));
+    BOOST_CHECK(db.IsAncestor(EthHeaderHash(vMain[3]), EthHeaderHash(vMain[9])));
+
+    // Decoded headers are evicted from the cache but still served from disk
+    std::shared_ptr<const dev::eth::BlockHeader> header;
+    for (const auto& vchHeader : vMain) {
+        BOOST_CHECK(db.GetHeader(EthHeaderHash(vchHeader), header));
+        BOOST_CHECK(header->parentHash() == dev::RLP(vchHeader)[0].toHash<dev::h256>());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ethheaders_import_file)
+{
+    const std::vector<std::vector<unsigned char> > vMain = MakeChain(uint256(), 1000, 20, 0);
+    const fs::path path = GetDataDir() / "ethheaders.txt";
+    FILE* file = fsbridge::fopen(path, "w");
+    BOOST_REQUIRE(file);
+    fprintf(file, "# exported headers\n");
+    for (const auto& vchHeader : vMain)
+        fprintf(file, "%s\r\n", HexStr(vchHeader).c_str());
+    fclose(file);
+
+    CEthHeaderDB db(1 << 20, true, true);
+    unsigned int nImported = 0;
+    std::string strError;
+    BOOST_CHECK(db.ImportFile(path, nImported, strError));
+    BOOST_CHECK_EQUAL(nImported, vMain.size());
+    uint256 hashTip;
+    uint32_t nTipHeight;
+    BOOST_CHECK(db.ReadTip(hashTip, nTipHeight));
+    BOOST_CHECK_EQUAL(nTipHeight, 1019U);
+    BOOST_CHECK(db.IsAncestor(EthHeaderHash(vMain[0]), hashTip));
+
+    // A file that does not connect stops at the first bad line
+    file = fsbridge::fopen(path, "w");
+    BOOST_REQUIRE(file);
+    fprintf(file, "%s\n", HexStr(MakeHeader(hashTip, 1020, 0)).c_str());
+    fprintf(file, "%s\n", HexStr(MakeHeader(uint256S("0x01"), 1021, 0)).c_str());
+    fclose(file);
+    BOOST_CHECK(!db.ImportFile(path, nImported, strError));
+    BOOST_CHECK_EQUAL(nImported, 1U);
+    BOOST_CHECK(strError.find("line 2") == 0);
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
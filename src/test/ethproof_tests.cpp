@@ -0,0 +1,177 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "ethereum/ethproof.h"
+#include "ethereum/MemoryDB.h"
+#include "ethereum/RLP.h"
+#include "ethereum/TrieDB.h"
+#include "ethereum/TrieHash.h"
+#include "test/test_syscoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace dev;
+
+BOOST_FIXTURE_TEST_SUITE(ethproof_tests, BasicTestingSetup)
+
+/** A receipts-style trie, keyed by rlp(index), with every node kept so proofs can be cut from it. */
+struct ProofTrie
+{
+    std::vector<bytes> vKeys;
+    std::vector<bytes> vValues;
+    std::vector<bytes> vNodes;
+    h256 root;
+
+    explicit ProofTrie(unsigned int nCount)
+    {
+        MemoryDB db;
+        GenericTrieDB<MemoryDB> trie(&db);
+        trie.init();
+        for (unsigned int i = 0; i < nCount; i++) {
+            vKeys.push_back(rlp(i));
+            // Short values make some leaves small enough to be embedded in their parent
+            vValues.push_back(bytes(i % 3 == 0 ? 4 : 40 + i % 50, (byte)i));
+            trie.insert(vKeys.back(), vValues.back());
+        }
+        root = trie.root();
+        for (const auto& node : db.get())
+            vNodes.push_back(bytes(node.second.begin(), node.second.end()));
+    }
+
+    // Cut the proof of item i: the hashed nodes on its path, root first.
+    CEthProof Proof(unsigned int i) const
+    {
+        CEthProof proof;
+        proof.key = &vKeys[i];
+        proof.value = &vValues[i];
+        std::map<h256, bytesConstRef> mapNodes;
+        for (const auto& node : vNodes)
+            mapNodes[sha3(node)] = &node;
+        NibbleSlice path(proof.key);
+        RLP rlp(mapNodes[root]);
+        proof.nodes.push_back(mapNodes[root]);
+        while (true) {
+            RLP child;
+            if (rlp.itemCount() == 17) {
+                if (path.empty())
+                    break;
+                child = rlp[path[0]];
+                path = path.mid(1);
+            } else if (!isLeaf(rlp)) {
+                path = path.mid(keyOf(rlp).size());
+                child = rlp[1];
+            } else {
+                break;
+            }
+            if (child.isList()) {
+                rlp = child;
+            } else {
+                proof.nodes.push_back(mapNodes[child.toHash<h256>()]);
+                rlp = RLP(proof.nodes.back());
+            }
+        }
+        return proof;
+    }
+};
+
+BOOST_AUTO_TEST_CASE(ethproof_single)
+{
+    const ProofTrie trie(200);
+    BOOST_CHECK(trie.root == orderedTrieRoot(trie.vValues));
+
+    CEthProofVerifier verifier;
+    for (unsigned int i = 0; i < trie.vKeys.size(); i++)
+        BOOST_CHECK(verifier.Verify(trie.root, trie.Proof(i)));
+    BOOST_CHECK_EQUAL(verifier.CacheSize(), trie.vKeys.size());
+
+    // A wrong value, key or root is rejected whether or not the proof is cached
+    for (int fCached = 1; fCached >= 0; fCached--) {
+        if (!fCached)
+            verifier.ClearCache();
+        CEthProof proof = trie.Proof(7);
+        const bytes badValue(trie.vValues[7].size(), 0xff);
+        proof.value = &badValue;
+        BOOST_CHECK(!verifier.Verify(trie.root, proof));
+        proof = trie.Proof(7);
+        proof.key = &trie.vKeys[8];
+        BOOST_CHECK(!verifier.Verify(trie.root, proof));
+        proof = trie.Proof(7);
+        BOOST_CHECK(!verifier.Verify(sha3(trie.root), proof));
+    }
+
+    // Uncached, a tampered or missing node is rejected too
+    CEthProof proof = trie.Proof(7);
+    bytes badNode = proof.nodes.back().toBytes();
+    badNode.back() ^= 1;
+    proof.nodes.back() = &badNode;
+    BOOST_CHECK(!verifier.Verify(trie.root, proof));
+    proof.nodes.pop_back();
+    BOOST_CHECK(!verifier.Verify(trie.root, proof));
+    BOOST_CHECK_EQUAL(verifier.CacheSize(), 0U);
+    BOOST_CHECK(verifier.Verify(trie.root, trie.Proof(7)));
+    BOOST_CHECK_EQUAL(verifier.CacheSize(), 1U);
+
+    // Garbage nodes fail cleanly
+    const bytes garbage(100, 0xf9);
+    proof = trie.Proof(3);
+    proof.nodes.assign(1, &garbage);
+    BOOST_CHECK(!verifier.Verify(sha3(garbage), proof));
+}
+
+BOOST_AUTO_TEST_CASE(ethproof_batch)
+{
+    const ProofTrie trie(300);
+    std::vector<CEthProof> vProofs;
+    for (unsigned int i = 0; i < trie.vKeys.size(); i++)
+        vProofs.push_back(trie.Proof(i));
+
+    CEthProofVerifier verifier;
+    std::vector<bool> vResults;
+    BOOST_CHECK(verifier.VerifyBatch(trie.root, vProofs, vResults));
+    BOOST_CHECK_EQUAL(std::count(vResults.begin(), vResults.end(), true), (int)vProofs.size());
+
+    // One bad proof only fails itself, including when the others come from the cache
+    const bytes badValue(10, 0xff);
+    vProofs[5].value = &badValue;
+    BOOST_CHECK(!verifier.VerifyBatch(trie.root, vProofs, vResults));
+    BOOST_CHECK(!vResults[5]);
+    BOOST_CHECK_EQUAL(std::count(vResults.begin(), vResults.end(), true), (int)vProofs.size() - 1);
+    verifier.ClearCache();
+    BOOST_CHECK(!verifier.VerifyBatch(trie.root, vProofs, vResults));
+    BOOST_CHECK_EQUAL(std::count(vResults.begin(), vResults.end(), true), (int)vProofs.size() - 1);
+
+    // Batches accept nodes in any order, e.g. one shared node set for all proofs
+    verifier.ClearCache();
+    std::vector<CEthProof> vShared(3);
+    for (unsigned int i = 0; i < vShared.size(); i++) {
+        vShared[i].key = &trie.vKeys[i * 100];
+        vShared[i].value = &trie.vValues[i * 100];
+    }
+    for (auto it = trie.vNodes.rbegin(); it != trie.vNodes.rend(); ++it)
+        vShared[0].nodes.push_back(&*it);
+    BOOST_CHECK(verifier.VerifyBatch(trie.root, vShared, vResults));
+}
+
+BOOST_AUTO_TEST_CASE(ethproof_parse_nodes)
+{
+    const ProofTrie trie(50);
+    const CEthProof proof = trie.Proof(42);
+    RLPStream s(proof.nodes.size());
+    for (const auto& node : proof.nodes)
+        s.appendRaw(node);
+    const bytes rlpNodes = s.out();
+
+    CEthProof parsed = proof;
+    BOOST_CHECK(ParseEthProofNodes(&rlpNodes, parsed.nodes));
+    BOOST_CHECK_EQUAL(parsed.nodes.size(), proof.nodes.size());
+    for (unsigned int i = 0; i < parsed.nodes.size(); i++)
+        BOOST_CHECK(parsed.nodes[i].toBytes() == proof.nodes[i].toBytes());
+    CEthProofVerifier verifier;
+    BOOST_CHECK(verifier.Verify(trie.root, parsed));
+
+    const bytes notList = rlp(bytes(40, 1));
+    BOOST_CHECK(!ParseEthProofNodes(&notList, parsed.nodes));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
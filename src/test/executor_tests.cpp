@@ -0,0 +1,210 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <checkqueue.h>
+#include <executor.h>
+
+#include <test/test_syscoin.h>
+#include <utiltime.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(executor_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(executor_priority)
+{
+    CExecutor executor;
+    executor.Start(1);
+
+    // Hold the only thread while tasks of every class queue up
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    BOOST_CHECK(executor.TrySubmit(TaskClass::BACKGROUND, [released] { released.wait(); }));
+    MilliSleep(10);
+
+    std::vector<TaskClass> vRun;
+    for (TaskClass cls : {TaskClass::BACKGROUND, TaskClass::RPC, TaskClass::MEMPOOL, TaskClass::BLOCK, TaskClass::RPC}) {
+        BOOST_CHECK(executor.TrySubmit(cls, [&vRun, cls] { vRun.push_back(cls); }));
+    }
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::RPC).nQueued, 2U);
+    release.set_value();
+    executor.Stop();
+
+    const std::vector<TaskClass> vExpected{TaskClass::BLOCK, TaskClass::MEMPOOL, TaskClass::RPC, TaskClass::RPC, TaskClass::BACKGROUND};
+    BOOST_CHECK(vRun == vExpected);
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::BACKGROUND).nExecuted, 2U);
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::RPC).nPeakQueued, 2U);
+}
+
+BOOST_AUTO_TEST_CASE(executor_limits)
+{
+    CExecutor executor;
+    executor.SetClassLimits(TaskClass::MEMPOOL, 2, 0);
+    executor.Start(4);
+
+    std::atomic<int> nRunning{0};
+    std::atomic<int> nMostRunning{0};
+    for (int i = 0; i < 50; i++) {
+        BOOST_CHECK(executor.TrySubmit(TaskClass::MEMPOOL, [&nRunning, &nMostRunning] {
+            int n = ++nRunning;
+            int nMost = nMostRunning;
+            while (n > nMost && !nMostRunning.compare_exchange_weak(nMost, n)) {}
+            MilliSleep(1);
+            --nRunning;
+        }));
+    }
+    // Classes under their limit use the threads left over
+    std::atomic<int> nBlock{0};
+    for (int i = 0; i < 10; i++)
+        BOOST_CHECK(executor.TrySubmit(TaskClass::BLOCK, [&nBlock] { nBlock++; }));
+    executor.Stop();
+    BOOST_CHECK(nMostRunning <= 2);
+    BOOST_CHECK_EQUAL(nBlock, 10);
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::MEMPOOL).nExecuted, 50U);
+
+    // A full queue refuses tasks, as does a stopped executor
+    executor.SetClassLimits(TaskClass::MEMPOOL, 0, 0);
+    executor.SetClassLimits(TaskClass::RPC, 0, 1);
+    executor.Start(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    BOOST_CHECK(executor.TrySubmit(TaskClass::BLOCK, [released] { released.wait(); }));
+    MilliSleep(10);
+    BOOST_CHECK(executor.TrySubmit(TaskClass::RPC, [] {}));
+    BOOST_CHECK(!executor.TrySubmit(TaskClass::RPC, [] {}));
+    release.set_value();
+    executor.Stop();
+    BOOST_CHECK(!executor.IsRunning());
+    BOOST_CHECK(!executor.TrySubmit(TaskClass::RPC, [] {}));
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::RPC).nExecuted, 1U);
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::RPC).nRejected, 2U);
+}
+
+/** A script check stand-in that records the thread it ran on */
+struct ThreadRecordingCheck {
+    std::mutex* pmutex = nullptr;
+    std::set<std::thread::id>* psetThreads = nullptr;
+
+    bool operator()()
+    {
+        MilliSleep(1);
+        std::lock_guard<std::mutex> lock(*pmutex);
+        psetThreads->insert(std::this_thread::get_id());
+        return true;
+    }
+    void swap(ThreadRecordingCheck& check)
+    {
+        std::swap(pmutex, check.pmutex);
+        std::swap(psetThreads, check.psetThreads);
+    }
+};
+
+BOOST_AUTO_TEST_CASE(executor_block_helpers_reserved)
+{
+    // Sized as init does, with a thread for every task the class limits let run
+    CExecutor executor;
+    executor.SetClassLimits(TaskClass::BLOCK, 3, 0);
+    executor.SetClassLimits(TaskClass::RPC, 2, 0);
+    executor.SetClassLimits(TaskClass::MEMPOOL, 2, 0);
+    executor.SetClassLimits(TaskClass::NOTIFY, 1, 0);
+    executor.SetClassLimits(TaskClass::BACKGROUND, 1, 0);
+    executor.Start(3 + 2 + 2 + 1 + 1);
+
+    // RPC requests and mempool checks that wait for cs_main take all the threads they may, with more queued
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    for (int i = 0; i < 10; i++) {
+        BOOST_CHECK(executor.TrySubmit(TaskClass::RPC, [released] { released.wait(); }));
+        BOOST_CHECK(executor.TrySubmit(TaskClass::MEMPOOL, [released] { released.wait(); }));
+    }
+    while (executor.GetStats(TaskClass::RPC).nRunning < 2 || executor.GetStats(TaskClass::MEMPOOL).nRunning < 2)
+        MilliSleep(1);
+
+    // The script checks of a block still get their helpers
+    std::mutex mutex;
+    std::set<std::thread::id> setThreads;
+    {
+        CCheckQueue<ThreadRecordingCheck> queue(8);
+        queue.SetExecutor(&executor, TaskClass::BLOCK, 3);
+        CCheckQueueControl<ThreadRecordingCheck> control(&queue);
+        std::vector<ThreadRecordingCheck> vChecks(200);
+        for (ThreadRecordingCheck& check : vChecks) {
+            check.pmutex = &mutex;
+            check.psetThreads = &setThreads;
+        }
+        control.Add(vChecks);
+        BOOST_CHECK(control.Wait());
+    }
+    BOOST_CHECK(setThreads.size() > 1);
+    BOOST_CHECK(executor.GetStats(TaskClass::BLOCK).nExecuted > 0);
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::RPC).nExecuted, 0U);
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::MEMPOOL).nExecuted, 0U);
+    release.set_value();
+    executor.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(executor_notify_not_starved)
+{
+    // Started with fewer threads than the limits add up to, as when httpserver raises the RPC limit later
+    CExecutor executor;
+    executor.SetClassLimits(TaskClass::MEMPOOL, 2, 0);
+    executor.SetClassLimits(TaskClass::RPC, 1, 0);
+    executor.SetClassLimits(TaskClass::NOTIFY, 1, 0);
+    executor.Start(1);
+    BOOST_CHECK_EQUAL(executor.GetThreadCount(), 4);
+    executor.SetClassLimits(TaskClass::RPC, 2, 0);
+    BOOST_CHECK_EQUAL(executor.GetThreadCount(), 5);
+
+    // Mempool checks keep their class busy and queued the whole time
+    std::atomic<bool> fFlood{true};
+    std::function<void()> flood = [&] {
+        MilliSleep(1);
+        if (fFlood)
+            executor.TrySubmit(TaskClass::MEMPOOL, flood);
+    };
+    for (int i = 0; i < 4; i++)
+        BOOST_CHECK(executor.TrySubmit(TaskClass::MEMPOOL, flood));
+
+    // RPC requests that wait for a wallet callback, as sendrawtransaction does, still see it run
+    std::atomic<int> nNotified{0};
+    std::promise<void> done[2];
+    for (std::promise<void>& promise : done) {
+        BOOST_CHECK(executor.TrySubmit(TaskClass::RPC, [&executor, &nNotified, &promise] {
+            auto callback = std::make_shared<std::promise<void>>();
+            std::future<void> called = callback->get_future();
+            BOOST_CHECK(executor.TrySubmit(TaskClass::NOTIFY, [callback] { callback->set_value(); }));
+            if (called.wait_for(std::chrono::seconds(10)) == std::future_status::ready)
+                nNotified++;
+            promise.set_value();
+        }));
+    }
+    for (std::promise<void>& promise : done)
+        promise.get_future().wait();
+    BOOST_CHECK_EQUAL(nNotified, 2);
+    fFlood = false;
+    executor.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(executor_exceptions)
+{
+    CExecutor executor;
+    executor.Start(1);
+    std::atomic<bool> fRan{false};
+    BOOST_CHECK(executor.TrySubmit(TaskClass::RPC, [] { throw std::runtime_error("executor_exceptions"); }));
+    BOOST_CHECK(executor.TrySubmit(TaskClass::RPC, [&fRan] { fRan = true; }));
+    executor.Stop();
+    BOOST_CHECK(fRan);
+    BOOST_CHECK_EQUAL(executor.GetStats(TaskClass::RPC).nExecuted, 2U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
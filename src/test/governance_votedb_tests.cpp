@@ -0,0 +1,182 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "governance-votedb.h"
+#include "primitives/transaction.h"
+
+#include "test/test_syscoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(governance_votedb_tests, BasicTestingSetup)
+
+static CGovernanceObjectVoteFile CreateVoteFile(const uint256& nParentHash, int nVotes, std::vector<uint256>& vecHashesRet)
+{
+    CGovernanceObjectVoteFile fileVotes;
+    for (int i = 0; i < nVotes; ++i) {
+        CGovernanceVote vote(COutPoint(InsecureRand256(), i), nParentHash, VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_YES);
+        fileVotes.AddVote(vote);
+        vecHashesRet.push_back(vote.GetHash());
+    }
+    return fileVotes;
+}
+
+BOOST_AUTO_TEST_CASE(votes_page_resume)
+{
+    std::vector<uint256> vecHashes;
+    CGovernanceObjectVoteFile fileVotes = CreateVoteFile(InsecureRand256(), 25, vecHashes);
+
+    CBloomFilter filter;
+    filter.clear();
+
+    // page through all votes, oldest first, 10 at a time
+    std::vector<CGovernanceVote> vecVotes;
+    uint256 hashContinuation;
+    int nPages = 0;
+    do {
+        size_t nPrevSize = vecVotes.size();
+        BOOST_CHECK(fileVotes.GetVotesPage(hashContinuation, filter, 10, 100, vecVotes, hashContinuation));
+        BOOST_CHECK(vecVotes.size() - nPrevSize <= 10);
+        ++nPages;
+    } while (!hashContinuation.IsNull());
+
+    BOOST_CHECK_EQUAL(nPages, 3);
+    BOOST_REQUIRE_EQUAL(vecVotes.size(), vecHashes.size());
+    for (size_t i = 0; i < vecHashes.size(); ++i) {
+        BOOST_CHECK(vecVotes[i].GetHash() == vecHashes[i]);
+    }
+
+    // votes added while paging are picked up at the end
+    std::vector<CGovernanceVote> vecFirst;
+    BOOST_CHECK(fileVotes.GetVotesPage(uint256(), filter, 10, 100, vecFirst, hashContinuation));
+    CGovernanceVote voteNew(COutPoint(InsecureRand256(), 0), vecHashes[0], VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_NO);
+    fileVotes.AddVote(voteNew);
+    std::vector<CGovernanceVote> vecRest;
+    BOOST_CHECK(fileVotes.GetVotesPage(hashContinuation, filter, 100, 100, vecRest, hashContinuation));
+    BOOST_CHECK(hashContinuation.IsNull());
+    BOOST_REQUIRE_EQUAL(vecRest.size(), 16U);
+    BOOST_CHECK(vecRest.front().GetHash() == vecHashes[10]);
+    BOOST_CHECK(vecRest.back().GetHash() == voteNew.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(votes_page_no_budget)
+{
+    std::vector<uint256> vecHashes;
+    uint256 nParentHash = InsecureRand256();
+    CGovernanceObjectVoteFile fileVotes = CreateVoteFile(nParentHash, 5, vecHashes);
+
+    CBloomFilter filter;
+    filter.clear();
+
+    // a peer out of budget is told that no progress was made, not that it has everything
+    std::vector<CGovernanceVote> vecVotes;
+    uint256 hashContinuation;
+    BOOST_CHECK(!fileVotes.GetVotesPage(uint256(), filter, 0, 100, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation.IsNull());
+    BOOST_CHECK(vecVotes.empty());
+    BOOST_CHECK(fileVotes.GetVotesPage(uint256(), filter, 100, 100, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation.IsNull());
+    BOOST_REQUIRE_EQUAL(vecVotes.size(), 5U);
+    BOOST_CHECK(vecVotes.front().GetHash() == vecHashes[0]);
+
+    // and in the middle of a sync it keeps its place
+    vecVotes.clear();
+    BOOST_CHECK(fileVotes.GetVotesPage(uint256(), filter, 2, 100, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation == vecHashes[1]);
+    BOOST_CHECK(!fileVotes.GetVotesPage(hashContinuation, filter, 0, 100, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation == vecHashes[1]);
+    BOOST_CHECK_EQUAL(vecVotes.size(), 2U);
+    BOOST_CHECK(fileVotes.GetVotesPage(hashContinuation, filter, 100, 100, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation.IsNull());
+    BOOST_CHECK_EQUAL(vecVotes.size(), 5U);
+
+    // an empty file has nothing left to page through, budget or not
+    CGovernanceObjectVoteFile fileEmpty;
+    hashContinuation = vecHashes[0];
+    BOOST_CHECK(fileEmpty.GetVotesPage(uint256(), filter, 0, 100, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation.IsNull());
+}
+
+BOOST_AUTO_TEST_CASE(votes_page_filter)
+{
+    std::vector<uint256> vecHashes;
+    CGovernanceObjectVoteFile fileVotes = CreateVoteFile(InsecureRand256(), 20, vecHashes);
+
+    // the peer already has every other vote
+    CBloomFilter filter(20, 0.000001, 0, BLOOM_UPDATE_ALL);
+    for (size_t i = 0; i < vecHashes.size(); i += 2) {
+        filter.insert(vecHashes[i]);
+    }
+
+    std::vector<CGovernanceVote> vecVotes;
+    uint256 hashContinuation;
+    BOOST_CHECK(fileVotes.GetVotesPage(uint256(), filter, 100, 100, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation.IsNull());
+    BOOST_REQUIRE_EQUAL(vecVotes.size(), 10U);
+    for (size_t i = 0; i < vecVotes.size(); ++i) {
+        BOOST_CHECK(vecVotes[i].GetHash() == vecHashes[2 * i + 1]);
+    }
+
+    // the scan limit bounds the work spent on votes the peer already has
+    vecVotes.clear();
+    BOOST_CHECK(fileVotes.GetVotesPage(uint256(), filter, 100, 5, vecVotes, hashContinuation));
+    BOOST_CHECK(hashContinuation == vecHashes[4]);
+    BOOST_CHECK_EQUAL(vecVotes.size(), 2U);
+
+    // an unknown continuation token restarts from the oldest vote
+    vecVotes.clear();
+    BOOST_CHECK(fileVotes.GetVotesPage(InsecureRand256(), filter, 1, 100, vecVotes, hashContinuation));
+    BOOST_REQUIRE_EQUAL(vecVotes.size(), 1U);
+    BOOST_CHECK(vecVotes[0].GetHash() == vecHashes[1]);
+}
+
+BOOST_AUTO_TEST_CASE(votes_serialized_cache)
+{
+    std::vector<uint256> vecHashes;
+    CGovernanceObjectVoteFile fileVotes = CreateVoteFile(InsecureRand256(), 3, vecHashes);
+
+    for (int i = 0; i < 2; ++i) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        BOOST_CHECK(fileVotes.SerializeVoteToStream(vecHashes[1], ss));
+        CGovernanceVote vote;
+        ss >> vote;
+        BOOST_CHECK(vote.GetHash() == vecHashes[1]);
+        BOOST_CHECK(ss.empty());
+    }
+
+    // the stream's version is used
+    CDataStream ssOld(SER_NETWORK, PROTOCOL_VERSION - 1);
+    BOOST_CHECK(fileVotes.SerializeVoteToStream(vecHashes[1], ssOld));
+    BOOST_CHECK_EQUAL(ssOld.GetVersion(), PROTOCOL_VERSION - 1);
+    CGovernanceVote voteOld;
+    ssOld >> voteOld;
+    BOOST_CHECK(voteOld.GetHash() == vecHashes[1]);
+
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    BOOST_CHECK(!fileVotes.SerializeVoteToStream(InsecureRand256(), ss));
+}
+
+BOOST_AUTO_TEST_CASE(votes_serialized_cache_remove)
+{
+    CGovernanceObjectVoteFile fileVotes;
+    CGovernanceVote vote(COutPoint(InsecureRand256(), 0), InsecureRand256(), VOTE_SIGNAL_FUNDING, VOTE_OUTCOME_YES);
+    fileVotes.AddVote(vote);
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    BOOST_CHECK(fileVotes.SerializeVoteToStream(vote.GetHash(), ss));
+
+    // the votes of a removed masternode leave the cache's order as well, and come back when voted again
+    fileVotes.RemoveVotesFromMasternode(vote.GetMasternodeOutpoint());
+    BOOST_CHECK(!fileVotes.HasVote(vote.GetHash()));
+    for (int i = 0; i < 3; ++i) {
+        fileVotes.AddVote(vote);
+        CDataStream ssAgain(SER_NETWORK, PROTOCOL_VERSION);
+        BOOST_CHECK(fileVotes.SerializeVoteToStream(vote.GetHash(), ssAgain));
+        CGovernanceVote voteAgain;
+        ssAgain >> voteAgain;
+        BOOST_CHECK(voteAgain.GetHash() == vote.GetHash());
+        fileVotes.RemoveVotesFromMasternode(vote.GetMasternodeOutpoint());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <logging.h>
+
+#include <fs.h>
+#include <test/test_syscoin.h>
+
+#include <fstream>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(logging_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(logging_ring)
+{
+    BCLog::LogRing ring(5);
+    BOOST_CHECK_EQUAL(ring.Capacity(), 8U);
+
+    std::string str;
+    BOOST_CHECK(!ring.TryPop(str));
+    // Go round the ring a few times, filling it up each time
+    for (int nLap = 0; nLap < 3; nLap++) {
+        for (int i = 0; i < 8; i++)
+            BOOST_CHECK(ring.TryPush(strprintf("%d %d\n", nLap, i)));
+        BOOST_CHECK(!ring.TryPush("dropped\n"));
+        for (int i = 0; i < 8; i++) {
+            BOOST_CHECK(ring.TryPop(str));
+            BOOST_CHECK_EQUAL(str, strprintf("%d %d\n", nLap, i));
+        }
+        BOOST_CHECK(!ring.TryPop(str));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(logging_ring_threads)
+{
+    const int nThreads = 4;
+    const int nLines = 20000;
+    BCLog::LogRing ring(64);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nThreads; t++) {
+        threads.emplace_back([&ring, t] {
+            for (int i = 0; i < nLines; i++) {
+                while (!ring.TryPush(strprintf("%d %d", t, i)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    // Every thread's lines come out, and in the order that thread pushed them
+    std::vector<int> vNext(nThreads, 0);
+    std::string str;
+    for (int nPopped = 0; nPopped < nThreads * nLines;) {
+        if (!ring.TryPop(str)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int t, i;
+        BOOST_REQUIRE(sscanf(str.c_str(), "%d %d", &t, &i) == 2);
+        BOOST_REQUIRE(t >= 0 && t < nThreads);
+        BOOST_CHECK_EQUAL(i, vNext[t]);
+        vNext[t] = i + 1;
+        nPopped++;
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    BOOST_CHECK(!ring.TryPop(str));
+}
+
+BOOST_AUTO_TEST_CASE(logging_async)
+{
+    const int nThreads = 4;
+    const int nLines = 5000;
+    const fs::path path = fs::temp_directory_path() / fs::unique_path();
+
+    BCLog::Logger logger;
+    logger.m_print_to_console = false;
+    logger.m_print_to_file = true;
+    logger.m_log_timestamps = false;
+    logger.m_file_path = path;
+    BOOST_REQUIRE(logger.OpenDebugLog());
+
+    logger.StartAsync(16);
+    BOOST_CHECK(logger.IsAsync());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nThreads; t++) {
+        threads.emplace_back([&logger, t] {
+            for (int i = 0; i < nLines; i++)
+                logger.LogPrintStr(strprintf("line %d %d\n", t, i));
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    logger.StopAsync();
+    BOOST_CHECK(!logger.IsAsync());
+    logger.LogPrintStr("sync\n");
+
+    // Each line was either written or counted as dropped, and drops were reported
+    uint64_t nWritten = 0;
+    uint64_t nReported = 0;
+    std::string strLast;
+    std::ifstream file(path.string());
+    for (std::string strLine; std::getline(file, strLine); strLast = strLine) {
+        unsigned int nDropped;
+        if (strLine.compare(0, 5, "line ") == 0)
+            nWritten++;
+        else if (sscanf(strLine.c_str(), "%u log messages dropped", &nDropped) == 1)
+            nReported += nDropped;
+    }
+    BOOST_CHECK_EQUAL(nWritten + logger.GetDroppedCount(), (uint64_t)nThreads * nLines);
+    BOOST_CHECK_EQUAL(nReported, logger.GetDroppedCount());
+    BOOST_CHECK_EQUAL(strLast, "sync");
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
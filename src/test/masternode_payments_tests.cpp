@@ -0,0 +1,150 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "masternode-payments.h"
+#include "streams.h"
+
+#include "test/test_syscoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(masternode_payments_tests, BasicTestingSetup)
+
+static CMasternodePaymentVote CreateVote(int nBlockHeight, const CScript& payee)
+{
+    CMasternodePaymentVote vote(COutPoint(InsecureRand256(), 0), nBlockHeight, payee, 0);
+    vote.vchSig.resize(65, 1);
+    return vote;
+}
+
+static uint256 AddVote(CMasternodePaymentsRing& ring, const CMasternodePaymentVote& vote)
+{
+    uint256 nHash = vote.GetHash();
+    BOOST_CHECK(ring.AddVote(nHash, vote));
+    BOOST_CHECK(ring.AddPayee(nHash));
+    return nHash;
+}
+
+BOOST_AUTO_TEST_CASE(ring_add_and_lookup)
+{
+    CMasternodePaymentsRing ring;
+    ring.Reserve(100);
+    BOOST_CHECK_EQUAL(ring.Capacity(), 1024);
+
+    CScript payeeA = CScript() << OP_TRUE;
+    CScript payeeB = CScript() << OP_FALSE;
+
+    uint256 nHash1 = AddVote(ring, CreateVote(500, payeeA));
+    AddVote(ring, CreateVote(500, payeeA));
+    AddVote(ring, CreateVote(500, payeeB));
+
+    // a vote which was only seen but not verified yet doesn't make a payee
+    CMasternodePaymentVote voteSeen = CreateVote(501, payeeB);
+    voteSeen.MarkAsNotVerified();
+    BOOST_CHECK(ring.AddVote(voteSeen.GetHash(), voteSeen));
+
+    BOOST_CHECK_EQUAL(ring.GetVoteCount(), 4);
+    BOOST_CHECK_EQUAL(ring.GetBlockCount(), 1);
+    BOOST_CHECK(ring.GetBlock(501) == nullptr);
+    BOOST_CHECK(ring.GetBlock(500 + 1024) == nullptr);
+
+    const CMasternodeBlockPayees* pblockPayees = ring.GetBlock(500);
+    BOOST_REQUIRE(pblockPayees != nullptr);
+    CScript payeeBest;
+    BOOST_CHECK(pblockPayees->GetBestPayee(payeeBest));
+    BOOST_CHECK(payeeBest == payeeA);
+
+    const CMasternodePaymentVote* pvote = ring.GetVote(nHash1);
+    BOOST_REQUIRE(pvote != nullptr);
+    BOOST_CHECK(pvote->GetHash() == nHash1);
+    BOOST_CHECK(pvote->IsVerified());
+    BOOST_CHECK(!ring.GetVote(voteSeen.GetHash())->IsVerified());
+    BOOST_CHECK(ring.DynamicMemoryUsage() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(ring_expiry)
+{
+    CMasternodePaymentsRing ring;
+    ring.Reserve(1024);
+
+    CScript payee = CScript() << OP_TRUE;
+    std::vector<uint256> vecHashes;
+    for (int h = 1000; h < 1100; ++h) {
+        vecHashes.push_back(AddVote(ring, CreateVote(h, payee)));
+    }
+    BOOST_CHECK_EQUAL(ring.GetBlockCount(), 100);
+
+    ring.ExpireBelow(1050);
+    BOOST_CHECK_EQUAL(ring.GetBlockCount(), 50);
+    BOOST_CHECK_EQUAL(ring.GetVoteCount(), 50);
+    BOOST_CHECK(!ring.HasVote(vecHashes[49]));
+    BOOST_CHECK(ring.HasVote(vecHashes[50]));
+    BOOST_CHECK(ring.GetBlock(1049) == nullptr);
+    BOOST_CHECK(ring.GetBlock(1050) != nullptr);
+
+    // expired heights are not accepted anymore
+    CMasternodePaymentVote voteOld = CreateVote(1049, payee);
+    BOOST_CHECK(!ring.AddVote(voteOld.GetHash(), voteOld));
+
+    // a later height which maps to the same slot replaces the old one
+    uint256 nHashNew = AddVote(ring, CreateVote(1060 + 1024, payee));
+    BOOST_CHECK(ring.GetBlock(1060) == nullptr);
+    BOOST_CHECK(!ring.HasVote(vecHashes[60]));
+    BOOST_CHECK(ring.HasVote(nHashNew));
+    BOOST_CHECK_EQUAL(ring.GetBlockCount(), 50);
+
+    // ... but not the other way around
+    CMasternodePaymentVote voteStale = CreateVote(1070 - 1024 + 2048, payee);
+    BOOST_CHECK(ring.AddVote(voteStale.GetHash(), voteStale));
+    CMasternodePaymentVote voteOlder = CreateVote(1070, payee);
+    BOOST_CHECK(!ring.AddVote(voteOlder.GetHash(), voteOlder));
+
+    // jumping far ahead clears everything
+    ring.ExpireBelow(100000);
+    BOOST_CHECK_EQUAL(ring.GetBlockCount(), 0);
+    BOOST_CHECK_EQUAL(ring.GetVoteCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ring_reserve_and_serialize)
+{
+    CMasternodePaymentsRing ring;
+    ring.Reserve(1024);
+
+    CScript payee = CScript() << OP_TRUE;
+    std::vector<uint256> vecHashes;
+    for (int h = 2000; h < 2900; ++h) {
+        vecHashes.push_back(AddVote(ring, CreateVote(h, payee)));
+    }
+
+    ring.Reserve(3000);
+    BOOST_CHECK_EQUAL(ring.Capacity(), 3072);
+    BOOST_CHECK_EQUAL(ring.GetBlockCount(), 900);
+    for (int h = 2000; h < 2900; ++h) {
+        BOOST_CHECK(ring.GetBlock(h) != nullptr);
+    }
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << ring;
+
+    // the format is the one of the former std::map based storage
+    std::map<uint256, CMasternodePaymentVote> mapVotes;
+    std::map<int, CMasternodeBlockPayees> mapBlocks;
+    CDataStream ssMap(ss);
+    ssMap >> mapVotes >> mapBlocks;
+    BOOST_CHECK_EQUAL(mapVotes.size(), 900U);
+    BOOST_CHECK_EQUAL(mapBlocks.size(), 900U);
+    BOOST_CHECK(mapVotes.count(vecHashes[0]));
+    BOOST_CHECK(mapBlocks.count(2899));
+
+    CMasternodePaymentsRing ringLoaded;
+    ringLoaded.Reserve(3000);
+    ss >> ringLoaded;
+    BOOST_CHECK_EQUAL(ringLoaded.GetBlockCount(), 900);
+    BOOST_CHECK_EQUAL(ringLoaded.GetVoteCount(), 900);
+    for (const auto& nHash : vecHashes) {
+        BOOST_CHECK(ringLoaded.HasVote(nHash));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
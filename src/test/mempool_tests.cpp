@@ -2,9 +2,17 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <executor.h>
+#include <key.h>
 #include <policy/policy.h>
+#include <script/interpreter.h>
+#include <services/asset.h>
+#include <services/assetallocation.h>
+#include <streams.h>
 #include <txmempool.h>
 #include <util.h>
+#include <utiltime.h>
+#include <validation.h>
 
 #include <test/test_syscoin.h>
 
@@ -12,6 +20,10 @@
 #include <list>
 #include <vector>
 
+extern AssetBalanceMap mempoolMapAssetBalances;
+extern ArrivalTimesMapImpl arrivalTimesMap;
+extern AssetAllocationSendsMap mempoolMapAssetAllocationSends;
+
 BOOST_FIXTURE_TEST_SUITE(mempool_tests, TestingSetup)
 
 BOOST_AUTO_TEST_CASE(MempoolRemoveTest)
@@ -749,4 +761,271 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTests)
     BOOST_CHECK_EQUAL(descendants, 6ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolZDAGStatePersist)
+{
+    // The ZDAG state saved with mempool.dat comes back exactly as it was taken
+    CAssetAllocationMempoolState state;
+    state.hashBlock = InsecureRand256();
+    for (int i = 0; i < 20; i++) {
+        const std::string strTuple = strprintf("%d-sender%d", 1000 + i % 3, i);
+        for (int j = 0; j <= i % 4; j++)
+            state.mapArrivalTimes[strTuple].emplace_back(InsecureRand256(), 1500000000000 + InsecureRandRange(1000000));
+        std::sort(state.mapArrivalTimes[strTuple].begin(), state.mapArrivalTimes[strTuple].end());
+        state.mapBalances[strTuple] = InsecureRandRange(MAX_MONEY);
+    }
+    state.vecConflicts = {"1000-sender0", "1001-sender4"};
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << state;
+    CAssetAllocationMempoolState restored;
+    ss >> restored;
+    BOOST_CHECK(restored.hashBlock == state.hashBlock);
+    BOOST_CHECK(restored.mapArrivalTimes == state.mapArrivalTimes);
+    BOOST_CHECK(restored.mapBalances == state.mapBalances);
+    BOOST_CHECK(restored.vecConflicts == state.vecConflicts);
+
+    RestoreAssetAllocationMempoolState(restored);
+    CAssetAllocationMempoolState current;
+    GetAssetAllocationMempoolState(current);
+    for (auto& arrivalTimes : current.mapArrivalTimes)
+        std::sort(arrivalTimes.second.begin(), arrivalTimes.second.end());
+    BOOST_CHECK(current.mapArrivalTimes == state.mapArrivalTimes);
+    BOOST_CHECK(current.mapBalances == state.mapBalances);
+    for (const std::string& conflict : state.vecConflicts)
+        BOOST_CHECK(std::count(current.vecConflicts.begin(), current.vecConflicts.end(), conflict));
+
+    // Entries already in the mempool state are kept over the restored ones
+    mempoolMapAssetBalances["1000-sender0"] = 1;
+    RestoreAssetAllocationMempoolState(restored);
+    BOOST_CHECK_EQUAL(mempoolMapAssetBalances["1000-sender0"], 1);
+
+    // A state of an unknown version is rejected rather than misread
+    CDataStream ssFuture(SER_DISK, CLIENT_VERSION);
+    state.nVersion = CAssetAllocationMempoolState::CURRENT_VERSION + 1;
+    ssFuture << state;
+    BOOST_CHECK_THROW(ssFuture >> restored, std::ios_base::failure);
+
+    mempoolMapAssetBalances.clear();
+    arrivalTimesMap.clear();
+}
+
+/** An asset allocation send spending the first output of a coinbase paid to key */
+static CTransactionRef MakeAssetAllocationSend(const CTransactionRef& coinbase, const CKey& key, CAssetAllocation assetAllocation)
+{
+    const CScript scriptPubKey = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+    std::vector<unsigned char> vchData;
+    assetAllocation.Serialize(vchData);
+
+    CMutableTransaction tx;
+    tx.nVersion = SYSCOIN_TX_VERSION_ASSET;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = COutPoint(coinbase->GetHash(), 0);
+    tx.vout.resize(2);
+    tx.vout[0].nValue = coinbase->vout[0].nValue - CENT;
+    tx.vout[0].scriptPubKey = CScript() << CScript::EncodeOP_N(OP_SYSCOIN_ASSET_ALLOCATION) << CScript::EncodeOP_N(OP_ASSET_ALLOCATION_SEND) << OP_2DROP;
+    tx.vout[0].scriptPubKey += scriptPubKey;
+    tx.vout[1].nValue = 0;
+    tx.vout[1].scriptPubKey = CScript() << OP_RETURN << CScript::EncodeOP_N(OP_SYSCOIN_ASSET_ALLOCATION) << vchData;
+
+    std::vector<unsigned char> vchSig;
+    const uint256 hash = SignatureHash(scriptPubKey, tx, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+    BOOST_CHECK(key.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    tx.vin[0].scriptSig << vchSig;
+    return MakeTransactionRef(tx);
+}
+
+static void ClearMempoolAndZDAGState()
+{
+    LOCK(cs_main);
+    mempool.clear();
+    arrivalTimesMap.clear();
+    mempoolMapAssetBalances.clear();
+    mempoolMapAssetAllocationSends.clear();
+}
+
+/** Wait for the checks LoadMempool leaves to the executor, which drop what fails them from the mempool */
+static void SyncWithMempoolChecks()
+{
+    while (true) {
+        const CExecutorClassStats stats = g_executor.GetStats(TaskClass::MEMPOOL);
+        if (stats.nRunning == 0 && stats.nQueued == 0)
+            break;
+        MilliSleep(1);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(MempoolZDAGStateDumpLoad, TestChain100Setup)
+{
+    // The asset dbs are not set up here, so CheckSyscoinInputs fails every send: a send
+    // that is still in the mempool after loading was accepted without it
+    CAssetAllocation assetAllocation;
+    assetAllocation.assetAllocationTuple = CAssetAllocationTuple(1, vchFromString("sender"));
+    assetAllocation.listSendingAllocationAmounts.emplace_back(vchFromString("receiver"), 10 * COIN);
+    const std::string strSender = assetAllocation.assetAllocationTuple.ToString();
+    const CTransactionRef tx1 = MakeAssetAllocationSend(m_coinbase_txns[0], coinbaseKey, assetAllocation);
+    const CTransactionRef tx2 = MakeAssetAllocationSend(m_coinbase_txns[1], coinbaseKey, assetAllocation);
+    const int64_t nArrivalTime1 = 1500000000000;
+    const int64_t nArrivalTime2 = nArrivalTime1 + 5;
+
+    // Both sends in the mempool, with the state CheckAssetAllocationInputs left for them
+    auto fill = [&](int64_t nTime2) {
+        ClearMempoolAndZDAGState();
+        TestMemPoolEntryHelper entry;
+        LOCK2(cs_main, mempool.cs);
+        mempool.addUnchecked(tx1->GetHash(), entry.Fee(CENT).Time(GetTime()).SpendsCoinbase(true).FromTx(tx1));
+        mempool.addUnchecked(tx2->GetHash(), entry.Time(nTime2).FromTx(tx2));
+        arrivalTimesMap[strSender][tx1->GetHash()] = nArrivalTime1;
+        arrivalTimesMap[strSender][tx2->GetHash()] = nArrivalTime2;
+        mempoolMapAssetBalances[strSender] = 80 * COIN;
+    };
+
+    // Saved on the current tip: the state comes back and tx1 skips CheckSyscoinInputs, while
+    // tx2 has expired and its arrival time is taken out again
+    fill(GetTime() - DEFAULT_MEMPOOL_EXPIRY * 60 * 60 - 60);
+    BOOST_CHECK(DumpMempool());
+    ClearMempoolAndZDAGState();
+    BOOST_CHECK(LoadMempool());
+    SyncWithMempoolChecks();
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(mempool.exists(tx1->GetHash()));
+        BOOST_CHECK(!mempool.exists(tx2->GetHash()));
+        BOOST_CHECK_EQUAL(arrivalTimesMap[strSender].size(), 1U);
+        BOOST_CHECK_EQUAL(arrivalTimesMap[strSender][tx1->GetHash()], nArrivalTime1);
+        // the balance was derived again without tx2, from the empty asset db
+        BOOST_CHECK_EQUAL(mempoolMapAssetBalances[strSender], 0);
+    }
+
+    // A file that breaks off inside its second transaction: the state restored for it is pruned
+    fill(GetTime());
+    BOOST_CHECK(DumpMempool());
+    ClearMempoolAndZDAGState();
+    const fs::path path = GetDataDir() / "mempool.dat";
+    CTransactionRef txFirst;
+    {
+        CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+        uint64_t version;
+        std::vector<unsigned char> vchZDAGState;
+        uint64_t num;
+        int64_t nTime;
+        int64_t nFeeDelta;
+        file >> version >> vchZDAGState >> num >> txFirst >> nTime >> nFeeDelta;
+        BOOST_CHECK_EQUAL(num, 2U);
+        fs::resize_file(path, ftell(file.Get()) + 10);
+    }
+    const CTransactionRef& txSecond = txFirst->GetHash() == tx1->GetHash() ? tx2 : tx1;
+    BOOST_CHECK(!LoadMempool());
+    SyncWithMempoolChecks();
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(mempool.exists(txFirst->GetHash()));
+        BOOST_CHECK(!mempool.exists(txSecond->GetHash()));
+        BOOST_CHECK_EQUAL(arrivalTimesMap[strSender].size(), 1U);
+        BOOST_CHECK(arrivalTimesMap[strSender].count(txFirst->GetHash()));
+    }
+
+    // Saved on another tip: nothing is restored and both sends go through CheckSyscoinInputs again
+    fill(GetTime());
+    BOOST_CHECK(DumpMempool());
+    ClearMempoolAndZDAGState();
+    CreateAndProcessBlock({}, CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG);
+    BOOST_CHECK(LoadMempool());
+    SyncWithMempoolChecks();
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!mempool.exists(tx1->GetHash()));
+        BOOST_CHECK(!mempool.exists(tx2->GetHash()));
+        BOOST_CHECK(arrivalTimesMap.empty());
+        BOOST_CHECK(mempoolMapAssetBalances.empty());
+    }
+    ClearMempoolAndZDAGState();
+}
+
+BOOST_FIXTURE_TEST_CASE(MempoolZDAGBalancesRederived, TestChain100Setup)
+{
+    // An allocation db in memory, which blocks are flushed to and undone from as ConnectBlock and DisconnectBlock do
+    passetallocationdb.reset(new CAssetAllocationDB(1 << 20, true, false));
+    auto allocation = [](const std::string& strAddress, CAmount nBalance) {
+        CAssetAllocation assetAllocation;
+        assetAllocation.assetAllocationTuple = CAssetAllocationTuple(1, vchFromString(strAddress));
+        assetAllocation.nBalance = nBalance;
+        return assetAllocation;
+    };
+    auto send = [&](int nCoinbase, const std::string& strSender, const std::string& strReceiver, CAmount nAmount) {
+        CAssetAllocation assetAllocation = allocation(strSender, 0);
+        assetAllocation.listSendingAllocationAmounts.emplace_back(vchFromString(strReceiver), nAmount);
+        return MakeAssetAllocationSend(m_coinbase_txns[nCoinbase], coinbaseKey, assetAllocation);
+    };
+    auto balance = [](const std::string& strTuple) {
+        AssetBalanceMap::const_iterator it = mempoolMapAssetBalances.find(strTuple);
+        return it == mempoolMapAssetBalances.end() ? -1 : it->second;
+    };
+    const std::string strA = allocation("a", 0).assetAllocationTuple.ToString();
+    const std::string strB = allocation("b", 0).assetAllocationTuple.ToString();
+    const std::string strC = allocation("c", 0).assetAllocationTuple.ToString();
+    const std::string strD = allocation("d", 0).assetAllocationTuple.ToString();
+    const std::string strE = allocation("e", 0).assetAllocationTuple.ToString();
+    const std::string strF = allocation("f", 0).assetAllocationTuple.ToString();
+    ClearMempoolAndZDAGState();
+    BOOST_CHECK(passetallocationdb->Flush(AssetAllocationMap{{strA, allocation("a", 100)}, {strD, allocation("d", 100)}}));
+
+    // Three sends pending, with the state CheckAssetAllocationInputs left for them, and a warm balance of an allocation no block moves
+    const CTransactionRef tx1 = send(0, "a", "b", 30);
+    const CTransactionRef tx2 = send(1, "a", "c", 50);
+    const CTransactionRef tx3 = send(2, "d", "b", 5);
+    {
+        TestMemPoolEntryHelper entry;
+        LOCK2(cs_main, mempool.cs);
+        int64_t nArrivalTime = 1500000000000;
+        for (const CTransactionRef& tx : {tx1, tx2, tx3}) {
+            mempool.addUnchecked(tx->GetHash(), entry.Fee(CENT).Time(GetTime()).SpendsCoinbase(true).FromTx(tx));
+            arrivalTimesMap[CAssetAllocation(*tx).assetAllocationTuple.ToString()][tx->GetHash()] = nArrivalTime++;
+            AddAssetAllocationMempoolSend(*tx);
+        }
+        mempoolMapAssetBalances = AssetBalanceMap{{strA, 20}, {strB, 35}, {strC, 50}, {strD, 95}, {strF, 7}};
+    }
+
+    // A block mining tx1: a and b are derived again from the db with tx2 and tx3 on top, the rest is left alone
+    const SyscoinBestBlock block1(101, InsecureRand256());
+    const SyscoinBestBlock block2(101, InsecureRand256());
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(passetallocationdb->FlushBlock(AssetAllocationMap{{strA, allocation("a", 70)}, {strB, allocation("b", 30)}}, block1, chainActive.Tip()->GetBlockHash()));
+        mempool.removeForBlock({tx1}, 101);
+        UpdateMempoolAssetBalancesForBlock({tx1});
+        BOOST_CHECK_EQUAL(balance(strA), 20);
+        BOOST_CHECK_EQUAL(balance(strB), 35);
+        BOOST_CHECK_EQUAL(balance(strC), 50);
+        BOOST_CHECK_EQUAL(balance(strD), 95);
+        BOOST_CHECK_EQUAL(balance(strF), 7);
+        // the index let go of the mined send
+        BOOST_CHECK(!mempoolMapAssetAllocationSends[strA].count(tx1->GetHash()));
+
+        // Disconnected again, tx1 waits for the end of the reorg outside the mempool
+        BOOST_CHECK(passetallocationdb->UndoBlock(block1));
+        UpdateMempoolAssetBalancesForBlock({tx1});
+        BOOST_CHECK_EQUAL(balance(strA), 50);
+        BOOST_CHECK_EQUAL(balance(strB), 5);
+        BOOST_CHECK_EQUAL(balance(strC), 50);
+        BOOST_CHECK_EQUAL(balance(strF), 7);
+
+        // A block with a send that was never pending leaves too little for tx2, which is skipped, and
+        // gives no entry to a receiver with nothing pending
+        const CTransactionRef tx4 = send(3, "a", "e", 60);
+        BOOST_CHECK(passetallocationdb->FlushBlock(AssetAllocationMap{{strA, allocation("a", 40)}, {strE, allocation("e", 60)}}, block2, chainActive.Tip()->GetBlockHash()));
+        UpdateMempoolAssetBalancesForBlock({tx4});
+        BOOST_CHECK_EQUAL(balance(strA), 40);
+        BOOST_CHECK_EQUAL(balance(strC), 50);
+        BOOST_CHECK_EQUAL(balance(strE), -1);
+
+        BOOST_CHECK(passetallocationdb->UndoBlock(block2));
+        UpdateMempoolAssetBalancesForBlock({tx4});
+        BOOST_CHECK_EQUAL(balance(strA), 50);
+        BOOST_CHECK_EQUAL(balance(strE), -1);
+    }
+    ClearMempoolAndZDAGState();
+    passetallocationdb.reset();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
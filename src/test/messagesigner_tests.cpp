@@ -0,0 +1,72 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <messagesigner.h>
+
+#include <hash.h>
+#include <key.h>
+#include <uint256.h>
+#include <test/test_syscoin.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+// TestingSetup starts the message signature check threads
+BOOST_FIXTURE_TEST_SUITE(messagesigner_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(verifyhash_cached)
+{
+    CKey key, keyOther;
+    key.MakeNewKey(true);
+    keyOther.MakeNewKey(true);
+    const uint256 hash = Hash(key.GetPubKey().begin(), key.GetPubKey().end());
+
+    std::vector<unsigned char> vchSig;
+    BOOST_CHECK(CHashSigner::SignHash(hash, key, vchSig));
+
+    std::string strError;
+    // the second call is answered from the signature cache and must agree
+    BOOST_CHECK(CHashSigner::VerifyHash(hash, key.GetPubKey(), vchSig, strError));
+    BOOST_CHECK(CHashSigner::VerifyHash(hash, key.GetPubKey(), vchSig, strError));
+    // a cached valid signature must not validate for another key or hash
+    BOOST_CHECK(!CHashSigner::VerifyHash(hash, keyOther.GetPubKey(), vchSig, strError));
+    BOOST_CHECK(!CHashSigner::VerifyHash(uint256S("01"), key.GetPubKey(), vchSig, strError));
+
+    std::vector<unsigned char> vchSigBad(vchSig);
+    vchSigBad[10] ^= 0x01;
+    BOOST_CHECK(!CHashSigner::VerifyHash(hash, key.GetPubKey(), vchSigBad, strError));
+    BOOST_CHECK(!CHashSigner::VerifyHash(hash, key.GetPubKey(), vchSigBad, strError));
+}
+
+BOOST_AUTO_TEST_CASE(preverify_batch)
+{
+    std::vector<CKey> vKeys(20);
+    std::vector<uint256> vHashes;
+    std::vector<std::vector<unsigned char> > vSigs;
+    std::vector<CHashSignerCheck> vChecks;
+    for (size_t i = 0; i < vKeys.size(); i++) {
+        vKeys[i].MakeNewKey(true);
+        vHashes.push_back(Hash(vKeys[i].begin(), vKeys[i].end()));
+        std::vector<unsigned char> vchSig;
+        BOOST_CHECK(CHashSigner::SignHash(vHashes[i], vKeys[i], vchSig));
+        // corrupt every third signature
+        if (i % 3 == 0)
+            vchSig[5] ^= 0x80;
+        vSigs.push_back(vchSig);
+        vChecks.emplace_back(vHashes[i], vKeys[i].GetPubKey().GetID(), vchSig);
+    }
+
+    CHashSigner::PreVerifyHashes(vChecks);
+    BOOST_CHECK(vChecks.empty());
+
+    // results after pre-verification match the signatures' validity
+    std::string strError;
+    for (size_t i = 0; i < vKeys.size(); i++) {
+        BOOST_CHECK_EQUAL(CHashSigner::VerifyHash(vHashes[i], vKeys[i].GetPubKey(), vSigs[i], strError), i % 3 != 0);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -227,4 +227,83 @@ BOOST_AUTO_TEST_CASE(ipv4_peer_with_ipv6_addrMe_test)
     BOOST_CHECK(1);
 }
 
+// SYSCOIN
+BOOST_AUTO_TEST_CASE(netmsg_buffer_pool)
+{
+    CNetMessageBufferPool pool;
+    // Buffers are rounded up to their size class and come back from it empty
+    CSerializeData buffer = pool.Get(1000);
+    BOOST_CHECK(buffer.empty());
+    BOOST_CHECK_EQUAL(buffer.capacity(), 1024U);
+    buffer.resize(1000);
+    const char* pchBuffer = buffer.data();
+    pool.Put(buffer);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 0U);
+    BOOST_CHECK_EQUAL(pool.size(), 1U);
+    BOOST_CHECK(pool.Get(100).data() != pchBuffer);
+    CSerializeData reused = pool.Get(600);
+    BOOST_CHECK(reused.data() == pchBuffer);
+    BOOST_CHECK(reused.empty());
+    BOOST_CHECK_EQUAL(pool.size(), 0U);
+
+    // Buffers too small or too large for any class are not kept
+    BOOST_CHECK_EQUAL(pool.Get(1 << 20).capacity(), 0U);
+    CSerializeData small(10);
+    pool.Put(small);
+    CSerializeData large(1 << 20);
+    pool.Put(large);
+    BOOST_CHECK_EQUAL(pool.size(), 0U);
+
+    // Each class keeps a bounded number of bytes
+    for (int i = 0; i < 10; i++) {
+        CSerializeData buffer256k = pool.Get(256 * 1024);
+        pool.Put(buffer256k);
+        CSerializeData extra(256 * 1024);
+        pool.Put(extra);
+    }
+    BOOST_CHECK_EQUAL(pool.size(), 2U);
+}
+
+BOOST_AUTO_TEST_CASE(cnetmessage_direct_receive)
+{
+    CSerializedNetMsg serialized;
+    serialized.command = NetMsgType::BLOCK;
+    serialized.data.resize(300 * 1000);
+    for (size_t i = 0; i < serialized.data.size(); i++)
+        serialized.data[i] = InsecureRandBits(8);
+    const CSharedNetMsgRef msg = MakeSharedNetMsg(std::move(serialized));
+    BOOST_CHECK_EQUAL(msg->header.size(), CMessageHeader::HEADER_SIZE);
+    BOOST_CHECK_EQUAL(msg->size(), CMessageHeader::HEADER_SIZE + 300 * 1000);
+
+    // Copying the payload in pieces and receiving it straight into the message give the same result
+    CNetMessage copied(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION);
+    CNetMessage direct(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION);
+    const char* pchHeader = reinterpret_cast<const char*>(msg->header.data());
+    BOOST_CHECK_EQUAL(copied.readHeader(pchHeader, msg->header.size()), (int)msg->header.size());
+    BOOST_CHECK_EQUAL(direct.readHeader(pchHeader, msg->header.size()), (int)msg->header.size());
+    BOOST_CHECK(copied.in_data && direct.in_data);
+
+    const char* pchData = reinterpret_cast<const char*>(msg->data.data());
+    size_t nPos = 0;
+    while (!copied.complete()) {
+        int nBytes = copied.readData(pchData + nPos, std::min<size_t>(1000, msg->data.size() - nPos));
+        BOOST_CHECK(nBytes > 0);
+        nPos += nBytes;
+    }
+    nPos = 0;
+    while (!direct.complete()) {
+        unsigned int nSpace;
+        char* pchSpace = direct.getDataSpace(nSpace);
+        BOOST_CHECK(nSpace > 0 && nSpace <= 256 * 1024);
+        const unsigned int nBytes = std::min<unsigned int>(nSpace, 70000);
+        memcpy(pchSpace, pchData + nPos, nBytes);
+        direct.dataWritten(nBytes);
+        nPos += nBytes;
+    }
+    BOOST_CHECK(copied.vRecv.size() == msg->data.size() && std::equal(copied.vRecv.begin(), copied.vRecv.end(), pchData));
+    BOOST_CHECK(direct.vRecv.size() == msg->data.size() && std::equal(direct.vRecv.begin(), direct.vRecv.end(), pchData));
+    BOOST_CHECK(copied.GetMessageHash() == direct.GetMessageHash());
+    BOOST_CHECK(memcmp(direct.GetMessageHash().begin(), direct.hdr.pchChecksum, CMessageHeader::CHECKSUM_SIZE) == 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
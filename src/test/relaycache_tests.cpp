@@ -0,0 +1,93 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <relaycache.h>
+
+#include <protocol.h>
+#include <test/test_syscoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(relaycache_tests, BasicTestingSetup)
+
+static CSharedNetMsgRef RandomMsg(const std::string& command, size_t nSize)
+{
+    CSerializedNetMsg msg;
+    msg.command = command;
+    msg.data.resize(nSize);
+    for (unsigned char& c : msg.data)
+        c = InsecureRandBits(8);
+    return MakeSharedNetMsg(std::move(msg));
+}
+
+BOOST_AUTO_TEST_CASE(relaycache_keys)
+{
+    CRelayCache cache(1 << 20);
+    const uint256 hash = InsecureRand256();
+    const CSharedNetMsgRef block = RandomMsg(NetMsgType::BLOCK, 1000);
+    const CSharedNetMsgRef blockNoWitness = RandomMsg(NetMsgType::BLOCK, 900);
+    BOOST_CHECK(!cache.Get(hash, NetMsgType::BLOCK, true));
+    cache.Put(hash, NetMsgType::BLOCK, true, block);
+    cache.Put(hash, NetMsgType::BLOCK, false, blockNoWitness);
+
+    // Hash, command and witness flag all tell entries apart
+    BOOST_CHECK(cache.Get(hash, NetMsgType::BLOCK, true) == block);
+    BOOST_CHECK(cache.Get(hash, NetMsgType::BLOCK, false) == blockNoWitness);
+    BOOST_CHECK(!cache.Get(hash, NetMsgType::TX, true));
+    BOOST_CHECK(!cache.Get(InsecureRand256(), NetMsgType::BLOCK, true));
+
+    // Putting a key again replaces its entry
+    const CSharedNetMsgRef replacement = RandomMsg(NetMsgType::BLOCK, 1000);
+    cache.Put(hash, NetMsgType::BLOCK, true, replacement);
+    BOOST_CHECK(cache.Get(hash, NetMsgType::BLOCK, true) == replacement);
+
+    CRelayCacheStats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.nEntries, 2U);
+    BOOST_CHECK(stats.nBytes >= replacement->size() + blockNoWitness->size());
+    BOOST_CHECK_EQUAL(stats.nHits, 3U);
+    BOOST_CHECK_EQUAL(stats.nMisses, 3U);
+
+    cache.Clear();
+    BOOST_CHECK(!cache.Get(hash, NetMsgType::BLOCK, true));
+    BOOST_CHECK_EQUAL(cache.GetStats().nBytes, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(relaycache_lru)
+{
+    CRelayCache cache(1 << 20);
+    std::vector<uint256> hashes{InsecureRand256()};
+    cache.Put(hashes.back(), NetMsgType::TX, true, RandomMsg(NetMsgType::TX, 1000));
+    // Room for exactly ten of these messages
+    const size_t nEntryBytes = cache.GetStats().nBytes;
+    cache.SetMaxBytes(10 * nEntryBytes);
+    for (int i = 1; i < 10; i++) {
+        hashes.push_back(InsecureRand256());
+        cache.Put(hashes.back(), NetMsgType::TX, true, RandomMsg(NetMsgType::TX, 1000));
+    }
+    BOOST_CHECK_EQUAL(cache.GetStats().nEntries, 10U);
+
+    // Using the oldest entry keeps it when the next one makes room
+    BOOST_CHECK(cache.Get(hashes[0], NetMsgType::TX, true));
+    cache.Put(InsecureRand256(), NetMsgType::TX, true, RandomMsg(NetMsgType::TX, 1000));
+    BOOST_CHECK(cache.Get(hashes[0], NetMsgType::TX, true));
+    BOOST_CHECK(!cache.Get(hashes[1], NetMsgType::TX, true));
+    BOOST_CHECK_EQUAL(cache.GetStats().nEntries, 10U);
+
+    // A message larger than the whole cache is not kept, and does not push the others out
+    const uint256 hashLarge = InsecureRand256();
+    cache.Put(hashLarge, NetMsgType::BLOCK, true, RandomMsg(NetMsgType::BLOCK, 20000));
+    BOOST_CHECK(!cache.Get(hashLarge, NetMsgType::BLOCK, true));
+    BOOST_CHECK_EQUAL(cache.GetStats().nEntries, 10U);
+
+    // Shrinking drops the least recently used entries
+    cache.SetMaxBytes(3 * nEntryBytes);
+    BOOST_CHECK_EQUAL(cache.GetStats().nEntries, 3U);
+    BOOST_CHECK(cache.Get(hashes[0], NetMsgType::TX, true));
+    BOOST_CHECK(cache.Get(hashes[9], NetMsgType::TX, true));
+    BOOST_CHECK(!cache.Get(hashes[8], NetMsgType::TX, true));
+    cache.SetMaxBytes(0);
+    BOOST_CHECK_EQUAL(cache.GetStats().nEntries, 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
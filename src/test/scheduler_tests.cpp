@@ -154,4 +154,38 @@ BOOST_AUTO_TEST_CASE(singlethreadedscheduler_ordered)
     BOOST_CHECK_EQUAL(counter2, 100);
 }
 
+BOOST_AUTO_TEST_CASE(scheduler_executor)
+{
+    // Tasks handed to an executor class that runs one at a time keep their order
+    CExecutor executor;
+    executor.SetClassLimits(TaskClass::BACKGROUND, 1, 0);
+    executor.Start(4);
+    CScheduler scheduler;
+    scheduler.SetExecutor(&executor, TaskClass::BACKGROUND);
+    SingleThreadedSchedulerClient queue(&scheduler);
+    boost::thread schedulerThread(boost::bind(&CScheduler::serviceQueue, &scheduler));
+
+    int counter = 0;
+    int counterDirect = 0;
+    const boost::chrono::system_clock::time_point now = boost::chrono::system_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        queue.AddToProcessQueue([i, &counter]() {
+            assert(i == counter++);
+        });
+        scheduler.schedule([i, &counterDirect]() {
+            assert(i == counterDirect++);
+        }, now + boost::chrono::microseconds(i));
+    }
+
+    scheduler.stop(true);
+    schedulerThread.join();
+    // The scheduler thread only handed the tasks on
+    executor.Stop();
+    queue.EmptyQueue();
+
+    BOOST_CHECK_EQUAL(counter, 100);
+    BOOST_CHECK_EQUAL(counterDirect, 100);
+    BOOST_CHECK(executor.GetStats(TaskClass::BACKGROUND).nExecuted >= 100U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
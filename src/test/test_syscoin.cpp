@@ -8,7 +8,10 @@
 #include <consensus/consensus.h>
 #include <consensus/params.h>
 #include <consensus/validation.h>
+#include <crypto/keccak.h>
 #include <crypto/sha256.h>
+#include <executor.h>
+#include <messagesigner.h>
 #include <miner.h>
 #include <net_processing.h>
 #include <noui.h>
@@ -49,12 +52,14 @@ BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
     : m_path_root(fs::temp_directory_path() / "test_syscoin" / strprintf("%lu_%i", (unsigned long)GetTime(), (int)(InsecureRandRange(1 << 30))))
 {
     SHA256AutoDetect();
+    KeccakAutoDetect();
     RandomInit();
     ECC_Start();
     SetupEnvironment();
     SetupNetworking();
     InitSignatureCache();
     InitScriptExecutionCache();
+    InitMessageSignatureCache();
     fCheckBlockIndex = true;
     // CreateAndProcessBlock() does not support building SegWit blocks, so don't activate in these tests.
     // TODO: fix the code to support SegWit blocks.
@@ -107,8 +112,11 @@ TestingSetup::TestingSetup(const std::string& chainName) : BasicTestingSetup(cha
             }
         }
         nScriptCheckThreads = 3;
-        for (int i=0; i < nScriptCheckThreads-1; i++)
-            threadGroup.create_thread(&ThreadScriptCheck);
+        // SYSCOIN
+        g_executor.Start(nScriptCheckThreads);
+        SetScriptCheckExecutor(&g_executor, nScriptCheckThreads - 1);
+        SetMessageSigCheckExecutor(&g_executor, nScriptCheckThreads - 1);
+        GetMainSignals().SetExecutor(&g_executor, TaskClass::NOTIFY);
         g_connman = MakeUnique<CConnman>(0x1337, 0x1337); // Deterministic randomness for tests.
         connman = g_connman.get();
         peerLogic.reset(new PeerLogicValidation(connman, scheduler, /*enable_bip61=*/true));
@@ -118,6 +126,10 @@ TestingSetup::~TestingSetup()
 {
     threadGroup.interrupt_all();
     threadGroup.join_all();
+    // SYSCOIN
+    g_executor.Stop();
+    SetScriptCheckExecutor(nullptr, 0);
+    SetMessageSigCheckExecutor(nullptr, 0);
     GetMainSignals().FlushBackgroundCallbacks();
     GetMainSignals().UnregisterBackgroundSignalScheduler();
     g_connman.reset();
@@ -0,0 +1,182 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <txoutsetscan.h>
+
+#include <coins.h>
+#include <script/standard.h>
+#include <test/test_syscoin.h>
+#include <txdb.h>
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(txoutsetscan_tests, BasicTestingSetup)
+
+static CScript RandomScript()
+{
+    // Mostly P2PKH, with some short non-standard scripts for the small-script fingerprint path
+    if (InsecureRandBits(3) == 0)
+        return CScript() << (int64_t)InsecureRandBits(16) << OP_DROP;
+    uint160 hash;
+    GetRandBytes(hash.begin(), hash.size());
+    return GetScriptForDestination(CKeyID(hash));
+}
+
+/** Write nCount coins with random outpoints to view, every nStride-th one paying to a script in needles. */
+static void AddCoins(CCoinsViewDB& view, int nCount, const std::vector<CScript>& needles, int nStride, std::map<COutPoint, Coin>& expected)
+{
+    CCoinsViewCache cache(&view);
+    for (int i = 0; i < nCount; i++) {
+        const COutPoint outpoint(InsecureRand256(), InsecureRandBits(2));
+        const CScript script = i % nStride == 0 ? needles[i / nStride % needles.size()] : RandomScript();
+        Coin coin(CTxOut(1 + InsecureRandRange(1000000), script), 1 + i, false);
+        if (i % nStride == 0)
+            expected.emplace(outpoint, coin);
+        cache.AddCoin(outpoint, std::move(coin), false);
+    }
+    cache.SetBestBlock(InsecureRand256());
+    BOOST_CHECK(cache.Flush());
+}
+
+static std::map<COutPoint, Coin> RunScan(CTxOutSetScan& scan)
+{
+    scan.Wait();
+    BOOST_CHECK(scan.Succeeded());
+    BOOST_CHECK_EQUAL(scan.Progress(), 100);
+    std::vector<std::pair<COutPoint, Coin>> results;
+    scan.FetchResults(results);
+    return std::map<COutPoint, Coin>(results.begin(), results.end());
+}
+
+static bool SameCoins(const std::map<COutPoint, Coin>& a, const std::map<COutPoint, Coin>& b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const std::pair<const COutPoint, Coin>& x, const std::pair<const COutPoint, Coin>& y) {
+        return x.first == y.first && x.second.out == y.second.out && x.second.nHeight == y.second.nHeight;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(txoutsetscan_needle_set)
+{
+    std::set<CScript> needles;
+    for (int i = 0; i < 1000; i++)
+        needles.insert(RandomScript());
+    needles.insert(CScript());
+    const CScriptNeedleSet set(needles);
+    BOOST_CHECK_EQUAL(set.size(), needles.size());
+    for (const CScript& script : needles)
+        BOOST_CHECK(set.Contains(script));
+    for (int i = 0; i < 10000; i++) {
+        const CScript script = RandomScript();
+        BOOST_CHECK_EQUAL(set.Contains(script), needles.count(script) > 0);
+    }
+    // Scripts that differ only outside the fingerprinted bytes are still told apart
+    CScript script = *needles.rbegin();
+    script[0] ^= 1;
+    BOOST_CHECK_EQUAL(set.Contains(script), needles.count(script) > 0);
+}
+
+BOOST_AUTO_TEST_CASE(txoutsetscan_threads)
+{
+    CCoinsViewDB view(1 << 20, true);
+    std::vector<CScript> needles;
+    for (int i = 0; i < 10; i++)
+        needles.push_back(RandomScript());
+    std::map<COutPoint, Coin> expected;
+    AddCoins(view, 5000, needles, 50, expected);
+    BOOST_CHECK_EQUAL(expected.size(), 100U);
+
+    const std::set<CScript> setNeedles(needles.begin(), needles.end());
+    for (unsigned int nThreads : {1, 3, 4, 16}) {
+        CTxOutSetScan scan(setNeedles, nThreads);
+        BOOST_CHECK_EQUAL(scan.Threads(), nThreads);
+        scan.Start(view);
+        BOOST_CHECK(SameCoins(RunScan(scan), expected));
+        BOOST_CHECK_EQUAL(scan.SearchedItems(), 5000);
+    }
+
+    // Nothing to find
+    CTxOutSetScan scan(std::set<CScript>(), 4);
+    scan.Start(view);
+    BOOST_CHECK(RunScan(scan).empty());
+    BOOST_CHECK_EQUAL(scan.SearchedItems(), 5000);
+}
+
+BOOST_AUTO_TEST_CASE(txoutsetscan_snapshot)
+{
+    CCoinsViewDB view(1 << 20, true);
+    std::vector<CScript> needles{RandomScript()};
+    std::map<COutPoint, Coin> expected;
+    AddCoins(view, 2000, needles, 10, expected);
+
+    CTxOutSetScan scan(std::set<CScript>(needles.begin(), needles.end()), 4);
+    scan.Start(view);
+    // Coins written while the scan runs, even for the same script, are not part of its snapshot
+    std::map<COutPoint, Coin> later;
+    AddCoins(view, 2000, needles, 10, later);
+    BOOST_CHECK(SameCoins(RunScan(scan), expected));
+    BOOST_CHECK_EQUAL(scan.SearchedItems(), 2000);
+
+    CTxOutSetScan rescan(std::set<CScript>(needles.begin(), needles.end()), 4);
+    rescan.Start(view);
+    expected.insert(later.begin(), later.end());
+    BOOST_CHECK(SameCoins(RunScan(rescan), expected));
+}
+
+BOOST_AUTO_TEST_CASE(txoutsetscan_fetch_and_abort)
+{
+    CCoinsViewDB view(1 << 20, true);
+    std::vector<CScript> needles{RandomScript(), RandomScript()};
+    std::map<COutPoint, Coin> expected;
+    AddCoins(view, 20000, needles, 7, expected);
+
+    // Results fetched piecemeal while the scan runs add up to the full set
+    std::shared_ptr<CTxOutSetScan> scan = std::make_shared<CTxOutSetScan>(std::set<CScript>(needles.begin(), needles.end()), 2);
+    scan->Start(view);
+    const uint64_t id = AddTxOutSetScan(scan);
+    BOOST_CHECK(id != 0);
+    BOOST_CHECK(GetTxOutSetScan(id) == scan);
+    std::vector<std::pair<COutPoint, Coin>> results;
+    bool fDone = false;
+    while (!fDone) {
+        fDone = scan->IsDone();
+        scan->FetchResults(results);
+    }
+    BOOST_CHECK(scan->Succeeded());
+    BOOST_CHECK(SameCoins(std::map<COutPoint, Coin>(results.begin(), results.end()), expected));
+    RemoveTxOutSetScan(id);
+    BOOST_CHECK(!GetTxOutSetScan(id));
+
+    // An aborted scan finishes without succeeding
+    CTxOutSetScan aborted(std::set<CScript>(needles.begin(), needles.end()), 2);
+    aborted.Abort();
+    aborted.Start(view);
+    aborted.Wait();
+    BOOST_CHECK(aborted.IsDone());
+    BOOST_CHECK(!aborted.Succeeded());
+    BOOST_CHECK(aborted.SearchedItems() < 20000);
+
+    // The registry holds a bounded number of scans and makes room by dropping finished ones
+    std::vector<std::shared_ptr<CTxOutSetScan>> vScans;
+    BOOST_CHECK(HaveRoomForTxOutSetScan());
+    for (unsigned int i = 0; i < MAX_TXOUTSET_SCANS; i++) {
+        vScans.push_back(std::make_shared<CTxOutSetScan>(std::set<CScript>(), 1));
+        vScans.back()->Start(view);
+        BOOST_CHECK(AddTxOutSetScan(vScans.back()) != 0);
+    }
+    BOOST_CHECK_EQUAL(GetTxOutSetScans().size(), MAX_TXOUTSET_SCANS);
+    vScans.front()->Wait();
+    BOOST_CHECK(HaveRoomForTxOutSetScan());
+    std::shared_ptr<CTxOutSetScan> extra = std::make_shared<CTxOutSetScan>(std::set<CScript>(), 1);
+    extra->Start(view);
+    BOOST_CHECK(AddTxOutSetScan(extra) != 0);
+    BOOST_CHECK_EQUAL(GetTxOutSetScans().size(), MAX_TXOUTSET_SCANS);
+    StopTxOutSetScans();
+    BOOST_CHECK(GetTxOutSetScans().empty());
+    for (const auto& s : vScans)
+        BOOST_CHECK(s->IsDone());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
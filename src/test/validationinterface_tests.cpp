@@ -0,0 +1,165 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <executor.h>
+#include <primitives/transaction.h>
+#include <scheduler.h>
+#include <utiltime.h>
+#include <validationinterface.h>
+
+#include <test/test_syscoin.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+/** Counts the transactions it is told of, waiting for a gate to open before each */
+class TxCounter : public CValidationInterface
+{
+public:
+    std::atomic<int> nTransactions{0};
+    std::shared_future<void> gate;
+    bool fSyncOnSubmit = false;
+    //! the order the transactions arrived in
+    std::vector<CTransactionRef> vReceived;
+
+    explicit TxCounter(std::shared_future<void> gateIn) : gate(gateIn) {}
+
+protected:
+    void TransactionAddedToMempool(const CTransactionRef& ptx) override
+    {
+        gate.wait();
+        vReceived.push_back(ptx);
+        nTransactions++;
+    }
+    bool SyncOnTransactionSubmit() const override { return fSyncOnSubmit; }
+};
+
+/** Runs the signals on their own scheduler and executor, as init does */
+struct ValidationInterfaceSetup : public BasicTestingSetup {
+    CScheduler scheduler;
+    CExecutor executor;
+    boost::thread schedulerThread;
+
+    ValidationInterfaceSetup()
+    {
+        executor.Start(4);
+        GetMainSignals().RegisterBackgroundSignalScheduler(scheduler);
+        GetMainSignals().SetExecutor(&executor, TaskClass::NOTIFY);
+        schedulerThread = boost::thread(boost::bind(&CScheduler::serviceQueue, &scheduler));
+    }
+
+    ~ValidationInterfaceSetup()
+    {
+        UnregisterAllValidationInterfaces();
+        scheduler.stop(false);
+        schedulerThread.join();
+        executor.Stop();
+        GetMainSignals().FlushBackgroundCallbacks();
+        GetMainSignals().UnregisterBackgroundSignalScheduler();
+    }
+};
+
+static CTransactionRef MakeTx(int n)
+{
+    CMutableTransaction mtx;
+    mtx.nLockTime = n;
+    return MakeTransactionRef(std::move(mtx));
+}
+
+BOOST_FIXTURE_TEST_SUITE(validationinterface_tests, ValidationInterfaceSetup)
+
+BOOST_AUTO_TEST_CASE(validationinterface_slow_subscriber)
+{
+    // A subscriber that does not get to its callbacks holds back no other
+    std::promise<void> slowGate;
+    std::promise<void> fastGate;
+    fastGate.set_value();
+    TxCounter slow(slowGate.get_future().share());
+    TxCounter fast(fastGate.get_future().share());
+    RegisterValidationInterface(&slow);
+    RegisterValidationInterface(&fast);
+
+    std::vector<CTransactionRef> vTx;
+    for (int i = 0; i < 100; i++) {
+        vTx.push_back(MakeTx(i));
+        GetMainSignals().TransactionAddedToMempool(vTx.back());
+    }
+    SyncWithValidationInterfaceQueue(&fast);
+    BOOST_CHECK_EQUAL(fast.nTransactions, 100);
+    BOOST_CHECK_EQUAL(slow.nTransactions, 0);
+    BOOST_CHECK(GetMainSignals().CallbacksPending() >= 99U);
+
+    // Only the lagging subscriber is waited for
+    SyncWithLaggingValidationInterfaceQueues(200);
+    std::atomic<bool> fSynced{false};
+    std::thread syncThread([&fSynced] {
+        SyncWithLaggingValidationInterfaceQueues(10);
+        fSynced = true;
+    });
+    MilliSleep(50);
+    BOOST_CHECK(!fSynced);
+    slowGate.set_value();
+    syncThread.join();
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK_EQUAL(slow.nTransactions, 100);
+    BOOST_CHECK(slow.vReceived == vTx);
+    BOOST_CHECK(fast.vReceived == vTx);
+
+    const std::vector<CValidationQueueStats> vStats = GetMainSignals().GetQueueStats();
+    BOOST_REQUIRE_EQUAL(vStats.size(), 2U);
+    BOOST_CHECK_EQUAL(vStats[0].strName, "TxCounter");
+    BOOST_CHECK_EQUAL(vStats[0].nPending, 0U);
+    BOOST_CHECK(vStats[0].nPeakPending >= 99U);
+    // Each ran the transactions and the functions waiting for it, of which the
+    // last one may not be counted yet when the wait for it is over
+    BOOST_CHECK(vStats[0].nExecuted >= 101U && vStats[0].nExecuted <= 102U);
+    BOOST_CHECK(vStats[0].nMaxWaitMicros >= 50000);
+    BOOST_CHECK(vStats[1].nExecuted >= 101U && vStats[1].nExecuted <= 102U);
+}
+
+BOOST_AUTO_TEST_CASE(validationinterface_submit)
+{
+    // Submitting a transaction waits for the subscribers that ask for it only
+    std::promise<void> slowGate;
+    std::promise<void> walletGate;
+    walletGate.set_value();
+    TxCounter slow(slowGate.get_future().share());
+    TxCounter wallet(walletGate.get_future().share());
+    wallet.fSyncOnSubmit = true;
+    RegisterValidationInterface(&slow);
+    RegisterValidationInterface(&wallet);
+
+    GetMainSignals().TransactionAddedToMempool(MakeTx(0));
+    std::promise<void> promise;
+    CallFunctionInSubmitValidationInterfaceQueues([&promise] {
+        promise.set_value();
+    });
+    promise.get_future().wait();
+    BOOST_CHECK_EQUAL(wallet.nTransactions, 1);
+    BOOST_CHECK_EQUAL(slow.nTransactions, 0);
+    // Let the slow subscriber start on its callback
+    while (GetMainSignals().GetQueueStats()[0].nPending > 0)
+        MilliSleep(1);
+
+    // An unregistered subscriber is no longer called, but what waits for it still runs
+    std::promise<void> unregistered;
+    CallFunctionInValidationInterfaceQueue([&unregistered] {
+        unregistered.set_value();
+    });
+    UnregisterValidationInterface(&slow);
+    GetMainSignals().TransactionAddedToMempool(MakeTx(1));
+    slowGate.set_value();
+    unregistered.get_future().wait();
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK_EQUAL(slow.nTransactions, 1);
+    BOOST_CHECK_EQUAL(wallet.nTransactions, 2);
+    BOOST_CHECK_EQUAL(GetMainSignals().GetQueueStats().size(), 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
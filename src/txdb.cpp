@@ -176,16 +176,32 @@ CCoinsViewCursor *CCoinsViewDB::Cursor() const
        that restriction.  */
     i->pcursor->Seek(DB_COIN);
     // Cache key of first record
-    if (i->pcursor->Valid()) {
-        CoinEntry entry(&i->keyTmp.second);
-        i->pcursor->GetKey(entry);
-        i->keyTmp.first = entry.key;
-    } else {
-        i->keyTmp.first = 0; // Make sure Valid() and GetKey() return false
-    }
+    i->CacheKey();
     return i;
 }
 
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsViewDB::ShardedCursors(unsigned int nShards) const
+{
+    assert(nShards >= 1 && nShards <= 256);
+    std::shared_ptr<const leveldb::Snapshot> snapshot = db.GetSnapshot();
+    // The best block the shards report must match the coins they iterate
+    uint256 hashBestBlock;
+    if (!db.Read(DB_BEST_BLOCK, hashBestBlock, snapshot))
+        hashBestBlock.SetNull();
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    for (unsigned int n = 0; n < nShards; n++) {
+        const unsigned int nBeginByte = 256 * n / nShards;
+        const unsigned int nEndByte = 256 * (n + 1) / nShards;
+        CCoinsViewDBCursor *i = new CCoinsViewDBCursor(db.NewIterator(snapshot), hashBestBlock, snapshot, nEndByte);
+        uint256 hashBegin;
+        *hashBegin.begin() = (unsigned char)nBeginByte;
+        i->pcursor->Seek(std::make_pair(DB_COIN, hashBegin));
+        i->CacheKey();
+        cursors.emplace_back(i);
+    }
+    return cursors;
+}
+
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const
 {
     // Return cached key
@@ -214,8 +230,13 @@ bool CCoinsViewDBCursor::Valid() const
 void CCoinsViewDBCursor::Next()
 {
     pcursor->Next();
+    CacheKey();
+}
+
+void CCoinsViewDBCursor::CacheKey()
+{
     CoinEntry entry(&keyTmp.second);
-    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
+    if (!pcursor->Valid() || !pcursor->GetKey(entry) || (nEndByte < 256 && *keyTmp.second.hash.begin() >= nEndByte)) {
         keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
     } else {
         keyTmp.first = entry.key;
@@ -37,6 +37,9 @@ static const int64_t nMaxBlockDBCache = 2;
 // Unlike for the UTXO database, for the txindex scenario the leveldb cache make
 // a meaningful difference: https://github.com/syscoin/syscoin/pull/8273#issuecomment-229601991
 static const int64_t nMaxTxIndexCache = 1024;
+// SYSCOIN
+//! Max memory allocated to address index DB specific cache, if -addressindex (MiB)
+static const int64_t nMaxAddressIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
 
@@ -55,6 +58,13 @@ public:
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
 
+    /**
+     * Split one consistent snapshot of the coins into nShards cursors over
+     * disjoint ranges of the first txid byte, so they can be read in parallel.
+     * Each cursor keeps the snapshot alive; all must be destroyed before this view.
+     */
+    std::vector<std::unique_ptr<CCoinsViewCursor>> ShardedCursors(unsigned int nShards) const;
+
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
@@ -76,8 +86,16 @@ public:
 private:
     CCoinsViewDBCursor(CDBIterator* pcursorIn, const uint256 &hashBlockIn):
         CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
+    CCoinsViewDBCursor(CDBIterator* pcursorIn, const uint256 &hashBlockIn, std::shared_ptr<const leveldb::Snapshot> snapshotIn, unsigned int nEndByteIn):
+        CCoinsViewCursor(hashBlockIn), snapshot(std::move(snapshotIn)), pcursor(pcursorIn), nEndByte(nEndByteIn) {}
+    void CacheKey();
+
+    //! Declared before pcursor so that the iterator is destroyed first
+    std::shared_ptr<const leveldb::Snapshot> snapshot;
     std::unique_ptr<CDBIterator> pcursor;
     std::pair<char, COutPoint> keyTmp;
+    //! Stop before the first coin whose txid starts with this byte (256: no limit)
+    unsigned int nEndByte = 256;
 
     friend class CCoinsViewDB;
 };
@@ -0,0 +1,225 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <txoutsetscan.h>
+
+#include <crypto/common.h>
+#include <hash.h>
+#include <random.h>
+#include <txdb.h>
+#include <util.h>
+
+#include <algorithm>
+#include <limits>
+
+CScriptNeedleSet::SaltedScriptHasher::SaltedScriptHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
+
+size_t CScriptNeedleSet::SaltedScriptHasher::operator()(const CScript& script) const
+{
+    return CSipHasher(k0, k1).Write(script.data(), script.size()).Finalize();
+}
+
+uint64_t CScriptNeedleSet::Fingerprint(const CScript& script)
+{
+    // Standard scripts end in a key hash followed by at most two opcodes, so
+    // eight bytes from there tell almost all scripts apart.
+    const size_t size = script.size();
+    uint64_t fp = size;
+    if (size >= 10) {
+        fp ^= ReadLE64(script.data() + size - 10);
+    } else {
+        for (size_t i = 0; i < size; i++)
+            fp = (fp << 8) ^ script[i];
+    }
+    return fp * 0x9E3779B97F4A7C15ULL;
+}
+
+CScriptNeedleSet::CScriptNeedleSet(const std::set<CScript>& needles) : setNeedles(needles.begin(), needles.end())
+{
+    // About 16 bits per needle keeps false positives near 1 in 16
+    unsigned int nBits = 16;
+    while (nBits < 30 && (uint64_t{1} << nBits) < 16 * needles.size())
+        nBits++;
+    nFilterShift = 64 - nBits;
+    vFilter.assign(size_t{1} << nBits, false);
+    for (const CScript& script : needles)
+        vFilter[Fingerprint(script) >> nFilterShift] = true;
+}
+
+bool CScriptNeedleSet::Contains(const CScript& script) const
+{
+    return vFilter[Fingerprint(script) >> nFilterShift] && setNeedles.count(script);
+}
+
+CTxOutSetScan::CTxOutSetScan(std::set<CScript> needlesIn, unsigned int nThreadsIn) :
+    needles(needlesIn), nThreads(std::max(1u, std::min(nThreadsIn, MAX_TXOUTSET_SCAN_THREADS))),
+    vShardProgress(new std::atomic<int>[nThreads])
+{
+    for (size_t i = 0; i < nThreads; i++)
+        vShardProgress[i] = 0;
+}
+
+CTxOutSetScan::~CTxOutSetScan()
+{
+    Abort();
+    for (auto& thread : vThreads)
+        thread.join();
+}
+
+void CTxOutSetScan::Start(const CCoinsViewDB& view)
+{
+    assert(vThreads.empty());
+    vCursors = view.ShardedCursors(nThreads);
+    nShardsRunning = vCursors.size();
+    for (size_t i = 0; i < vCursors.size(); i++)
+        vThreads.emplace_back(&CTxOutSetScan::ScanShard, this, i, vCursors[i].get());
+}
+
+void CTxOutSetScan::Wait()
+{
+    std::unique_lock<std::mutex> lock(cs);
+    condDone.wait(lock, [this] { return nShardsRunning == 0; });
+}
+
+int CTxOutSetScan::Progress() const
+{
+    int nTotal = 0;
+    for (size_t i = 0; i < nThreads; i++)
+        nTotal += vShardProgress[i];
+    return (nTotal + nThreads / 2) / nThreads;
+}
+
+void CTxOutSetScan::FetchResults(std::vector<std::pair<COutPoint, Coin>>& out)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    if (out.empty()) {
+        out.swap(vResults);
+    } else {
+        out.insert(out.end(), std::make_move_iterator(vResults.begin()), std::make_move_iterator(vResults.end()));
+        vResults.clear();
+    }
+}
+
+void CTxOutSetScan::ScanShard(size_t nShard, CCoinsViewCursor* cursor)
+{
+    RenameThread("syscoin-txoutscan");
+    // The shard covers txids whose first byte is in [nBegin, nEnd)
+    const uint32_t nBegin = 0x100 * (256 * nShard / nThreads);
+    const uint32_t nEnd = 0x100 * (256 * (nShard + 1) / nThreads);
+    std::vector<std::pair<COutPoint, Coin>> vFound;
+    int64_t nCount = 0;
+    try {
+        while (cursor->Valid()) {
+            COutPoint key;
+            Coin coin;
+            if (!cursor->GetKey(key) || !cursor->GetValue(coin)) {
+                fFailed = true;
+                break;
+            }
+            if (++nCount % 256 == 0) {
+                if (fAbort)
+                    break;
+                nSearched += 256;
+                const uint32_t high = 0x100 * *key.hash.begin() + *(key.hash.begin() + 1);
+                vShardProgress[nShard] = (int)((high - nBegin) * 100.0 / (nEnd - nBegin) + 0.5);
+                if (!vFound.empty()) {
+                    std::lock_guard<std::mutex> lock(cs);
+                    vResults.insert(vResults.end(), vFound.begin(), vFound.end());
+                    vFound.clear();
+                }
+            }
+            if (needles.Contains(coin.out.scriptPubKey)) {
+                vFound.emplace_back(key, std::move(coin));
+            }
+            cursor->Next();
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("%s: shard %u: %s\n", __func__, nShard, e.what());
+        fFailed = true;
+    }
+    nSearched += nCount % 256;
+    if (!fAbort && !fFailed)
+        vShardProgress[nShard] = 100;
+    // Let go of this shard's iterator, and with the last one the snapshot
+    vCursors[nShard].reset();
+    std::lock_guard<std::mutex> lock(cs);
+    vResults.insert(vResults.end(), vFound.begin(), vFound.end());
+    if (--nShardsRunning == 0)
+        condDone.notify_all();
+}
+
+namespace {
+std::mutex g_txoutset_scans_mutex;
+uint64_t g_txoutset_scan_next_id = 1;
+std::map<uint64_t, std::shared_ptr<CTxOutSetScan>> g_txoutset_scans;
+
+//! The oldest scan that has finished but was never fetched
+std::map<uint64_t, std::shared_ptr<CTxOutSetScan>>::iterator FindDoneTxOutSetScan()
+{
+    return std::find_if(g_txoutset_scans.begin(), g_txoutset_scans.end(),
+        [](const std::pair<const uint64_t, std::shared_ptr<CTxOutSetScan>>& entry) { return entry.second->IsDone(); });
+}
+}
+
+uint64_t AddTxOutSetScan(std::shared_ptr<CTxOutSetScan> scan)
+{
+    std::lock_guard<std::mutex> lock(g_txoutset_scans_mutex);
+    if (g_txoutset_scans.size() >= MAX_TXOUTSET_SCANS) {
+        // Make room by dropping the oldest scan that has finished but was never fetched
+        auto it = FindDoneTxOutSetScan();
+        if (it == g_txoutset_scans.end())
+            return 0;
+        g_txoutset_scans.erase(it);
+    }
+    const uint64_t id = g_txoutset_scan_next_id++;
+    g_txoutset_scans.emplace(id, std::move(scan));
+    return id;
+}
+
+bool HaveRoomForTxOutSetScan()
+{
+    std::lock_guard<std::mutex> lock(g_txoutset_scans_mutex);
+    return g_txoutset_scans.size() < MAX_TXOUTSET_SCANS || FindDoneTxOutSetScan() != g_txoutset_scans.end();
+}
+
+std::shared_ptr<CTxOutSetScan> GetTxOutSetScan(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(g_txoutset_scans_mutex);
+    auto it = g_txoutset_scans.find(id);
+    return it == g_txoutset_scans.end() ? nullptr : it->second;
+}
+
+void RemoveTxOutSetScan(uint64_t id)
+{
+    std::shared_ptr<CTxOutSetScan> scan;
+    {
+        std::lock_guard<std::mutex> lock(g_txoutset_scans_mutex);
+        auto it = g_txoutset_scans.find(id);
+        if (it == g_txoutset_scans.end())
+            return;
+        scan = std::move(it->second);
+        g_txoutset_scans.erase(it);
+    }
+    // Joining the scan's threads happens outside the lock
+    scan.reset();
+}
+
+std::map<uint64_t, std::shared_ptr<CTxOutSetScan>> GetTxOutSetScans()
+{
+    std::lock_guard<std::mutex> lock(g_txoutset_scans_mutex);
+    return g_txoutset_scans;
+}
+
+void StopTxOutSetScans()
+{
+    std::map<uint64_t, std::shared_ptr<CTxOutSetScan>> scans;
+    {
+        std::lock_guard<std::mutex> lock(g_txoutset_scans_mutex);
+        scans.swap(g_txoutset_scans);
+    }
+    for (const auto& entry : scans)
+        entry.second->Abort();
+    for (const auto& entry : scans)
+        entry.second->Wait();
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2018 The Syscoin Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef SYSCOIN_TXOUTSETSCAN_H
+#define SYSCOIN_TXOUTSETSCAN_H
+
+#include <coins.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+class CCoinsViewDB;
+
+/** Maximum number of scans that may run or hold unfetched results at once */
+static const unsigned int MAX_TXOUTSET_SCANS = 8;
+/** Maximum number of threads a single scan shards the UTXO set across */
+static const unsigned int MAX_TXOUTSET_SCAN_THREADS = 16;
+
+/**
+ * A set of scriptPubKeys to look for. Every coin's script is first checked
+ * against a bitmap of cheap script fingerprints, so that the vast majority of
+ * coins are rejected without hashing or comparing the full script.
+ */
+class CScriptNeedleSet
+{
+public:
+    explicit CScriptNeedleSet(const std::set<CScript>& needles);
+
+    bool Contains(const CScript& script) const;
+    size_t size() const { return setNeedles.size(); }
+
+private:
+    class SaltedScriptHasher
+    {
+        const uint64_t k0, k1;
+    public:
+        SaltedScriptHasher();
+        size_t operator()(const CScript& script) const;
+    };
+
+    static uint64_t Fingerprint(const CScript& script);
+
+    std::vector<bool> vFilter;
+    unsigned int nFilterShift;
+    std::unordered_set<CScript, SaltedScriptHasher> setNeedles;
+};
+
+/**
+ * A scan of one consistent snapshot of the UTXO set for a set of scripts.
+ * The snapshot is split by txid range into one shard per thread. Matches are
+ * buffered as they are found and can be fetched while the scan runs.
+ */
+class CTxOutSetScan
+{
+public:
+    CTxOutSetScan(std::set<CScript> needles, unsigned int nThreadsIn);
+    ~CTxOutSetScan();
+
+    /** Take a snapshot of view and start scanning it in the background. */
+    void Start(const CCoinsViewDB& view);
+    /** Ask the scan to stop early. It still has to be waited for. */
+    void Abort() { fAbort = true; }
+    /** Block until every shard has finished. */
+    void Wait();
+
+    bool IsDone() const { return nShardsRunning == 0; }
+    /** True if the whole snapshot was scanned without being aborted or hitting a read error */
+    bool Succeeded() const { return IsDone() && !fAbort && !fFailed; }
+    /** Percentage of the snapshot scanned so far */
+    int Progress() const;
+    int64_t SearchedItems() const { return nSearched; }
+    size_t Threads() const { return nThreads; }
+
+    /** Move the matches found since the last call into out, in no particular order. */
+    void FetchResults(std::vector<std::pair<COutPoint, Coin>>& out);
+
+private:
+    void ScanShard(size_t nShard, CCoinsViewCursor* cursor);
+
+    const CScriptNeedleSet needles;
+    const unsigned int nThreads;
+    std::vector<std::unique_ptr<CCoinsViewCursor>> vCursors;
+    std::vector<std::thread> vThreads;
+    std::unique_ptr<std::atomic<int>[]> vShardProgress;
+
+    std::atomic<bool> fAbort{false};
+    std::atomic<bool> fFailed{false};
+    std::atomic<unsigned int> nShardsRunning{0};
+    std::atomic<int64_t> nSearched{0};
+
+    std::mutex cs;
+    std::condition_variable condDone;
+    std::vector<std::pair<COutPoint, Coin>> vResults;
+};
+
+/** Register a started scan and return its id, or 0 if MAX_TXOUTSET_SCANS are already held. */
+uint64_t AddTxOutSetScan(std::shared_ptr<CTxOutSetScan> scan);
+/** True if AddTxOutSetScan would currently find room, to be asked before a scan is started */
+bool HaveRoomForTxOutSetScan();
+std::shared_ptr<CTxOutSetScan> GetTxOutSetScan(uint64_t id);
+void RemoveTxOutSetScan(uint64_t id);
+/** All registered scans, oldest first */
+std::map<uint64_t, std::shared_ptr<CTxOutSetScan>> GetTxOutSetScans();
+/** Abort and wait for all scans, e.g. before the coins database is closed. */
+void StopTxOutSetScans();
+
+#endif // SYSCOIN_TXOUTSETSCAN_H
@@ -80,7 +80,8 @@
 //Syscoin only features
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
-#include <keccak256.h>
+#include <crypto/keccak.h>
+#include <support/cleanse.h>
 bool fMasternodeMode = false;
 bool fUnitTest = false;
 bool fTPSTest = false;
@@ -335,13 +336,11 @@ bool ethers_decodeTransaction(Transaction* transaction, uint8_t * data, uint16_t
 
 void ethers_keccak256(const uint8_t *data, uint16_t length, uint8_t *result) {
 
-    SHA3_CTX context;
-    keccak_init(&context);
-    keccak_update(&context, (const unsigned char*)data, (size_t)length);
-    keccak_final(&context, (unsigned char*)result);
+    CKeccak256 hasher;
+    hasher.Write(data, length).Finalize(result);
 
     // Clear out the contents of what we hashed (in case it was secret)
-    memset((char*)&context, 0, sizeof(SHA3_CTX));
+    memory_cleanse(&hasher, sizeof(hasher));
 }
 
 
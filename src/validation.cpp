@@ -16,6 +16,7 @@
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
 #include <cuckoocache.h>
+#include <executor.h>
 #include <hash.h>
 #include <index/txindex.h>
 #include <policy/fees.h>
@@ -53,7 +54,6 @@
 #include <services/asset.h>
 #include <services/assetallocation.h>
 #include <services/graph.h>
-#include <thread_pool/thread_pool.hpp>
 std::vector<std::pair<uint256, int64_t> > vecTPSTestReceivedTimesMempool;
 int64_t nTPSTestingStartTime = 0;
 double nTPSTestingSendRawEndTime = 0;
@@ -61,9 +61,7 @@ int64_t nTPSTestingSendRawStartTime = 0;
 std::vector<JSONRPCRequest> vecTPSRawTransactions;
 int64_t nLastMultithreadMempoolFailure = 0;
 bool fLogThreadpool = false;
-tp::ThreadPool *threadpool = NULL;
 std::vector<CInv> vInvToSend;
-extern AssetBalanceMap mempoolMapAssetBalances;
 // track worker thread metrics
 static int totalWorkerCount = 0;
 static int totalExecutionCount = 0;
@@ -202,7 +200,7 @@ public:
     bool AcceptBlock(const std::shared_ptr<const CBlock>& pblock, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, bool fRequested, const CDiskBlockPos* dbp, bool* fNewBlock) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     // Block (dis)connection on a given view:
-    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view);
+    DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, bool fDisconnectSyscoin = true);
     bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
                     CCoinsViewCache& view, const CChainParams& chainparams, bool fJustCheck = false);
 
@@ -215,6 +213,7 @@ public:
     void ResetBlockFailureFlags(CBlockIndex* pindex) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     bool ReplayBlocks(const CChainParams& params, CCoinsView* view);
+    bool ReplaySyscoinBlocks(const CChainParams& params, CCoinsView* view);
     bool RewindBlockIndex(const CChainParams& params);
     bool LoadGenesisBlock(const CChainParams& chainparams);
 
@@ -502,7 +501,7 @@ static void LimitMempoolSize(CTxMemPool& pool, size_t limit, unsigned long age)
     for (const COutPoint& removed : vNoSpendsRemaining)
         pcoinsTip->Uncache(removed);
 }
-bool DisconnectSyscoinTransaction(const CTransaction& tx, const CBlockIndex* pindex, CCoinsViewCache& view)
+bool DisconnectSyscoinTransaction(const CTransaction& tx, const CBlockIndex* pindex, CCoinsViewCache& view, bool fAssetDBs)
 {
     if(tx.IsCoinBase() || !passetdb || !passetallocationdb)
         return true;
@@ -521,6 +520,9 @@ bool DisconnectSyscoinTransaction(const CTransaction& tx, const CBlockIndex* pin
     }
     else if (tx.nVersion != SYSCOIN_TX_VERSION_ASSET)
         return true;
+    // the asset databases were already rolled back as a whole, or are not at this block
+    if (!fAssetDBs)
+        return true;
 
     AssetAllocationMap mapAssetAllocations;
     AssetMap mapAssets; 
@@ -781,13 +783,11 @@ bool CheckSyscoinInputs(const CTransaction& tx, CValidationState& state, const C
         }
 
         if(!bSanity && !fJustCheck){
-            if(!bMiner && (!passetallocationdb->Flush(mapAssetAllocations) || !passetdb->Flush(mapLastAssets, mapAssets))){
-                good = false;
-                LogPrint(BCLog::SYS, "Error flushing to asset dbs\n");
+            if(!bMiner && !FlushSyscoinBlock(mapAssetAllocations, mapLastAssets, mapAssets, nHeight, block.GetHash(), block.hashPrevBlock)){
+                return state.Error("Error flushing to asset dbs");
             }
             mapAssetAllocations.clear();
             blockMapAssetBalances.clear();
-            mempoolMapAssetBalances.clear();
         }        
         if (bSanity && (!good || !errorMessage.empty()))
             return state.DoS(100, false, REJECT_INVALID, errorMessage);
@@ -906,13 +906,12 @@ static CuckooCache::cache<uint256, SignatureCacheHasher> scriptExecutionCache;
 static uint256 scriptExecutionCacheNonce(GetRandHash());
 static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
 
-void ThreadScriptCheck() {
-    RenameThread("syscoin-scriptch");
-    scriptcheckqueue.Thread();
+void SetScriptCheckExecutor(CExecutor* executor, int nHelpers) {
+    scriptcheckqueue.SetExecutor(executor, TaskClass::BLOCK, nHelpers);
 }
 static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool& pool, CValidationState& state, const CTransactionRef& ptx,
                               bool* pfMissingInputs, int64_t nAcceptTime, std::list<CTransactionRef>* plTxnReplaced,
-                              bool bypass_limits, const CAmount& nAbsurdFee, std::vector<COutPoint>& coins_to_uncache, bool test_accept,bool bMultiThreaded)
+                              bool bypass_limits, const CAmount& nAbsurdFee, std::vector<COutPoint>& coins_to_uncache, bool test_accept,bool bMultiThreaded, bool bSkipSyscoinInputs)
 {
     const CTransaction& tx = *ptx;
     const uint256 hash = tx.GetHash();
@@ -1277,7 +1276,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
             control.Add(vChecks);   
             if (!control.Wait())
                 return false;
-            if (!CheckSyscoinInputs(tx, state, view, true, chainActive.Height(), CBlock())) {
+            if (!bSkipSyscoinInputs && !CheckSyscoinInputs(tx, state, view, true, chainActive.Height(), CBlock())) {
                 return false;
             }
         }            
@@ -1311,11 +1310,11 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                 return state.DoS(0, false, REJECT_INSUFFICIENTFEE, "mempool full");
         }
         
-        if (bMultiThreaded && threadpool != NULL)
+        if (bMultiThreaded && g_executor.IsRunning())
         {
             const CTransaction &txIn = *ptx;
             // define a task for the worker to process
-            std::packaged_task<void()> task([&pool, chainparams, txIn, hash, coins_to_uncache, hashCacheEntry, vChecksConcurrent]() {
+            auto task = [&pool, chainparams, txIn, hash, coins_to_uncache, hashCacheEntry, vChecksConcurrent, bSkipSyscoinInputs]() {
                 // metrics
                 int64_t time;
                 if (fLogThreadpool) {
@@ -1366,7 +1365,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                     }
                     {
                          
-                        if (!CheckSyscoinInputs(txIn, validationState, coinsViewCache, true, chainActive.Height(), CBlock()))
+                        if (!bSkipSyscoinInputs && !CheckSyscoinInputs(txIn, validationState, coinsViewCache, true, chainActive.Height(), CBlock()))
                         {
                             nLastMultithreadMempoolFailure = GetTime();
                             LOCK2(cs_main, mempool.cs);
@@ -1409,7 +1408,7 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
                     // indicate that this thread is done
                     concurrentExecutionCount -= 1;
                 }
-            });
+            };
             if(fLogThreadpool)
                 totalExecutionCount ++;
             // every 100th transaction or when not in unit test mode
@@ -1426,8 +1425,8 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
             bool isThreadPosted = false;
             for (int numTries = 1; numTries <= 50; numTries++)
             {
-                // send task to threadpool pointer from init.cpp
-                isThreadPosted = threadpool->tryPost(task);
+                // send task to the shared executor started in init.cpp
+                isThreadPosted = g_executor.TrySubmit(TaskClass::MEMPOOL, task);
                 if (isThreadPosted)
                 {
                     totalWorkerCount += 1;
@@ -1452,10 +1451,10 @@ static bool AcceptToMemoryPoolWorker(const CChainParams& chainparams, CTxMemPool
 /** (try to) add transaction to memory pool with a specified acceptance time **/
 static bool AcceptToMemoryPoolWithTime(const CChainParams& chainparams, CTxMemPool& pool, CValidationState &state, const CTransactionRef &tx,
                         bool* pfMissingInputs, int64_t nAcceptTime, std::list<CTransactionRef>* plTxnReplaced,
-                        bool bypass_limits, const CAmount nAbsurdFee, bool test_accept,bool bMultiThreaded)
+                        bool bypass_limits, const CAmount nAbsurdFee, bool test_accept,bool bMultiThreaded, bool bSkipSyscoinInputs=false)
 {
     std::vector<COutPoint> coins_to_uncache;
-    bool res = AcceptToMemoryPoolWorker(chainparams, pool, state, tx, pfMissingInputs, nAcceptTime, plTxnReplaced, bypass_limits, nAbsurdFee, coins_to_uncache, test_accept,bMultiThreaded);
+    bool res = AcceptToMemoryPoolWorker(chainparams, pool, state, tx, pfMissingInputs, nAcceptTime, plTxnReplaced, bypass_limits, nAbsurdFee, coins_to_uncache, test_accept,bMultiThreaded, bSkipSyscoinInputs);
     if (!res) {
         for (const COutPoint& hashTx : coins_to_uncache)
             pcoinsTip->Uncache(hashTx);
@@ -2076,7 +2075,10 @@ bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint
     return true;
 }
 
-static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
+} // namespace
+
+// SYSCOIN
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
 {
     CDiskBlockPos pos = pindex->GetUndoPos();
     if (pos.IsNull()) {
@@ -2107,6 +2109,8 @@ static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
     return true;
 }
 
+namespace {
+
 /** Abort with a message */
 static bool AbortNode(const std::string& strMessage, const std::string& userMessage="")
 {
@@ -2162,8 +2166,9 @@ int ApplyTxInUndo(Coin&& undo, CCoinsViewCache& view, const COutPoint& out)
 }
 
 /** Undo the effects of this block (with given index) on the UTXO set represented by coins.
- *  When FAILED is returned, view is left in an indeterminate state. */
-DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view)
+ *  When FAILED is returned, view is left in an indeterminate state.
+ *  The asset databases are only touched if fDisconnectSyscoin is set. */
+DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockIndex* pindex, CCoinsViewCache& view, bool fDisconnectSyscoin)
 {
     bool fClean = true;
 
@@ -2212,7 +2217,10 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
             // At this point, all of txundo.vprevout should have been moved out.
         }
     }
-    // SYSCOIN
+    // SYSCOIN roll the asset databases back with the block's undo records, or tx by tx for blocks
+    // connected before those were kept. Databases that are not at this block are left alone.
+    const uint256 hashBlock = pindex->GetBlockHash();
+    const bool fAssetDBs = fDisconnectSyscoin && !UndoSyscoinBlock(pindex->nHeight, hashBlock) && SyscoinDBsAtBlock(hashBlock);
     CBlock sortedBlock;
     Graph graph;
     std::vector<vertex_descriptor> vertices;
@@ -2226,9 +2234,11 @@ DisconnectResult CChainState::DisconnectBlock(const CBlock& block, const CBlockI
     // undo transactions in reverse order
     for (int i = processBlock.vtx.size() - 1; i >= 0; i--) {
         const CTransaction &tx = *(processBlock.vtx[i]);
-        if(!DisconnectSyscoinTransaction(tx, pindex, view))
+        if(!DisconnectSyscoinTransaction(tx, pindex, view, fAssetDBs))
             fClean = false;
     }      
+    if (fAssetDBs && !WriteSyscoinBestBlock(pindex->nHeight - 1, pindex->pprev->GetBlockHash()))
+        fClean = false;
 
     // move best block pointer to prevout block
     view.SetBestBlock(pindex->pprev->GetBlockHash());
@@ -2660,6 +2670,9 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
         int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
         int64_t cacheSize = pcoinsTip->DynamicMemoryUsage();
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
+        // SYSCOIN block cache the asset databases have not filled is lent out the same way
+        if (passetdbblockcache)
+            nTotalSpace += passetdbblockcache->Capacity() - std::min(passetdbblockcache->Usage(), passetdbblockcache->Capacity());
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now (not in the middle of a block processing).
         bool fCacheLarge = mode == FlushStateMode::PERIODIC && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
         // The cache is over the limit, we have to write now.
@@ -2712,6 +2725,8 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             // Flush the chainstate (which may refer to block index entries).
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            // SYSCOIN asset undo records are kept for reorgs and for rolling back to the flushed chainstate on startup
+            PruneSyscoinUndo(chainActive[chainActive.Height() - (int)MIN_BLOCKS_TO_KEEP]);
             nLastFlush = nNow;
             full_flush_completed = true;
         }
@@ -2863,6 +2878,9 @@ bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& cha
         }
     }
 
+    // SYSCOIN disconnected transactions are re-accepted on top of these balances at the end of the reorg
+    UpdateMempoolAssetBalancesForBlock(block.vtx);
+
     chainActive.SetTip(pindexDelete->pprev);
 
     UpdateTip(pindexDelete->pprev, chainparams);
@@ -2978,6 +2996,8 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
         bool rv = ConnectBlock(blockConnecting, state, pindexNew, view, chainparams);
         GetMainSignals().BlockChecked(blockConnecting, state);
         if (!rv) {
+            // SYSCOIN the asset changes were written before the block failed further on
+            UndoSyscoinBlock(pindexNew->nHeight, pindexNew->GetBlockHash());
             if (state.IsInvalid())
                 InvalidBlockFound(pindexNew, state);
             return error("ConnectTip(): ConnectBlock %s failed", pindexNew->GetBlockHash().ToString());
@@ -2997,6 +3017,8 @@ bool CChainState::ConnectTip(CValidationState& state, const CChainParams& chainp
     // Remove conflicting transactions from the mempool.;
     mempool.removeForBlock(blockConnecting.vtx, pindexNew->nHeight);
     disconnectpool.removeForBlock(blockConnecting.vtx);
+    // SYSCOIN re-derive the ZDAG balances of the allocations this block moved against what is left in the mempool
+    UpdateMempoolAssetBalancesForBlock(blockConnecting.vtx);
     // Update chainActive & related variables.
     chainActive.SetTip(pindexNew);
     UpdateTip(pindexNew, chainparams);
@@ -3257,17 +3279,20 @@ bool CChainState::ActivateBestChain(CValidationState &state, const CChainParams&
     CBlockIndex *pindexMostWork = nullptr;
     CBlockIndex *pindexNewTip = nullptr;
     int nStopAtHeight = gArgs.GetArg("-stopatheight", DEFAULT_STOPATHEIGHT);
+    // SYSCOIN
+    const size_t nMaxNotifyQueue = std::max<int64_t>(gArgs.GetArg("-maxnotifyqueue", DEFAULT_MAX_NOTIFY_QUEUE), 0);
     do {
         boost::this_thread::interruption_point();
 
-        if (GetMainSignals().CallbacksPending() > 10) {
-            // Block until the validation queue drains. This should largely
+        if (GetMainSignals().CallbacksPending() > nMaxNotifyQueue) {
+            // Block until the lagging validation queues drain. This should largely
             // never happen in normal operation, however may happen during
             // reindex, causing memory blowup if we run too far ahead.
             // Note that if a validationinterface callback ends up calling
             // ActivateBestChain this may lead to a deadlock! We should
             // probably have a DEBUG_LOCKORDER test for this in the future.
-            SyncWithValidationInterfaceQueue();
+            // SYSCOIN Subscribers that keep up are not waited for.
+            SyncWithLaggingValidationInterfaceQueues(nMaxNotifyQueue);
         }
 
         {
@@ -4594,7 +4619,8 @@ bool CVerifyDB::VerifyDB(const CChainParams& chainparams, CCoinsView *coinsview,
         // check level 3: check for inconsistencies during memory-only disconnect of tip blocks
         if (nCheckLevel >= 3 && (coins.DynamicMemoryUsage() + pcoinsTip->DynamicMemoryUsage()) <= nCoinCacheUsage) {
             assert(coins.GetBestBlock() == pindex->GetBlockHash());
-            DisconnectResult res = g_chainstate.DisconnectBlock(block, pindex, coins);
+            // SYSCOIN the asset databases stay at the tip, reconnecting below leaves them as they are
+            DisconnectResult res = g_chainstate.DisconnectBlock(block, pindex, coins, false);
             if (res == DISCONNECT_FAILED) {
                 return error("VerifyDB(): *** irrecoverable inconsistency in block data at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
             }
@@ -4694,7 +4720,8 @@ bool CChainState::ReplayBlocks(const CChainParams& params, CCoinsView* view)
                 return error("RollbackBlock(): ReadBlockFromDisk() failed at %d, hash=%s", pindexOld->nHeight, pindexOld->GetBlockHash().ToString());
             }
             LogPrintf("Rolling back %s (%i)\n", pindexOld->GetBlockHash().ToString(), pindexOld->nHeight);
-            DisconnectResult res = DisconnectBlock(block, pindexOld, cache);
+            // SYSCOIN the asset databases were rolled back when the block was disconnected
+            DisconnectResult res = DisconnectBlock(block, pindexOld, cache, false);
             if (res == DISCONNECT_FAILED) {
                 return error("RollbackBlock(): DisconnectBlock failed at %d, hash=%s", pindexOld->nHeight, pindexOld->GetBlockHash().ToString());
             }
@@ -4724,6 +4751,87 @@ bool ReplayBlocks(const CChainParams& params, CCoinsView* view) {
     return g_chainstate.ReplayBlocks(params, view);
 }
 
+// SYSCOIN
+/** Undo blocks of an asset database until its best block is on the chain of pindexTip. */
+template <typename AssetDB>
+static bool RollbackSyscoinDB(AssetDB& db, const CBlockIndex* pindexTip, SyscoinBestBlock& bestBlock) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    while (true) {
+        // a block written to the asset database may not have made it into the block index on disk
+        const CBlockIndex* pindex = LookupBlockIndex(bestBlock.second);
+        if (pindex && pindexTip->GetAncestor(pindex->nHeight) == pindex)
+            return true;
+        LogPrintf("Rolling back asset changes of %s (%i)\n", bestBlock.second.ToString(), bestBlock.first);
+        if (!db.UndoBlock(bestBlock) || !db.ReadBestBlock(bestBlock))
+            return error("RollbackSyscoinDB(): no undo data for block %s", bestBlock.second.ToString());
+    }
+}
+
+bool CChainState::ReplaySyscoinBlocks(const CChainParams& params, CCoinsView* view)
+{
+    LOCK(cs_main);
+
+    if (!passetdb || !passetallocationdb)
+        return true;
+    const uint256 hashTip = view->GetBestBlock();
+    if (hashTip.IsNull())
+        return true;
+    const CBlockIndex* pindexTip = LookupBlockIndex(hashTip);
+    if (!pindexTip)
+        return error("ReplaySyscoinBlocks(): chainstate is at unknown block");
+
+    // Asset databases from before best blocks were kept are taken to be at the chainstate's
+    const SyscoinBestBlock tip(pindexTip->nHeight, hashTip);
+    SyscoinBestBlock assetBestBlock, assetAllocationBestBlock;
+    if ((!passetdb->ReadBestBlock(assetBestBlock) && !passetdb->WriteBestBlock(tip)) ||
+        (!passetallocationdb->ReadBestBlock(assetAllocationBestBlock) && !passetallocationdb->WriteBestBlock(tip)))
+        return error("ReplaySyscoinBlocks(): failed to write asset best block");
+    if (!passetdb->ReadBestBlock(assetBestBlock) || !passetallocationdb->ReadBestBlock(assetAllocationBestBlock))
+        return error("ReplaySyscoinBlocks(): failed to read asset best block");
+    if (assetBestBlock == tip && assetAllocationBestBlock == tip)
+        return true; // We're already in a consistent state.
+
+    // Asset changes are written as blocks connect, before the chainstate is flushed, so after a crash
+    // the asset databases are usually ahead of it. Undo their blocks back onto the chainstate's chain.
+    if (!RollbackSyscoinDB(*passetdb, pindexTip, assetBestBlock) || !RollbackSyscoinDB(*passetallocationdb, pindexTip, assetAllocationBestBlock))
+        return false;
+    // Both are now at or below the tip. If one is lower, e.g. after a crash during a reorg or between
+    // writing the two databases, bring the other and the chainstate down to it.
+    const CBlockIndex* pindexFork = pindexTip->GetAncestor(std::min(assetBestBlock.first, assetAllocationBestBlock.first));
+    const SyscoinBestBlock fork(pindexFork->nHeight, pindexFork->GetBlockHash());
+    while (assetBestBlock.first > fork.first) {
+        if (!passetdb->UndoBlock(assetBestBlock) || !passetdb->ReadBestBlock(assetBestBlock))
+            return error("ReplaySyscoinBlocks(): no asset undo data for block %s", assetBestBlock.second.ToString());
+    }
+    while (assetAllocationBestBlock.first > fork.first) {
+        if (!passetallocationdb->UndoBlock(assetAllocationBestBlock) || !passetallocationdb->ReadBestBlock(assetAllocationBestBlock))
+            return error("ReplaySyscoinBlocks(): no asset allocation undo data for block %s", assetAllocationBestBlock.second.ToString());
+    }
+    if (pindexFork == pindexTip)
+        return true;
+
+    uiInterface.ShowProgress(_("Replaying blocks..."), 0, false);
+    LogPrintf("Rolling back chainstate from %s (%i) to the asset databases at %s (%i)\n", hashTip.ToString(), pindexTip->nHeight, fork.second.ToString(), fork.first);
+    CCoinsViewCache cache(view);
+    for (const CBlockIndex* pindex = pindexTip; pindex != pindexFork; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, params.GetConsensus())) {
+            return error("ReplaySyscoinBlocks(): ReadBlockFromDisk() failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
+        }
+        if (DisconnectBlock(block, pindex, cache, false) == DISCONNECT_FAILED) {
+            return error("ReplaySyscoinBlocks(): DisconnectBlock failed at %d, hash=%s", pindex->nHeight, pindex->GetBlockHash().ToString());
+        }
+    }
+    cache.SetBestBlock(fork.second);
+    cache.Flush();
+    uiInterface.ShowProgress("", 100, false);
+    return true;
+}
+
+bool ReplaySyscoinBlocks(const CChainParams& params, CCoinsView* view) {
+    return g_chainstate.ReplaySyscoinBlocks(params, view);
+}
+
 bool CChainState::RewindBlockIndex(const CChainParams& params)
 {
     LOCK(cs_main);
@@ -5257,7 +5365,9 @@ int VersionBitsTipStateSinceHeight(const Consensus::Params& params, Consensus::D
     return VersionBitsStateSinceHeight(chainActive.Tip(), params, pos, versionbitscache);
 }
 
-static const uint64_t MEMPOOL_DUMP_VERSION = 1;
+// SYSCOIN version 2 adds the ZDAG state ahead of the transactions
+static const uint64_t MEMPOOL_DUMP_VERSION = 2;
+static const uint64_t MEMPOOL_DUMP_VERSION_NO_ZDAG = 1;
 
 bool LoadMempool(void)
 {
@@ -5275,13 +5385,37 @@ bool LoadMempool(void)
     int64_t failed = 0;
     int64_t already_there = 0;
     int64_t nNow = GetTime();
+    // SYSCOIN
+    bool fZDAGStateRestored = false;
+    std::vector<CTransactionRef> vecAssetTxsDropped;
 
     try {
         uint64_t version;
         file >> version;
-        if (version != MEMPOOL_DUMP_VERSION) {
+        if (version != MEMPOOL_DUMP_VERSION && version != MEMPOOL_DUMP_VERSION_NO_ZDAG) {
             return false;
         }
+        // SYSCOIN the ZDAG state is kept in its own blob so a state of another version can be skipped. If it
+        // was saved on the current tip it is restored as is and asset transactions are not checked against
+        // the asset db again, which would reset their arrival times and read every sender back from disk
+        if (version == MEMPOOL_DUMP_VERSION) {
+            std::vector<unsigned char> vchZDAGState;
+            file >> vchZDAGState;
+            try {
+                CDataStream ssZDAGState(vchZDAGState, SER_DISK, CLIENT_VERSION);
+                CAssetAllocationMempoolState zdagState;
+                ssZDAGState >> zdagState;
+                LOCK(cs_main);
+                if (zdagState.hashBlock == chainActive.Tip()->GetBlockHash()) {
+                    RestoreAssetAllocationMempoolState(zdagState);
+                    fZDAGStateRestored = true;
+                } else {
+                    LogPrintf("Mempool ZDAG state was saved on another tip, checking asset transactions again\n");
+                }
+            } catch (const std::exception& e) {
+                LogPrintf("Failed to deserialize mempool ZDAG state: %s. Checking asset transactions again\n", e.what());
+            }
+        }
         uint64_t num;
         file >> num;
         while (num--) {
@@ -5297,13 +5431,18 @@ bool LoadMempool(void)
                 mempool.PrioritiseTransaction(tx->GetHash(), amountdelta);
             }
             CValidationState state;
+            // SYSCOIN
+            // A restored asset tx is checked synchronously, as the async failure path would leave its restored ZDAG state behind
+            const bool bAssetTx = fZDAGStateRestored && tx->nVersion == SYSCOIN_TX_VERSION_ASSET;
             if (nTime + nExpiryTimeout > nNow) {
                 LOCK(cs_main);
                 AcceptToMemoryPoolWithTime(chainparams, mempool, state, tx, nullptr /* pfMissingInputs */, nTime,
                                            nullptr /* plTxnReplaced */, false /* bypass_limits */, 0 /* nAbsurdFee */,
-                                           false /* test_accept */, true /* bMultiThreaded */);
+                                           false /* test_accept */, !bAssetTx /* bMultiThreaded */, bAssetTx /* bSkipSyscoinInputs */);
                 if (state.IsValid()) {
                     ++count;
+                    if (bAssetTx)
+                        AddAssetAllocationMempoolSend(*tx);
                 } else {
                     // mempool may contain the transaction already, e.g. from
                     // wallet(s) having loaded it while we were processing
@@ -5313,10 +5452,14 @@ bool LoadMempool(void)
                         ++already_there;
                     } else {
                         ++failed;
+                        if (bAssetTx)
+                            vecAssetTxsDropped.push_back(tx);
                     }
                 }
             } else {
                 ++expired;
+                if (bAssetTx)
+                    vecAssetTxsDropped.push_back(tx);
             }
             if (ShutdownRequested())
                 return false;
@@ -5329,8 +5472,18 @@ bool LoadMempool(void)
         }
     } catch (const std::exception& e) {
         LogPrintf("Failed to deserialize mempool data on disk: %s. Continuing anyway.\n", e.what());
+        // SYSCOIN the rest of the restored ZDAG state belongs to transactions that were never read
+        if (fZDAGStateRestored) {
+            LOCK(cs_main);
+            PruneAssetAllocationMempoolState();
+        }
         return false;
     }
+    // SYSCOIN take out what the restored ZDAG state recorded for asset transactions that did not come back
+    if (!vecAssetTxsDropped.empty()) {
+        LOCK(cs_main);
+        RevertAssetAllocationMempoolState(vecAssetTxsDropped);
+    }
 
     LogPrintf("Imported mempool transactions from disk: %i succeeded, %i failed, %i expired, %i already there\n", count, failed, expired, already_there);
     return true;
@@ -5342,13 +5495,18 @@ bool DumpMempool(void)
 
     std::map<uint256, CAmount> mapDeltas;
     std::vector<TxMempoolInfo> vinfo;
+    // SYSCOIN
+    CAssetAllocationMempoolState zdagState;
 
     {
-        LOCK(mempool.cs);
+        LOCK2(cs_main, mempool.cs);
         for (const auto &i : mempool.mapDeltas) {
             mapDeltas[i.first] = i.second;
         }
         vinfo = mempool.infoAll();
+        if (chainActive.Tip())
+            zdagState.hashBlock = chainActive.Tip()->GetBlockHash();
+        GetAssetAllocationMempoolState(zdagState);
     }
 
     int64_t mid = GetTimeMicros();
@@ -5363,6 +5521,10 @@ bool DumpMempool(void)
 
         uint64_t version = MEMPOOL_DUMP_VERSION;
         file << version;
+        // SYSCOIN
+        CDataStream ssZDAGState(SER_DISK, CLIENT_VERSION);
+        ssZDAGState << zdagState;
+        file << std::vector<unsigned char>(ssZDAGState.begin(), ssZDAGState.end());
 
         file << (uint64_t)vinfo.size();
         for (const auto& i : vinfo) {
@@ -5,40 +5,228 @@
 
 #include <validationinterface.h>
 
+#include <executor.h>
 #include <primitives/block.h>
 #include <scheduler.h>
 #include <sync.h>
 #include <txmempool.h>
 #include <util.h>
+#include <utiltime.h>
 #include <validation.h>
 
 #include <list>
 #include <atomic>
 #include <future>
 
-#include <boost/signals2/signal.hpp>
+#include <boost/bind.hpp>
+#include <boost/core/demangle.hpp>
+
+// SYSCOIN
+/**
+ * The callbacks of one subscriber. They run in order and one at a time, each
+ * in a task of its own on the executor, or on the scheduler if there is no
+ * executor or it refuses the task. Tasks hold a reference to the queue, so it
+ * lives on until they ran even if its subscriber unregisters.
+ */
+class ValidationQueue : public std::enable_shared_from_this<ValidationQueue>
+{
+public:
+    //! nullptr for the queue of functions that wait for no subscriber
+    CValidationInterface* const m_interface;
+    const std::string m_name;
+    const bool m_sync_on_submit;
+
+    ValidationQueue(CValidationInterface* pinterface, const std::string& name, bool fSyncOnSubmit, CScheduler* pscheduler) :
+        m_interface(pinterface), m_name(name), m_sync_on_submit(fSyncOnSubmit), m_pscheduler(pscheduler) {}
+
+    void SetExecutor(CExecutor* pexecutor, TaskClass executorClass)
+    {
+        LOCK(m_cs);
+        m_pexecutor = pexecutor;
+        m_executor_class = executorClass;
+    }
+
+    /** Stop calling the subscriber. Functions queued to wait for it still run. */
+    void Disconnect() { m_connected = false; }
+    bool IsConnected() const { return m_connected; }
+
+    /** Queue a call of the subscriber, dropped if it unregisters before */
+    void AddCallback(std::function<void ()> func) { Add(std::move(func), true); }
+    /** Queue a function that runs once the callbacks queued before it ran */
+    void AddToProcessQueue(std::function<void ()> func) { Add(std::move(func), false); }
+
+    // Processes all remaining queue members on the calling thread, blocking until queue is empty
+    void EmptyQueue()
+    {
+        bool should_continue = true;
+        while (should_continue) {
+            ProcessQueue();
+            LOCK(m_cs);
+            should_continue = !m_pending.empty();
+        }
+    }
+
+    size_t CallbacksPending() const
+    {
+        LOCK(m_cs);
+        return m_pending.size();
+    }
+
+    CValidationQueueStats GetStats()
+    {
+        LOCK(m_cs);
+        CValidationQueueStats stats = m_stats;
+        stats.strName = m_name;
+        stats.nPending = m_pending.size();
+        return stats;
+    }
+
+private:
+    struct Callback {
+        std::function<void ()> func;
+        int64_t nTimeQueued;
+        bool fCallsSubscriber;
+    };
+
+    CScheduler* const m_pscheduler;
+    std::atomic<bool> m_connected{true};
+
+    mutable CCriticalSection m_cs;
+    CExecutor* m_pexecutor GUARDED_BY(m_cs) = nullptr;
+    TaskClass m_executor_class GUARDED_BY(m_cs) = TaskClass::NOTIFY;
+    std::list<Callback> m_pending GUARDED_BY(m_cs);
+    //! whether a task to run the next callback is waiting to start
+    bool m_scheduled GUARDED_BY(m_cs) = false;
+    bool m_running GUARDED_BY(m_cs) = false;
+    CValidationQueueStats m_stats GUARDED_BY(m_cs);
+
+    void Add(std::function<void ()> func, bool fCallsSubscriber)
+    {
+        {
+            LOCK(m_cs);
+            m_pending.push_back(Callback{std::move(func), GetTimeMicros(), fCallsSubscriber});
+            m_stats.nPeakPending = std::max(m_stats.nPeakPending, m_pending.size());
+        }
+        MaybeScheduleProcessQueue();
+    }
+
+    void MaybeScheduleProcessQueue()
+    {
+        CExecutor* pexecutor;
+        TaskClass executorClass;
+        {
+            LOCK(m_cs);
+            if (m_scheduled || m_running || m_pending.empty()) return;
+            m_scheduled = true;
+            pexecutor = m_pexecutor;
+            executorClass = m_executor_class;
+        }
+        std::shared_ptr<ValidationQueue> self = shared_from_this();
+        std::function<void ()> task = [self] { self->ProcessQueue(); };
+        if (pexecutor && pexecutor->TrySubmit(executorClass, task))
+            return;
+        m_pscheduler->schedule(std::move(task));
+    }
+
+    void ProcessQueue()
+    {
+        Callback callback;
+        {
+            LOCK(m_cs);
+            m_scheduled = false;
+            if (m_running || m_pending.empty()) return;
+            m_running = true;
+            callback = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+
+        // RAII the accounting of the callback and calling MaybeScheduleProcessQueue
+        // to ensure both happen safely even if callback() throws.
+        struct RAIICallbackRunning {
+            ValidationQueue* instance;
+            int64_t nTimeQueued;
+            int64_t nTimeStart;
+            RAIICallbackRunning(ValidationQueue* _instance, int64_t _nTimeQueued) : instance(_instance), nTimeQueued(_nTimeQueued), nTimeStart(GetTimeMicros()) {}
+            ~RAIICallbackRunning() {
+                const int64_t nTimeEnd = GetTimeMicros();
+                {
+                    LOCK(instance->m_cs);
+                    instance->m_running = false;
+                    CValidationQueueStats& stats = instance->m_stats;
+                    stats.nExecuted++;
+                    stats.nWaitMicros += nTimeStart - nTimeQueued;
+                    stats.nMaxWaitMicros = std::max(stats.nMaxWaitMicros, nTimeStart - nTimeQueued);
+                    stats.nRunMicros += nTimeEnd - nTimeStart;
+                }
+                instance->MaybeScheduleProcessQueue();
+            }
+        } raiicallbackrunning(this, callback.nTimeQueued);
+
+        if (!callback.fCallsSubscriber || m_connected)
+            callback.func();
+    }
+};
+
+typedef std::shared_ptr<ValidationQueue> ValidationQueueRef;
 
 struct MainSignalsInstance {
-    boost::signals2::signal<void (const CBlockIndex *, const CBlockIndex *, bool fInitialDownload)> UpdatedBlockTip;
-    boost::signals2::signal<void (const CTransactionRef &)> TransactionAddedToMempool;
-    boost::signals2::signal<void (const std::shared_ptr<const CBlock> &, const CBlockIndex *pindex, const std::vector<CTransactionRef>&)> BlockConnected;
-    boost::signals2::signal<void (const std::shared_ptr<const CBlock> &)> BlockDisconnected;
-    boost::signals2::signal<void (const CTransactionRef &)> TransactionRemovedFromMempool;
-    boost::signals2::signal<void (const CBlockLocator &)> ChainStateFlushed;
-    boost::signals2::signal<void (int64_t nBestBlockTime, CConnman* connman)> Broadcast;
-    boost::signals2::signal<void (const CBlock&, const CValidationState&)> BlockChecked;
-    boost::signals2::signal<void (const CBlockIndex *, const std::shared_ptr<const CBlock>&)> NewPoWValidBlock;
-    // SYSCOIN
-    boost::signals2::signal<void (const CBlockIndex *)> AcceptedBlockHeader;
-    boost::signals2::signal<void(const char *value, const char *topic)> NotifySyscoinUpdate;
-    boost::signals2::signal<void (const CBlockIndex *, bool fInitialDownload)> NotifyHeaderTip;
-
-    // We are not allowed to assume the scheduler only runs in one thread,
-    // but must ensure all callbacks happen in-order, so we end up creating
-    // our own queue here :(
-    SingleThreadedSchedulerClient m_schedulerClient;
-
-    explicit MainSignalsInstance(CScheduler *pscheduler) : m_schedulerClient(pscheduler) {}
+    CScheduler *m_pscheduler;
+
+    CCriticalSection m_cs;
+    CExecutor* m_pexecutor GUARDED_BY(m_cs) = nullptr;
+    TaskClass m_executor_class GUARDED_BY(m_cs) = TaskClass::NOTIFY;
+    //! in the order the subscribers registered
+    std::vector<ValidationQueueRef> m_subscribers GUARDED_BY(m_cs);
+    //! runs the functions queued while no subscriber is registered
+    ValidationQueueRef m_queue;
+
+    explicit MainSignalsInstance(CScheduler *pscheduler) : m_pscheduler(pscheduler),
+        m_queue(std::make_shared<ValidationQueue>(nullptr, "", false, pscheduler)) {}
+
+    std::vector<ValidationQueueRef> GetSubscribers()
+    {
+        LOCK(m_cs);
+        return m_subscribers;
+    }
+
+    /** Queue a call of every subscriber */
+    void AddToProcessQueues(const std::function<void (CValidationInterface*)>& func)
+    {
+        // Holding m_cs while adding keeps the callbacks in the same order in every queue
+        LOCK(m_cs);
+        for (const ValidationQueueRef& queue : m_subscribers) {
+            queue->AddCallback(std::bind(func, queue->m_interface));
+        }
+    }
+
+    /** Call every subscriber on the calling thread */
+    void CallSubscribers(const std::function<void (CValidationInterface*)>& func)
+    {
+        for (const ValidationQueueRef& queue : GetSubscribers()) {
+            if (queue->IsConnected())
+                func(queue->m_interface);
+        }
+    }
+
+    /** Queue func to run once each of the queues selected ran the callbacks queued before it */
+    void AddBarrier(const std::function<bool (const ValidationQueue&)>& select, std::function<void ()> func) EXCLUSIVE_LOCKS_REQUIRED(m_cs)
+    {
+        std::vector<ValidationQueueRef> queues;
+        for (const ValidationQueueRef& queue : m_subscribers) {
+            if (select(*queue))
+                queues.push_back(queue);
+        }
+        if (queues.empty())
+            queues.push_back(m_queue);
+        auto remaining = std::make_shared<std::atomic<size_t>>(queues.size());
+        auto shared_func = std::make_shared<std::function<void ()>>(std::move(func));
+        for (const ValidationQueueRef& queue : queues) {
+            queue->AddToProcessQueue([remaining, shared_func] {
+                if (--*remaining == 0)
+                    (*shared_func)();
+            });
+        }
+    }
 };
 
 static CMainSignals g_signals;
@@ -52,15 +240,41 @@ void CMainSignals::UnregisterBackgroundSignalScheduler() {
     m_internals.reset(nullptr);
 }
 
+void CMainSignals::SetExecutor(CExecutor* pexecutor, TaskClass executorClass) {
+    LOCK(m_internals->m_cs);
+    m_internals->m_pexecutor = pexecutor;
+    m_internals->m_executor_class = executorClass;
+    m_internals->m_queue->SetExecutor(pexecutor, executorClass);
+    for (const ValidationQueueRef& queue : m_internals->m_subscribers) {
+        queue->SetExecutor(pexecutor, executorClass);
+    }
+}
+
 void CMainSignals::FlushBackgroundCallbacks() {
     if (m_internals) {
-        m_internals->m_schedulerClient.EmptyQueue();
+        for (const ValidationQueueRef& queue : m_internals->GetSubscribers()) {
+            queue->EmptyQueue();
+        }
+        m_internals->m_queue->EmptyQueue();
     }
 }
 
 size_t CMainSignals::CallbacksPending() {
     if (!m_internals) return 0;
-    return m_internals->m_schedulerClient.CallbacksPending();
+    size_t nPending = m_internals->m_queue->CallbacksPending();
+    for (const ValidationQueueRef& queue : m_internals->GetSubscribers()) {
+        nPending = std::max(nPending, queue->CallbacksPending());
+    }
+    return nPending;
+}
+
+std::vector<CValidationQueueStats> CMainSignals::GetQueueStats() {
+    std::vector<CValidationQueueStats> vStats;
+    if (!m_internals) return vStats;
+    for (const ValidationQueueRef& queue : m_internals->GetSubscribers()) {
+        vStats.push_back(queue->GetStats());
+    }
+    return vStats;
 }
 
 void CMainSignals::RegisterWithMempoolSignals(CTxMemPool& pool) {
@@ -77,58 +291,40 @@ CMainSignals& GetMainSignals()
 }
 
 void RegisterValidationInterface(CValidationInterface* pwalletIn) {
-    g_signals.m_internals->UpdatedBlockTip.connect(boost::bind(&CValidationInterface::UpdatedBlockTip, pwalletIn, _1, _2, _3));
-    g_signals.m_internals->TransactionAddedToMempool.connect(boost::bind(&CValidationInterface::TransactionAddedToMempool, pwalletIn, _1));
-    g_signals.m_internals->BlockConnected.connect(boost::bind(&CValidationInterface::BlockConnected, pwalletIn, _1, _2, _3));
-    g_signals.m_internals->BlockDisconnected.connect(boost::bind(&CValidationInterface::BlockDisconnected, pwalletIn, _1));
-    g_signals.m_internals->TransactionRemovedFromMempool.connect(boost::bind(&CValidationInterface::TransactionRemovedFromMempool, pwalletIn, _1));
-    g_signals.m_internals->ChainStateFlushed.connect(boost::bind(&CValidationInterface::ChainStateFlushed, pwalletIn, _1));
-    g_signals.m_internals->Broadcast.connect(boost::bind(&CValidationInterface::ResendWalletTransactions, pwalletIn, _1, _2));
-    g_signals.m_internals->BlockChecked.connect(boost::bind(&CValidationInterface::BlockChecked, pwalletIn, _1, _2));
-    g_signals.m_internals->NewPoWValidBlock.connect(boost::bind(&CValidationInterface::NewPoWValidBlock, pwalletIn, _1, _2));
-    // SYSCOIN
-    g_signals.m_internals->NotifySyscoinUpdate.connect(boost::bind(&CValidationInterface::NotifySyscoinUpdate, pwalletIn, _1, _2));
-    g_signals.m_internals->AcceptedBlockHeader.connect(boost::bind(&CValidationInterface::AcceptedBlockHeader, pwalletIn, _1));
-    g_signals.m_internals->NotifyHeaderTip.connect(boost::bind(&CValidationInterface::NotifyHeaderTip, pwalletIn, _1, _2));
+    MainSignalsInstance& internals = *g_signals.m_internals;
+    ValidationQueueRef queue = std::make_shared<ValidationQueue>(pwalletIn, boost::core::demangle(typeid(*pwalletIn).name()),
+                                                                 pwalletIn->SyncOnTransactionSubmit(), internals.m_pscheduler);
+    LOCK(internals.m_cs);
+    queue->SetExecutor(internals.m_pexecutor, internals.m_executor_class);
+    internals.m_subscribers.push_back(queue);
 }
 
 void UnregisterValidationInterface(CValidationInterface* pwalletIn) {
-    g_signals.m_internals->BlockChecked.disconnect(boost::bind(&CValidationInterface::BlockChecked, pwalletIn, _1, _2));
-    g_signals.m_internals->Broadcast.disconnect(boost::bind(&CValidationInterface::ResendWalletTransactions, pwalletIn, _1, _2));
-    g_signals.m_internals->ChainStateFlushed.disconnect(boost::bind(&CValidationInterface::ChainStateFlushed, pwalletIn, _1));
-    g_signals.m_internals->TransactionAddedToMempool.disconnect(boost::bind(&CValidationInterface::TransactionAddedToMempool, pwalletIn, _1));
-    g_signals.m_internals->BlockConnected.disconnect(boost::bind(&CValidationInterface::BlockConnected, pwalletIn, _1, _2, _3));
-    g_signals.m_internals->BlockDisconnected.disconnect(boost::bind(&CValidationInterface::BlockDisconnected, pwalletIn, _1));
-    g_signals.m_internals->TransactionRemovedFromMempool.disconnect(boost::bind(&CValidationInterface::TransactionRemovedFromMempool, pwalletIn, _1));
-    g_signals.m_internals->UpdatedBlockTip.disconnect(boost::bind(&CValidationInterface::UpdatedBlockTip, pwalletIn, _1, _2, _3));
-    g_signals.m_internals->NewPoWValidBlock.disconnect(boost::bind(&CValidationInterface::NewPoWValidBlock, pwalletIn, _1, _2));
-    // SYSCOIN
-    g_signals.m_internals->NotifySyscoinUpdate.disconnect(boost::bind(&CValidationInterface::NotifySyscoinUpdate, pwalletIn, _1, _2));
-    g_signals.m_internals->NotifyHeaderTip.disconnect(boost::bind(&CValidationInterface::NotifyHeaderTip, pwalletIn, _1, _2));
-    g_signals.m_internals->AcceptedBlockHeader.disconnect(boost::bind(&CValidationInterface::AcceptedBlockHeader, pwalletIn, _1));
+    MainSignalsInstance& internals = *g_signals.m_internals;
+    LOCK(internals.m_cs);
+    for (auto it = internals.m_subscribers.begin(); it != internals.m_subscribers.end(); ++it) {
+        if ((*it)->m_interface == pwalletIn) {
+            (*it)->Disconnect();
+            internals.m_subscribers.erase(it);
+            break;
+        }
+    }
 }
 
 void UnregisterAllValidationInterfaces() {
     if (!g_signals.m_internals) {
         return;
     }
-    g_signals.m_internals->BlockChecked.disconnect_all_slots();
-    g_signals.m_internals->Broadcast.disconnect_all_slots();
-    g_signals.m_internals->ChainStateFlushed.disconnect_all_slots();
-    g_signals.m_internals->TransactionAddedToMempool.disconnect_all_slots();
-    g_signals.m_internals->BlockConnected.disconnect_all_slots();
-    g_signals.m_internals->BlockDisconnected.disconnect_all_slots();
-    g_signals.m_internals->TransactionRemovedFromMempool.disconnect_all_slots();
-    g_signals.m_internals->UpdatedBlockTip.disconnect_all_slots();
-    g_signals.m_internals->NewPoWValidBlock.disconnect_all_slots();
-    // SYSCOIN
-    g_signals.m_internals->NotifySyscoinUpdate.disconnect_all_slots();
-    g_signals.m_internals->NotifyHeaderTip.disconnect_all_slots();
-    g_signals.m_internals->AcceptedBlockHeader.disconnect_all_slots();
+    LOCK(g_signals.m_internals->m_cs);
+    for (const ValidationQueueRef& queue : g_signals.m_internals->m_subscribers) {
+        queue->Disconnect();
+    }
+    g_signals.m_internals->m_subscribers.clear();
 }
 
 void CallFunctionInValidationInterfaceQueue(std::function<void ()> func) {
-    g_signals.m_internals->m_schedulerClient.AddToProcessQueue(std::move(func));
+    LOCK(g_signals.m_internals->m_cs);
+    g_signals.m_internals->AddBarrier([](const ValidationQueue&) { return true; }, std::move(func));
 }
 
 void SyncWithValidationInterfaceQueue() {
@@ -141,10 +337,51 @@ void SyncWithValidationInterfaceQueue() {
     promise.get_future().wait();
 }
 
+// SYSCOIN
+void SyncWithValidationInterfaceQueue(CValidationInterface* pinterface) {
+    AssertLockNotHeld(cs_main);
+    std::promise<void> promise;
+    {
+        LOCK(g_signals.m_internals->m_cs);
+        g_signals.m_internals->AddBarrier([pinterface](const ValidationQueue& queue) {
+            return queue.m_interface == pinterface;
+        }, [&promise] {
+            promise.set_value();
+        });
+    }
+    promise.get_future().wait();
+}
+
+void SyncWithLaggingValidationInterfaceQueues(size_t nMaxPending) {
+    AssertLockNotHeld(cs_main);
+    std::promise<void> promise;
+    {
+        LOCK(g_signals.m_internals->m_cs);
+        const auto lagging = [nMaxPending](const ValidationQueue& queue) {
+            return queue.CallbacksPending() > nMaxPending;
+        };
+        bool fLagging = false;
+        for (const ValidationQueueRef& queue : g_signals.m_internals->m_subscribers) {
+            fLagging |= lagging(*queue);
+        }
+        if (!fLagging)
+            return;
+        g_signals.m_internals->AddBarrier(lagging, [&promise] {
+            promise.set_value();
+        });
+    }
+    promise.get_future().wait();
+}
+
+void CallFunctionInSubmitValidationInterfaceQueues(std::function<void ()> func) {
+    LOCK(g_signals.m_internals->m_cs);
+    g_signals.m_internals->AddBarrier([](const ValidationQueue& queue) { return queue.m_sync_on_submit; }, std::move(func));
+}
+
 void CMainSignals::MempoolEntryRemoved(CTransactionRef ptx, MemPoolRemovalReason reason) {
     if (reason != MemPoolRemovalReason::BLOCK && reason != MemPoolRemovalReason::CONFLICT) {
-        m_internals->m_schedulerClient.AddToProcessQueue([ptx, this] {
-            m_internals->TransactionRemovedFromMempool(ptx);
+        m_internals->AddToProcessQueues([ptx](CValidationInterface* pinterface) {
+            pinterface->TransactionRemovedFromMempool(ptx);
         });
     }
 }
@@ -154,53 +391,68 @@ void CMainSignals::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockInd
     // the chain actually updates. One way to ensure this is for the caller to invoke this signal
     // in the same critical section where the chain is updated
 
-    m_internals->m_schedulerClient.AddToProcessQueue([pindexNew, pindexFork, fInitialDownload, this] {
-        m_internals->UpdatedBlockTip(pindexNew, pindexFork, fInitialDownload);
+    m_internals->AddToProcessQueues([pindexNew, pindexFork, fInitialDownload](CValidationInterface* pinterface) {
+        pinterface->UpdatedBlockTip(pindexNew, pindexFork, fInitialDownload);
     });
 }
 
 void CMainSignals::TransactionAddedToMempool(const CTransactionRef &ptx) {
-    m_internals->m_schedulerClient.AddToProcessQueue([ptx, this] {
-        m_internals->TransactionAddedToMempool(ptx);
+    m_internals->AddToProcessQueues([ptx](CValidationInterface* pinterface) {
+        pinterface->TransactionAddedToMempool(ptx);
     });
 }
 
 void CMainSignals::BlockConnected(const std::shared_ptr<const CBlock> &pblock, const CBlockIndex *pindex, const std::shared_ptr<const std::vector<CTransactionRef>>& pvtxConflicted) {
-    m_internals->m_schedulerClient.AddToProcessQueue([pblock, pindex, pvtxConflicted, this] {
-        m_internals->BlockConnected(pblock, pindex, *pvtxConflicted);
+    m_internals->AddToProcessQueues([pblock, pindex, pvtxConflicted](CValidationInterface* pinterface) {
+        pinterface->BlockConnected(pblock, pindex, *pvtxConflicted);
     });
 }
 
 void CMainSignals::BlockDisconnected(const std::shared_ptr<const CBlock> &pblock) {
-    m_internals->m_schedulerClient.AddToProcessQueue([pblock, this] {
-        m_internals->BlockDisconnected(pblock);
+    m_internals->AddToProcessQueues([pblock](CValidationInterface* pinterface) {
+        pinterface->BlockDisconnected(pblock);
     });
 }
 
 void CMainSignals::ChainStateFlushed(const CBlockLocator &locator) {
-    m_internals->m_schedulerClient.AddToProcessQueue([locator, this] {
-        m_internals->ChainStateFlushed(locator);
+    m_internals->AddToProcessQueues([locator](CValidationInterface* pinterface) {
+        pinterface->ChainStateFlushed(locator);
     });
 }
 
 void CMainSignals::Broadcast(int64_t nBestBlockTime, CConnman* connman) {
-    m_internals->Broadcast(nBestBlockTime, connman);
+    m_internals->CallSubscribers([nBestBlockTime, connman](CValidationInterface* pinterface) {
+        pinterface->ResendWalletTransactions(nBestBlockTime, connman);
+    });
 }
 
 void CMainSignals::BlockChecked(const CBlock& block, const CValidationState& state) {
-    m_internals->BlockChecked(block, state);
+    m_internals->CallSubscribers([&block, &state](CValidationInterface* pinterface) {
+        pinterface->BlockChecked(block, state);
+    });
 }
 
 void CMainSignals::NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock> &block) {
-    m_internals->NewPoWValidBlock(pindex, block);
+    m_internals->CallSubscribers([pindex, &block](CValidationInterface* pinterface) {
+        pinterface->NewPoWValidBlock(pindex, block);
+    });
 }
 // SYSCOIN
 void CMainSignals::NotifySyscoinUpdate(const char *value, const char *topic) {
-    m_internals->NotifySyscoinUpdate(value, topic);
+    // Publishing can be slow, so it is queued like the other notifications rather than run by the caller
+    const std::string strValue(value);
+    const std::string strTopic(topic);
+    m_internals->AddToProcessQueues([strValue, strTopic](CValidationInterface* pinterface) {
+        pinterface->NotifySyscoinUpdate(strValue.c_str(), strTopic.c_str());
+    });
 }
 void CMainSignals::NotifyHeaderTip(const CBlockIndex * pindex, bool fInitialDownload) {
-    m_internals->NotifyHeaderTip(pindex, fInitialDownload);
+    m_internals->CallSubscribers([pindex, fInitialDownload](CValidationInterface* pinterface) {
+        pinterface->NotifyHeaderTip(pindex, fInitialDownload);
+    });
 }
 void CMainSignals::AcceptedBlockHeader(const CBlockIndex * pindex) {
-    m_internals->AcceptedBlockHeader(pindex);
+    m_internals->CallSubscribers([pindex](CValidationInterface* pinterface) {
+        pinterface->AcceptedBlockHeader(pindex);
+    });
 }
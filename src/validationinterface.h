@@ -10,6 +10,8 @@
 
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 class CBlock;
 class CBlockIndex;
@@ -22,7 +24,13 @@ class CValidationState;
 class uint256;
 class CScheduler;
 class CTxMemPool;
+class CExecutor;
 enum class MemPoolRemovalReason;
+enum class TaskClass;
+
+// SYSCOIN
+/** Default for -maxnotifyqueue */
+static const unsigned int DEFAULT_MAX_NOTIFY_QUEUE = 10;
 
 // These functions dispatch to one or all registered wallets
 
@@ -52,6 +60,20 @@ void CallFunctionInValidationInterfaceQueue(std::function<void ()> func);
  *     promise.get_future().wait();
  */
 void SyncWithValidationInterfaceQueue();
+// SYSCOIN
+/** Wait until one subscriber has run the callbacks generated prior to now */
+void SyncWithValidationInterfaceQueue(CValidationInterface* pinterface);
+/**
+ * Wait for the subscribers with more than nMaxPending callbacks pending to
+ * run the callbacks generated prior to now. Subscribers that keep up are not
+ * waited for.
+ */
+void SyncWithLaggingValidationInterfaceQueues(size_t nMaxPending);
+/**
+ * Pushes a function to callback once the subscribers that asked for it with
+ * SyncOnTransactionSubmit() have run the callbacks generated prior to now.
+ */
+void CallFunctionInSubmitValidationInterfaceQueues(std::function<void ()> func);
 
 /**
  * Implement this to subscribe to events generated in validation
@@ -67,6 +89,9 @@ void SyncWithValidationInterfaceQueue();
  * the BlockConnected() callback without worrying about explicit
  * synchronization. No ordering should be assumed across
  * ValidationInterface() subscribers.
+ *
+ * SYSCOIN Each subscriber has a queue of its own, so a subscriber that is slow
+ * to handle its callbacks does not hold back the others.
  */
 class CValidationInterface {
 protected:
@@ -146,12 +171,37 @@ protected:
      * has been received and connected to the headers tree, though not validated yet */
     virtual void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& block) {};
     // SYSCOIN
+    /**
+     * Notifies listeners of an updated asset or asset allocation.
+     *
+     * Called on a background thread.
+     */
     virtual void NotifySyscoinUpdate(const char *value, const char *topic) {}
     virtual void AcceptedBlockHeader(const CBlockIndex *pindexNew) {}
     virtual void NotifyHeaderTip(const CBlockIndex *pindexNew, bool fInitialDownload) {}
+    /**
+     * Whether RPCs that submit a transaction wait for this subscriber to be
+     * told of it, so that their callers find it in what the subscriber serves.
+     */
+    virtual bool SyncOnTransactionSubmit() const { return false; }
     friend void ::RegisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterAllValidationInterfaces();
+    friend class CMainSignals;
+};
+
+// SYSCOIN
+/** The callbacks queued for one subscriber and those it has run since it registered */
+struct CValidationQueueStats {
+    std::string strName;
+    size_t nPending = 0;
+    //! the most callbacks that were pending at once
+    size_t nPeakPending = 0;
+    uint64_t nExecuted = 0;
+    //! total and longest time executed callbacks waited, and their total run time
+    int64_t nWaitMicros = 0;
+    int64_t nMaxWaitMicros = 0;
+    int64_t nRunMicros = 0;
 };
 
 struct MainSignalsInstance;
@@ -163,6 +213,10 @@ private:
     friend void ::UnregisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterAllValidationInterfaces();
     friend void ::CallFunctionInValidationInterfaceQueue(std::function<void ()> func);
+    // SYSCOIN
+    friend void ::SyncWithValidationInterfaceQueue(CValidationInterface* pinterface);
+    friend void ::SyncWithLaggingValidationInterfaceQueues(size_t nMaxPending);
+    friend void ::CallFunctionInSubmitValidationInterfaceQueues(std::function<void ()> func);
 
     void MempoolEntryRemoved(CTransactionRef tx, MemPoolRemovalReason reason);
 
@@ -171,10 +225,16 @@ public:
     void RegisterBackgroundSignalScheduler(CScheduler& scheduler);
     /** Unregister a CScheduler to give callbacks which should run in the background - these callbacks will now be dropped! */
     void UnregisterBackgroundSignalScheduler();
+    // SYSCOIN
+    /** Run the subscriber queues on an executor rather than on the scheduler (after RegisterBackgroundSignalScheduler) */
+    void SetExecutor(CExecutor* pexecutor, TaskClass executorClass);
     /** Call any remaining callbacks on the calling thread */
     void FlushBackgroundCallbacks();
 
+    /** The most callbacks pending for any one subscriber */
     size_t CallbacksPending();
+    // SYSCOIN
+    std::vector<CValidationQueueStats> GetQueueStats();
 
     /** Register with mempool to call TransactionRemovedFromMempool callbacks */
     void RegisterWithMempoolSignals(CTxMemPool& pool);
@@ -1351,7 +1351,8 @@ void CWallet::BlockUntilSyncedToCurrentChain() {
     // ...otherwise put a callback in the validation interface queue and wait
     // for the queue to drain enough to execute it (indicating we are caught up
     // at least with the time we entered this function).
-    SyncWithValidationInterfaceQueue();
+    // SYSCOIN Only this wallet's queue matters.
+    SyncWithValidationInterfaceQueue(this);
 }
 
 
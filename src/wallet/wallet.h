@@ -1036,6 +1036,8 @@ public:
     CAmount GetCredit(const CTransaction& tx, const isminefilter& filter) const;
     CAmount GetChange(const CTransaction& tx) const;
     void ChainStateFlushed(const CBlockLocator& loc) override;
+    // SYSCOIN sendrawtransaction returns once the wallet knows of the transaction
+    bool SyncOnTransactionSubmit() const override { return true; }
 
     DBErrors LoadWallet(bool& fFirstRunRet);
     DBErrors ZapWalletTx(std::vector<CWalletTx>& vWtx);
@@ -4,7 +4,7 @@
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 """Test the scantxoutset rpc call."""
 from test_framework.test_framework import SyscoinTestFramework
-from test_framework.util import assert_equal
+from test_framework.util import assert_equal, assert_raises_rpc_error
 
 from decimal import Decimal
 import shutil
@@ -91,5 +91,21 @@ class ScantxoutsetTest(SyscoinTestFramework):
         assert_equal(self.nodes[0].scantxoutset("start", [ {"desc": "combo(tpubD6NzVbkrYhZ4WaWSyoBvQwbpLkojyoTZPRsgXELWz3Popb3qkjcJyJUGLnL4qHHoQvao8ESaAstxYSnhyswJ76uZPStJRJCTKvosUCJZL5B/1/1/*)", "range": 1499}])['total_amount'], Decimal("12.288"))
         assert_equal(self.nodes[0].scantxoutset("start", [ {"desc": "combo(tpubD6NzVbkrYhZ4WaWSyoBvQwbpLkojyoTZPRsgXELWz3Popb3qkjcJyJUGLnL4qHHoQvao8ESaAstxYSnhyswJ76uZPStJRJCTKvosUCJZL5B/1/1/*)", "range": 1500}])['total_amount'], Decimal("28.672"))
 
+        self.log.info("Test a background scan with begin/status/fetch")
+        desc = {"desc": "combo(tpubD6NzVbkrYhZ4WaWSyoBvQwbpLkojyoTZPRsgXELWz3Popb3qkjcJyJUGLnL4qHHoQvao8ESaAstxYSnhyswJ76uZPStJRJCTKvosUCJZL5B/1/1/*)", "range": 1500}
+        jobid = self.nodes[0].scantxoutset("begin", [desc])['jobid']
+        total = Decimal(0)
+        while True:
+            res = self.nodes[0].scantxoutset("fetch", jobid)
+            total += res['total_amount']
+            if res['done']:
+                assert res['success']
+                break
+        assert_equal(total, Decimal("28.672"))
+        # a finished and fetched job is forgotten
+        assert_raises_rpc_error(-8, "Unknown jobid", self.nodes[0].scantxoutset, "status", jobid)
+        assert_equal(self.nodes[0].scantxoutset("status"), None)
+        assert_equal(self.nodes[0].scantxoutset("abort"), False)
+
 if __name__ == '__main__':
     ScantxoutsetTest().main()